@@ -0,0 +1,247 @@
+#include "Fixtures.hpp"
+#include "../TestRenderer/Allocators.hpp"
+#include "../TestRenderer/MemoryTracker.hpp"
+#include "../TestRenderer/JobSystem.hpp"
+#include "../TestRenderer/TangentSpace.hpp"
+
+#include <cmath>
+#include <memory>
+
+namespace
+{
+	constexpr uint32_t FRAME_ALLOCATION_COUNT = 512;
+	constexpr uint32_t FRAME_VECTOR_SIZE = 4096;
+	constexpr size_t POOL_SLOT_COUNT = 4096;
+	// below the batch size of GenerateTangentSpace, so ParallelFor stays on the calling thread and
+	// does not create threads of its own
+	constexpr uint32_t GRID_SIZE = 16;
+	constexpr uint32_t WARM_FRAME_COUNT = 16;
+	// several batches of GenerateTangentSpace, so every pass is split across the workers
+	constexpr uint32_t PARALLEL_GRID_SIZE = 96;
+	constexpr float TANGENT_TOLERANCE = 1e-5f;
+
+	// what a frame of the application does with its frame arena and the TexGen node pool, the arena
+	// starts with a block far below the frame's peak so the first frames spill
+	struct SAllocatorFixture
+	{
+		FArenaAllocator Arena{ "Benchmark Frame", 64 << 10 };
+		FPoolAllocator Pool{ "Benchmark Pool", 64, 256 };
+		std::vector<void*> Slots;
+		std::vector<DirectX::XMFLOAT3> Positions;
+		std::vector<DirectX::XMFLOAT2> TexCoords;
+		std::vector<uint32_t> Indices;
+	};
+
+	// a bumpy grid with hard and smooth edges, two triangles per cell
+	void MakeGrid(const uint32_t GridSize, std::vector<DirectX::XMFLOAT3>& Positions, std::vector<DirectX::XMFLOAT2>& TexCoords, std::vector<uint32_t>& Indices)
+	{
+		for (uint32_t Y = 0; Y <= GridSize; ++Y)
+		{
+			for (uint32_t X = 0; X <= GridSize; ++X)
+			{
+				Positions.push_back({ static_cast<float>(X), static_cast<float>((X * Y) % 3), static_cast<float>(Y) });
+				TexCoords.push_back({ static_cast<float>(X) / GridSize, static_cast<float>(Y) / GridSize });
+			}
+		}
+		for (uint32_t Y = 0; Y < GridSize; ++Y)
+		{
+			for (uint32_t X = 0; X < GridSize; ++X)
+			{
+				const uint32_t Corner = Y * (GridSize + 1) + X;
+				Indices.insert(Indices.end(), { Corner, Corner + GridSize + 1, Corner + 1, Corner + 1, Corner + GridSize + 1, Corner + GridSize + 2 });
+			}
+		}
+	}
+
+	std::shared_ptr<SAllocatorFixture> MakeAllocatorFixture()
+	{
+		auto Fixture = std::make_shared<SAllocatorFixture>();
+		Fixture->Slots.reserve(POOL_SLOT_COUNT);
+		MakeGrid(GRID_SIZE, Fixture->Positions, Fixture->TexCoords, Fixture->Indices);
+		return Fixture;
+	}
+
+	void RunArenaFrame(SAllocatorFixture& Fixture)
+	{
+		auto& Arena = Fixture.Arena;
+		Arena.Reset();
+		for (uint32_t Index = 0; Index < FRAME_ALLOCATION_COUNT; ++Index)
+		{
+			Arena.Allocate(16 + (Index * 37) % 1024);
+		}
+		{
+			FArenaScope Scope(Arena);
+			TArenaVector<uint32_t> Visible{ TArenaAdaptor<uint32_t>(Arena) };
+			for (uint32_t Index = 0; Index < FRAME_VECTOR_SIZE; ++Index)
+			{
+				Visible.push_back(Index);
+			}
+		}
+		{
+			FArenaScope Scope(Arena);
+			STangentSpaceInput Input{};
+			Input.Positions = Fixture.Positions.data();
+			Input.TexCoords = Fixture.TexCoords.data();
+			Input.VertexCount = Fixture.Positions.size();
+			Input.Indices = Fixture.Indices.data();
+			Input.IndexCount = Fixture.Indices.size();
+			TArenaVector<STangentSpaceVertex> Vertices{ TArenaAdaptor<STangentSpaceVertex>(Arena) };
+			TArenaVector<uint32_t> Indices{ TArenaAdaptor<uint32_t>(Arena) };
+			GenerateTangentSpace(Arena, Input, 45.0f, Vertices, Indices);
+		}
+	}
+
+	// frees every other slot and takes them back before freeing all, so the free list is not in
+	// allocation order
+	void RunPoolFrame(SAllocatorFixture& Fixture)
+	{
+		auto& Slots = Fixture.Slots;
+		for (size_t Index = 0; Index < POOL_SLOT_COUNT; ++Index)
+		{
+			Slots.push_back(Fixture.Pool.Allocate());
+		}
+		for (size_t Index = 0; Index < POOL_SLOT_COUNT; Index += 2)
+		{
+			Fixture.Pool.Free(Slots[Index]);
+		}
+		for (size_t Index = 0; Index < POOL_SLOT_COUNT; Index += 2)
+		{
+			Slots[Index] = Fixture.Pool.Allocate();
+		}
+		for (const auto Slot : Slots)
+		{
+			Fixture.Pool.Free(Slot);
+		}
+		Slots.clear();
+	}
+
+	bool IsNear(const float* A, const float* B, const size_t Count)
+	{
+		for (size_t Index = 0; Index < Count; ++Index)
+		{
+			if (std::fabs(A[Index] - B[Index]) > TANGENT_TOLERANCE)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// The same grid through GenerateTangentSpace on a single thread and spread over a job system's
+	// workers. Every corner has to come out with the same vertex.
+	bool CheckParallelTangentSpace()
+	{
+		std::vector<DirectX::XMFLOAT3> Positions;
+		std::vector<DirectX::XMFLOAT2> TexCoords;
+		std::vector<uint32_t> InputIndices;
+		MakeGrid(PARALLEL_GRID_SIZE, Positions, TexCoords, InputIndices);
+		STangentSpaceInput Input{};
+		Input.Positions = Positions.data();
+		Input.TexCoords = TexCoords.data();
+		Input.VertexCount = Positions.size();
+		Input.Indices = InputIndices.data();
+		Input.IndexCount = InputIndices.size();
+
+		// the calling thread works for the job system between Initialize and Shutdown
+		const auto Generate = [&Input](const size_t ThreadCount, std::vector<STangentSpaceVertex>& Corners)
+		{
+			FJobSystem JobSystem;
+			JobSystem.Initialize(ThreadCount);
+			FArenaAllocator Arena{ "Benchmark Tangent Space", 4 << 20 };
+			TArenaVector<STangentSpaceVertex> Vertices{ TArenaAdaptor<STangentSpaceVertex>(Arena) };
+			TArenaVector<uint32_t> Indices{ TArenaAdaptor<uint32_t>(Arena) };
+			GenerateTangentSpace(Arena, Input, 45.0f, Vertices, Indices);
+			JobSystem.Shutdown();
+			for (const auto Index : Indices)
+			{
+				Corners.push_back(Vertices[Index]);
+			}
+		};
+		std::vector<STangentSpaceVertex> Serial;
+		std::vector<STangentSpaceVertex> Parallel;
+		Generate(1, Serial);
+		Generate(4, Parallel);
+
+		if (Serial.size() != Parallel.size() || Serial.size() != InputIndices.size())
+		{
+			fprintf(stderr, "%zu corners serial, %zu parallel, %zu expected\n", Serial.size(), Parallel.size(), InputIndices.size());
+			return false;
+		}
+		for (size_t Corner = 0; Corner < Serial.size(); ++Corner)
+		{
+			const auto& A = Serial[Corner];
+			const auto& B = Parallel[Corner];
+			if (!IsNear(&A.Position.x, &B.Position.x, 3) || !IsNear(&A.Normal.x, &B.Normal.x, 3) || !IsNear(&A.TexCoord.x, &B.TexCoord.x, 2) || !IsNear(&A.Tangent.x, &B.Tangent.x, 4))
+			{
+				fprintf(stderr, "corner %zu: normal %g %g %g tangent %g %g %g %g serial, normal %g %g %g tangent %g %g %g %g parallel\n", Corner,
+					A.Normal.x, A.Normal.y, A.Normal.z, A.Tangent.x, A.Tangent.y, A.Tangent.z, A.Tangent.w,
+					B.Normal.x, B.Normal.y, B.Normal.z, B.Tangent.x, B.Tangent.y, B.Tangent.z, B.Tangent.w);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool CheckNoHeapAllocations()
+	{
+		// a counter that does not see the heap would pass everything below
+		const auto ProbeBefore = GetHeapAllocationCount();
+		void* volatile Probe = ::operator new(16);
+		::operator delete(Probe);
+		if (GetHeapAllocationCount() == ProbeBefore)
+		{
+			fprintf(stderr, "heap allocations are not counted\n");
+			return false;
+		}
+
+		auto Fixture = MakeAllocatorFixture();
+		// the first frame spills into extra blocks and the reset after it merges them into one
+		for (uint32_t Frame = 0; Frame < 2; ++Frame)
+		{
+			RunArenaFrame(*Fixture);
+			RunPoolFrame(*Fixture);
+		}
+
+		const auto Before = GetHeapAllocationCount();
+		for (uint32_t Frame = 0; Frame < WARM_FRAME_COUNT; ++Frame)
+		{
+			RunArenaFrame(*Fixture);
+			RunPoolFrame(*Fixture);
+		}
+		const auto Allocations = GetHeapAllocationCount() - Before;
+		if (Allocations != 0)
+		{
+			fprintf(stderr, "%llu heap allocations in %u warm frames\n", static_cast<unsigned long long>(Allocations), WARM_FRAME_COUNT);
+			return false;
+		}
+		return true;
+	}
+}
+
+void AddAllocatorBenchmarks(FBenchmarkRunner& Runner)
+{
+	Runner.AddCheck({ "allocators/no_heap_when_warm", CheckNoHeapAllocations });
+	Runner.AddCheck({ "tangentspace/parallel_matches_serial", CheckParallelTangentSpace });
+
+	// items are arena allocations, the scoped vector's growth and the tangent space scratch not counted
+	auto ArenaFixture = MakeAllocatorFixture();
+	SBenchmark Arena{};
+	Arena.Name = "allocators/frame_arena";
+	Arena.Items = FRAME_ALLOCATION_COUNT;
+	Arena.Run = [ArenaFixture]()
+	{
+		RunArenaFrame(*ArenaFixture);
+	};
+	Runner.Add(std::move(Arena));
+
+	// items are pool allocations
+	auto PoolFixture = MakeAllocatorFixture();
+	SBenchmark Pool{};
+	Pool.Name = "allocators/pool";
+	Pool.Items = POOL_SLOT_COUNT + POOL_SLOT_COUNT / 2;
+	Pool.Run = [PoolFixture]()
+	{
+		RunPoolFrame(*PoolFixture);
+	};
+	Runner.Add(std::move(Pool));
+}
@@ -0,0 +1,324 @@
+#include "Benchmark.hpp"
+#include "../TestRenderer/MemoryTracker.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+	double Percentile(const std::vector<double>& Sorted, const double Fraction) noexcept
+	{
+		return Sorted[std::min(Sorted.size() - 1, static_cast<size_t>(Fraction * (Sorted.size() - 1) + 0.5))];
+	}
+
+	// Linux forgets the peak when 5 is written to clear_refs, which needs 4.0 or later
+	void ResetPeakResidentBytes() noexcept
+	{
+#if defined(__linux__)
+		if (FILE* File = fopen("/proc/self/clear_refs", "w"))
+		{
+			fputs("5", File);
+			fclose(File);
+		}
+#endif
+	}
+
+	uint64_t GetPeakResidentBytes() noexcept
+	{
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS Counters{};
+		return GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters)) ? Counters.PeakWorkingSetSize : 0;
+#elif defined(__linux__)
+		// VmHWM follows the reset, the maximum getrusage reports does not
+		uint64_t Kilobytes = 0;
+		if (FILE* File = fopen("/proc/self/status", "r"))
+		{
+			char Line[256];
+			while (fgets(Line, sizeof(Line), File))
+			{
+				unsigned long long Value = 0;
+				if (sscanf(Line, "VmHWM: %llu kB", &Value) == 1)
+				{
+					Kilobytes = Value;
+					break;
+				}
+			}
+			fclose(File);
+		}
+		return Kilobytes * 1024;
+#else
+		rusage Usage{};
+		return getrusage(RUSAGE_SELF, &Usage) == 0 ? static_cast<uint64_t>(Usage.ru_maxrss) : 0;
+#endif
+	}
+
+	void WriteJsonString(FILE* File, const std::string& Value) noexcept
+	{
+		fputc('"', File);
+		for (const char Character : Value)
+		{
+			if (Character == '"' || Character == '\\')
+			{
+				fputc('\\', File);
+			}
+			fputc(Character, File);
+		}
+		fputc('"', File);
+	}
+}
+
+SBenchmarkStatistics ComputeStatistics(std::vector<double> Milliseconds)
+{
+	SBenchmarkStatistics Statistics{};
+	if (Milliseconds.empty())
+	{
+		return Statistics;
+	}
+	std::sort(Milliseconds.begin(), Milliseconds.end());
+	double Total = 0.0;
+	for (const auto Value : Milliseconds)
+	{
+		Total += Value;
+	}
+	Statistics.Mean = Total / Milliseconds.size();
+	Statistics.Median = Percentile(Milliseconds, 0.5);
+	Statistics.P95 = Percentile(Milliseconds, 0.95);
+	Statistics.Minimum = Milliseconds.front();
+	Statistics.Maximum = Milliseconds.back();
+
+	for (auto& Value : Milliseconds)
+	{
+		Value = std::fabs(Value - Statistics.Median);
+	}
+	std::sort(Milliseconds.begin(), Milliseconds.end());
+	Statistics.MedianAbsoluteDeviation = Percentile(Milliseconds, 0.5);
+	return Statistics;
+}
+
+void FBenchmarkRunner::SetWarmupCount(const uint32_t Count) noexcept
+{
+	WarmupCount = Count;
+}
+
+void FBenchmarkRunner::SetRepetitionCount(const uint32_t Count) noexcept
+{
+	RepetitionCount = std::max(1u, Count);
+}
+
+void FBenchmarkRunner::SetFilter(const char* InFilter) noexcept
+{
+	Filter = InFilter ? InFilter : "";
+}
+
+void FBenchmarkRunner::Add(SBenchmark&& Benchmark)
+{
+	Benchmarks.push_back(std::move(Benchmark));
+}
+
+void FBenchmarkRunner::AddCheck(SBenchmarkCheck&& Check)
+{
+	Checks.push_back(std::move(Check));
+}
+
+bool FBenchmarkRunner::RunChecks()
+{
+	bool bPassed = true;
+	for (const auto& Check : Checks)
+	{
+		if (!Filter.empty() && Check.Name.find(Filter) == std::string::npos)
+		{
+			continue;
+		}
+		const bool bCheckPassed = Check.Run();
+		printf("%-40s %s\n", Check.Name.c_str(), bCheckPassed ? "passed" : "FAILED");
+		bPassed = bPassed && bCheckPassed;
+	}
+	return bPassed;
+}
+
+void FBenchmarkRunner::Run()
+{
+	using FClock = std::chrono::steady_clock;
+	for (const auto& Benchmark : Benchmarks)
+	{
+		if (!Filter.empty() && Benchmark.Name.find(Filter) == std::string::npos)
+		{
+			continue;
+		}
+
+		SBenchmarkResult Result{};
+		Result.Name = Benchmark.Name;
+		Result.Items = Benchmark.Items;
+		ResetPeakResidentBytes();
+		if (Benchmark.Setup && !Benchmark.Setup(Result.Items))
+		{
+			Result.bSkipped = true;
+			printf("%-40s skipped\n", Benchmark.Name.c_str());
+			Results.push_back(std::move(Result));
+			continue;
+		}
+
+		const uint32_t Warmups = Benchmark.RepetitionLimit > 0 ? 0 : WarmupCount;
+		const uint32_t Repetitions = Benchmark.RepetitionLimit > 0 ? std::min(RepetitionCount, Benchmark.RepetitionLimit) : RepetitionCount;
+		for (uint32_t Index = 0; Index < Warmups; ++Index)
+		{
+			Benchmark.Run();
+		}
+
+		Result.Milliseconds.reserve(Repetitions);
+		const auto AllocationsBefore = GetHeapAllocationCount();
+		for (uint32_t Index = 0; Index < Repetitions; ++Index)
+		{
+			const auto Start = FClock::now();
+			Benchmark.Run();
+			Result.Milliseconds.push_back(std::chrono::duration<double, std::milli>(FClock::now() - Start).count());
+		}
+		// the samples were reserved up front, so every allocation counted here is the fixture's
+		Result.Allocations = static_cast<double>(GetHeapAllocationCount() - AllocationsBefore) / Repetitions;
+		Result.PeakResidentBytes = GetPeakResidentBytes();
+		Result.Statistics = ComputeStatistics(Result.Milliseconds);
+		if (Benchmark.Counters)
+		{
+			Benchmark.Counters(Result.Counters);
+		}
+		if (Benchmark.Teardown)
+		{
+			Benchmark.Teardown();
+		}
+
+		const auto& Statistics = Result.Statistics;
+		printf("%-40s median %10.4f ms  p95 %10.4f ms  mad %8.4f ms  %12.0f items/s  %8.1f allocs  %8.1f MB peak", Benchmark.Name.c_str(),
+			Statistics.Median, Statistics.P95, Statistics.MedianAbsoluteDeviation,
+			Statistics.Median > 0.0 ? Result.Items * 1000.0 / Statistics.Median : 0.0, Result.Allocations, Result.PeakResidentBytes / 1048576.0);
+		for (const auto& Counter : Result.Counters)
+		{
+			printf("  %s %llu", Counter.Name.c_str(), static_cast<unsigned long long>(Counter.Value));
+		}
+		printf("\n");
+		Results.push_back(std::move(Result));
+	}
+}
+
+const std::vector<SBenchmarkResult>& FBenchmarkRunner::GetResults() const noexcept
+{
+	return Results;
+}
+
+bool FBenchmarkRunner::WriteJson(const char* FileName, const char* Label) const noexcept
+{
+	FILE* File = fopen(FileName, "w");
+	if (File == nullptr)
+	{
+		return false;
+	}
+	fprintf(File, "{\n\t\"version\": 1,\n\t\"label\": ");
+	WriteJsonString(File, Label ? Label : "");
+	fprintf(File, ",\n\t\"warmup\": %u,\n\t\"repetitions\": %u,\n\t\"benchmarks\": [", WarmupCount, RepetitionCount);
+	for (size_t Index = 0; Index < Results.size(); ++Index)
+	{
+		const auto& Result = Results[Index];
+		const auto& Statistics = Result.Statistics;
+		fprintf(File, "%s\n\t\t{ \"name\": ", Index == 0 ? "" : ",");
+		WriteJsonString(File, Result.Name);
+		if (Result.bSkipped)
+		{
+			fprintf(File, ", \"skipped\": true }");
+			continue;
+		}
+		fprintf(File, ", \"items\": %llu, \"median_ms\": %.6f, \"p95_ms\": %.6f, \"mad_ms\": %.6f, \"mean_ms\": %.6f, \"min_ms\": %.6f, \"max_ms\": %.6f, \"allocations\": %.1f, \"peak_rss_bytes\": %llu, \"samples_ms\": [",
+			static_cast<unsigned long long>(Result.Items), Statistics.Median, Statistics.P95, Statistics.MedianAbsoluteDeviation, Statistics.Mean, Statistics.Minimum, Statistics.Maximum, Result.Allocations,
+			static_cast<unsigned long long>(Result.PeakResidentBytes));
+		for (size_t Sample = 0; Sample < Result.Milliseconds.size(); ++Sample)
+		{
+			fprintf(File, "%s%.6f", Sample == 0 ? "" : ", ", Result.Milliseconds[Sample]);
+		}
+		fprintf(File, "]");
+		if (!Result.Counters.empty())
+		{
+			fprintf(File, ", \"counters\": {");
+			for (size_t Counter = 0; Counter < Result.Counters.size(); ++Counter)
+			{
+				fprintf(File, "%s ", Counter == 0 ? "" : ",");
+				WriteJsonString(File, Result.Counters[Counter].Name);
+				fprintf(File, ": %llu", static_cast<unsigned long long>(Result.Counters[Counter].Value));
+			}
+			fprintf(File, " }");
+		}
+		fprintf(File, " }");
+	}
+	fprintf(File, "\n\t]\n}\n");
+	const bool bWritten = ferror(File) == 0;
+	fclose(File);
+	return bWritten;
+}
+
+std::vector<std::string> ListDirectory(const std::string& Directory, const bool bDirectories)
+{
+	std::vector<std::string> Names;
+#if defined(_WIN32)
+	WIN32_FIND_DATAA FindData{};
+	const HANDLE Find = FindFirstFileA((Directory + "\\*").c_str(), &FindData);
+	if (Find == INVALID_HANDLE_VALUE)
+	{
+		return Names;
+	}
+	do
+	{
+		const bool bDirectory = (FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+		if (bDirectory == bDirectories && FindData.cFileName[0] != '.')
+		{
+			Names.push_back(FindData.cFileName);
+		}
+	} while (FindNextFileA(Find, &FindData));
+	FindClose(Find);
+#else
+	DIR* Handle = opendir(Directory.c_str());
+	if (Handle == nullptr)
+	{
+		return Names;
+	}
+	while (const dirent* Entry = readdir(Handle))
+	{
+		struct stat Status{};
+		if (Entry->d_name[0] == '.' || stat((Directory + "/" + Entry->d_name).c_str(), &Status) != 0)
+		{
+			continue;
+		}
+		if ((S_ISDIR(Status.st_mode) != 0) == bDirectories)
+		{
+			Names.push_back(Entry->d_name);
+		}
+	}
+	closedir(Handle);
+#endif
+	std::sort(Names.begin(), Names.end());
+	return Names;
+}
+
+bool ReadWholeFile(const std::string& FileName, std::vector<uint8_t>& Contents)
+{
+	FILE* File = fopen(FileName.c_str(), "rb");
+	if (File == nullptr)
+	{
+		return false;
+	}
+	fseek(File, 0, SEEK_END);
+	const long Size = ftell(File);
+	fseek(File, 0, SEEK_SET);
+	Contents.resize(Size > 0 ? static_cast<size_t>(Size) : 0);
+	const bool bRead = Size >= 0 && fread(Contents.data(), 1, Contents.size(), File) == Contents.size();
+	fclose(File);
+	return bRead;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct SBenchmarkStatistics
+{
+	double Median = 0.0;
+	double P95 = 0.0;
+	// median absolute deviation from the median, robust against the odd descheduled sample
+	double MedianAbsoluteDeviation = 0.0;
+	double Mean = 0.0;
+	double Minimum = 0.0;
+	double Maximum = 0.0;
+};
+
+SBenchmarkStatistics ComputeStatistics(std::vector<double> Milliseconds);
+
+// A count describing what a fixture's work produced, how many boxes were culled for example
+struct SBenchmarkCounter
+{
+	std::string Name;
+	uint64_t Value;
+};
+
+// One fixture. Setup runs once and may fail, for example when an asset is missing, which skips
+// the fixture. Run is what gets timed, Items is how much work a single Run does and may be set by
+// Setup when it depends on the data. Teardown runs after the samples were taken and frees what
+// should not stay around for the following fixtures.
+struct SBenchmark
+{
+	std::string Name;
+	std::function<bool(uint64_t& Items)> Setup;
+	std::function<void()> Run;
+	std::function<void()> Teardown;
+	uint64_t Items = 1;
+	// optional, called once after the samples and before Teardown, the counters are printed and
+	// written to the json next to the timings
+	std::function<void(std::vector<SBenchmarkCounter>& Counters)> Counters;
+	// fixtures that run for seconds skip the warmup and are timed at most this often, 0 for no limit
+	uint32_t RepetitionLimit = 0;
+};
+
+// A correctness check of code the fixtures time, asserting what a timing cannot show. Run
+// returns false when the check fails, it may print why to stderr first.
+struct SBenchmarkCheck
+{
+	std::string Name;
+	std::function<bool()> Run;
+};
+
+struct SBenchmarkResult
+{
+	std::string Name;
+	bool bSkipped = false;
+	uint64_t Items = 0;
+	std::vector<double> Milliseconds;
+	SBenchmarkStatistics Statistics;
+	// tracked heap allocations per Run
+	double Allocations = 0.0;
+	// peak resident memory of the process after the samples, reset before every fixture on Linux
+	// and the peak since the start elsewhere
+	uint64_t PeakResidentBytes = 0;
+	std::vector<SBenchmarkCounter> Counters;
+};
+
+class FBenchmarkRunner
+{
+public:
+	void SetWarmupCount(const uint32_t Count) noexcept;
+	void SetRepetitionCount(const uint32_t Count) noexcept;
+	// only fixtures whose name contains Filter run, nullptr runs all of them
+	void SetFilter(const char* Filter) noexcept;
+
+	void Add(SBenchmark&& Benchmark);
+	void AddCheck(SBenchmarkCheck&& Check);
+	// runs the checks whose name contains the filter in the order they were added and prints a
+	// line for each, false when one of them failed
+	bool RunChecks();
+	// runs the fixtures in the order they were added and prints a line for each
+	void Run();
+
+	const std::vector<SBenchmarkResult>& GetResults() const noexcept;
+	// Label identifies the build or machine when results are tracked over time
+	bool WriteJson(const char* FileName, const char* Label) const noexcept;
+
+private:
+	uint32_t WarmupCount = 2;
+	uint32_t RepetitionCount = 15;
+	std::string Filter;
+	std::vector<SBenchmark> Benchmarks;
+	std::vector<SBenchmarkCheck> Checks;
+	std::vector<SBenchmarkResult> Results;
+};
+
+// Names of the entries of Directory, directories or regular files, sorted
+std::vector<std::string> ListDirectory(const std::string& Directory, const bool bDirectories);
+bool ReadWholeFile(const std::string& FileName, std::vector<uint8_t>& Contents);
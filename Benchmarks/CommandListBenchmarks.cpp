@@ -0,0 +1,149 @@
+#include "Fixtures.hpp"
+#include "../TestRenderer/CommandList.hpp"
+#include "../TestRenderer/JobSystem.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+namespace
+{
+	// the draw count the Model window benchmarks recording with
+	constexpr size_t DRAW_COUNT = 10000;
+
+	struct SRecordingFixture
+	{
+		// padded so the vectors of neighbouring lists never share a cache line
+		struct SPaddedCommandList
+		{
+			FCommandList CommandList;
+			uint8_t Padding[64];
+		};
+
+		FJobSystem JobSystem;
+		std::vector<SPaddedCommandList> CommandLists;
+	};
+
+	// Lists with mixed sort keys are recorded on several threads, so they finish in any order, and
+	// passed in by index. The merged draws have to come out ordered by key and, within a key, by
+	// index, every time.
+	bool CheckMergeOrder()
+	{
+		static constexpr uint32_t SORT_KEYS[] = { 2, 0, 1, 0, 2, 1, 0, 2 };
+		static constexpr size_t LIST_COUNT = sizeof(SORT_KEYS) / sizeof(SORT_KEYS[0]);
+		static constexpr uint32_t DRAWS_PER_LIST = 3;
+
+		std::vector<uint32_t> Expected;
+		for (uint32_t Key = 0; Key < 3; ++Key)
+		{
+			for (uint32_t List = 0; List < LIST_COUNT; ++List)
+			{
+				for (uint32_t Draw = 0; Draw < DRAWS_PER_LIST && SORT_KEYS[List] == Key; ++Draw)
+				{
+					Expected.push_back(List * 100 + Draw);
+				}
+			}
+		}
+
+		FJobSystem JobSystem;
+		JobSystem.Initialize(std::max(2u, std::thread::hardware_concurrency()));
+		std::vector<FCommandList> CommandLists(LIST_COUNT);
+		std::vector<const FCommandList*> Order;
+		std::vector<uint32_t> Merged;
+		for (uint32_t Round = 0; Round < 64; ++Round)
+		{
+			JobSystem.ParallelFor(LIST_COUNT, 1, [&CommandLists, Round](const size_t Begin, const size_t End)
+			{
+				for (size_t List = Begin; List < End; ++List)
+				{
+					auto& CommandList = CommandLists[List];
+					CommandList.Reset(SORT_KEYS[List]);
+					// uneven amounts of work, so lists finish in a different order than they started
+					RecordBenchmarkDraws(CommandList, 0, (List * 7 + Round) % 5 * 50);
+					for (uint32_t Draw = 0; Draw < DRAWS_PER_LIST; ++Draw)
+					{
+						CommandList.Draw(List * 100 + Draw, 0);
+					}
+				}
+			});
+
+			std::vector<const FCommandList*> Pointers;
+			for (const auto& CommandList : CommandLists)
+			{
+				Pointers.push_back(&CommandList);
+			}
+			SortCommandLists(Pointers.data(), Pointers.size(), Order);
+			Merged.clear();
+			for (const auto CommandList : Order)
+			{
+				for (size_t Index = 0; Index < CommandList->GetCommandCount(); ++Index)
+				{
+					const auto& Command = CommandList->GetCommand(Index);
+					if (Command.Type == FCommandList::ECommand::DRAW)
+					{
+						Merged.push_back(Command.Draw.Count);
+					}
+				}
+			}
+			if (Merged != Expected)
+			{
+				const auto Mismatch = std::mismatch(Merged.begin(), Merged.end(), Expected.begin(), Expected.end());
+				fprintf(stderr, "round %u: %zu of %zu draws merged, draw %zu is list %u's instead of list %u's\n", Round, Merged.size(), Expected.size(),
+					static_cast<size_t>(Mismatch.first - Merged.begin()), Mismatch.first != Merged.end() ? *Mismatch.first / 100 : 0u,
+					Mismatch.second != Expected.end() ? *Mismatch.second / 100 : 0u);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// every thread records a contiguous range of the draws into a list of its own, the lists are
+	// kept between runs so steady state recording does not allocate. Items are draws.
+	SBenchmark MakeRecordingBenchmark(const uint32_t ThreadCount)
+	{
+		auto Fixture = std::make_shared<SRecordingFixture>();
+		SBenchmark Benchmark{};
+		Benchmark.Name = "recording/t" + std::to_string(ThreadCount);
+		Benchmark.Items = DRAW_COUNT;
+		Benchmark.Setup = [Fixture, ThreadCount](uint64_t&)
+		{
+			Fixture->JobSystem.Initialize(ThreadCount);
+			Fixture->CommandLists.resize(ThreadCount);
+			return true;
+		};
+		Benchmark.Run = [Fixture, ThreadCount]()
+		{
+			Fixture->JobSystem.ParallelFor(ThreadCount, 1, [&Fixture, ThreadCount](const size_t Begin, const size_t End)
+			{
+				for (size_t List = Begin; List < End; ++List)
+				{
+					auto& CommandList = Fixture->CommandLists[List].CommandList;
+					CommandList.Reset(static_cast<uint32_t>(List));
+					RecordBenchmarkDraws(CommandList, DRAW_COUNT * List / ThreadCount, DRAW_COUNT * (List + 1) / ThreadCount);
+				}
+			});
+		};
+		Benchmark.Teardown = [Fixture]()
+		{
+			Fixture->JobSystem.Shutdown();
+			Fixture->CommandLists.clear();
+		};
+		return Benchmark;
+	}
+}
+
+void AddCommandListBenchmarks(FBenchmarkRunner& Runner)
+{
+	Runner.AddCheck({ "recording/merge_is_key_sorted_and_stable", CheckMergeOrder });
+
+	// speedup curve, 1, 2, 4 ... threads up to every hardware thread
+	const uint32_t HardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+	for (uint32_t ThreadCount = 1; ; ThreadCount *= 2)
+	{
+		Runner.Add(MakeRecordingBenchmark(std::min(ThreadCount, HardwareThreads)));
+		if (ThreadCount >= HardwareThreads)
+		{
+			break;
+		}
+	}
+}
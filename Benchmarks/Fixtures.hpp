@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Benchmark.hpp"
+
+// MeshDirectory is TestRenderer's Mesh directory, one subdirectory per asset
+void AddImportBenchmarks(FBenchmarkRunner& Runner, const std::string& MeshDirectory);
+void AddImageBenchmarks(FBenchmarkRunner& Runner, const std::string& MeshDirectory);
+// a frame's worth of frame arena and pool traffic, and a check that warm arenas and pools do not
+// touch the heap
+void AddAllocatorBenchmarks(FBenchmarkRunner& Runner);
+// empty jobs spawned on one thread and stolen by the others, and a fork/join tree at every power
+// of two thread count, with a check that the tree runs every job once
+void AddJobBenchmarks(FBenchmarkRunner& Runner);
+// the Model window's 10k draws recorded into command lists on 1, 2, 4 ... threads
+void AddCommandListBenchmarks(FBenchmarkRunner& Runner);
+// update and render loads run serially and overlapped on an update thread, and a check that the
+// triple buffer between them only hands over whole states in order
+void AddFramePipelineBenchmarks(FBenchmarkRunner& Runner);
+// CPU blur passes, frustum and occlusion culling, matrix batches
+void AddKernelBenchmarks(FBenchmarkRunner& Runner);
+// CPU texture generator nodes and a small graph at 1024x1024 and 4096x4096, wide and deep graphs
+// at every power of two thread count, items are pixels, and compiling and walking the schedule of
+// a synthetic 10k node graph, items are nodes, and a 16384x16384 bake streamed to a PNG, items
+// are pixels
+void AddTexGenBenchmarks(FBenchmarkRunner& Runner);
+// checks of the decisions FTexGen makes about its nodes without the GPU, and a pass over an
+// unchanged chain of 10k nodes, items are nodes
+void AddTexGenEvaluatorBenchmarks(FBenchmarkRunner& Runner);
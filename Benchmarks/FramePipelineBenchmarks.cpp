@@ -0,0 +1,137 @@
+#include "Fixtures.hpp"
+#include "../TestRenderer/FramePipeline.hpp"
+#include "../TestRenderer/TripleBuffer.hpp"
+
+#include <chrono>
+#include <memory>
+
+namespace
+{
+	constexpr uint32_t HANDOFF_FRAME_COUNT = 20000;
+	constexpr size_t STATE_FIELDS = 32;
+	constexpr uint32_t PIPELINE_FRAME_COUNT = 32;
+	constexpr double PIPELINE_UPDATE_MILLISECONDS = 0.5;
+	constexpr double PIPELINE_RENDER_MILLISECONDS = 0.5;
+
+	// what the application hands from the update to the render thread, every field derived from
+	// the frame so a state mixing two of them shows
+	struct SHandoffState
+	{
+		uint64_t Frame;
+		uint64_t Fields[STATE_FIELDS];
+	};
+
+	bool IsWhole(const SHandoffState& State)
+	{
+		for (size_t Field = 0; Field < STATE_FIELDS; ++Field)
+		{
+			if (State.Fields[Field] != State.Frame * STATE_FIELDS + Field)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// The render side publishes inputs as fast as it can while the update thread turns each into
+	// a state, without any load so the two sides race as hard as they can. Every state the render
+	// side gets has to be whole and newer than the last, and the state of the last input has to
+	// arrive once the inputs stop.
+	bool CheckHandoff()
+	{
+		auto Inputs = std::make_unique<TTripleBuffer<uint64_t>>();
+		auto States = std::make_unique<TTripleBuffer<SHandoffState>>();
+		FUpdateThread Thread;
+		Thread.Start([&Inputs, &States]()
+		{
+			if (!Inputs->Update())
+			{
+				return;
+			}
+			auto& State = States->GetWriteBuffer();
+			State.Frame = Inputs->GetReadBuffer();
+			for (size_t Field = 0; Field < STATE_FIELDS; ++Field)
+			{
+				State.Fields[Field] = State.Frame * STATE_FIELDS + Field;
+			}
+			States->Publish();
+		});
+
+		uint64_t Received = 0;
+		uint64_t LastFrame = 0;
+		const auto Receive = [&]()
+		{
+			if (!States->Update())
+			{
+				return true;
+			}
+			const auto& State = States->GetReadBuffer();
+			if (!IsWhole(State) || State.Frame <= LastFrame)
+			{
+				fprintf(stderr, "got state %llu after %llu, %s\n", static_cast<unsigned long long>(State.Frame), static_cast<unsigned long long>(LastFrame),
+					IsWhole(State) ? "out of order" : "torn");
+				return false;
+			}
+			LastFrame = State.Frame;
+			++Received;
+			return true;
+		};
+
+		for (uint64_t Frame = 1; Frame <= HANDOFF_FRAME_COUNT; ++Frame)
+		{
+			Inputs->GetWriteBuffer() = Frame;
+			Inputs->Publish();
+			Thread.Notify();
+			if (!Receive())
+			{
+				return false;
+			}
+		}
+		const auto Deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		while (LastFrame != HANDOFF_FRAME_COUNT && std::chrono::steady_clock::now() < Deadline)
+		{
+			if (!Receive())
+			{
+				return false;
+			}
+		}
+		Thread.Stop();
+		if (LastFrame != HANDOFF_FRAME_COUNT)
+		{
+			fprintf(stderr, "the state of the last input never arrived, %llu states received\n", static_cast<unsigned long long>(Received));
+			return false;
+		}
+
+		// the same through the pipeline the Frame Pipeline window runs, with and without loads
+		for (const double Load : { 0.0, 0.02 })
+		{
+			const auto Run = RunPipelinedFrames(Load, Load, Load > 0.0 ? 200 : HANDOFF_FRAME_COUNT);
+			if (Run.TornSnapshots != 0 || Run.OutOfOrderSnapshots != 0)
+			{
+				fprintf(stderr, "pipeline with %.2f ms loads rendered %llu torn and %llu out of order snapshots\n", Load,
+					static_cast<unsigned long long>(Run.TornSnapshots), static_cast<unsigned long long>(Run.OutOfOrderSnapshots));
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+void AddFramePipelineBenchmarks(FBenchmarkRunner& Runner)
+{
+	Runner.AddCheck({ "pipeline/handoff_whole_and_in_order", CheckHandoff });
+
+	// the same busy update and render loads one after the other and overlapped, items are frames
+	// rendered with a fresh state
+	SBenchmark Serial{};
+	Serial.Name = "pipeline/serial";
+	Serial.Items = PIPELINE_FRAME_COUNT;
+	Serial.Run = []() { RunSerialFrames(PIPELINE_UPDATE_MILLISECONDS, PIPELINE_RENDER_MILLISECONDS, PIPELINE_FRAME_COUNT); };
+	Runner.Add(std::move(Serial));
+
+	SBenchmark Pipelined{};
+	Pipelined.Name = "pipeline/update_thread";
+	Pipelined.Items = PIPELINE_FRAME_COUNT;
+	Pipelined.Run = []() { RunPipelinedFrames(PIPELINE_UPDATE_MILLISECONDS, PIPELINE_RENDER_MILLISECONDS, PIPELINE_FRAME_COUNT); };
+	Runner.Add(std::move(Pipelined));
+}
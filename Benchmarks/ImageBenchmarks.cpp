@@ -0,0 +1,75 @@
+#include "Fixtures.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../TestRenderer/stb_image.h"
+
+#include <memory>
+
+namespace
+{
+	struct SImageFixture
+	{
+		std::vector<std::string> FileNames;
+		std::vector<std::vector<uint8_t>> Contents;
+	};
+
+	// decodes like FTextureCache does, to RGBA8, and returns the number of pixels
+	uint64_t DecodeImages(const SImageFixture& Fixture) noexcept
+	{
+		uint64_t PixelCount = 0;
+		for (const auto& Contents : Fixture.Contents)
+		{
+			int Width = 0;
+			int Height = 0;
+			int Components = 0;
+			uint8_t* Pixels = stbi_load_from_memory(Contents.data(), static_cast<int>(Contents.size()), &Width, &Height, &Components, 4);
+			if (Pixels == nullptr)
+			{
+				return 0;
+			}
+			PixelCount += static_cast<uint64_t>(Width) * Height;
+			stbi_image_free(Pixels);
+		}
+		return PixelCount;
+	}
+}
+
+void AddImageBenchmarks(FBenchmarkRunner& Runner, const std::string& MeshDirectory)
+{
+	for (const auto& Asset : ListDirectory(MeshDirectory, true))
+	{
+		auto Fixture = std::make_shared<SImageFixture>();
+		for (const auto& File : ListDirectory(MeshDirectory + "/" + Asset, false))
+		{
+			const auto Dot = File.find_last_of('.');
+			const auto Extension = Dot == std::string::npos ? std::string() : File.substr(Dot);
+			if (Extension == ".png" || Extension == ".jpg" || Extension == ".tga")
+			{
+				Fixture->FileNames.push_back(MeshDirectory + "/" + Asset + "/" + File);
+			}
+		}
+		if (Fixture->FileNames.empty())
+		{
+			continue;
+		}
+
+		SBenchmark Decode{};
+		Decode.Name = "decode/" + Asset;
+		// the files are read up front so only decoding is timed
+		Decode.Setup = [Fixture](uint64_t& Items)
+		{
+			Fixture->Contents.resize(Fixture->FileNames.size());
+			for (size_t i = 0; i < Fixture->FileNames.size(); ++i)
+			{
+				if (!ReadWholeFile(Fixture->FileNames[i], Fixture->Contents[i]))
+				{
+					return false;
+				}
+			}
+			Items = DecodeImages(*Fixture);
+			return Items > 0;
+		};
+		Decode.Run = [Fixture]() { DecodeImages(*Fixture); };
+		Runner.Add(std::move(Decode));
+	}
+}
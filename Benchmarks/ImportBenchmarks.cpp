@@ -0,0 +1,130 @@
+#include "Fixtures.hpp"
+#include "../TestRenderer/MeshImport.hpp"
+#include "../TestRenderer/TangentSpace.hpp"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <memory>
+
+namespace
+{
+	constexpr float SMOOTHING_ANGLE = 80.0f;
+
+	struct SImportFixture
+	{
+		std::string FileName;
+		FArenaAllocator Arena{ "Benchmark Import", 4 << 20 };
+		// extracted once for the tangent space fixture
+		std::vector<std::vector<DirectX::XMFLOAT3>> Positions;
+		std::vector<std::vector<DirectX::XMFLOAT2>> TexCoords;
+		std::vector<std::vector<uint32_t>> Indices;
+	};
+
+	// what FModel::Initialize does on the CPU, minus materials and the GPU buffers
+	bool ImportModel(SImportFixture& Fixture)
+	{
+		Assimp::Importer Importer;
+		const aiScene* Scene = Importer.ReadFile(Fixture.FileName, MESH_IMPORT_FLAGS);
+		if (!Scene || Scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !Scene->mRootNode)
+		{
+			return false;
+		}
+		for (unsigned int i = 0; i < Scene->mNumMeshes; ++i)
+		{
+			FArenaScope Scope(Fixture.Arena);
+			TArenaVector<DirectX::XMFLOAT3> Positions{ TArenaAdaptor<DirectX::XMFLOAT3>(Fixture.Arena) };
+			TArenaVector<DirectX::XMFLOAT2> TexCoords{ TArenaAdaptor<DirectX::XMFLOAT2>(Fixture.Arena) };
+			TArenaVector<uint32_t> InputIndices{ TArenaAdaptor<uint32_t>(Fixture.Arena) };
+			ExtractTangentSpaceInput(Scene->mMeshes[i], Positions, TexCoords, InputIndices);
+
+			STangentSpaceInput Input{};
+			Input.Positions = Positions.data();
+			Input.TexCoords = TexCoords.data();
+			Input.VertexCount = Positions.size();
+			Input.Indices = InputIndices.data();
+			Input.IndexCount = InputIndices.size();
+			TArenaVector<STangentSpaceVertex> Vertices{ TArenaAdaptor<STangentSpaceVertex>(Fixture.Arena) };
+			TArenaVector<uint32_t> Indices{ TArenaAdaptor<uint32_t>(Fixture.Arena) };
+			GenerateTangentSpace(Fixture.Arena, Input, SMOOTHING_ANGLE, Vertices, Indices);
+		}
+		return true;
+	}
+
+	// keeps the triangles of every mesh around and counts them
+	bool ExtractModel(SImportFixture& Fixture, uint64_t& TriangleCount)
+	{
+		Assimp::Importer Importer;
+		const aiScene* Scene = Importer.ReadFile(Fixture.FileName, MESH_IMPORT_FLAGS);
+		if (!Scene || Scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !Scene->mRootNode)
+		{
+			return false;
+		}
+		TriangleCount = 0;
+		Fixture.Positions.clear();
+		Fixture.TexCoords.clear();
+		Fixture.Indices.clear();
+		for (unsigned int i = 0; i < Scene->mNumMeshes; ++i)
+		{
+			FArenaScope Scope(Fixture.Arena);
+			TArenaVector<DirectX::XMFLOAT3> Positions{ TArenaAdaptor<DirectX::XMFLOAT3>(Fixture.Arena) };
+			TArenaVector<DirectX::XMFLOAT2> TexCoords{ TArenaAdaptor<DirectX::XMFLOAT2>(Fixture.Arena) };
+			TArenaVector<uint32_t> Indices{ TArenaAdaptor<uint32_t>(Fixture.Arena) };
+			ExtractTangentSpaceInput(Scene->mMeshes[i], Positions, TexCoords, Indices);
+			Fixture.Positions.emplace_back(Positions.begin(), Positions.end());
+			Fixture.TexCoords.emplace_back(TexCoords.begin(), TexCoords.end());
+			Fixture.Indices.emplace_back(Indices.begin(), Indices.end());
+			TriangleCount += Indices.size() / 3;
+		}
+		Fixture.Arena.Trim();
+		return true;
+	}
+
+	void GenerateModelTangentSpace(SImportFixture& Fixture)
+	{
+		for (size_t i = 0; i < Fixture.Positions.size(); ++i)
+		{
+			FArenaScope Scope(Fixture.Arena);
+			STangentSpaceInput Input{};
+			Input.Positions = Fixture.Positions[i].data();
+			Input.TexCoords = Fixture.TexCoords[i].data();
+			Input.VertexCount = Fixture.Positions[i].size();
+			Input.Indices = Fixture.Indices[i].data();
+			Input.IndexCount = Fixture.Indices[i].size();
+			TArenaVector<STangentSpaceVertex> Vertices{ TArenaAdaptor<STangentSpaceVertex>(Fixture.Arena) };
+			TArenaVector<uint32_t> Indices{ TArenaAdaptor<uint32_t>(Fixture.Arena) };
+			GenerateTangentSpace(Fixture.Arena, Input, SMOOTHING_ANGLE, Vertices, Indices);
+		}
+	}
+}
+
+void AddImportBenchmarks(FBenchmarkRunner& Runner, const std::string& MeshDirectory)
+{
+	for (const auto& Asset : ListDirectory(MeshDirectory, true))
+	{
+		for (const auto& File : ListDirectory(MeshDirectory + "/" + Asset, false))
+		{
+			const auto Dot = File.find_last_of('.');
+			const auto Extension = Dot == std::string::npos ? std::string() : File.substr(Dot);
+			if (Extension != ".obj" && Extension != ".fbx")
+			{
+				continue;
+			}
+
+			// shared by both fixtures, which keep it alive inside their std::functions
+			auto Fixture = std::make_shared<SImportFixture>();
+			Fixture->FileName = MeshDirectory + "/" + Asset + "/" + File;
+
+			SBenchmark Import{};
+			Import.Name = "import/" + Asset;
+			Import.Setup = [Fixture](uint64_t& Items) { return ExtractModel(*Fixture, Items); };
+			Import.Run = [Fixture]() { ImportModel(*Fixture); };
+			Runner.Add(std::move(Import));
+
+			SBenchmark TangentSpace{};
+			TangentSpace.Name = "tangentspace/" + Asset;
+			TangentSpace.Setup = [Fixture](uint64_t& Items) { return ExtractModel(*Fixture, Items); };
+			TangentSpace.Run = [Fixture]() { GenerateModelTangentSpace(*Fixture); };
+			Runner.Add(std::move(TangentSpace));
+		}
+	}
+}
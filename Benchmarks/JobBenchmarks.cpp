@@ -0,0 +1,137 @@
+#include "Fixtures.hpp"
+#include "../TestRenderer/JobSystem.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace
+{
+	// the sizes the Jobs window benchmarks with, a round stays well inside one worker's job ring
+	constexpr size_t ROUND_SIZE = FJobSystem::MAX_JOBS_PER_WORKER / 4;
+	constexpr uint32_t FORK_JOIN_DEPTH = 10;
+
+	struct SJobFixture
+	{
+		FJobSystem JobSystem;
+	};
+
+	uint64_t GetExecutedJobs(const FJobSystem& JobSystem)
+	{
+		uint64_t Executed = 0;
+		for (size_t Worker = 0; Worker < JobSystem.GetThreadCount(); ++Worker)
+		{
+			Executed += JobSystem.GetWorkerStatistics(Worker).Executed;
+		}
+		return Executed;
+	}
+
+	// the tree runs every job once on any number of threads, the root, two children per inner
+	// job and the leaves
+	bool CheckForkJoin()
+	{
+		const size_t JobCount = (size_t(2) << FORK_JOIN_DEPTH) - 1;
+		uint32_t Expected = 0;
+		{
+			FJobSystem JobSystem;
+			JobSystem.Initialize(1);
+			Expected = JobSystem.RunForkJoin(FORK_JOIN_DEPTH);
+		}
+
+		FJobSystem JobSystem;
+		JobSystem.Initialize(std::max(2u, std::thread::hardware_concurrency()));
+		const auto Before = GetExecutedJobs(JobSystem);
+		const auto Result = JobSystem.RunForkJoin(FORK_JOIN_DEPTH);
+		const auto Executed = GetExecutedJobs(JobSystem) - Before;
+		if (Result != Expected || Executed != JobCount)
+		{
+			fprintf(stderr, "%llu of %zu jobs ran on %zu threads, leaves summed to %u instead of %u\n", static_cast<unsigned long long>(Executed), JobCount,
+				JobSystem.GetThreadCount(), Result, Expected);
+			return false;
+		}
+		return true;
+	}
+
+	// a root that is only run once all of its children were spawned, with more children than
+	// one worker's job ring holds, so the ring wraps onto the root before it was run
+	bool CheckPendingRoot()
+	{
+		const size_t ChildCount = FJobSystem::MAX_JOBS_PER_WORKER + FJobSystem::MAX_JOBS_PER_WORKER / 2;
+		for (const size_t ThreadCount : { size_t(1), size_t(std::max(2u, std::thread::hardware_concurrency())) })
+		{
+			FJobSystem JobSystem;
+			JobSystem.Initialize(ThreadCount);
+			std::atomic<size_t> Executed{ 0 };
+			SJob* Root = JobSystem.CreateJob([]() {});
+			for (size_t Child = 0; Child < ChildCount; ++Child)
+			{
+				JobSystem.Run(JobSystem.CreateJob([&Executed]() { Executed.fetch_add(1, std::memory_order_relaxed); }, Root));
+			}
+			JobSystem.Run(Root);
+			JobSystem.Wait(Root);
+			if (Executed.load() != ChildCount)
+			{
+				fprintf(stderr, "%zu of %zu children ran on %zu threads\n", Executed.load(), ChildCount, ThreadCount);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// items are jobs, the root included
+	SBenchmark MakeEmptyJobsBenchmark(const char* Name, const size_t ThreadCount, const bool bHelp)
+	{
+		auto Fixture = std::make_shared<SJobFixture>();
+		SBenchmark Benchmark{};
+		Benchmark.Name = Name;
+		Benchmark.Items = ROUND_SIZE + 1;
+		Benchmark.Setup = [Fixture, ThreadCount](uint64_t&)
+		{
+			Fixture->JobSystem.Initialize(ThreadCount);
+			return true;
+		};
+		Benchmark.Run = [Fixture, bHelp]() { Fixture->JobSystem.RunEmptyJobs(ROUND_SIZE, bHelp); };
+		Benchmark.Teardown = [Fixture]() { Fixture->JobSystem.Shutdown(); };
+		return Benchmark;
+	}
+
+	// items are leaves
+	SBenchmark MakeForkJoinBenchmark(const uint32_t ThreadCount)
+	{
+		auto Fixture = std::make_shared<SJobFixture>();
+		SBenchmark Benchmark{};
+		Benchmark.Name = "jobs/fork_join_t" + std::to_string(ThreadCount);
+		Benchmark.Items = uint64_t(1) << FORK_JOIN_DEPTH;
+		Benchmark.Setup = [Fixture, ThreadCount](uint64_t&)
+		{
+			Fixture->JobSystem.Initialize(ThreadCount);
+			return true;
+		};
+		Benchmark.Run = [Fixture]() { Fixture->JobSystem.RunForkJoin(FORK_JOIN_DEPTH); };
+		Benchmark.Teardown = [Fixture]() { Fixture->JobSystem.Shutdown(); };
+		return Benchmark;
+	}
+}
+
+void AddJobBenchmarks(FBenchmarkRunner& Runner)
+{
+	Runner.AddCheck({ "jobs/fork_join_runs_every_job", CheckForkJoin });
+	Runner.AddCheck({ "jobs/ring_wraps_past_pending_root", CheckPendingRoot });
+
+	// creating, running and finishing an empty job on one thread, and the same with the spawning
+	// thread only waiting so every job is stolen
+	const uint32_t HardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+	Runner.Add(MakeEmptyJobsBenchmark("jobs/spawn", 1, true));
+	Runner.Add(MakeEmptyJobsBenchmark("jobs/steal", std::max(2u, HardwareThreads), false));
+
+	// speedup curve, 1, 2, 4 ... threads up to every hardware thread
+	for (uint32_t ThreadCount = 1; ; ThreadCount *= 2)
+	{
+		Runner.Add(MakeForkJoinBenchmark(std::min(ThreadCount, HardwareThreads)));
+		if (ThreadCount >= HardwareThreads)
+		{
+			break;
+		}
+	}
+}
@@ -0,0 +1,362 @@
+#include "Fixtures.hpp"
+#include "../TestRenderer/BlurKernels.hpp"
+#include "../TestRenderer/OcclusionCulling.hpp"
+
+#include <cmath>
+#include <memory>
+
+namespace
+{
+	constexpr uint32_t BLUR_SIZE = 256;
+	constexpr size_t BOUNDS_COUNT = 4096;
+	constexpr uint32_t OCCLUDER_GRID = 64;
+	constexpr size_t MATRIX_COUNT = 4096;
+	constexpr size_t VERTEX_COUNT = 65536;
+
+	// fixed seed, every run sees the same data
+	struct FRandom
+	{
+		uint32_t State = 0x2545F491u;
+
+		float Next(const float Minimum, const float Maximum) noexcept
+		{
+			State = State * 1664525u + 1013904223u;
+			return Minimum + (Maximum - Minimum) * static_cast<float>(State >> 8) / static_cast<float>(1 << 24);
+		}
+	};
+
+	// the default camera of the application looking at the origin
+	DirectX::XMMATRIX MakeViewProjection() noexcept
+	{
+		const auto View = DirectX::XMMatrixLookAtLH(DirectX::XMVectorSet(0.0f, 5.0f, -10.0f, 1.0f), DirectX::XMVectorZero(), DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		const auto Projection = DirectX::XMMatrixPerspectiveFovLH(DirectX::XM_PIDIV2 * 0.5f, 16.0f / 9.0f, 0.1f, 1000.0f);
+		return DirectX::XMMatrixMultiply(View, Projection);
+	}
+
+	struct SBlurFixture
+	{
+		std::vector<DirectX::XMFLOAT4> Input;
+		std::vector<DirectX::XMFLOAT4> Mask;
+		std::vector<DirectX::XMFLOAT4> Output;
+		FBlurKernel Kernel{};
+	};
+
+	// short enough that every tap of both passes stays inside the apron, the default parameters
+	// of the Blur window reach further and take the direct path at this size
+	SBlurParams MakeTiledBlurParams() noexcept
+	{
+		SBlurParams Params{};
+		Params.Size = 0.35f;
+		return Params;
+	}
+
+	std::shared_ptr<SBlurFixture> MakeBlurFixture(const bool bVertical, const SBlurParams& Params)
+	{
+		auto Fixture = std::make_shared<SBlurFixture>();
+		const size_t PixelCount = static_cast<size_t>(BLUR_SIZE) * BLUR_SIZE;
+		Fixture->Input.resize(PixelCount);
+		Fixture->Mask.resize(PixelCount);
+		Fixture->Output.resize(PixelCount);
+		FRandom Random;
+		for (size_t i = 0; i < PixelCount; ++i)
+		{
+			Fixture->Input[i] = { Random.Next(0.0f, 1.0f), Random.Next(0.0f, 1.0f), Random.Next(0.0f, 1.0f), 1.0f };
+			// the right half is blurred, like the mask BlurMaterial creates
+			const float MaskValue = i % BLUR_SIZE >= BLUR_SIZE / 2 ? 1.0f : 0.0f;
+			Fixture->Mask[i] = { MaskValue, MaskValue, MaskValue, MaskValue };
+		}
+		Fixture->Kernel.Params = MakeBlurPassParams(Params, bVertical, BLUR_SIZE, BLUR_SIZE);
+		Fixture->Kernel.Input = { BLUR_SIZE, BLUR_SIZE, Fixture->Input.data() };
+		Fixture->Kernel.Mask = { BLUR_SIZE, BLUR_SIZE, Fixture->Mask.data() };
+		Fixture->Kernel.Output = Fixture->Output.data();
+		return Fixture;
+	}
+
+	// the tile cache holds the same clamped texels the direct path fetches, so both have to blur
+	// every pixel to the same bits
+	bool CheckBlurTiling()
+	{
+		const uint32_t Groups = (BLUR_SIZE + BLUR_TILE_SIZE - 1) / BLUR_TILE_SIZE;
+		for (const bool bVertical : { false, true })
+		{
+			auto Fixture = MakeBlurFixture(bVertical, MakeTiledBlurParams());
+			if (!Fixture->Kernel.Params.bTiled)
+			{
+				fprintf(stderr, "%s pass reaches past the apron, it is never tiled\n", bVertical ? "vertical" : "horizontal");
+				return false;
+			}
+			DispatchOnCpu(Fixture->Kernel, Groups, Groups);
+			const auto Tiled = Fixture->Output;
+			Fixture->Kernel.Params.bTiled = 0;
+			DispatchOnCpu(Fixture->Kernel, Groups, Groups);
+			for (size_t Pixel = 0; Pixel < Tiled.size(); ++Pixel)
+			{
+				const auto& A = Tiled[Pixel];
+				const auto& B = Fixture->Output[Pixel];
+				if (A.x != B.x || A.y != B.y || A.z != B.z || A.w != B.w)
+				{
+					fprintf(stderr, "%s pass differs at pixel %zu, %zu: %.9g tiled, %.9g direct\n", bVertical ? "vertical" : "horizontal",
+						Pixel % BLUR_SIZE, Pixel / BLUR_SIZE, A.x, B.x);
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	struct SCullingFixture
+	{
+		FOcclusionCuller Culler;
+		std::vector<DirectX::XMFLOAT3> BoundsMin;
+		std::vector<DirectX::XMFLOAT3> BoundsMax;
+		std::vector<DirectX::XMFLOAT3> OccluderPositions;
+		std::vector<uint32_t> OccluderIndices;
+		DirectX::XMFLOAT4X4 ViewProjection;
+		uint32_t VisibleCount = 0;
+	};
+
+	std::shared_ptr<SCullingFixture> MakeCullingFixture()
+	{
+		auto Fixture = std::make_shared<SCullingFixture>();
+		DirectX::XMStoreFloat4x4(&Fixture->ViewProjection, MakeViewProjection());
+
+		// scattered around the camera so roughly half of them are outside the frustum
+		FRandom Random;
+		for (size_t i = 0; i < BOUNDS_COUNT; ++i)
+		{
+			const DirectX::XMFLOAT3 Center(Random.Next(-40.0f, 40.0f), Random.Next(-10.0f, 10.0f), Random.Next(-20.0f, 60.0f));
+			const float Extent = Random.Next(0.1f, 1.0f);
+			Fixture->BoundsMin.push_back({ Center.x - Extent, Center.y - Extent, Center.z - Extent });
+			Fixture->BoundsMax.push_back({ Center.x + Extent, Center.y + Extent, Center.z + Extent });
+		}
+
+		// a wall in front of the origin, tessellated so the rasterizer sees many small triangles
+		for (uint32_t Y = 0; Y <= OCCLUDER_GRID; ++Y)
+		{
+			for (uint32_t X = 0; X <= OCCLUDER_GRID; ++X)
+			{
+				Fixture->OccluderPositions.push_back({ -8.0f + 16.0f * X / OCCLUDER_GRID, -4.0f + 8.0f * Y / OCCLUDER_GRID, 2.0f });
+			}
+		}
+		for (uint32_t Y = 0; Y < OCCLUDER_GRID; ++Y)
+		{
+			for (uint32_t X = 0; X < OCCLUDER_GRID; ++X)
+			{
+				const uint32_t Corner = Y * (OCCLUDER_GRID + 1) + X;
+				const uint32_t Quad[6] = { Corner, Corner + OCCLUDER_GRID + 1, Corner + 1, Corner + 1, Corner + OCCLUDER_GRID + 1, Corner + OCCLUDER_GRID + 2 };
+				Fixture->OccluderIndices.insert(Fixture->OccluderIndices.end(), Quad, Quad + 6);
+			}
+		}
+		return Fixture;
+	}
+
+	void RenderOccluders(SCullingFixture& Fixture) noexcept
+	{
+		Fixture.Culler.BeginFrame();
+		Fixture.Culler.RenderOccluder(Fixture.OccluderPositions.data(), Fixture.OccluderPositions.size(), Fixture.OccluderIndices.data(), Fixture.OccluderIndices.size(), DirectX::XMLoadFloat4x4(&Fixture.ViewProjection));
+		Fixture.Culler.EndOccluders();
+	}
+
+	void TestBounds(SCullingFixture& Fixture) noexcept
+	{
+		const auto ViewProjection = DirectX::XMLoadFloat4x4(&Fixture.ViewProjection);
+		uint32_t VisibleCount = 0;
+		for (size_t i = 0; i < Fixture.BoundsMin.size(); ++i)
+		{
+			VisibleCount += Fixture.Culler.IsVisible(Fixture.BoundsMin[i], Fixture.BoundsMax[i], ViewProjection) ? 1 : 0;
+		}
+		Fixture.VisibleCount = VisibleCount;
+	}
+
+	// one untimed pass over the boxes against whatever the fixture rasterized last
+	void CountBounds(SCullingFixture& Fixture, std::vector<SBenchmarkCounter>& Counters)
+	{
+		const auto Before = Fixture.Culler.GetStatistics();
+		TestBounds(Fixture);
+		const auto& After = Fixture.Culler.GetStatistics();
+		Counters.push_back({ "visible", Fixture.VisibleCount });
+		Counters.push_back({ "frustum_culled", After.FrustumCulled - Before.FrustumCulled });
+		Counters.push_back({ "occlusion_culled", After.OcclusionCulled - Before.OcclusionCulled });
+	}
+
+	// the wall rasterized by both paths has to give the same depth buffer bit for bit, the first
+	// tile that differs is reported
+	bool CheckAvx2Depth()
+	{
+		if (!FOcclusionCuller::IsAvx2Supported())
+		{
+			fprintf(stderr, "no AVX2 on this CPU, only the scalar path is used\n");
+			return true;
+		}
+		auto Fixture = MakeCullingFixture();
+		Fixture->Culler.SetUseAvx2(false);
+		RenderOccluders(*Fixture);
+		const std::vector<float> Scalar(Fixture->Culler.GetDepthBuffer(), Fixture->Culler.GetDepthBuffer() + FOcclusionCuller::WIDTH * FOcclusionCuller::HEIGHT);
+		Fixture->Culler.SetUseAvx2(true);
+		RenderOccluders(*Fixture);
+		const float* Avx2 = Fixture->Culler.GetDepthBuffer();
+		for (uint32_t TileY = 0; TileY < FOcclusionCuller::TILES_Y; ++TileY)
+		{
+			for (uint32_t TileX = 0; TileX < FOcclusionCuller::TILES_X; ++TileX)
+			{
+				for (uint32_t Y = TileY * FOcclusionCuller::TILE_SIZE; Y < (TileY + 1) * FOcclusionCuller::TILE_SIZE; ++Y)
+				{
+					for (uint32_t X = TileX * FOcclusionCuller::TILE_SIZE; X < (TileX + 1) * FOcclusionCuller::TILE_SIZE; ++X)
+					{
+						const size_t Pixel = static_cast<size_t>(Y) * FOcclusionCuller::WIDTH + X;
+						if (Avx2[Pixel] != Scalar[Pixel])
+						{
+							fprintf(stderr, "tile %u, %u differs at pixel %u, %u: %.9g with AVX2, %.9g scalar\n", TileX, TileY, X, Y, Avx2[Pixel], Scalar[Pixel]);
+							return false;
+						}
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	// a box right behind the middle of the wall is hidden, the same box between the camera and
+	// the wall is not, on both paths
+	bool CheckWallOcclusion()
+	{
+		auto Fixture = MakeCullingFixture();
+		const auto ViewProjection = DirectX::XMLoadFloat4x4(&Fixture->ViewProjection);
+		for (const bool bAvx2 : { false, true })
+		{
+			Fixture->Culler.SetUseAvx2(bAvx2);
+			RenderOccluders(*Fixture);
+			const bool bBehindVisible = Fixture->Culler.IsVisible({ -0.5f, -0.5f, 4.0f }, { 0.5f, 0.5f, 5.0f }, ViewProjection);
+			const bool bFrontVisible = Fixture->Culler.IsVisible({ -0.5f, -0.5f, -1.0f }, { 0.5f, 0.5f, 0.0f }, ViewProjection);
+			if (bBehindVisible || !bFrontVisible)
+			{
+				fprintf(stderr, "%s path: box behind the wall %s, box in front of it %s\n", Fixture->Culler.IsUsingAvx2() ? "AVX2" : "scalar",
+					bBehindVisible ? "visible" : "culled", bFrontVisible ? "visible" : "culled");
+				return false;
+			}
+		}
+		return true;
+	}
+
+	struct SMathFixture
+	{
+		std::vector<DirectX::XMFLOAT4X4> World;
+		std::vector<DirectX::XMFLOAT4X4> WorldViewProjection;
+		std::vector<DirectX::XMFLOAT3> Positions;
+		std::vector<DirectX::XMFLOAT4> ClipPositions;
+		DirectX::XMFLOAT4X4 ViewProjection;
+	};
+
+	std::shared_ptr<SMathFixture> MakeMathFixture()
+	{
+		auto Fixture = std::make_shared<SMathFixture>();
+		DirectX::XMStoreFloat4x4(&Fixture->ViewProjection, MakeViewProjection());
+		FRandom Random;
+		Fixture->World.resize(MATRIX_COUNT);
+		Fixture->WorldViewProjection.resize(MATRIX_COUNT);
+		for (auto& World : Fixture->World)
+		{
+			const auto Rotation = DirectX::XMMatrixRotationRollPitchYaw(Random.Next(-3.0f, 3.0f), Random.Next(-3.0f, 3.0f), Random.Next(-3.0f, 3.0f));
+			const auto Translation = DirectX::XMMatrixTranslation(Random.Next(-50.0f, 50.0f), Random.Next(-50.0f, 50.0f), Random.Next(-50.0f, 50.0f));
+			DirectX::XMStoreFloat4x4(&World, DirectX::XMMatrixMultiply(Rotation, Translation));
+		}
+		Fixture->Positions.resize(VERTEX_COUNT);
+		Fixture->ClipPositions.resize(VERTEX_COUNT);
+		for (auto& Position : Fixture->Positions)
+		{
+			Position = { Random.Next(-10.0f, 10.0f), Random.Next(-10.0f, 10.0f), Random.Next(-10.0f, 10.0f) };
+		}
+		return Fixture;
+	}
+}
+
+void AddKernelBenchmarks(FBenchmarkRunner& Runner)
+{
+	Runner.AddCheck({ "blur/tiled_matches_direct", CheckBlurTiling });
+	Runner.AddCheck({ "cull/avx2_depth_matches_scalar", CheckAvx2Depth });
+	Runner.AddCheck({ "cull/wall_hides_box_behind_it", CheckWallOcclusion });
+
+	const uint64_t BlurPixels = static_cast<uint64_t>(BLUR_SIZE) * BLUR_SIZE;
+	const uint32_t BlurGroups = (BLUR_SIZE + BLUR_TILE_SIZE - 1) / BLUR_TILE_SIZE;
+	for (const bool bTiled : { false, true })
+	{
+		for (const bool bVertical : { false, true })
+		{
+			auto Fixture = MakeBlurFixture(bVertical, bTiled ? MakeTiledBlurParams() : SBlurParams{});
+			SBenchmark Blur{};
+			// BlurCS.hlsl on the CPU, the same passes BlurMaterial dispatches, with the default
+			// parameters and with a blur short enough for the tile cache
+			Blur.Name = std::string(bVertical ? "blur/vertical" : "blur/horizontal") + (bTiled ? "_tiled" : "");
+			Blur.Items = BlurPixels;
+			Blur.Run = [Fixture, BlurGroups]() { DispatchOnCpu(Fixture->Kernel, BlurGroups, BlurGroups); };
+			Runner.Add(std::move(Blur));
+		}
+	}
+
+	auto Culling = MakeCullingFixture();
+	SBenchmark Frustum{};
+	Frustum.Name = "cull/frustum";
+	Frustum.Items = BOUNDS_COUNT;
+	// no occluders, the depth test never rejects and only the frustum planes do
+	Frustum.Setup = [Culling](uint64_t&)
+	{
+		Culling->Culler.BeginFrame();
+		Culling->Culler.EndOccluders();
+		return true;
+	};
+	Frustum.Run = [Culling]() { TestBounds(*Culling); };
+	Frustum.Counters = [Culling](std::vector<SBenchmarkCounter>& Counters) { CountBounds(*Culling, Counters); };
+	Runner.Add(std::move(Frustum));
+
+	for (const bool bAvx2 : { false, true })
+	{
+		SBenchmark Raster{};
+		Raster.Name = bAvx2 ? "cull/occluders_avx2" : "cull/occluders_scalar";
+		Raster.Items = OCCLUDER_GRID * OCCLUDER_GRID * 2;
+		Raster.Setup = [Culling, bAvx2](uint64_t&)
+		{
+			Culling->Culler.SetUseAvx2(bAvx2);
+			return Culling->Culler.IsUsingAvx2() == bAvx2;
+		};
+		Raster.Run = [Culling]() { RenderOccluders(*Culling); };
+		// the rejection the depth buffer of this path gives, not timed
+		Raster.Counters = [Culling](std::vector<SBenchmarkCounter>& Counters) { CountBounds(*Culling, Counters); };
+		Runner.Add(std::move(Raster));
+	}
+
+	SBenchmark Occlusion{};
+	Occlusion.Name = "cull/occlusion";
+	Occlusion.Items = BOUNDS_COUNT;
+	Occlusion.Setup = [Culling](uint64_t&)
+	{
+		Culling->Culler.SetUseAvx2(true);
+		RenderOccluders(*Culling);
+		return true;
+	};
+	Occlusion.Run = [Culling]() { TestBounds(*Culling); };
+	Occlusion.Counters = [Culling](std::vector<SBenchmarkCounter>& Counters) { CountBounds(*Culling, Counters); };
+	Runner.Add(std::move(Occlusion));
+
+	auto Math = MakeMathFixture();
+	SBenchmark Multiply{};
+	Multiply.Name = "math/matrix_multiply";
+	Multiply.Items = MATRIX_COUNT;
+	Multiply.Run = [Math]()
+	{
+		const auto ViewProjection = DirectX::XMLoadFloat4x4(&Math->ViewProjection);
+		for (size_t i = 0; i < Math->World.size(); ++i)
+		{
+			DirectX::XMStoreFloat4x4(&Math->WorldViewProjection[i], DirectX::XMMatrixMultiply(DirectX::XMLoadFloat4x4(&Math->World[i]), ViewProjection));
+		}
+	};
+	Runner.Add(std::move(Multiply));
+
+	SBenchmark Transform{};
+	Transform.Name = "math/transform_stream";
+	Transform.Items = VERTEX_COUNT;
+	Transform.Run = [Math]()
+	{
+		DirectX::XMVector3TransformStream(Math->ClipPositions.data(), sizeof(DirectX::XMFLOAT4), Math->Positions.data(), sizeof(DirectX::XMFLOAT3), Math->Positions.size(), DirectX::XMLoadFloat4x4(&Math->ViewProjection));
+	};
+	Runner.Add(std::move(Transform));
+}
@@ -0,0 +1,108 @@
+#include "Fixtures.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+// Times the CPU side hot paths of TestRenderer in isolation.
+//
+// Benchmarks [-filter=<substring>] [-warmup=<n>] [-repeat=<n>] [-mesh=<directory>]
+//            [-json=<file>] [-label=<text>] [-check]
+//
+// Every fixture runs its warmup iterations first and is then timed -repeat times, one sample per
+// run. The median, 95th percentile and median absolute deviation of the samples are printed and,
+// with -json, written together with the raw samples so results can be compared across builds.
+// -label is stored in the json, a commit hash for example. Fixtures whose data is missing are
+// reported as skipped. The correctness checks run before the fixtures, -check runs only them.
+// Returns 0 on success and 1 on bad arguments, a failed check or when the json could not be
+// written.
+
+#ifndef BENCHMARK_MESH_DIRECTORY
+#define BENCHMARK_MESH_DIRECTORY "../TestRenderer/Mesh"
+#endif
+
+// model import needs Assimp, which builds without it leave out
+#ifndef BENCHMARK_WITH_ASSIMP
+#define BENCHMARK_WITH_ASSIMP 1
+#endif
+
+namespace
+{
+	void PrintUsage()
+	{
+		printf("usage: Benchmarks [-filter=<substring>] [-warmup=<n>] [-repeat=<n>] [-mesh=<directory>] [-json=<file>] [-label=<text>] [-check]\n");
+	}
+}
+
+int main(int ArgumentCount, char** Arguments)
+{
+	FBenchmarkRunner Runner;
+	const char* MeshDirectory = BENCHMARK_MESH_DIRECTORY;
+	const char* JsonFileName = nullptr;
+	const char* Label = nullptr;
+	bool bChecksOnly = false;
+	for (int Index = 1; Index < ArgumentCount; ++Index)
+	{
+		const char* Argument = Arguments[Index];
+		if (strncmp(Argument, "-filter=", 8) == 0)
+		{
+			Runner.SetFilter(Argument + 8);
+		}
+		else if (strncmp(Argument, "-warmup=", 8) == 0)
+		{
+			Runner.SetWarmupCount(static_cast<uint32_t>(strtoul(Argument + 8, nullptr, 10)));
+		}
+		else if (strncmp(Argument, "-repeat=", 8) == 0)
+		{
+			Runner.SetRepetitionCount(static_cast<uint32_t>(strtoul(Argument + 8, nullptr, 10)));
+		}
+		else if (strncmp(Argument, "-mesh=", 6) == 0)
+		{
+			MeshDirectory = Argument + 6;
+		}
+		else if (strncmp(Argument, "-json=", 6) == 0)
+		{
+			JsonFileName = Argument + 6;
+		}
+		else if (strncmp(Argument, "-label=", 7) == 0)
+		{
+			Label = Argument + 7;
+		}
+		else if (strcmp(Argument, "-check") == 0)
+		{
+			bChecksOnly = true;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+#if BENCHMARK_WITH_ASSIMP
+	AddImportBenchmarks(Runner, MeshDirectory);
+#endif
+	AddImageBenchmarks(Runner, MeshDirectory);
+	AddAllocatorBenchmarks(Runner);
+	AddJobBenchmarks(Runner);
+	AddCommandListBenchmarks(Runner);
+	AddFramePipelineBenchmarks(Runner);
+	AddKernelBenchmarks(Runner);
+	AddTexGenBenchmarks(Runner);
+	AddTexGenEvaluatorBenchmarks(Runner);
+	if (!Runner.RunChecks())
+	{
+		return 1;
+	}
+	if (bChecksOnly)
+	{
+		return 0;
+	}
+	Runner.Run();
+
+	if (JsonFileName && !Runner.WriteJson(JsonFileName, Label))
+	{
+		fprintf(stderr, "cannot write %s\n", JsonFileName);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,415 @@
+#include "Fixtures.hpp"
+#include "../TestRenderer/ImageWriter.hpp"
+#include "../TestRenderer/JobSystem.hpp"
+#include "../TestRenderer/TexGenFusion.hpp"
+#include "../TestRenderer/TexGenKernels.hpp"
+#include "../TestRenderer/TexGenSchedule.hpp"
+#include "../TestRenderer/stb_image.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace
+{
+	const uint32_t TEXGEN_SIZES[] = { 1024, 4096 };
+	constexpr uint32_t SCHEDULE_NODE_COUNT = 10000;
+	constexpr uint32_t SCHEDULE_SLOT_COUNT = 3;
+	constexpr uint32_t SCALING_SIZE = 512;
+	constexpr uint32_t SCALING_BRANCH_COUNT = 8;
+	constexpr uint32_t SCALING_NODE_COUNT = 24;
+	constexpr uint32_t FUSION_CHAIN_COUNT = 3333;
+	constexpr uint32_t BAKE_SIZE = 16384;
+	const char* const BAKE_FILE_NAME = "texgen_bake_16k.png";
+
+	const Generator::SRectangleParams RECTANGLE_PARAMS{ DirectX::XMFLOAT4(0.5f, 0.5f, 0.5f, 0.5f), 3.0f, 1.0f };
+	const Generator::SEnvMapParams ENVMAP_PARAMS{ DirectX::XMFLOAT4(0.5f, 0.1f, 1.0f, 1.0f) };
+	const Generator::SLoopParams LOOP_PARAMS{ DirectX::XMFLOAT2(4.0f, 4.0f) };
+	const Generator::SSineDistParams SINEDIST_PARAMS{ 3.0f, 0.05f, 2.0f, 0.05f };
+
+	struct STexGenFixture
+	{
+		Generator::STexGenImage Input;
+		Generator::STexGenImage Output;
+		Generator::FTexGenCpuGraph Graph;
+		uint32_t GraphOutput = Generator::FTexGenCpuGraph::NO_INPUT;
+	};
+
+	void ReleaseImages(STexGenFixture& Fixture) noexcept
+	{
+		Fixture.Input = Generator::STexGenImage();
+		Fixture.Output = Generator::STexGenImage();
+		Fixture.Graph.ReleaseImages();
+	}
+
+	// Each fixture runs on a job system of its own with a given number of threads. Wide graphs are
+	// independent rectangle -> sinedist -> loop branches, deep graphs a single chain of as many
+	// nodes, so only the tiles of one node at a time can run in parallel.
+	struct SScalingFixture
+	{
+		FJobSystem JobSystem;
+		Generator::FTexGenCpuGraph Graph;
+		uint32_t Output = Generator::FTexGenCpuGraph::NO_INPUT;
+	};
+
+	void MakeScalingGraph(Generator::FTexGenCpuGraph& Graph, const bool bWide)
+	{
+		uint32_t Node = Generator::FTexGenCpuGraph::NO_INPUT;
+		for (uint32_t Index = 0; Index < SCALING_NODE_COUNT; ++Index)
+		{
+			const uint32_t Step = bWide ? Index % (SCALING_NODE_COUNT / SCALING_BRANCH_COUNT) : Index;
+			if (Step == 0)
+			{
+				auto Params = RECTANGLE_PARAMS;
+				Params.Data.x += 0.01f * Index;
+				Node = Graph.AddRectangle(Params);
+			}
+			else
+			{
+				Node = Step % 2 == 1 ? Graph.AddSineDist(SINEDIST_PARAMS, Node) : Graph.AddLoop(LOOP_PARAMS, Node);
+			}
+		}
+	}
+
+	SBenchmark MakeScalingBenchmark(const bool bWide, const uint32_t ThreadCount)
+	{
+		auto Fixture = std::make_shared<SScalingFixture>();
+		SBenchmark Benchmark{};
+		Benchmark.Name = std::string(bWide ? "texgen/wide_t" : "texgen/deep_t") + std::to_string(ThreadCount);
+		Benchmark.Items = static_cast<uint64_t>(SCALING_SIZE) * SCALING_SIZE * SCALING_NODE_COUNT;
+		Benchmark.Setup = [Fixture, bWide, ThreadCount](uint64_t&)
+		{
+			Fixture->JobSystem.Initialize(ThreadCount);
+			Fixture->Graph.Clear();
+			MakeScalingGraph(Fixture->Graph, bWide);
+			Fixture->Output = static_cast<uint32_t>(Fixture->Graph.GetNodeCount() - 1);
+			return true;
+		};
+		Benchmark.Run = [Fixture]() { Fixture->Graph.Evaluate(SCALING_SIZE, SCALING_SIZE, Fixture->Output); };
+		Benchmark.Teardown = [Fixture]()
+		{
+			Fixture->Graph.ReleaseImages();
+			Fixture->JobSystem.Shutdown();
+		};
+		return Benchmark;
+	}
+
+	// Node N reads node N - 1 and two earlier nodes picked with a fixed seed, so every node is
+	// reachable from the last one, which is the output
+	struct SScheduleFixture
+	{
+		std::vector<uint32_t> SlotCounts;
+		std::vector<Generator::STexGenEdge> Edges;
+		Generator::FTexGenSchedule Schedule;
+		std::vector<uint64_t> Hashes;
+	};
+
+	void MakeSyntheticGraph(SScheduleFixture& Fixture)
+	{
+		uint32_t State = 0x2545F491u;
+		Fixture.SlotCounts.assign(SCHEDULE_NODE_COUNT, SCHEDULE_SLOT_COUNT);
+		Fixture.SlotCounts[0] = 0;
+		Fixture.Edges.clear();
+		for (uint32_t Node = 1; Node < SCHEDULE_NODE_COUNT; ++Node)
+		{
+			Fixture.Edges.push_back({ Node, 0, Node - 1 });
+			for (uint32_t Slot = 1; Slot < SCHEDULE_SLOT_COUNT; ++Slot)
+			{
+				State = State * 1664525u + 1013904223u;
+				Fixture.Edges.push_back({ Node, Slot, (State >> 8) % Node });
+			}
+		}
+		Fixture.Hashes.assign(SCHEDULE_NODE_COUNT, 0);
+	}
+
+	// what FTexGen::OnUpdate does per node besides drawing, hashing the inputs' hashes
+	void EvaluateSchedule(SScheduleFixture& Fixture) noexcept
+	{
+		const auto& Schedule = Fixture.Schedule;
+		auto Hashes = Fixture.Hashes.data();
+		for (const auto Node : Schedule.GetOrder())
+		{
+			const auto Inputs = Schedule.GetInputs(Node);
+			uint64_t Hash = 14695981039346656037ull ^ Node;
+			for (uint32_t Slot = 0, Count = Schedule.GetInputCount(Node); Slot < Count; ++Slot)
+			{
+				Hash = (Hash ^ (Inputs[Slot] != Generator::FTexGenSchedule::NO_NODE ? Hashes[Inputs[Slot]] : 0)) * 1099511628211ull;
+			}
+			Hashes[Node] = Hash;
+		}
+	}
+
+	// FUSION_CHAIN_COUNT rectangle -> sinedist -> loop chains read by one output node, slots laid
+	// out like the editor's nodes. Every chain fuses into its loop node, the setup checks that the
+	// plan and the shader written for it are what the renderer expects.
+	struct SFusionFixture
+	{
+		std::vector<uint32_t> SlotCounts;
+		std::vector<uint32_t> TextureSlots;
+		std::vector<Generator::ENodeType> Types;
+		std::vector<Generator::STexGenEdge> Edges;
+		Generator::FTexGenSchedule Schedule;
+		Generator::FTexGenFusion Fusion;
+		std::string Hlsl;
+	};
+
+	bool MakeFusionGraph(SFusionFixture& Fixture)
+	{
+		using Generator::ENodeType;
+		const uint32_t Output = FUSION_CHAIN_COUNT * 3;
+		Fixture.SlotCounts.clear();
+		Fixture.TextureSlots.clear();
+		Fixture.Types.clear();
+		Fixture.Edges.clear();
+		for (uint32_t Chain = 0; Chain < FUSION_CHAIN_COUNT; ++Chain)
+		{
+			const uint32_t Rectangle = Chain * 3;
+			Fixture.SlotCounts.insert(Fixture.SlotCounts.end(), { 3, 3, 2 });
+			Fixture.TextureSlots.insert(Fixture.TextureSlots.end(), { Generator::FTexGenSchedule::NO_NODE, 2, 1 });
+			Fixture.Types.insert(Fixture.Types.end(), { ENodeType::RECTANGLE, ENodeType::SINE, ENodeType::LOOP });
+			Fixture.Edges.push_back({ Rectangle + 1, 2, Rectangle });
+			Fixture.Edges.push_back({ Rectangle + 2, 1, Rectangle + 1 });
+			Fixture.Edges.push_back({ Output, Chain, Rectangle + 2 });
+		}
+		Fixture.SlotCounts.push_back(FUSION_CHAIN_COUNT);
+		Fixture.TextureSlots.push_back(0);
+		Fixture.Types.push_back(ENodeType::OUTPUT);
+		Fixture.Schedule.Compile(Fixture.SlotCounts.data(), Fixture.SlotCounts.size(), Fixture.Edges.data(), Fixture.Edges.size(), Output);
+		Fixture.Fusion.Plan(Fixture.Schedule, Fixture.Types.data(), Fixture.TextureSlots.data());
+
+		const auto& Fusion = Fixture.Fusion;
+		if (Fusion.GetChainCount() != FUSION_CHAIN_COUNT || Fusion.GetChain(Output) != Generator::FTexGenFusion::NO_CHAIN)
+		{
+			return false;
+		}
+		for (uint32_t Chain = 0; Chain < FUSION_CHAIN_COUNT; ++Chain)
+		{
+			const auto Nodes = Fusion.GetChainNodes(Chain);
+			if (Fusion.GetChainLength(Chain) != 3 || Fusion.GetChainSource(Chain) != Generator::FTexGenSchedule::NO_NODE ||
+				Nodes[0] % 3 != 2 || Nodes[1] != Nodes[0] - 1 || Nodes[2] != Nodes[0] - 2)
+			{
+				return false;
+			}
+		}
+
+		// the loop wraps before the sinedist reads, the sinedist clamps before the rectangle is evaluated
+		Generator::WriteFusedShader(Fusion.GetChainTypes(0), Fusion.GetChainLength(0), Fixture.Hlsl);
+		const auto Wrap = Fixture.Hlsl.find("t = frac(t);");
+		const auto Clamp = Fixture.Hlsl.find("t = saturate(t);");
+		return Fixture.Hlsl.find("float4 P[4];") != std::string::npos && Wrap != std::string::npos && Clamp != std::string::npos &&
+			Wrap < Clamp && Fixture.Hlsl.find("Texture.Sample") == std::string::npos;
+	}
+
+	// A 16K bake of rectangle -> sinedist -> loop streamed to a PNG on all hardware threads. The
+	// setup checks on small images that baking gives the pixels of Evaluate and a PNG that reads
+	// back, with bands that do not divide the image and a loop repeated often enough that its input
+	// has to be computed whole.
+	struct SBakeFixture
+	{
+		FJobSystem JobSystem;
+		Generator::FTexGenCpuGraph Graph;
+		uint32_t Output = Generator::FTexGenCpuGraph::NO_INPUT;
+		FPngWriter Writer;
+	};
+
+	bool CheckBake(Generator::FTexGenCpuGraph& Graph, const uint32_t Output, const uint32_t Width, const uint32_t Height, const uint32_t BandHeight)
+	{
+		const auto Evaluated = Graph.Evaluate(Width, Height, Output);
+		if (Evaluated == nullptr)
+		{
+			return false;
+		}
+		const auto Expected = Evaluated->Pixels;
+		size_t Row = 0;
+		bool bEqual = true;
+		const bool bBaked = Graph.Bake(Width, Height, Output, BandHeight, [&](const uint32_t* Pixels, const uint32_t RowCount)
+		{
+			bEqual = bEqual && std::equal(Pixels, Pixels + static_cast<size_t>(RowCount) * Width, Expected.begin() + Row * Width);
+			Row += RowCount;
+			return true;
+		});
+		return bBaked && bEqual && Row == Height;
+	}
+
+	bool CheckPng(Generator::FTexGenCpuGraph& Graph, const uint32_t Output, const uint32_t Width, const uint32_t Height)
+	{
+		const auto Evaluated = Graph.Evaluate(Width, Height, Output);
+		FPngWriter Writer;
+		if (Evaluated == nullptr || !Writer.Open(BAKE_FILE_NAME, Width, Height) || !Writer.WriteRows(Evaluated->Pixels.data(), Height) || !Writer.Close())
+		{
+			return false;
+		}
+		int LoadedWidth = 0, LoadedHeight = 0, Components = 0;
+		uint8_t* Loaded = stbi_load(BAKE_FILE_NAME, &LoadedWidth, &LoadedHeight, &Components, 4);
+		remove(BAKE_FILE_NAME);
+		const bool bEqual = Loaded && LoadedWidth == static_cast<int>(Width) && LoadedHeight == static_cast<int>(Height) && Components == 4 &&
+			memcmp(Loaded, Evaluated->Pixels.data(), Evaluated->Pixels.size() * 4) == 0;
+		stbi_image_free(Loaded);
+		return bEqual;
+	}
+
+	bool CheckBakes()
+	{
+		Generator::FTexGenCpuGraph Graph;
+		const auto Rectangle = Graph.AddRectangle(RECTANGLE_PARAMS);
+		const auto SineDist = Graph.AddSineDist(SINEDIST_PARAMS, Rectangle);
+		const auto Loop = Graph.AddLoop(LOOP_PARAMS, SineDist);
+		const auto Tiled = Graph.AddLoop(Generator::SLoopParams{ DirectX::XMFLOAT2(64.0f, 0.75f) }, Graph.AddSineDist(SINEDIST_PARAMS, Loop));
+		const auto Whole = Graph.AddLoop(Generator::SLoopParams{ DirectX::XMFLOAT2(64.0f, 64.0f) }, SineDist);
+		const auto Unconnected = Graph.AddLoop(LOOP_PARAMS, Generator::FTexGenCpuGraph::NO_INPUT);
+		return CheckBake(Graph, Loop, 1024, 1024, 96) && CheckBake(Graph, Tiled, 1000, 600, 128) && CheckBake(Graph, Whole, 512, 512, 64) &&
+			CheckBake(Graph, Unconnected, 300, 200, 64) &&
+			CheckPng(Graph, Tiled, 333, 71);
+	}
+
+	// the texture nodes that sample read a rectangle, which has edges to filter across
+	SBenchmark MakeNodeBenchmark(const char* Node, const uint32_t Size, std::function<void(STexGenFixture&, uint32_t)> Generate, const bool bSamplesInput)
+	{
+		auto Fixture = std::make_shared<STexGenFixture>();
+		SBenchmark Benchmark{};
+		Benchmark.Name = std::string("texgen/") + Node + "_" + std::to_string(Size);
+		Benchmark.Items = static_cast<uint64_t>(Size) * Size;
+		Benchmark.Setup = [Fixture, Size, bSamplesInput](uint64_t&)
+		{
+			if (bSamplesInput)
+			{
+				Generator::GenerateRectangle(RECTANGLE_PARAMS, Size, Size, Fixture->Input);
+			}
+			return true;
+		};
+		Benchmark.Run = [Fixture, Size, Generate]() { Generate(*Fixture, Size); };
+		Benchmark.Teardown = [Fixture]() { ReleaseImages(*Fixture); };
+		return Benchmark;
+	}
+}
+
+void AddTexGenBenchmarks(FBenchmarkRunner& Runner)
+{
+	for (const auto Size : TEXGEN_SIZES)
+	{
+		Runner.Add(MakeNodeBenchmark("rectangle", Size, [](STexGenFixture& Fixture, const uint32_t Size)
+		{
+			Generator::GenerateRectangle(RECTANGLE_PARAMS, Size, Size, Fixture.Output);
+		}, false));
+		Runner.Add(MakeNodeBenchmark("envmap", Size, [](STexGenFixture& Fixture, const uint32_t Size)
+		{
+			Generator::GenerateEnvMap(ENVMAP_PARAMS, Size, Size, Fixture.Output);
+		}, false));
+		Runner.Add(MakeNodeBenchmark("loop", Size, [](STexGenFixture& Fixture, const uint32_t Size)
+		{
+			Generator::GenerateLoop(LOOP_PARAMS, &Fixture.Input, Size, Size, Fixture.Output);
+		}, true));
+		Runner.Add(MakeNodeBenchmark("sinedist", Size, [](STexGenFixture& Fixture, const uint32_t Size)
+		{
+			Generator::GenerateSineDist(SINEDIST_PARAMS, &Fixture.Input, Size, Size, Fixture.Output);
+		}, true));
+
+		// rectangle -> sinedist -> loop, items are the pixels of the whole graph
+		auto Fixture = std::make_shared<STexGenFixture>();
+		SBenchmark Graph{};
+		Graph.Name = "texgen/graph_" + std::to_string(Size);
+		Graph.Items = static_cast<uint64_t>(Size) * Size * 3;
+		Graph.Setup = [Fixture](uint64_t&)
+		{
+			auto& CpuGraph = Fixture->Graph;
+			const auto Rectangle = CpuGraph.AddRectangle(RECTANGLE_PARAMS);
+			const auto SineDist = CpuGraph.AddSineDist(SINEDIST_PARAMS, Rectangle);
+			Fixture->GraphOutput = CpuGraph.AddLoop(LOOP_PARAMS, SineDist);
+			return true;
+		};
+		Graph.Run = [Fixture, Size]() { Fixture->Graph.Evaluate(Size, Size, Fixture->GraphOutput); };
+		Graph.Teardown = [Fixture]() { ReleaseImages(*Fixture); };
+		Runner.Add(std::move(Graph));
+	}
+
+	// speedup curves, 1, 2, 4 ... threads up to every hardware thread
+	const uint32_t HardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+	for (const bool bWide : { true, false })
+	{
+		for (uint32_t ThreadCount = 1; ; ThreadCount *= 2)
+		{
+			Runner.Add(MakeScalingBenchmark(bWide, std::min(ThreadCount, HardwareThreads)));
+			if (ThreadCount >= HardwareThreads)
+			{
+				break;
+			}
+		}
+	}
+
+	auto Fixture = std::make_shared<SScheduleFixture>();
+	SBenchmark Compile{};
+	Compile.Name = "texgen/schedule_compile_10k";
+	Compile.Items = SCHEDULE_NODE_COUNT;
+	Compile.Setup = [Fixture](uint64_t&)
+	{
+		MakeSyntheticGraph(*Fixture);
+		return true;
+	};
+	Compile.Run = [Fixture]()
+	{
+		Fixture->Schedule.Compile(Fixture->SlotCounts.data(), Fixture->SlotCounts.size(), Fixture->Edges.data(), Fixture->Edges.size(), SCHEDULE_NODE_COUNT - 1);
+	};
+	Runner.Add(std::move(Compile));
+
+	SBenchmark Evaluate{};
+	Evaluate.Name = "texgen/schedule_evaluate_10k";
+	Evaluate.Items = SCHEDULE_NODE_COUNT;
+	Evaluate.Setup = [Fixture](uint64_t&)
+	{
+		MakeSyntheticGraph(*Fixture);
+		Fixture->Schedule.Compile(Fixture->SlotCounts.data(), Fixture->SlotCounts.size(), Fixture->Edges.data(), Fixture->Edges.size(), SCHEDULE_NODE_COUNT - 1);
+		return Fixture->Schedule.GetOrder().size() == SCHEDULE_NODE_COUNT;
+	};
+	Evaluate.Run = [Fixture]() { EvaluateSchedule(*Fixture); };
+	Runner.Add(std::move(Evaluate));
+
+	auto FusionFixture = std::make_shared<SFusionFixture>();
+	SBenchmark Fusion{};
+	Fusion.Name = "texgen/fusion_plan_10k";
+	Fusion.Items = FUSION_CHAIN_COUNT * 3 + 1;
+	Fusion.Setup = [FusionFixture](uint64_t&) { return MakeFusionGraph(*FusionFixture); };
+	Fusion.Run = [FusionFixture]()
+	{
+		FusionFixture->Fusion.Plan(FusionFixture->Schedule, FusionFixture->Types.data(), FusionFixture->TextureSlots.data());
+	};
+	Runner.Add(std::move(Fusion));
+
+	// items are output pixels, the peak memory printed with it is the figure to watch
+	auto BakeFixture = std::make_shared<SBakeFixture>();
+	SBenchmark Bake{};
+	Bake.Name = "texgen/bake_16k";
+	Bake.Items = static_cast<uint64_t>(BAKE_SIZE) * BAKE_SIZE;
+	Bake.RepetitionLimit = 1;
+	Bake.Setup = [BakeFixture](uint64_t&)
+	{
+		BakeFixture->JobSystem.Initialize(std::max(1u, std::thread::hardware_concurrency()));
+		if (!CheckBakes())
+		{
+			return false;
+		}
+		auto& Graph = BakeFixture->Graph;
+		Graph.Clear();
+		BakeFixture->Output = Graph.AddLoop(LOOP_PARAMS, Graph.AddSineDist(SINEDIST_PARAMS, Graph.AddRectangle(RECTANGLE_PARAMS)));
+		return true;
+	};
+	Bake.Run = [BakeFixture]()
+	{
+		auto& Writer = BakeFixture->Writer;
+		Writer.Open(BAKE_FILE_NAME, BAKE_SIZE, BAKE_SIZE);
+		BakeFixture->Graph.Bake(BAKE_SIZE, BAKE_SIZE, BakeFixture->Output, Generator::TEXGEN_BAKE_BAND_HEIGHT, [&Writer](const uint32_t* Pixels, const uint32_t RowCount)
+		{
+			return Writer.WriteRows(Pixels, RowCount);
+		});
+		Writer.Close();
+	};
+	Bake.Teardown = [BakeFixture]()
+	{
+		printf("%-40s %.1f MB of images, %.1f MB written\n", "texgen/bake_16k", BakeFixture->Graph.GetBakeBytes() / 1048576.0, BakeFixture->Writer.GetBytesWritten() / 1048576.0);
+		remove(BAKE_FILE_NAME);
+		BakeFixture->Graph.ReleaseImages();
+		BakeFixture->JobSystem.Shutdown();
+	};
+	Runner.Add(std::move(Bake));
+}
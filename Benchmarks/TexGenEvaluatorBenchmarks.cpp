@@ -0,0 +1,451 @@
+#include "Fixtures.hpp"
+#include "../TestRenderer/TexGenEvaluator.hpp"
+#include "../TestRenderer/TexGenKernels.hpp"
+
+#include <DirectXMath.h>
+#include <memory>
+
+namespace
+{
+	constexpr uint32_t CHAIN_NODE_COUNT = 10000;
+	constexpr double FAST_DRAW_MILLISECONDS = 0.25;
+	constexpr double SLOW_DRAW_MILLISECONDS = 5.0;
+	constexpr float BUDGET_MILLISECONDS = 2.0f;
+	// every node's targets take as much, cache budgets are counted in nodes
+	constexpr uint64_t TARGET_BYTES = 1;
+	constexpr uint32_t NO_NODE = Generator::FTexGenSchedule::NO_NODE;
+
+	using Generator::ENodeType;
+
+	bool IsValueNode(const ENodeType Type)
+	{
+		return Type == ENodeType::SCALAR || Type == ENodeType::VECTOR2 || Type == ENodeType::VECTOR4;
+	}
+
+	// The editor's nodes without the GPU: their types, values and states, laid out like FTexGen
+	// hands them to its evaluator. Draws are recorded instead of made and take the time of a clock
+	// that only moves when they do, a node marked slow takes longer than any budget. A node reads the
+	// texture of its last input that is not a value.
+	struct SEvaluatorGraph : public Generator::FTexGenBackend
+	{
+		std::vector<ENodeType> Types;
+		std::vector<DirectX::XMFLOAT4> Values;
+		std::vector<uint32_t> SlotCounts;
+		std::vector<Generator::STexGenEdge> Edges;
+		std::vector<Generator::STexGenNodeState> States;
+		std::vector<Generator::STexGenNodeState*> StatePointers;
+		Generator::FTexGenSchedule Schedule;
+		Generator::FTexGenEvaluator Evaluator;
+		// what each node's back and front target hold, the hash they were drawn with
+		std::vector<uint64_t> Back;
+		std::vector<uint64_t> Front;
+		std::vector<bool> bIsSlow;
+		// nodes drawn and evicted by the last Evaluate or Frame
+		std::vector<uint32_t> Drawn;
+		std::vector<uint32_t> Evicted;
+		// set when a node was drawn without its targets or those of the node it reads
+		bool bIsTargetMissing = false;
+		double Clock = 0.0;
+		uint32_t PresentCount = 0;
+
+		uint32_t AddNode(const ENodeType Type, const uint32_t SlotCount)
+		{
+			Types.push_back(Type);
+			Values.push_back(DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f));
+			SlotCounts.push_back(SlotCount);
+			return static_cast<uint32_t>(Types.size() - 1);
+		}
+
+		void Connect(const uint32_t Node, const uint32_t Slot, const uint32_t Input)
+		{
+			Edges.push_back({ Node, Slot, Input });
+		}
+
+		void Compile(const uint32_t Output)
+		{
+			Schedule.Compile(SlotCounts.data(), SlotCounts.size(), Edges.data(), Edges.size(), Output);
+			States.resize(Types.size());
+			StatePointers.resize(Types.size());
+			Back.resize(Types.size());
+			Front.resize(Types.size());
+			bIsSlow.resize(Types.size());
+			for (uint32_t Index = 0; Index < Types.size(); ++Index)
+			{
+				auto& State = States[Index];
+				State.bIsDrawn = !IsValueNode(Types[Index]) && Types[Index] != ENodeType::OUTPUT;
+				State.TargetBytes = State.bIsDrawn ? TARGET_BYTES : 0;
+				State.DrawInput = NO_NODE;
+				const auto Inputs = Schedule.GetInputs(Index);
+				for (uint32_t Slot = 0; Slot < Schedule.GetInputCount(Index); ++Slot)
+				{
+					if (Inputs[Slot] != NO_NODE && !IsValueNode(Types[Inputs[Slot]]))
+					{
+						State.DrawInput = Inputs[Slot];
+					}
+				}
+				StatePointers[Index] = &State;
+			}
+			Evaluator.SetGraph(Schedule, StatePointers.data());
+		}
+
+		// a whole pass after an edit
+		void Evaluate()
+		{
+			Drawn.clear();
+			Evicted.clear();
+			Evaluator.Restart();
+			Evaluator.Update(*this, 0.0f);
+		}
+
+		// one frame of a pass spread over frames, true when it finished
+		bool Frame(const float Budget)
+		{
+			Drawn.clear();
+			Evicted.clear();
+			return Evaluator.Update(*this, Budget);
+		}
+
+		uint64_t HashValues(const uint32_t Node) override
+		{
+			const uint64_t Hash = Generator::HashTexGenBytes(&Types[Node], sizeof(Types[Node]));
+			return Generator::HashTexGenBytes(&Values[Node], sizeof(Values[Node]), Hash);
+		}
+
+		void Draw(const uint32_t Node) override
+		{
+			const auto Input = States[Node].DrawInput;
+			bIsTargetMissing |= States[Node].ResidentBytes == 0 || (Input != NO_NODE && States[Input].ResidentBytes == 0);
+			Drawn.push_back(Node);
+			Back[Node] = States[Node].Hash;
+			Clock += bIsSlow[Node] ? SLOW_DRAW_MILLISECONDS : FAST_DRAW_MILLISECONDS;
+		}
+
+		void CreateTargets(const uint32_t Node) override
+		{
+			Back[Node] = 0;
+			Front[Node] = 0;
+		}
+
+		void ReleaseTargets(const uint32_t Node) override
+		{
+			Evicted.push_back(Node);
+		}
+
+		void Present() override
+		{
+			Front = Back;
+			++PresentCount;
+		}
+
+		double GetMilliseconds() override
+		{
+			return Clock;
+		}
+	};
+
+	// Rectangle -> Loop -> SineDist -> Loop -> Output, every slot but the texture ones fed by a value
+	// node of its own
+	struct SEditorGraph
+	{
+		SEvaluatorGraph Graph;
+		uint32_t Position, Chamfer, Falloff, Rectangle;
+		uint32_t Repeat, Loop;
+		uint32_t Count, Amplitude, SineDist;
+		uint32_t SecondRepeat, SecondLoop;
+		uint32_t Output;
+	};
+
+	void MakeEditorGraph(SEditorGraph& Editor)
+	{
+		auto& Graph = Editor.Graph;
+		Editor.Position = Graph.AddNode(ENodeType::VECTOR4, 0);
+		Editor.Chamfer = Graph.AddNode(ENodeType::SCALAR, 0);
+		Editor.Falloff = Graph.AddNode(ENodeType::SCALAR, 0);
+		Editor.Rectangle = Graph.AddNode(ENodeType::RECTANGLE, 3);
+		Graph.Connect(Editor.Rectangle, 0, Editor.Position);
+		Graph.Connect(Editor.Rectangle, 1, Editor.Chamfer);
+		Graph.Connect(Editor.Rectangle, 2, Editor.Falloff);
+		Editor.Repeat = Graph.AddNode(ENodeType::VECTOR2, 0);
+		Editor.Loop = Graph.AddNode(ENodeType::LOOP, 2);
+		Graph.Connect(Editor.Loop, 0, Editor.Repeat);
+		Graph.Connect(Editor.Loop, 1, Editor.Rectangle);
+		Editor.Count = Graph.AddNode(ENodeType::VECTOR2, 0);
+		Editor.Amplitude = Graph.AddNode(ENodeType::VECTOR2, 0);
+		Editor.SineDist = Graph.AddNode(ENodeType::SINE, 3);
+		Graph.Connect(Editor.SineDist, 0, Editor.Count);
+		Graph.Connect(Editor.SineDist, 1, Editor.Amplitude);
+		Graph.Connect(Editor.SineDist, 2, Editor.Loop);
+		Editor.SecondRepeat = Graph.AddNode(ENodeType::VECTOR2, 0);
+		Editor.SecondLoop = Graph.AddNode(ENodeType::LOOP, 2);
+		Graph.Connect(Editor.SecondLoop, 0, Editor.SecondRepeat);
+		Graph.Connect(Editor.SecondLoop, 1, Editor.SineDist);
+		Editor.Output = Graph.AddNode(ENodeType::OUTPUT, 1);
+		Graph.Connect(Editor.Output, 0, Editor.SecondLoop);
+		Graph.Compile(Editor.Output);
+	}
+
+	bool CheckDrawn(const SEvaluatorGraph& Graph, std::vector<uint32_t> Expected, const char* Step)
+	{
+		if (Graph.Drawn != Expected)
+		{
+			fprintf(stderr, "%s: %zu nodes drawn, expected %zu\n", Step, Graph.Drawn.size(), Expected.size());
+			return false;
+		}
+		return true;
+	}
+
+	bool CheckEvicted(const SEvaluatorGraph& Graph, std::vector<uint32_t> Expected, const char* Step)
+	{
+		if (Graph.Evicted != Expected)
+		{
+			fprintf(stderr, "%s: %zu nodes evicted, not the %zu expected in that order\n", Step, Graph.Evicted.size(), Expected.size());
+			return false;
+		}
+		if (Graph.bIsTargetMissing)
+		{
+			fprintf(stderr, "%s: a node was drawn without its targets or those of its input\n", Step);
+			return false;
+		}
+		return true;
+	}
+
+	bool CheckResident(const SEvaluatorGraph& Graph, const uint32_t Node, const char* Step)
+	{
+		if (Graph.Evaluator.GetResidentBytes() != TARGET_BYTES || Graph.States[Node].ResidentBytes != TARGET_BYTES)
+		{
+			fprintf(stderr, "%s: %llu bytes resident, expected only the shown node\n", Step, static_cast<unsigned long long>(Graph.Evaluator.GetResidentBytes()));
+			return false;
+		}
+		return true;
+	}
+
+	// every edit of a value redraws the texture nodes downstream of it and nothing upstream
+	bool CheckDownstreamRedraw()
+	{
+		SEditorGraph Editor;
+		MakeEditorGraph(Editor);
+		auto& Graph = Editor.Graph;
+		Graph.Evaluate();
+		if (!CheckDrawn(Graph, { Editor.Rectangle, Editor.Loop, Editor.SineDist, Editor.SecondLoop }, "first pass"))
+		{
+			return false;
+		}
+		Graph.Evaluate();
+		if (!CheckDrawn(Graph, {}, "unchanged"))
+		{
+			return false;
+		}
+
+		Graph.Values[Editor.Amplitude].y = 0.25f;
+		Graph.Evaluate();
+		if (!CheckDrawn(Graph, { Editor.SineDist, Editor.SecondLoop }, "amplitude edited"))
+		{
+			return false;
+		}
+		Graph.Values[Editor.SecondRepeat].x = 3.0f;
+		Graph.Evaluate();
+		if (!CheckDrawn(Graph, { Editor.SecondLoop }, "last repeat edited"))
+		{
+			return false;
+		}
+		Graph.Values[Editor.Chamfer].x = 0.5f;
+		Graph.Evaluate();
+		if (!CheckDrawn(Graph, { Editor.Rectangle, Editor.Loop, Editor.SineDist, Editor.SecondLoop }, "chamfer edited"))
+		{
+			return false;
+		}
+
+		// dragging a value back and forth within a frame changes nothing
+		Graph.Values[Editor.Repeat].x = 2.0f;
+		Graph.Values[Editor.Repeat].x = 0.0f;
+		Graph.Evaluate();
+		return CheckDrawn(Graph, {}, "edited back");
+	}
+
+	bool CheckFrame(SEvaluatorGraph& Graph, const bool bFinished, std::vector<uint32_t> Expected, const char* Step)
+	{
+		if (Graph.Frame(BUDGET_MILLISECONDS) != bFinished)
+		{
+			fprintf(stderr, "%s: the pass %s\n", Step, bFinished ? "did not finish" : "finished early");
+			return false;
+		}
+		return CheckDrawn(Graph, Expected, Step);
+	}
+
+	// with the rectangle and the sinedist slower than the budget, every frame stops after drawing one
+	// of them and the next one goes on from there. Nothing is presented before the pass finished.
+	bool CheckTimeSlicing()
+	{
+		SEditorGraph Editor;
+		MakeEditorGraph(Editor);
+		auto& Graph = Editor.Graph;
+		Graph.bIsSlow[Editor.Rectangle] = true;
+		Graph.bIsSlow[Editor.SineDist] = true;
+		const auto Shown = Editor.SecondLoop;
+
+		Graph.Evaluator.Restart();
+		if (!CheckFrame(Graph, false, { Editor.Rectangle }, "first frame") || !CheckFrame(Graph, false, { Editor.Loop, Editor.SineDist }, "second frame"))
+		{
+			return false;
+		}
+		if (Graph.PresentCount != 0 || Graph.Evaluator.GetCursor() == 0)
+		{
+			fprintf(stderr, "presented or did not move on before the pass finished\n");
+			return false;
+		}
+		if (!CheckFrame(Graph, true, { Editor.SecondLoop }, "third frame"))
+		{
+			return false;
+		}
+		if (Graph.PresentCount != 1 || Graph.Front[Shown] != Graph.States[Shown].Hash || Graph.Evaluator.GetLastFrameCount() != 3 || Graph.Evaluator.GetLastEvaluationCount() != 4)
+		{
+			fprintf(stderr, "the finished pass was not presented once over 3 frames\n");
+			return false;
+		}
+
+		// an edit in the middle of a pass starts it over, the rectangle drawn before is not drawn again
+		const auto ShownBefore = Graph.Front[Shown];
+		Graph.Values[Editor.Chamfer].x = 0.5f;
+		Graph.Evaluator.Restart();
+		if (!CheckFrame(Graph, false, { Editor.Rectangle }, "first frame after an edit"))
+		{
+			return false;
+		}
+		Graph.Values[Editor.Count].x = 2.0f;
+		Graph.Evaluator.Restart();
+		if (Graph.Evaluator.GetCursor() != 0)
+		{
+			fprintf(stderr, "an edit in the middle of a pass did not restart it\n");
+			return false;
+		}
+		if (!CheckFrame(Graph, false, { Editor.Loop, Editor.SineDist }, "first frame after a second edit") || Graph.Front[Shown] != ShownBefore)
+		{
+			return false;
+		}
+		if (!CheckFrame(Graph, true, { Editor.SecondLoop }, "second frame after a second edit"))
+		{
+			return false;
+		}
+		if (Graph.PresentCount != 2 || Graph.Front[Shown] != Graph.States[Shown].Hash || Graph.Front[Shown] == ShownBefore)
+		{
+			fprintf(stderr, "the restarted pass was not presented once\n");
+			return false;
+		}
+
+		// without an edit there is nothing to go on with
+		return !Graph.Frame(BUDGET_MILLISECONDS) && Graph.Drawn.empty() && Graph.PresentCount == 2;
+	}
+
+	// with room for three of the four results, the least recently drawn or read one goes first. The
+	// node being drawn, the one it reads and the one the output shows are never evicted.
+	bool CheckEvictionOrder()
+	{
+		SEditorGraph Editor;
+		MakeEditorGraph(Editor);
+		auto& Graph = Editor.Graph;
+		Graph.Evaluator.SetCacheBudget(3 * TARGET_BYTES);
+		Graph.Evaluate();
+		if (!CheckEvicted(Graph, { Editor.Rectangle }, "first pass"))
+		{
+			return false;
+		}
+
+		// the second loop is shown and stays, the others make room for each other along the path
+		Graph.Values[Editor.Chamfer].x = 0.5f;
+		Graph.Evaluate();
+		if (!CheckDrawn(Graph, { Editor.Rectangle, Editor.Loop, Editor.SineDist, Editor.SecondLoop }, "chamfer edited") ||
+			!CheckEvicted(Graph, { Editor.Loop, Editor.SineDist, Editor.Rectangle }, "chamfer edited"))
+		{
+			return false;
+		}
+		if (Graph.Evaluator.GetResidentBytes() > 3 * TARGET_BYTES || Graph.Evaluator.GetRecomputeCount() != 0)
+		{
+			fprintf(stderr, "the cache went over its budget or recomputed a node\n");
+			return false;
+		}
+
+		// a lowered budget takes effect without a pass, the shown result is kept above it
+		Graph.Evaluator.SetCacheBudget(0);
+		Graph.Frame(BUDGET_MILLISECONDS);
+		return CheckEvicted(Graph, { Editor.Loop, Editor.SineDist }, "budget lowered") && CheckResident(Graph, Editor.SecondLoop, "budget lowered");
+	}
+
+	// a node reading an evicted result draws it again first, and the nodes that one reads if they
+	// were evicted as well
+	bool CheckRecompute()
+	{
+		SEditorGraph Editor;
+		MakeEditorGraph(Editor);
+		auto& Graph = Editor.Graph;
+		Graph.Evaluator.SetCacheBudget(3 * TARGET_BYTES);
+		Graph.Evaluate();
+
+		// the first loop reads the evicted rectangle, whose inputs did not change
+		Graph.Values[Editor.Repeat].x = 2.0f;
+		Graph.Evaluate();
+		if (!CheckDrawn(Graph, { Editor.Rectangle, Editor.Loop, Editor.SineDist, Editor.SecondLoop }, "repeat edited") ||
+			!CheckEvicted(Graph, { Editor.Loop, Editor.SineDist, Editor.Rectangle }, "repeat edited"))
+		{
+			return false;
+		}
+		if (Graph.Evaluator.GetRecomputeCount() != 1)
+		{
+			fprintf(stderr, "repeat edited: %llu recomputes, expected 1\n", static_cast<unsigned long long>(Graph.Evaluator.GetRecomputeCount()));
+			return false;
+		}
+
+		// showing an unchanged node evicted earlier draws the whole path to it before presenting
+		Graph.Evaluator.SetCacheBudget(0);
+		Graph.Frame(BUDGET_MILLISECONDS);
+		Graph.Connect(Editor.Output, 0, Editor.SineDist);
+		Graph.Compile(Editor.Output);
+		Graph.Evaluate();
+		if (!CheckDrawn(Graph, { Editor.Rectangle, Editor.Loop, Editor.SineDist }, "output rewired") ||
+			!CheckEvicted(Graph, { Editor.Rectangle, Editor.SecondLoop, Editor.Loop }, "output rewired") ||
+			!CheckResident(Graph, Editor.SineDist, "output rewired"))
+		{
+			return false;
+		}
+		if (Graph.Evaluator.GetRecomputeCount() != 3 || Graph.Front[Editor.SineDist] != Graph.States[Editor.SineDist].Hash)
+		{
+			fprintf(stderr, "output rewired: the evicted path was not drawn again and presented\n");
+			return false;
+		}
+		return true;
+	}
+}
+
+void AddTexGenEvaluatorBenchmarks(FBenchmarkRunner& Runner)
+{
+	Runner.AddCheck({ "texgen/evaluator_redraws_downstream", CheckDownstreamRedraw });
+	Runner.AddCheck({ "texgen/evaluator_time_slicing", CheckTimeSlicing });
+	Runner.AddCheck({ "texgen/evaluator_eviction_order", CheckEvictionOrder });
+	Runner.AddCheck({ "texgen/evaluator_recompute", CheckRecompute });
+
+	// a pass over an unchanged chain of value and loop nodes, hashing every node and drawing none,
+	// items are nodes
+	auto Fixture = std::make_shared<SEvaluatorGraph>();
+	SBenchmark Unchanged{};
+	Unchanged.Name = "texgen/evaluator_unchanged_10k";
+	Unchanged.Items = CHAIN_NODE_COUNT;
+	Unchanged.Setup = [Fixture](uint64_t&)
+	{
+		uint32_t Input = Generator::FTexGenSchedule::NO_NODE;
+		while (Fixture->Types.size() + 2 <= CHAIN_NODE_COUNT)
+		{
+			const auto Repeat = Fixture->AddNode(ENodeType::VECTOR2, 0);
+			const auto Loop = Fixture->AddNode(ENodeType::LOOP, 2);
+			Fixture->Connect(Loop, 0, Repeat);
+			if (Input != Generator::FTexGenSchedule::NO_NODE)
+			{
+				Fixture->Connect(Loop, 1, Input);
+			}
+			Input = Loop;
+		}
+		Fixture->Compile(Input);
+		Fixture->Evaluate();
+		return Fixture->Schedule.GetOrder().size() == CHAIN_NODE_COUNT;
+	};
+	Unchanged.Run = [Fixture]() { Fixture->Evaluate(); };
+	Runner.Add(std::move(Unchanged));
+}
@@ -0,0 +1,263 @@
+#include "../TestRenderer/Application.hpp"
+#include "../TestRenderer/HeadlessPlatform.hpp"
+#include "../TestRenderer/MemoryTracker.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Renders a scene offscreen along a scripted camera orbit or a recorded camera path and writes per
+// frame timings as json.
+//
+// HeadlessRunner [-scene=<file>] [-path=<file>] [-frames=<n>] [-warmup=<n>] [-width=<w>] [-height=<h>]
+//                [-warp] [-threadedupdate] [-json=<file>] [-renderstats=<file>]
+//                [-memcsv=<file>] [-memcsvinterval=<seconds>]
+//
+// Time advances by a fixed 1/60 s per frame and the update runs inline by default, so every run
+// renders the same views. A path is played once over the measured frames, one time step per frame,
+// -frames defaults to its length then. It restarts with the first measured frame. A frame is timed
+// from BeginFrame until the GPU finished it. Paths are relative to the working directory, which has
+// to contain the shaders and the Mesh directory.
+// -memcsv appends per tag memory totals to a csv every -memcsvinterval seconds of wall clock time,
+// one by default, and once more at the end of the run.
+// Frames that allocate on the heap after the application's own warmup are counted in the json.
+// Returns 0 on success and 1 when the device, the scene or the path could not be created or when
+// any frame allocated.
+
+FApplication Application{};
+
+namespace
+{
+	constexpr double TIME_STEP = 1.0 / 60.0;
+
+	struct SSummary
+	{
+		double Mean = 0.0;
+		double Median = 0.0;
+		double P95 = 0.0;
+		double P99 = 0.0;
+		double Minimum = 0.0;
+		double Maximum = 0.0;
+	};
+
+	SSummary Summarize(std::vector<double> Values)
+	{
+		SSummary Summary{};
+		if (Values.empty())
+		{
+			return Summary;
+		}
+		std::sort(Values.begin(), Values.end());
+		const auto Percentile = [&](const double Fraction)
+		{
+			return Values[std::min(Values.size() - 1, static_cast<size_t>(Fraction * (Values.size() - 1) + 0.5))];
+		};
+		double Total = 0.0;
+		for (const auto Value : Values)
+		{
+			Total += Value;
+		}
+		Summary.Mean = Total / Values.size();
+		Summary.Median = Percentile(0.5);
+		Summary.P95 = Percentile(0.95);
+		Summary.P99 = Percentile(0.99);
+		Summary.Minimum = Values.front();
+		Summary.Maximum = Values.back();
+		return Summary;
+	}
+
+	// one turn around the origin over the measured frames, looking at the origin from the height
+	// of the default camera
+	void SetOrbitPose(const uint64_t Frame, const uint64_t FrameCount)
+	{
+		static constexpr float RADIUS = 10.0f;
+		static constexpr float HEIGHT = 5.0f;
+		const float Angle = 6.2831853f * static_cast<float>(Frame) / static_cast<float>(std::max<uint64_t>(FrameCount, 1));
+		const DirectX::XMFLOAT3 Position(RADIUS * std::sin(Angle), HEIGHT, -RADIUS * std::cos(Angle));
+		const float Pitch = std::atan2(HEIGHT, RADIUS);
+		Application.SetCameraPose(Position, -Angle, Pitch);
+	}
+
+	void PrintUsage()
+	{
+		printf("usage: HeadlessRunner [-scene=<file>] [-path=<file>] [-frames=<n>] [-warmup=<n>] [-width=<w>] [-height=<h>] [-warp] [-threadedupdate] [-json=<file>] [-renderstats=<file>] [-memcsv=<file>] [-memcsvinterval=<seconds>]\n");
+	}
+}
+
+int main(int ArgumentCount, char** Arguments)
+{
+	const char* SceneFileName = nullptr;
+	const char* PathFileName = nullptr;
+	const char* JsonFileName = nullptr;
+	const char* RenderStatisticsFileName = nullptr;
+	const char* MemoryCsvFileName = nullptr;
+	double MemoryCsvInterval = 1.0;
+	uint32_t FrameCount = 0;
+	uint32_t WarmupCount = 60;
+	uint32_t Width = 1600;
+	uint32_t Height = 900;
+	bool bSoftware = false;
+	bool bThreadedUpdate = false;
+	for (int Index = 1; Index < ArgumentCount; ++Index)
+	{
+		const char* Argument = Arguments[Index];
+		if (strncmp(Argument, "-scene=", 7) == 0)
+		{
+			SceneFileName = Argument + 7;
+		}
+		else if (strncmp(Argument, "-path=", 6) == 0)
+		{
+			PathFileName = Argument + 6;
+		}
+		else if (strncmp(Argument, "-frames=", 8) == 0)
+		{
+			FrameCount = std::max(1u, static_cast<uint32_t>(strtoul(Argument + 8, nullptr, 10)));
+		}
+		else if (strncmp(Argument, "-warmup=", 8) == 0)
+		{
+			WarmupCount = static_cast<uint32_t>(strtoul(Argument + 8, nullptr, 10));
+		}
+		else if (strncmp(Argument, "-width=", 7) == 0)
+		{
+			Width = std::max(1u, static_cast<uint32_t>(strtoul(Argument + 7, nullptr, 10)));
+		}
+		else if (strncmp(Argument, "-height=", 8) == 0)
+		{
+			Height = std::max(1u, static_cast<uint32_t>(strtoul(Argument + 8, nullptr, 10)));
+		}
+		else if (strcmp(Argument, "-warp") == 0)
+		{
+			bSoftware = true;
+		}
+		else if (strcmp(Argument, "-threadedupdate") == 0)
+		{
+			bThreadedUpdate = true;
+		}
+		else if (strncmp(Argument, "-json=", 6) == 0)
+		{
+			JsonFileName = Argument + 6;
+		}
+		else if (strncmp(Argument, "-renderstats=", 13) == 0)
+		{
+			RenderStatisticsFileName = Argument + 13;
+		}
+		else if (strncmp(Argument, "-memcsv=", 8) == 0)
+		{
+			MemoryCsvFileName = Argument + 8;
+		}
+		else if (strncmp(Argument, "-memcsvinterval=", 16) == 0)
+		{
+			MemoryCsvInterval = strtod(Argument + 16, nullptr);
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (SceneFileName)
+	{
+		Application.SetScene(SceneFileName);
+	}
+	if (RenderStatisticsFileName)
+	{
+		Application.SetRenderStatisticsOutput(RenderStatisticsFileName);
+	}
+	if (MemoryCsvFileName)
+	{
+		FMemoryTracker::Get().SetCsvOutput(MemoryCsvFileName, MemoryCsvInterval);
+	}
+	Application.SetSoftwareRendering(bSoftware);
+	Application.SetThreadedUpdate(bThreadedUpdate);
+
+	if (PathFileName)
+	{
+		if (Application.PlayCameraPath(PathFileName, static_cast<float>(TIME_STEP), false) != EErrorCode::OK)
+		{
+			fprintf(stderr, "cannot load camera path %s\n", PathFileName);
+			return 1;
+		}
+		if (FrameCount == 0)
+		{
+			FrameCount = static_cast<uint32_t>(Application.GetCameraPathFrameCount());
+		}
+	}
+	else if (FrameCount == 0)
+	{
+		FrameCount = 600;
+	}
+
+	FHeadlessPlatform Platform(Width, Height, static_cast<uint64_t>(WarmupCount) + FrameCount, TIME_STEP);
+	const auto Result = Application.Setup(Platform);
+	if (Result != EErrorCode::OK)
+	{
+		fprintf(stderr, "setup failed with error %d, %s\n", static_cast<int>(Result), SceneFileName ? SceneFileName : "default scene");
+		return 1;
+	}
+
+	using FClock = std::chrono::steady_clock;
+	std::vector<double> FrameMilliseconds;
+	FrameMilliseconds.reserve(FrameCount);
+	double Time = Platform.GetTime();
+	while (Platform.PumpEvents())
+	{
+		const auto Frame = Platform.GetFrame();
+		const bool bWarmup = Frame <= WarmupCount;
+		if (PathFileName == nullptr)
+		{
+			SetOrbitPose(bWarmup ? 0 : Frame - WarmupCount - 1, FrameCount);
+		}
+		else if (Frame == WarmupCount + 1)
+		{
+			Application.PlayCameraPath(PathFileName, static_cast<float>(TIME_STEP), false);
+		}
+
+		const auto CurrentTime = Platform.GetTime();
+		const auto DeltaTime = CurrentTime - Time;
+		Time = CurrentTime;
+
+		const auto Start = FClock::now();
+		Application.RunFrame(static_cast<float>(DeltaTime));
+		const double Milliseconds = std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+		if (!bWarmup)
+		{
+			FrameMilliseconds.push_back(Milliseconds);
+		}
+	}
+	const auto FramesWithHeapAllocations = Application.GetFramesWithHeapAllocations();
+	Application.TearDown();
+
+	FILE* Json = JsonFileName ? fopen(JsonFileName, "w") : stdout;
+	if (Json == nullptr)
+	{
+		fprintf(stderr, "cannot write %s\n", JsonFileName);
+		return 1;
+	}
+	const auto Summary = Summarize(FrameMilliseconds);
+	fprintf(Json, "{\n\t\"scene\": \"%s\",\n\t\"camera\": \"%s\",\n\t\"width\": %u,\n\t\"height\": %u,\n\t\"warp\": %s,\n\t\"threaded_update\": %s,\n\t\"warmup\": %u,\n\t\"frames\": %u,\n",
+		SceneFileName ? SceneFileName : "default", PathFileName ? PathFileName : "orbit", Width, Height, bSoftware ? "true" : "false", bThreadedUpdate ? "true" : "false", WarmupCount, FrameCount);
+	fprintf(Json, "\t\"frames_with_heap_allocations\": %llu,\n", static_cast<unsigned long long>(FramesWithHeapAllocations));
+	fprintf(Json, "\t\"summary_ms\": { \"mean\": %.4f, \"median\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"min\": %.4f, \"max\": %.4f },\n",
+		Summary.Mean, Summary.Median, Summary.P95, Summary.P99, Summary.Minimum, Summary.Maximum);
+	fprintf(Json, "\t\"frame_ms\": [");
+	for (size_t Index = 0; Index < FrameMilliseconds.size(); ++Index)
+	{
+		fprintf(Json, "%s%.4f", Index == 0 ? "" : ", ", FrameMilliseconds[Index]);
+	}
+	fprintf(Json, "]\n}\n");
+	if (Json != stdout)
+	{
+		fclose(Json);
+	}
+	if (FramesWithHeapAllocations > 0)
+	{
+		fprintf(stderr, "%llu frames allocated on the heap\n", static_cast<unsigned long long>(FramesWithHeapAllocations));
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,177 @@
+#include "CaptureFile.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	// smallest payload of each call in 32 bit values, the variable parts are checked by the device
+	constexpr uint32_t MINIMUM_PAYLOAD[] =
+	{
+		5,	// CLEAR_RENDER_TARGET
+		4,	// CLEAR_DEPTH_STENCIL
+		0,	// UNBIND_RENDER_TARGETS
+		3,	// SET_CONSTANT_BUFFER
+		6,	// SET_VIEWPORT
+		5,	// SET_SHADER
+		2,	// SET_RENDER_TARGETS
+		2,	// SET_TEXTURE
+		1,	// SET_PRIMITIVE_TOPOLOGY
+		4,	// SET_VERTEX_BUFFER
+		2,	// SET_INDEX_BUFFER
+		2,	// SET_COMPUTE_TEXTURE
+		2,	// SET_COMPUTE_BUFFER
+		2,	// SET_READ_WRITE_TEXTURE
+		2,	// SET_READ_WRITE_BUFFER
+		0,	// UNBIND_COMPUTE_RESOURCES
+		3,	// DISPATCH
+		2,	// DRAW
+		3,	// DRAW_INDEXED
+		2	// UPDATE_SUBRESOURCE
+	};
+	static_assert(sizeof(MINIMUM_PAYLOAD) / sizeof(MINIMUM_PAYLOAD[0]) == static_cast<size_t>(ECaptureCall::COUNT), "every capture call needs a minimum payload");
+
+	// D3D11 does not create larger resources, anything above is a corrupt header
+	constexpr uint32_t MAXIMUM_RESOURCE_SIZE = 128u << 20;
+}
+
+bool FCaptureFile::Load(const char* FileName, std::string& Error)
+{
+	FILE* File = fopen(FileName, "rb");
+	if (File == nullptr)
+	{
+		Error = std::string("cannot open ") + FileName;
+		return false;
+	}
+	fseek(File, 0, SEEK_END);
+	const long Size = ftell(File);
+	fseek(File, 0, SEEK_SET);
+	Bytes.resize(Size > 0 ? static_cast<size_t>(Size) : 0);
+	const bool bRead = Bytes.empty() || fread(Bytes.data(), Bytes.size(), 1, File) == 1;
+	fclose(File);
+	if (!bRead)
+	{
+		Error = std::string("cannot read ") + FileName;
+		return false;
+	}
+
+	const bool bParsed = Parse(Error);
+	// resources and payloads are copied out, the raw file is not needed any more
+	Bytes.clear();
+	Bytes.shrink_to_fit();
+	return bParsed;
+}
+
+bool FCaptureFile::Parse(std::string& Error)
+{
+	size_t Offset = 0;
+	const auto Read = [&](void* Destination, const size_t Size)
+	{
+		if (Bytes.size() - Offset < Size)
+		{
+			return false;
+		}
+		memcpy(Destination, Bytes.data() + Offset, Size);
+		Offset += Size;
+		return true;
+	};
+
+	SCaptureFileHeader Header{};
+	if (!Read(&Header, sizeof(Header)) || Header.Magic != CAPTURE_MAGIC)
+	{
+		Error = "not a capture file";
+		return false;
+	}
+	if (Header.Version != CAPTURE_VERSION)
+	{
+		Error = "unsupported capture version " + std::to_string(Header.Version);
+		return false;
+	}
+	if (Header.ResourceCount > Bytes.size() / sizeof(SCaptureResourceHeader) || Header.CallCount > Bytes.size() / sizeof(SCaptureCallHeader))
+	{
+		Error = "truncated capture";
+		return false;
+	}
+
+	Resources.resize(Header.ResourceCount);
+	for (uint32_t Index = 0; Index < Header.ResourceCount; ++Index)
+	{
+		auto& Resource = Resources[Index];
+		if (!Read(&Resource.Header, sizeof(Resource.Header)))
+		{
+			Error = "truncated resource header " + std::to_string(Index);
+			return false;
+		}
+		if (Resource.Header.Id != Index || Resource.Header.Type > ECaptureResource::INPUT_LAYOUT || Resource.Header.DataSize > Bytes.size() - Offset
+			|| (Resource.Header.Type == ECaptureResource::BUFFER && Resource.Header.Width > MAXIMUM_RESOURCE_SIZE))
+		{
+			Error = "malformed resource " + std::to_string(Index);
+			return false;
+		}
+		Resource.Data.resize(Resource.Header.DataSize);
+		if (!Read(Resource.Data.data(), Resource.Data.size()))
+		{
+			Error = "truncated resource data " + std::to_string(Index);
+			return false;
+		}
+		// buffers are always backed by their full size so uploads can land anywhere
+		if (Resource.Header.Type == ECaptureResource::BUFFER && Resource.Data.size() < Resource.Header.Width)
+		{
+			Resource.Data.resize(Resource.Header.Width);
+		}
+	}
+
+	Calls.reserve(Header.CallCount);
+	CallData.reserve((Bytes.size() - Offset) / sizeof(uint32_t));
+	for (uint32_t Index = 0; Index < Header.CallCount; ++Index)
+	{
+		SCaptureCallHeader CallHeader{};
+		if (!Read(&CallHeader, sizeof(CallHeader)) || CallHeader.PayloadSize % sizeof(uint32_t) != 0 || Bytes.size() - Offset < CallHeader.PayloadSize)
+		{
+			Error = "truncated call " + std::to_string(Index);
+			return false;
+		}
+		if (CallHeader.Call >= ECaptureCall::COUNT || CallHeader.PayloadSize / sizeof(uint32_t) < MINIMUM_PAYLOAD[static_cast<size_t>(CallHeader.Call)])
+		{
+			Error = "malformed call " + std::to_string(Index);
+			return false;
+		}
+
+		SCaptureCall Call{};
+		Call.Call = CallHeader.Call;
+		Call.PayloadSize = CallHeader.PayloadSize;
+		Call.PayloadOffset = CallData.size();
+		CallData.resize(CallData.size() + CallHeader.PayloadSize / sizeof(uint32_t));
+		if (CallHeader.PayloadSize > 0)
+		{
+			Read(CallData.data() + Call.PayloadOffset, CallHeader.PayloadSize);
+		}
+		Calls.push_back(Call);
+	}
+	return true;
+}
+
+const std::vector<SCaptureResource>& FCaptureFile::GetResources() const noexcept
+{
+	return Resources;
+}
+
+const std::vector<SCaptureCall>& FCaptureFile::GetCalls() const noexcept
+{
+	return Calls;
+}
+
+const uint32_t* FCaptureFile::GetPayload(const SCaptureCall& Call) const noexcept
+{
+	return CallData.data() + Call.PayloadOffset;
+}
+
+uint64_t FCaptureFile::GetFileSize() const noexcept
+{
+	uint64_t Size = sizeof(SCaptureFileHeader);
+	for (const auto& Resource : Resources)
+	{
+		Size += sizeof(SCaptureResourceHeader) + Resource.Header.DataSize;
+	}
+	return Size + Calls.size() * sizeof(SCaptureCallHeader) + CallData.size() * sizeof(uint32_t);
+}
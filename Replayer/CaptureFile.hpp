@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../TestRenderer/FrameCaptureFormat.hpp"
+#include <string>
+#include <vector>
+
+struct SCaptureResource
+{
+	SCaptureResourceHeader Header{};
+	std::vector<uint8_t> Data;
+};
+
+struct SCaptureCall
+{
+	ECaptureCall Call;
+	uint32_t PayloadSize;
+	// offset of the payload in the call data, payloads are 4 byte aligned
+	size_t PayloadOffset;
+};
+
+// Reads a capture written by FFrameCapture and checks it is well formed, so the replay itself
+// can index resources and read payload values without bounds checks.
+class FCaptureFile
+{
+public:
+	bool Load(const char* FileName, std::string& Error);
+
+	const std::vector<SCaptureResource>& GetResources() const noexcept;
+	const std::vector<SCaptureCall>& GetCalls() const noexcept;
+
+	const uint32_t* GetPayload(const SCaptureCall& Call) const noexcept;
+	uint64_t GetFileSize() const noexcept;
+
+private:
+	bool Parse(std::string& Error);
+
+	std::vector<uint8_t> Bytes;
+	std::vector<SCaptureResource> Resources;
+	std::vector<SCaptureCall> Calls;
+	std::vector<uint32_t> CallData;
+};
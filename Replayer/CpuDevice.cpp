@@ -0,0 +1,620 @@
+#include "CpuDevice.hpp"
+#include "../TestRenderer/ShaderStage.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	// D3D11_APPEND_ALIGNED_ELEMENT
+	constexpr uint32_t APPEND_ALIGNED = 0xFFFFFFFF;
+	// D3D11_CLEAR_DEPTH and D3D11_CLEAR_STENCIL
+	constexpr uint32_t CLEAR_DEPTH = 0x1;
+	constexpr uint32_t CLEAR_STENCIL = 0x2;
+
+	uint16_t ToHalf(const float Value)
+	{
+		uint32_t Bits;
+		memcpy(&Bits, &Value, sizeof(Bits));
+		const uint32_t Sign = (Bits >> 16) & 0x8000;
+		const int32_t Exponent = static_cast<int32_t>((Bits >> 23) & 0xFF) - 127 + 15;
+		const uint32_t Mantissa = Bits & 0x7FFFFF;
+		if (((Bits >> 23) & 0xFF) == 0xFF)
+		{
+			return static_cast<uint16_t>(Sign | 0x7C00 | (Mantissa ? 0x200 : 0));
+		}
+		if (Exponent >= 0x1F)
+		{
+			return static_cast<uint16_t>(Sign | 0x7C00);
+		}
+		if (Exponent <= 0)
+		{
+			// denormals are flushed, clear values never need them
+			return static_cast<uint16_t>(Sign);
+		}
+		return static_cast<uint16_t>(Sign | (Exponent << 10) | (Mantissa >> 13));
+	}
+
+	uint32_t ToUnorm(const float Value, const uint32_t Maximum)
+	{
+		const float Clamped = std::min(std::max(Value, 0.0f), 1.0f);
+		return static_cast<uint32_t>(std::lround(Clamped * Maximum));
+	}
+
+	// writes one texel of Format holding Value and returns its size, 0 for unknown formats
+	uint32_t EncodeTexel(const uint32_t Format, const float Value[4], const uint32_t Stencil, uint8_t* Texel)
+	{
+		const auto Size = GetCaptureFormatSize(Format);
+		switch (Format)
+		{
+		case 2: case 6: case 16: case 40: case 41:
+			memcpy(Texel, Value, Size);
+			break;
+		case 10: case 54:
+			for (uint32_t Channel = 0; Channel < Size / 2; ++Channel)
+			{
+				const auto Half = ToHalf(Value[Channel]);
+				memcpy(Texel + Channel * 2, &Half, 2);
+			}
+			break;
+		case 11: case 56:
+			for (uint32_t Channel = 0; Channel < Size / 2; ++Channel)
+			{
+				const auto Unorm = static_cast<uint16_t>(ToUnorm(Value[Channel], 0xFFFF));
+				memcpy(Texel + Channel * 2, &Unorm, 2);
+			}
+			break;
+		case 28: case 29: case 61:
+			for (uint32_t Channel = 0; Channel < Size; ++Channel)
+			{
+				Texel[Channel] = static_cast<uint8_t>(ToUnorm(Value[Channel], 0xFF));
+			}
+			break;
+		case 87: case 91:
+			Texel[0] = static_cast<uint8_t>(ToUnorm(Value[2], 0xFF));
+			Texel[1] = static_cast<uint8_t>(ToUnorm(Value[1], 0xFF));
+			Texel[2] = static_cast<uint8_t>(ToUnorm(Value[0], 0xFF));
+			Texel[3] = static_cast<uint8_t>(ToUnorm(Value[3], 0xFF));
+			break;
+		case 44: case 45:
+		{
+			const uint32_t Packed = ToUnorm(Value[0], 0xFFFFFF) | (Stencil << 24);
+			memcpy(Texel, &Packed, sizeof(Packed));
+			break;
+		}
+		case 42: case 57:
+		{
+			const auto Integer = static_cast<uint32_t>(Value[0]);
+			memcpy(Texel, &Integer, Size);
+			break;
+		}
+		default:
+			return 0;
+		}
+		return Size;
+	}
+
+	uint32_t GetStageIndex(const uint32_t Stage)
+	{
+		switch (static_cast<EShaderStage>(Stage))
+		{
+		case EShaderStage::VERTEX: return 0;
+		case EShaderStage::PIXEL: return 1;
+		default: return 2;
+		}
+	}
+}
+
+FCpuDevice::FCpuDevice(const FCaptureFile& Capture)
+	: Capture(Capture)
+{
+	Reset();
+}
+
+void FCpuDevice::Reset()
+{
+	const auto& Resources = Capture.GetResources();
+	Contents.resize(Resources.size());
+	for (size_t Index = 0; Index < Resources.size(); ++Index)
+	{
+		Contents[Index] = Resources[Index].Data;
+	}
+
+	memset(&State, 0xFF, sizeof(State));
+	State.RenderTargetCount = 0;
+	State.Topology = 0;
+	State.IndexOffset = 0;
+	std::fill(std::begin(State.VertexStrides), std::end(State.VertexStrides), 0u);
+	std::fill(std::begin(State.VertexOffsets), std::end(State.VertexOffsets), 0u);
+	std::fill(std::begin(State.Viewport), std::end(State.Viewport), 0.0f);
+
+	ErrorCount = 0;
+	Messages.clear();
+}
+
+void FCpuDevice::Execute(const uint32_t Index, const SCaptureCall& Call)
+{
+	CurrentCall = Index;
+	CurrentType = Call.Call;
+	const uint32_t* Payload = Capture.GetPayload(Call);
+	const uint32_t PayloadCount = Call.PayloadSize / sizeof(uint32_t);
+
+	const auto ReadFloat = [&](const uint32_t Offset)
+	{
+		float Value;
+		memcpy(&Value, Payload + Offset, sizeof(Value));
+		return Value;
+	};
+
+	Count(Call.Call, Payload);
+	switch (Call.Call)
+	{
+	case ECaptureCall::CLEAR_RENDER_TARGET:
+	{
+		const float Colour[4] = { ReadFloat(1), ReadFloat(2), ReadFloat(3), ReadFloat(4) };
+		if (Expect(Payload[0], ECaptureResource::TEXTURE, "render target"))
+		{
+			ClearTexture(Payload[0], Colour, 0);
+		}
+		break;
+	}
+	case ECaptureCall::CLEAR_DEPTH_STENCIL:
+	{
+		if (!Expect(Payload[0], ECaptureResource::TEXTURE, "depth target") || Payload[0] == CAPTURE_INVALID_ID)
+		{
+			break;
+		}
+		const auto Format = Capture.GetResources()[Payload[0]].Header.Format;
+		const bool bHasStencil = Format == 44 || Format == 45;
+		if ((Payload[1] & CLEAR_DEPTH) == 0 || (bHasStencil && (Payload[1] & CLEAR_STENCIL) == 0))
+		{
+			// partial clears keep the other half of each texel, only whole clears are replayed
+			Fail("partial depth stencil clear is not replayed");
+			break;
+		}
+		const float Depth[4] = { ReadFloat(2), 0.0f, 0.0f, 0.0f };
+		ClearTexture(Payload[0], Depth, Payload[3] & 0xFF);
+		break;
+	}
+	case ECaptureCall::UNBIND_RENDER_TARGETS:
+		std::fill(std::begin(State.Textures), std::end(State.Textures), CAPTURE_INVALID_ID);
+		std::fill(std::begin(State.RenderTargets), std::end(State.RenderTargets), CAPTURE_INVALID_ID);
+		State.RenderTargetCount = 0;
+		State.DepthTarget = CAPTURE_INVALID_ID;
+		break;
+	case ECaptureCall::SET_CONSTANT_BUFFER:
+		if (Expect(Payload[0], ECaptureResource::BUFFER, "constant buffer") && ExpectSlot(Payload[2], MAX_SLOTS))
+		{
+			for (uint32_t Stage = 1; Stage <= static_cast<uint32_t>(EShaderStage::COMPUTE); Stage <<= 1)
+			{
+				if (Payload[1] & Stage)
+				{
+					State.ConstantBuffers[GetStageIndex(Stage)][Payload[2]] = Payload[0];
+				}
+			}
+		}
+		break;
+	case ECaptureCall::SET_VIEWPORT:
+		for (uint32_t Value = 0; Value < 6; ++Value)
+		{
+			State.Viewport[Value] = ReadFloat(Value);
+		}
+		if (State.Viewport[0] <= 0.0f || State.Viewport[1] <= 0.0f)
+		{
+			Fail("empty viewport");
+		}
+		break;
+	case ECaptureCall::SET_SHADER:
+	{
+		const auto Stage = static_cast<EShaderStage>(Payload[0]);
+		if ((Stage & EShaderStage::VERTEX) == EShaderStage::VERTEX
+			&& Expect(Payload[1], ECaptureResource::VERTEX_SHADER, "vertex shader")
+			&& Expect(Payload[2], ECaptureResource::INPUT_LAYOUT, "input layout"))
+		{
+			State.VertexShader = Payload[1];
+			State.InputLayout = Payload[2];
+		}
+		if ((Stage & EShaderStage::PIXEL) == EShaderStage::PIXEL && Expect(Payload[3], ECaptureResource::PIXEL_SHADER, "pixel shader"))
+		{
+			State.PixelShader = Payload[3];
+		}
+		if ((Stage & EShaderStage::COMPUTE) == EShaderStage::COMPUTE && Expect(Payload[4], ECaptureResource::COMPUTE_SHADER, "compute shader"))
+		{
+			State.ComputeShader = Payload[4];
+		}
+		break;
+	}
+	case ECaptureCall::SET_RENDER_TARGETS:
+	{
+		const uint32_t Count = Payload[0];
+		if (Count > MAX_RENDER_TARGETS || PayloadCount < 2 + Count)
+		{
+			Fail("malformed render target list");
+			break;
+		}
+		std::fill(std::begin(State.RenderTargets), std::end(State.RenderTargets), CAPTURE_INVALID_ID);
+		State.RenderTargetCount = Count;
+		State.DepthTarget = Expect(Payload[1], ECaptureResource::TEXTURE, "depth target") ? Payload[1] : CAPTURE_INVALID_ID;
+		for (uint32_t Target = 0; Target < Count; ++Target)
+		{
+			if (Expect(Payload[2 + Target], ECaptureResource::TEXTURE, "render target"))
+			{
+				State.RenderTargets[Target] = Payload[2 + Target];
+			}
+		}
+		break;
+	}
+	case ECaptureCall::SET_TEXTURE:
+		if (ExpectSlot(Payload[0], MAX_SLOTS) && Expect(Payload[1], ECaptureResource::TEXTURE, "texture"))
+		{
+			State.Textures[Payload[0]] = Payload[1];
+		}
+		break;
+	case ECaptureCall::SET_PRIMITIVE_TOPOLOGY:
+		State.Topology = Payload[0];
+		break;
+	case ECaptureCall::SET_VERTEX_BUFFER:
+		if (ExpectSlot(Payload[0], MAX_SLOTS) && Expect(Payload[1], ECaptureResource::BUFFER, "vertex buffer"))
+		{
+			State.VertexBuffers[Payload[0]] = Payload[1];
+			State.VertexStrides[Payload[0]] = Payload[2];
+			State.VertexOffsets[Payload[0]] = Payload[3];
+		}
+		break;
+	case ECaptureCall::SET_INDEX_BUFFER:
+		if (Expect(Payload[0], ECaptureResource::BUFFER, "index buffer"))
+		{
+			State.IndexBuffer = Payload[0];
+			State.IndexOffset = Payload[1];
+		}
+		break;
+	case ECaptureCall::SET_COMPUTE_TEXTURE:
+		if (ExpectSlot(Payload[0], MAX_SLOTS) && Expect(Payload[1], ECaptureResource::TEXTURE, "compute texture"))
+		{
+			State.ComputeTextures[Payload[0]] = Payload[1];
+		}
+		break;
+	case ECaptureCall::SET_COMPUTE_BUFFER:
+		if (ExpectSlot(Payload[0], MAX_SLOTS) && Expect(Payload[1], ECaptureResource::BUFFER, "compute buffer"))
+		{
+			State.ComputeBuffers[Payload[0]] = Payload[1];
+		}
+		break;
+	case ECaptureCall::SET_READ_WRITE_TEXTURE:
+		if (ExpectSlot(Payload[0], MAX_SLOTS) && Expect(Payload[1], ECaptureResource::TEXTURE, "read write texture"))
+		{
+			State.ReadWriteTextures[Payload[0]] = Payload[1];
+		}
+		break;
+	case ECaptureCall::SET_READ_WRITE_BUFFER:
+		if (ExpectSlot(Payload[0], MAX_SLOTS) && Expect(Payload[1], ECaptureResource::BUFFER, "read write buffer"))
+		{
+			State.ReadWriteBuffers[Payload[0]] = Payload[1];
+		}
+		break;
+	case ECaptureCall::UNBIND_COMPUTE_RESOURCES:
+		std::fill(std::begin(State.ComputeTextures), std::end(State.ComputeTextures), CAPTURE_INVALID_ID);
+		std::fill(std::begin(State.ComputeBuffers), std::end(State.ComputeBuffers), CAPTURE_INVALID_ID);
+		std::fill(std::begin(State.ReadWriteTextures), std::end(State.ReadWriteTextures), CAPTURE_INVALID_ID);
+		std::fill(std::begin(State.ReadWriteBuffers), std::end(State.ReadWriteBuffers), CAPTURE_INVALID_ID);
+		break;
+	case ECaptureCall::DISPATCH:
+		ValidateDispatch(Payload[0], Payload[1], Payload[2]);
+		break;
+	case ECaptureCall::DRAW:
+		ValidateDraw(Payload[0], Payload[1]);
+		break;
+	case ECaptureCall::DRAW_INDEXED:
+		ValidateDrawIndexed(Payload[0], Payload[1], static_cast<int32_t>(Payload[2]));
+		break;
+	case ECaptureCall::UPDATE_SUBRESOURCE:
+		if (Payload[1] > (PayloadCount - 2) * sizeof(uint32_t))
+		{
+			Fail("upload larger than its payload");
+		}
+		else if (Expect(Payload[0], ECaptureResource::BUFFER, "upload target"))
+		{
+			UpdateBuffer(Payload[0], Payload + 2, Payload[1]);
+		}
+		break;
+	default:
+		Fail("unknown call");
+		break;
+	}
+}
+
+void FCpuDevice::Count(const ECaptureCall Call, const uint32_t* Payload) noexcept
+{
+	// the counters FRenderer adds for the call that was captured. Resources are created before the
+	// captured frame, so creations are not counted.
+	switch (Call)
+	{
+	case ECaptureCall::CLEAR_RENDER_TARGET:
+	case ECaptureCall::CLEAR_DEPTH_STENCIL:
+		Statistics.Add(ERenderCounter::CLEARS);
+		break;
+	case ECaptureCall::UNBIND_RENDER_TARGETS:
+	case ECaptureCall::SET_RENDER_TARGETS:
+		Statistics.Add(ERenderCounter::RENDER_TARGET_BINDS);
+		break;
+	case ECaptureCall::SET_CONSTANT_BUFFER:
+		Statistics.Add(ERenderCounter::CONSTANT_BUFFER_BINDS);
+		break;
+	case ECaptureCall::SET_VIEWPORT:
+		Statistics.Add(ERenderCounter::VIEWPORT_CHANGES);
+		break;
+	case ECaptureCall::SET_SHADER:
+		Statistics.Add(ERenderCounter::SHADER_BINDS);
+		break;
+	case ECaptureCall::SET_TEXTURE:
+	case ECaptureCall::SET_COMPUTE_TEXTURE:
+	case ECaptureCall::SET_COMPUTE_BUFFER:
+		Statistics.Add(ERenderCounter::TEXTURE_BINDS);
+		break;
+	case ECaptureCall::SET_PRIMITIVE_TOPOLOGY:
+		Statistics.Add(ERenderCounter::TOPOLOGY_CHANGES);
+		break;
+	case ECaptureCall::SET_VERTEX_BUFFER:
+		Statistics.Add(ERenderCounter::VERTEX_BUFFER_BINDS);
+		break;
+	case ECaptureCall::SET_INDEX_BUFFER:
+		Statistics.Add(ERenderCounter::INDEX_BUFFER_BINDS);
+		break;
+	case ECaptureCall::SET_READ_WRITE_TEXTURE:
+	case ECaptureCall::SET_READ_WRITE_BUFFER:
+		Statistics.Add(ERenderCounter::READ_WRITE_BINDS);
+		break;
+	case ECaptureCall::DISPATCH:
+		Statistics.Add(ERenderCounter::DISPATCHES);
+		break;
+	case ECaptureCall::DRAW:
+		Statistics.Add(ERenderCounter::DRAW_CALLS);
+		Statistics.Add(ERenderCounter::VERTICES, Payload[0]);
+		break;
+	case ECaptureCall::DRAW_INDEXED:
+		Statistics.Add(ERenderCounter::DRAW_CALLS);
+		Statistics.Add(ERenderCounter::INDICES, Payload[0]);
+		break;
+	case ECaptureCall::UPDATE_SUBRESOURCE:
+		Statistics.Add(ERenderCounter::UPLOADS);
+		Statistics.Add(ERenderCounter::UPLOAD_BYTES, Payload[1]);
+		break;
+	default:
+		break;
+	}
+}
+
+void FCpuDevice::ClearTexture(const uint32_t Id, const float Value[4], const uint32_t Stencil)
+{
+	if (Id == CAPTURE_INVALID_ID)
+	{
+		return;
+	}
+	uint8_t Texel[16];
+	const auto TexelSize = EncodeTexel(Capture.GetResources()[Id].Header.Format, Value, Stencil, Texel);
+	if (TexelSize == 0)
+	{
+		Fail("clear of an unknown format");
+		return;
+	}
+	// views cover the whole resource in this renderer, so every subresource is cleared
+	auto& Data = Contents[Id];
+	for (size_t Offset = 0; Offset + TexelSize <= Data.size(); Offset += TexelSize)
+	{
+		memcpy(Data.data() + Offset, Texel, TexelSize);
+	}
+}
+
+void FCpuDevice::UpdateBuffer(const uint32_t Id, const uint32_t* Payload, const uint32_t ByteSize)
+{
+	if (Id == CAPTURE_INVALID_ID)
+	{
+		return;
+	}
+	auto& Data = Contents[Id];
+	if (ByteSize > Data.size())
+	{
+		Fail("upload of " + std::to_string(ByteSize) + " bytes into a " + std::to_string(Data.size()) + " byte buffer");
+		return;
+	}
+	memcpy(Data.data(), Payload, ByteSize);
+}
+
+uint32_t FCpuDevice::GetVertexCount(const uint32_t Slot) const noexcept
+{
+	const auto Buffer = State.VertexBuffers[Slot];
+	const auto Stride = State.VertexStrides[Slot];
+	if (Buffer == CAPTURE_INVALID_ID || Stride == 0)
+	{
+		return 0;
+	}
+	const auto Size = static_cast<uint32_t>(Contents[Buffer].size());
+	return Size > State.VertexOffsets[Slot] ? (Size - State.VertexOffsets[Slot]) / Stride : 0;
+}
+
+void FCpuDevice::ValidateDraw(const uint32_t VertexCount, const uint32_t VertexStart)
+{
+	if (State.VertexShader == CAPTURE_INVALID_ID || State.PixelShader == CAPTURE_INVALID_ID)
+	{
+		Fail("draw without a vertex and pixel shader");
+	}
+	if (State.Topology == 0)
+	{
+		Fail("draw without a primitive topology");
+	}
+	if (State.DepthTarget == CAPTURE_INVALID_ID && std::none_of(std::begin(State.RenderTargets), std::end(State.RenderTargets), [](const uint32_t Id) { return Id != CAPTURE_INVALID_ID; }))
+	{
+		Fail("draw without a render target");
+	}
+
+	for (uint32_t Slot = 0; Slot < MAX_SLOTS; ++Slot)
+	{
+		const auto Texture = State.Textures[Slot];
+		if (Texture == CAPTURE_INVALID_ID)
+		{
+			continue;
+		}
+		if (Texture == State.DepthTarget || std::find(std::begin(State.RenderTargets), std::end(State.RenderTargets), Texture) != std::end(State.RenderTargets))
+		{
+			Fail("texture slot " + std::to_string(Slot) + " is also bound as a render target");
+		}
+	}
+
+	// the vertex count is only known when the shader reads vertex buffers
+	if (State.InputLayout == CAPTURE_INVALID_ID)
+	{
+		return;
+	}
+	const auto& Layout = Capture.GetResources()[State.InputLayout].Data;
+	const auto ElementCount = Layout.size() / sizeof(SCaptureInputElement);
+	uint32_t AvailableVertices = 0xFFFFFFFF;
+	for (size_t Index = 0; Index < ElementCount; ++Index)
+	{
+		SCaptureInputElement Element;
+		memcpy(&Element, Layout.data() + Index * sizeof(Element), sizeof(Element));
+		if (Element.InputSlot >= MAX_SLOTS || State.VertexBuffers[Element.InputSlot] == CAPTURE_INVALID_ID)
+		{
+			Fail(std::string("no vertex buffer for ") + std::string(Element.SemanticName, strnlen(Element.SemanticName, sizeof(Element.SemanticName))));
+			return;
+		}
+		const auto Stride = State.VertexStrides[Element.InputSlot];
+		if (Element.AlignedByteOffset != APPEND_ALIGNED && Element.AlignedByteOffset + GetCaptureFormatSize(Element.Format) > Stride)
+		{
+			Fail("input element outside the vertex stride of slot " + std::to_string(Element.InputSlot));
+		}
+		AvailableVertices = std::min(AvailableVertices, GetVertexCount(Element.InputSlot));
+	}
+
+	if (ElementCount > 0 && static_cast<uint64_t>(VertexStart) + VertexCount > AvailableVertices)
+	{
+		Fail("draw reads vertex " + std::to_string(static_cast<uint64_t>(VertexStart) + VertexCount - 1) + " of " + std::to_string(AvailableVertices));
+	}
+}
+
+void FCpuDevice::ValidateDrawIndexed(const uint32_t IndexCount, const uint32_t IndexStart, const int32_t VertexBase)
+{
+	if (State.IndexBuffer == CAPTURE_INVALID_ID)
+	{
+		Fail("indexed draw without an index buffer");
+		return;
+	}
+	const auto& Indices = Contents[State.IndexBuffer];
+	const uint64_t First = State.IndexOffset / sizeof(uint32_t) + static_cast<uint64_t>(IndexStart);
+	if ((First + IndexCount) * sizeof(uint32_t) > Indices.size())
+	{
+		Fail("indexed draw reads past the index buffer");
+		return;
+	}
+
+	uint32_t MaximumIndex = 0;
+	for (uint64_t Index = First; Index < First + IndexCount; ++Index)
+	{
+		uint32_t Value;
+		memcpy(&Value, Indices.data() + Index * sizeof(uint32_t), sizeof(Value));
+		MaximumIndex = std::max(MaximumIndex, Value);
+	}
+
+	const int64_t LastVertex = static_cast<int64_t>(MaximumIndex) + VertexBase;
+	if (IndexCount > 0 && LastVertex < 0)
+	{
+		Fail("negative base vertex");
+		return;
+	}
+	// an empty draw still checks the bound state
+	ValidateDraw(IndexCount > 0 ? 1 : 0, IndexCount > 0 ? static_cast<uint32_t>(LastVertex) : 0);
+}
+
+void FCpuDevice::ValidateDispatch(const uint32_t GroupCountX, const uint32_t GroupCountY, const uint32_t GroupCountZ)
+{
+	if (State.ComputeShader == CAPTURE_INVALID_ID)
+	{
+		Fail("dispatch without a compute shader");
+	}
+	if (GroupCountX == 0 || GroupCountY == 0 || GroupCountZ == 0)
+	{
+		Fail("empty dispatch");
+	}
+
+	bool bWrites = false;
+	for (uint32_t Slot = 0; Slot < MAX_SLOTS; ++Slot)
+	{
+		const auto Texture = State.ReadWriteTextures[Slot];
+		const auto Buffer = State.ReadWriteBuffers[Slot];
+		bWrites |= Texture != CAPTURE_INVALID_ID || Buffer != CAPTURE_INVALID_ID;
+		if (Texture != CAPTURE_INVALID_ID && std::find(std::begin(State.ComputeTextures), std::end(State.ComputeTextures), Texture) != std::end(State.ComputeTextures))
+		{
+			Fail("read write texture slot " + std::to_string(Slot) + " is also bound for reading");
+		}
+		if (Buffer != CAPTURE_INVALID_ID && std::find(std::begin(State.ComputeBuffers), std::end(State.ComputeBuffers), Buffer) != std::end(State.ComputeBuffers))
+		{
+			Fail("read write buffer slot " + std::to_string(Slot) + " is also bound for reading");
+		}
+	}
+	if (!bWrites)
+	{
+		Fail("dispatch without a read write resource");
+	}
+}
+
+bool FCpuDevice::Expect(const uint32_t Id, const ECaptureResource Type, const char* What)
+{
+	if (Id == CAPTURE_INVALID_ID)
+	{
+		return true;
+	}
+	const auto& Resources = Capture.GetResources();
+	if (Id >= Resources.size() || Resources[Id].Header.Type != Type)
+	{
+		Fail(std::string(What) + " refers to resource " + std::to_string(Id) + " of the wrong type");
+		return false;
+	}
+	return true;
+}
+
+bool FCpuDevice::ExpectSlot(const uint32_t Slot, const uint32_t Count)
+{
+	if (Slot >= Count)
+	{
+		Fail("slot " + std::to_string(Slot) + " out of range");
+		return false;
+	}
+	return true;
+}
+
+void FCpuDevice::Fail(const std::string& Message)
+{
+	if (ErrorCount++ < MAX_MESSAGES)
+	{
+		Messages.push_back("call " + std::to_string(CurrentCall) + " " + GetCaptureCallName(CurrentType) + ": " + Message);
+	}
+}
+
+uint64_t FCpuDevice::GetChecksum() const noexcept
+{
+	uint64_t Hash = 14695981039346656037ull;
+	const auto& Resources = Capture.GetResources();
+	for (size_t Index = 0; Index < Contents.size(); ++Index)
+	{
+		const auto Type = Resources[Index].Header.Type;
+		if (Type != ECaptureResource::BUFFER && Type != ECaptureResource::TEXTURE)
+		{
+			continue;
+		}
+		for (const uint8_t Byte : Contents[Index])
+		{
+			Hash = (Hash ^ Byte) * 1099511628211ull;
+		}
+	}
+	return Hash;
+}
+
+uint32_t FCpuDevice::GetErrorCount() const noexcept
+{
+	return ErrorCount;
+}
+
+const std::vector<std::string>& FCpuDevice::GetMessages() const noexcept
+{
+	return Messages;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CaptureFile.hpp"
+#include "../TestRenderer/RenderStatistics.hpp"
+#include <string>
+#include <vector>
+
+// Stand-in for the D3D11 device that replays a capture on the CPU. It keeps the contents of
+// every buffer and texture, applies uploads and clears to them and tracks the bound pipeline
+// state. Draws and dispatches are not rasterized, they validate the bound state against the
+// resources they read instead: index ranges, vertex counts, input layouts and read/write hazards.
+// Every call is counted like FRenderer counts it, the caller closes the frames.
+class FCpuDevice
+{
+public:
+	explicit FCpuDevice(const FCaptureFile& Capture);
+
+	// restores the captured resource contents and unbinds everything
+	void Reset();
+	void Execute(const uint32_t Index, const SCaptureCall& Call);
+
+	// FNV-1a over the contents of every buffer and texture
+	uint64_t GetChecksum() const noexcept;
+
+	// kept over Reset, the caller ends a frame after each replay
+	FRenderStatistics& GetStatistics() noexcept { return Statistics; }
+
+	uint32_t GetErrorCount() const noexcept;
+	// only the first MAX_MESSAGES errors keep their message
+	const std::vector<std::string>& GetMessages() const noexcept;
+
+	static constexpr uint32_t MAX_MESSAGES = 32;
+
+private:
+	static constexpr uint32_t MAX_SLOTS = 16;
+	static constexpr uint32_t MAX_RENDER_TARGETS = 8;
+	static constexpr uint32_t STAGE_COUNT = 3;
+
+	struct SState
+	{
+		uint32_t VertexShader;
+		uint32_t InputLayout;
+		uint32_t PixelShader;
+		uint32_t ComputeShader;
+		uint32_t Topology;
+
+		uint32_t RenderTargets[MAX_RENDER_TARGETS];
+		uint32_t RenderTargetCount;
+		uint32_t DepthTarget;
+
+		uint32_t ConstantBuffers[STAGE_COUNT][MAX_SLOTS];
+		uint32_t Textures[MAX_SLOTS];
+		uint32_t ComputeTextures[MAX_SLOTS];
+		uint32_t ComputeBuffers[MAX_SLOTS];
+		uint32_t ReadWriteTextures[MAX_SLOTS];
+		uint32_t ReadWriteBuffers[MAX_SLOTS];
+
+		uint32_t VertexBuffers[MAX_SLOTS];
+		uint32_t VertexStrides[MAX_SLOTS];
+		uint32_t VertexOffsets[MAX_SLOTS];
+		uint32_t IndexBuffer;
+		uint32_t IndexOffset;
+
+		float Viewport[6];
+	};
+
+	void Count(const ECaptureCall Call, const uint32_t* Payload) noexcept;
+	void ClearTexture(const uint32_t Id, const float Value[4], const uint32_t Stencil);
+	void UpdateBuffer(const uint32_t Id, const uint32_t* Payload, const uint32_t ByteSize);
+
+	void ValidateDraw(const uint32_t VertexCount, const uint32_t VertexStart);
+	void ValidateDrawIndexed(const uint32_t IndexCount, const uint32_t IndexStart, const int32_t VertexBase);
+	void ValidateDispatch(const uint32_t GroupCountX, const uint32_t GroupCountY, const uint32_t GroupCountZ);
+	uint32_t GetVertexCount(const uint32_t Slot) const noexcept;
+
+	// false and an error when Id is neither invalid nor a resource of Type
+	bool Expect(const uint32_t Id, const ECaptureResource Type, const char* What);
+	bool ExpectSlot(const uint32_t Slot, const uint32_t Count);
+	void Fail(const std::string& Message);
+
+	const FCaptureFile& Capture;
+	std::vector<std::vector<uint8_t>> Contents;
+	SState State{};
+	FRenderStatistics Statistics;
+
+	uint32_t CurrentCall = 0;
+	ECaptureCall CurrentType = ECaptureCall::COUNT;
+	uint32_t ErrorCount = 0;
+	std::vector<std::string> Messages;
+};
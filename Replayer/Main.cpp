@@ -0,0 +1,200 @@
+#include "CaptureFile.hpp"
+#include "CpuDevice.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+
+// Replays a capture written by TestRenderer -capture=<file> without a window or a GPU.
+//
+// Replayer <capture> [-repeat=<n>] [-csv=<file>] [-top=<n>] [-renderstats=<file>]
+//
+// -renderstats writes the render counters of the replayed frames as json, in the format
+// TestRenderer -renderstats=<file> writes.
+// Every repetition starts from the captured resource contents, so the checksum printed at the
+// end has to match between repetitions and between machines for the same capture.
+// Returns 0 on success, 1 when the capture cannot be read or the replay is not deterministic
+// and 2 when the call stream failed validation.
+
+namespace
+{
+	struct SCallTiming
+	{
+		uint64_t Count = 0;
+		double Total = 0.0;
+		double Maximum = 0.0;
+	};
+
+	void PrintUsage()
+	{
+		printf("usage: Replayer <capture> [-repeat=<n>] [-csv=<file>] [-top=<n>] [-renderstats=<file>]\n");
+	}
+}
+
+int main(int ArgumentCount, char** Arguments)
+{
+	const char* FileName = nullptr;
+	const char* CsvFileName = nullptr;
+	const char* StatisticsFileName = nullptr;
+	uint32_t RepeatCount = 1;
+	uint32_t TopCount = 10;
+	for (int Index = 1; Index < ArgumentCount; ++Index)
+	{
+		const char* Argument = Arguments[Index];
+		if (strncmp(Argument, "-repeat=", 8) == 0)
+		{
+			RepeatCount = std::max(1u, static_cast<uint32_t>(strtoul(Argument + 8, nullptr, 10)));
+		}
+		else if (strncmp(Argument, "-csv=", 5) == 0)
+		{
+			CsvFileName = Argument + 5;
+		}
+		else if (strncmp(Argument, "-renderstats=", 13) == 0)
+		{
+			StatisticsFileName = Argument + 13;
+		}
+		else if (strncmp(Argument, "-top=", 5) == 0)
+		{
+			TopCount = static_cast<uint32_t>(strtoul(Argument + 5, nullptr, 10));
+		}
+		else if (Argument[0] != '-' && FileName == nullptr)
+		{
+			FileName = Argument;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+	if (FileName == nullptr)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	FCaptureFile Capture;
+	std::string Error;
+	if (!Capture.Load(FileName, Error))
+	{
+		fprintf(stderr, "%s: %s\n", FileName, Error.c_str());
+		return 1;
+	}
+	const auto& Calls = Capture.GetCalls();
+	printf("%s: %zu resources, %zu calls, %.2f MiB\n", FileName, Capture.GetResources().size(), Calls.size(), Capture.GetFileSize() / (1024.0 * 1024.0));
+
+	FCpuDevice Device(Capture);
+	std::vector<double> CallTimes(Calls.size(), 0.0);
+	SCallTiming Timings[static_cast<size_t>(ECaptureCall::COUNT)];
+	uint64_t FirstChecksum = 0;
+	double ReplayTime = 0.0;
+	bool bDeterministic = true;
+
+	using FClock = std::chrono::steady_clock;
+	for (uint32_t Repeat = 0; Repeat < RepeatCount; ++Repeat)
+	{
+		Device.Reset();
+		const auto ReplayStart = FClock::now();
+		for (uint32_t Index = 0; Index < Calls.size(); ++Index)
+		{
+			const auto Start = FClock::now();
+			Device.Execute(Index, Calls[Index]);
+			const double Microseconds = std::chrono::duration<double, std::micro>(FClock::now() - Start).count();
+
+			CallTimes[Index] += Microseconds;
+			auto& Timing = Timings[static_cast<size_t>(Calls[Index].Call)];
+			++Timing.Count;
+			Timing.Total += Microseconds;
+			Timing.Maximum = std::max(Timing.Maximum, Microseconds);
+		}
+		ReplayTime += std::chrono::duration<double, std::milli>(FClock::now() - ReplayStart).count();
+		Device.GetStatistics().EndFrame();
+
+		const auto Checksum = Device.GetChecksum();
+		if (Repeat == 0)
+		{
+			FirstChecksum = Checksum;
+		}
+		else if (Checksum != FirstChecksum)
+		{
+			bDeterministic = false;
+			fprintf(stderr, "repetition %u ended with checksum %016" PRIx64 ", the first with %016" PRIx64 "\n", Repeat, Checksum, FirstChecksum);
+		}
+	}
+
+	printf("\n%-24s %10s %12s %10s %10s\n", "call", "count", "total ms", "avg us", "max us");
+	for (size_t Call = 0; Call < static_cast<size_t>(ECaptureCall::COUNT); ++Call)
+	{
+		const auto& Timing = Timings[Call];
+		if (Timing.Count == 0)
+		{
+			continue;
+		}
+		printf("%-24s %10" PRIu64 " %12.3f %10.3f %10.3f\n", GetCaptureCallName(static_cast<ECaptureCall>(Call)),
+			Timing.Count / RepeatCount, Timing.Total / 1000.0, Timing.Total / Timing.Count, Timing.Maximum);
+	}
+
+	// every replay is the same frame, the last one stands for all
+	const auto& Statistics = Device.GetStatistics();
+	printf("\n%-24s %10s\n", "counter", "per frame");
+	for (size_t Counter = 0; Counter < FRenderStatistics::COUNTER_COUNT; ++Counter)
+	{
+		printf("%-24s %10" PRIu64 "\n", GetRenderCounterName(static_cast<ERenderCounter>(Counter)), Statistics.GetLastFrame()[static_cast<ERenderCounter>(Counter)]);
+	}
+	if (StatisticsFileName && !Statistics.WriteJson(StatisticsFileName))
+	{
+		fprintf(stderr, "cannot write %s\n", StatisticsFileName);
+		return 1;
+	}
+
+	std::vector<uint32_t> Slowest(Calls.size());
+	std::iota(Slowest.begin(), Slowest.end(), 0u);
+	const auto ShownCount = std::min<size_t>(TopCount, Slowest.size());
+	std::partial_sort(Slowest.begin(), Slowest.begin() + ShownCount, Slowest.end(), [&](const uint32_t Lhs, const uint32_t Rhs) { return CallTimes[Lhs] > CallTimes[Rhs]; });
+	if (ShownCount > 0)
+	{
+		printf("\nslowest calls\n");
+	}
+	for (size_t Index = 0; Index < ShownCount; ++Index)
+	{
+		const auto Call = Slowest[Index];
+		printf("  #%-8u %-24s %10.3f us\n", Call, GetCaptureCallName(Calls[Call].Call), CallTimes[Call] / RepeatCount);
+	}
+
+	if (CsvFileName)
+	{
+		FILE* Csv = fopen(CsvFileName, "w");
+		if (Csv == nullptr)
+		{
+			fprintf(stderr, "cannot write %s\n", CsvFileName);
+			return 1;
+		}
+		fprintf(Csv, "Index,Call,PayloadBytes,AverageMicroseconds\n");
+		for (uint32_t Index = 0; Index < Calls.size(); ++Index)
+		{
+			fprintf(Csv, "%u,%s,%u,%.3f\n", Index, GetCaptureCallName(Calls[Index].Call), Calls[Index].PayloadSize, CallTimes[Index] / RepeatCount);
+		}
+		fclose(Csv);
+	}
+
+	printf("\nreplayed %u time(s), %.3f ms per replay, checksum %016" PRIx64 "\n", RepeatCount, ReplayTime / RepeatCount, FirstChecksum);
+	// errors are the same on every repetition, the device reports the last one
+	const auto ErrorCount = Device.GetErrorCount();
+	for (const auto& Message : Device.GetMessages())
+	{
+		printf("error: %s\n", Message.c_str());
+	}
+	if (ErrorCount > FCpuDevice::MAX_MESSAGES)
+	{
+		printf("... %u more errors\n", ErrorCount - FCpuDevice::MAX_MESSAGES);
+	}
+
+	if (!bDeterministic)
+	{
+		return 1;
+	}
+	return ErrorCount > 0 ? 2 : 0;
+}
@@ -0,0 +1,267 @@
+#include "Allocators.hpp"
+#include "MemoryTracker.hpp"
+
+#include "imgui/imgui.h"
+#include <algorithm>
+#include <mutex>
+
+namespace
+{
+	struct SAllocatorRegistry
+	{
+		std::mutex Mutex;
+		std::vector<const SAllocatorStatistics*> Allocators;
+	};
+
+	// never destroyed, allocators owned by globals unregister during static destruction
+	SAllocatorRegistry& GetRegistry()
+	{
+		static auto* Registry = new SAllocatorRegistry();
+		return *Registry;
+	}
+
+	void Register(const SAllocatorStatistics* Statistics)
+	{
+		auto& Registry = GetRegistry();
+		std::lock_guard<std::mutex> Lock(Registry.Mutex);
+		Registry.Allocators.push_back(Statistics);
+	}
+
+	void Unregister(const SAllocatorStatistics* Statistics)
+	{
+		auto& Registry = GetRegistry();
+		std::lock_guard<std::mutex> Lock(Registry.Mutex);
+		Registry.Allocators.erase(std::remove(Registry.Allocators.begin(), Registry.Allocators.end(), Statistics), Registry.Allocators.end());
+	}
+
+	size_t AlignUp(const size_t Value, const size_t Alignment) noexcept
+	{
+		return (Value + Alignment - 1) & ~(Alignment - 1);
+	}
+}
+
+FArenaAllocator::FArenaAllocator(const char* Name, const size_t BlockSize) noexcept : BlockSize(BlockSize)
+{
+	Statistics.Name = Name;
+	Register(&Statistics);
+}
+
+FArenaAllocator::~FArenaAllocator()
+{
+	Trim();
+	Unregister(&Statistics);
+}
+
+void* FArenaAllocator::Allocate(const size_t Size, const size_t Alignment) noexcept
+{
+	while (true)
+	{
+		if (CurrentBlock < Blocks.size())
+		{
+			const auto& Block = Blocks[CurrentBlock];
+			const auto Address = reinterpret_cast<uintptr_t>(Block.Memory) + Offset;
+			const auto Padding = AlignUp(Address, Alignment) - Address;
+			if (Offset + Padding + Size <= Block.Size)
+			{
+				void* Memory = Block.Memory + Offset + Padding;
+				Offset += Padding + Size;
+				++Statistics.Allocations;
+				Statistics.BytesAllocated += Size;
+				Statistics.CurrentBytes += Padding + Size;
+				Statistics.PeakBytes = std::max(Statistics.PeakBytes, Statistics.CurrentBytes);
+				return Memory;
+			}
+
+			// blocks left over from a rewind are reused before new ones are allocated
+			if (CurrentBlock + 1 < Blocks.size())
+			{
+				Statistics.CurrentBytes += Block.Size - Offset;
+				++CurrentBlock;
+				Offset = 0;
+				continue;
+			}
+		}
+
+		if (!AddBlock(Size + Alignment))
+		{
+			return nullptr;
+		}
+	}
+}
+
+FArenaAllocator::SMarker FArenaAllocator::GetMarker() const noexcept
+{
+	return { CurrentBlock, Offset, Statistics.CurrentBytes };
+}
+
+void FArenaAllocator::RewindTo(const SMarker& Marker) noexcept
+{
+	CurrentBlock = Marker.Block;
+	Offset = Marker.Offset;
+	Statistics.CurrentBytes = Marker.CurrentBytes;
+}
+
+void FArenaAllocator::Reset() noexcept
+{
+	++Statistics.Resets;
+	if (Blocks.size() > 1)
+	{
+		size_t TotalSize = 0;
+		for (const auto& Block : Blocks)
+		{
+			TotalSize += Block.Size;
+			TrackedFree(Block.Memory);
+		}
+		Blocks.clear();
+		Statistics.ReservedBytes = 0;
+		AddBlock(TotalSize);
+	}
+	CurrentBlock = 0;
+	Offset = 0;
+	Statistics.CurrentBytes = 0;
+}
+
+void FArenaAllocator::Trim() noexcept
+{
+	for (const auto& Block : Blocks)
+	{
+		TrackedFree(Block.Memory);
+	}
+	Blocks.clear();
+	CurrentBlock = 0;
+	Offset = 0;
+	Statistics.CurrentBytes = 0;
+	Statistics.ReservedBytes = 0;
+}
+
+const SAllocatorStatistics& FArenaAllocator::GetStatistics() const noexcept
+{
+	return Statistics;
+}
+
+bool FArenaAllocator::AddBlock(const size_t MinimumSize) noexcept
+{
+	const auto Size = std::max(BlockSize, MinimumSize);
+	auto Memory = static_cast<uint8_t*>(TrackedAllocate(Size, GetCurrentMemoryTag()));
+	if (Memory == nullptr)
+	{
+		return false;
+	}
+
+	if (!Blocks.empty())
+	{
+		Statistics.CurrentBytes += Blocks[CurrentBlock].Size - Offset;
+	}
+	Blocks.push_back({ Memory, Size });
+	CurrentBlock = Blocks.size() - 1;
+	Offset = 0;
+	++Statistics.BlockAllocations;
+	Statistics.ReservedBytes += Size;
+	return true;
+}
+
+FPoolAllocator::FPoolAllocator(const char* Name, const size_t SlotSize, const size_t SlotsPerBlock) noexcept
+	: SlotSize(AlignUp(std::max(SlotSize, sizeof(SFreeSlot)), alignof(std::max_align_t)))
+	, SlotsPerBlock(SlotsPerBlock)
+{
+	Statistics.Name = Name;
+	Register(&Statistics);
+}
+
+FPoolAllocator::~FPoolAllocator()
+{
+	for (auto Block : Blocks)
+	{
+		TrackedFree(Block);
+	}
+	Unregister(&Statistics);
+}
+
+void* FPoolAllocator::Allocate() noexcept
+{
+	if (FreeList == nullptr)
+	{
+		auto Block = static_cast<uint8_t*>(TrackedAllocate(SlotSize * SlotsPerBlock, GetCurrentMemoryTag()));
+		if (Block == nullptr)
+		{
+			return nullptr;
+		}
+		Blocks.push_back(Block);
+		++Statistics.BlockAllocations;
+		Statistics.ReservedBytes += SlotSize * SlotsPerBlock;
+
+		for (size_t Slot = SlotsPerBlock; Slot > 0; --Slot)
+		{
+			auto FreeSlot = reinterpret_cast<SFreeSlot*>(Block + (Slot - 1) * SlotSize);
+			FreeSlot->Next = FreeList;
+			FreeList = FreeSlot;
+		}
+	}
+
+	auto Slot = FreeList;
+	FreeList = Slot->Next;
+	++Statistics.Allocations;
+	Statistics.BytesAllocated += SlotSize;
+	Statistics.CurrentBytes += SlotSize;
+	Statistics.PeakBytes = std::max(Statistics.PeakBytes, Statistics.CurrentBytes);
+	return Slot;
+}
+
+void FPoolAllocator::Free(void* Memory) noexcept
+{
+	if (Memory == nullptr)
+	{
+		return;
+	}
+	auto Slot = static_cast<SFreeSlot*>(Memory);
+	Slot->Next = FreeList;
+	FreeList = Slot;
+	Statistics.CurrentBytes -= SlotSize;
+}
+
+size_t FPoolAllocator::GetSlotSize() const noexcept
+{
+	return SlotSize;
+}
+
+const SAllocatorStatistics& FPoolAllocator::GetStatistics() const noexcept
+{
+	return Statistics;
+}
+
+void OnAllocatorGui() noexcept
+{
+	auto& Registry = GetRegistry();
+	std::lock_guard<std::mutex> Lock(Registry.Mutex);
+
+	ImGui::Columns(6, "Allocators");
+	ImGui::Text("Name");
+	ImGui::NextColumn();
+	ImGui::Text("Allocations");
+	ImGui::NextColumn();
+	ImGui::Text("Current KB");
+	ImGui::NextColumn();
+	ImGui::Text("Peak KB");
+	ImGui::NextColumn();
+	ImGui::Text("Reserved KB");
+	ImGui::NextColumn();
+	ImGui::Text("Blocks");
+	ImGui::NextColumn();
+	ImGui::Separator();
+	for (const auto Statistics : Registry.Allocators)
+	{
+		ImGui::Text("%s", Statistics->Name);
+		ImGui::NextColumn();
+		ImGui::Text("%llu", static_cast<unsigned long long>(Statistics->Allocations));
+		ImGui::NextColumn();
+		ImGui::Text("%.1f", Statistics->CurrentBytes / 1024.0);
+		ImGui::NextColumn();
+		ImGui::Text("%.1f", Statistics->PeakBytes / 1024.0);
+		ImGui::NextColumn();
+		ImGui::Text("%.1f", Statistics->ReservedBytes / 1024.0);
+		ImGui::NextColumn();
+		ImGui::Text("%llu", static_cast<unsigned long long>(Statistics->BlockAllocations));
+		ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+struct SAllocatorStatistics
+{
+	const char* Name = nullptr;
+	uint64_t Allocations = 0;
+	uint64_t BytesAllocated = 0;
+	uint64_t CurrentBytes = 0;
+	uint64_t PeakBytes = 0;
+	uint64_t ReservedBytes = 0;
+	uint64_t BlockAllocations = 0;
+	uint64_t Resets = 0;
+};
+
+// Bump allocator over a chain of blocks, individual allocations are never freed. Reset keeps
+// the memory, and if the last use spilled into extra blocks they are merged into one, so an
+// arena that is reset every frame stops touching the heap once it has seen its peak.
+class FArenaAllocator
+{
+public:
+	struct SMarker
+	{
+		size_t Block = 0;
+		size_t Offset = 0;
+		uint64_t CurrentBytes = 0;
+	};
+
+	explicit FArenaAllocator(const char* Name, const size_t BlockSize) noexcept;
+	~FArenaAllocator();
+
+	FArenaAllocator(const FArenaAllocator&) = delete;
+	FArenaAllocator& operator=(const FArenaAllocator&) = delete;
+
+	void* Allocate(const size_t Size, const size_t Alignment = alignof(std::max_align_t)) noexcept;
+
+	template <typename TType>
+	TType* AllocateArray(const size_t Count) noexcept
+	{
+		return static_cast<TType*>(Allocate(sizeof(TType) * Count, alignof(TType)));
+	}
+
+	SMarker GetMarker() const noexcept;
+	void RewindTo(const SMarker& Marker) noexcept;
+	void Reset() noexcept;
+	// frees every block, for arenas that are only used in bursts like model import
+	void Trim() noexcept;
+
+	const SAllocatorStatistics& GetStatistics() const noexcept;
+
+private:
+	struct SBlock
+	{
+		uint8_t* Memory;
+		size_t Size;
+	};
+
+	bool AddBlock(const size_t MinimumSize) noexcept;
+
+	std::vector<SBlock> Blocks;
+	size_t BlockSize;
+	size_t CurrentBlock = 0;
+	size_t Offset = 0;
+	SAllocatorStatistics Statistics{};
+};
+
+// Rewinds the arena to where it was on construction
+class FArenaScope
+{
+public:
+	explicit FArenaScope(FArenaAllocator& Arena) noexcept : InternalArena(Arena), Marker(Arena.GetMarker())
+	{
+	}
+
+	~FArenaScope()
+	{
+		InternalArena.RewindTo(Marker);
+	}
+
+	FArenaScope(const FArenaScope&) = delete;
+	FArenaScope& operator=(const FArenaScope&) = delete;
+
+private:
+	FArenaAllocator& InternalArena;
+	FArenaAllocator::SMarker Marker;
+};
+
+// Fixed size slots with an intrusive free list, blocks are kept until the pool is destroyed
+class FPoolAllocator
+{
+public:
+	explicit FPoolAllocator(const char* Name, const size_t SlotSize, const size_t SlotsPerBlock) noexcept;
+	~FPoolAllocator();
+
+	FPoolAllocator(const FPoolAllocator&) = delete;
+	FPoolAllocator& operator=(const FPoolAllocator&) = delete;
+
+	void* Allocate() noexcept;
+	void Free(void* Memory) noexcept;
+
+	size_t GetSlotSize() const noexcept;
+	const SAllocatorStatistics& GetStatistics() const noexcept;
+
+private:
+	struct SFreeSlot
+	{
+		SFreeSlot* Next;
+	};
+
+	std::vector<uint8_t*> Blocks;
+	SFreeSlot* FreeList = nullptr;
+	size_t SlotSize;
+	size_t SlotsPerBlock;
+	SAllocatorStatistics Statistics{};
+};
+
+// STL allocator on top of an arena, deallocate is a no-op until the arena rewinds
+template <typename TType>
+class TArenaAdaptor
+{
+public:
+	using value_type = TType;
+
+	explicit TArenaAdaptor(FArenaAllocator& Arena) noexcept : Arena(&Arena)
+	{
+	}
+
+	template <typename TOther>
+	TArenaAdaptor(const TArenaAdaptor<TOther>& Other) noexcept : Arena(Other.Arena)
+	{
+	}
+
+	TType* allocate(const size_t Count)
+	{
+		auto Memory = Arena->AllocateArray<TType>(Count);
+		if (Memory == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		return Memory;
+	}
+
+	void deallocate(TType*, size_t) noexcept
+	{
+	}
+
+	template <typename TOther>
+	bool operator==(const TArenaAdaptor<TOther>& Other) const noexcept
+	{
+		return Arena == Other.Arena;
+	}
+
+	template <typename TOther>
+	bool operator!=(const TArenaAdaptor<TOther>& Other) const noexcept
+	{
+		return Arena != Other.Arena;
+	}
+
+	FArenaAllocator* Arena;
+};
+
+template <typename TType>
+using TArenaVector = std::vector<TType, TArenaAdaptor<TType>>;
+
+// Lists every live arena and pool
+void OnAllocatorGui() noexcept;
@@ -9,40 +9,166 @@
 #include <DirectXMath.h>
 #include <chrono>
 
-EErrorCode FApplication::Setup(const HWND HWnd, const uint32_t Width, const uint32_t Height)
+EErrorCode FApplication::Setup(FPlatform& Platform)
 {
+	const auto Width = Platform.GetWidth();
+	const auto Height = Platform.GetHeight();
+	const auto HWnd = static_cast<HWND>(Platform.GetNativeWindow());
+	bHasWindow = HWnd != nullptr;
+
 	IMGUI_CHECKVERSION();
+	ImGui::SetAllocatorFunctions(ImGuiAllocate, ImGuiFree);
 	ImGui::CreateContext();
 	ImGuiIO& Io = ImGui::GetIO();
-	Io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
-	Io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
-	Io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
-	if (Io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+	if (bHasWindow)
+	{
+		Io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+		Io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+		Io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
+		if (Io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+		{
+			ImGuiStyle& Style = ImGui::GetStyle();
+			Style.WindowRounding = 0.0f;
+			Style.Colors[ImGuiCol_WindowBg].w = 1.0f;
+		}
+		ImGui::StyleColorsDark();
+		ImGui_ImplWin32_Init(HWnd);
+	}
+	else
 	{
-		ImGuiStyle& Style = ImGui::GetStyle();
-		Style.WindowRounding = 0.0f;
-		Style.Colors[ImGuiCol_WindowBg].w = 1.0f;
+		// the context only answers input queries, which all come back empty
+		Io.IniFilename = nullptr;
+		Io.DisplaySize = ImVec2(static_cast<float>(Width), static_cast<float>(Height));
 	}
-	ImGui::StyleColorsDark();
-	ImGui_ImplWin32_Init(HWnd);
-	
-	auto Result = Renderer.CreateDeviceAndSwapchainForHwnd(HWnd, Width, Height, BackBuffer);
 
-	Model.Initialize("Mesh/radio/Auna_Radio.obj", Width, Height);
+	// this thread becomes worker 0, model import and draw recording share the workers
+	JobSystem.Initialize();
+	
+	auto Result = bHasWindow ? Renderer.CreateDeviceAndSwapchainForHwnd(HWnd, Width, Height, BackBuffer) : Renderer.CreateOffscreenDevice(Width, Height, bSoftwareRendering, BackBuffer);
+	if (Result != EErrorCode::OK)
+	{
+		return Result;
+	}
 
-	Result = Blur.Initialize(Width, Height);
+	// a scene that fails to load leaves the rest usable, it is reported once everything else is set up
+	auto SceneResult = EErrorCode::OK;
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::MODEL);
+		SceneResult = Model.Initialize(SceneFileName, Width, Height);
+	}
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::BLUR);
+		Result = Blur.Initialize(Width, Height);
+	}
 
 	Renderer.CreateRenderTarget(Width, Height, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, SceneRenderTarget);
 	Renderer.CreateDepthStencil(Width, Height, DXGI_FORMAT_D24_UNORM_S8_UINT, SceneRenderTarget);
 
-	MainCamera.Initialize(Width, Height);
-	
-	Result = Renderer.InitializeImGui();
-	Light.Initialize(Width, Height);
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::CAMERA);
+		MainCamera.Initialize(Width, Height);
+	}
+	if (bHasWindow)
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::IMGUI);
+		Result = Renderer.InitializeImGui();
+	}
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::LIGHT);
+		Light.Initialize(Width, Height);
+	}
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::TEXGEN);
+		TexGen.Initialize(Width, Height);
+	}
 
-	TexGen.Initialize(Width, Height);
+	// the first state is simulated here so there is one to render before the update thread delivers
+	PublishFrameInput(0.0f);
+	RunSimulationStep();
+	if (bThreadedUpdate)
+	{
+		StartUpdateThread();
+	}
 	
-	return EErrorCode::OK;
+	return SceneResult;
+}
+
+void FApplication::RunFrame(const float DeltaTime) noexcept
+{
+	BeginFrame();
+
+	if (bHasWindow)
+	{
+		ImGui_ImplDX11_NewFrame();
+		ImGui_ImplWin32_NewFrame();
+		ImGui::NewFrame();
+
+		auto WindowFlags = ImGuiWindowFlags_MenuBar | ImGuiWindowFlags_NoDocking;
+
+		const auto Viewport = ImGui::GetMainViewport();
+		ImGui::SetNextWindowPos(Viewport->Pos);
+		ImGui::SetNextWindowSize(Viewport->Size);
+		ImGui::SetNextWindowViewport(Viewport->ID);
+		ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0.0f);
+		ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
+		WindowFlags |= ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoCollapse;
+		WindowFlags |= ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove;
+		WindowFlags |= ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoNavFocus;
+
+		bool Open = true;
+		ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+		ImGui::Begin("DockSpace", &Open, WindowFlags);
+		ImGui::PopStyleVar();
+		ImGui::PopStyleVar(2);
+
+		if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_DockingEnable)
+		{
+			const auto DockspaceId = ImGui::GetID("MyDockSpace");
+			ImGui::DockSpace(DockspaceId, ImVec2(0.0f, 0.0f), ImGuiDockNodeFlags_None);
+		}
+		ImGui::End();
+
+		OnGui();
+	}
+
+	OnUpdate(DeltaTime);
+	OnRender();
+
+	if (bHasWindow)
+	{
+		ImGui::Render();
+		ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+		if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+		{
+			ImGui::UpdatePlatformWindows();
+			ImGui::RenderPlatformWindowsDefault();
+		}
+	}
+
+	Present();
+}
+
+void FApplication::BeginFrame() noexcept
+{
+	FrameAllocator.Reset();
+	// the last frame's draw data was submitted, nothing samples the targets TexGen let go of anymore
+	TexGen.ReleasePendingTargets();
+
+	// after warmup every heap allocation in a frame is unexpected, ImGui's included
+	const auto HeapAllocationCount = GetHeapAllocationCount();
+	FrameHeapAllocations = HeapAllocationCount - LastHeapAllocationCount;
+	LastHeapAllocationCount = HeapAllocationCount;
+	if (++FrameIndex > WARMUP_FRAME_COUNT && FrameHeapAllocations > 0)
+	{
+		++FramesWithHeapAllocations;
+	}
+
+	if (CaptureFileName && FrameIndex == CaptureFrame)
+	{
+		Renderer.RequestCapture(CaptureFileName);
+	}
+
+	FMemoryTracker::Get().OnFrame(GetHighResolutionTime());
 }
 
 void FApplication::OnRender() noexcept
@@ -51,10 +177,29 @@ void FApplication::OnRender() noexcept
 	Renderer.ClearRenderTarget(SceneRenderTarget, DirectX::XMFLOAT4(0.0f, 0.2f, 0.4f, 1.0f));
 	Renderer.ClearDepthStencil(SceneRenderTarget, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 	Renderer.SetViewport(SceneRenderTarget.Width, SceneRenderTarget.Height);
-	Light.OnRender();
-	Model.OnRender(nullptr, 0);
+	auto& Statistics = Renderer.GetStatistics();
 
-	Blur.OnRender(&SceneRenderTarget, 1);
+	// without a new state the previous one is rendered again, it stays valid until the next Update
+	FrameStates.Update();
+	const auto& State = FrameStates.GetReadBuffer();
+	RepeatedStates += State.Frame == RenderedFrame;
+	RenderedFrame = State.Frame;
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::LIGHT);
+		FRenderPassScope Pass(Statistics, "Light");
+		Light.OnRender(State.Light);
+	}
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::MODEL);
+		FRenderPassScope Pass(Statistics, "Model");
+		MainCamera.OnRender(State.Camera);
+		Model.OnRender(State.Model, nullptr, 0);
+	}
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::BLUR);
+		FRenderPassScope Pass(Statistics, "Blur");
+		Blur.OnRender(State.Blur, &SceneRenderTarget, 1);
+	}
 
 	Renderer.SetRenderTarget(BackBuffer);
 	Renderer.ClearRenderTarget(BackBuffer, DirectX::XMFLOAT4(0.0f, 0.2f, 0.4f, 1.0f));
@@ -62,21 +207,136 @@ void FApplication::OnRender() noexcept
 
 void FApplication::OnUpdate(const float Time) noexcept
 {
-	MainCamera.OnUpdate(Time);
-	Model.OnUpdate(Time);
-	Light.OnUpdate(Time);
-	TexGen.OnUpdate(Time);
+	PublishFrameInput(Time);
+	if (UpdateThread.IsRunning())
+	{
+		UpdateThread.Notify();
+	}
+	else
+	{
+		RunSimulationStep();
+	}
+
+	// TexGen renders on the immediate context so it stays on this thread
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::TEXGEN);
+		FRenderPassScope Pass(Renderer.GetStatistics(), "TexGen");
+		TexGen.OnUpdate(Time);
+	}
 	if (TexGen.IsOutputUpdated())
 	{
+		FMemoryTagScope MemoryTag(EMemoryTag::BLUR);
 		Blur.SetMask(TexGen.GetOutput());
 	}
 }
 
+void FApplication::PublishFrameInput(const float Time) noexcept
+{
+	auto& Input = FrameInputs.GetWriteBuffer();
+	Input.Frame = FrameIndex;
+	Input.DeltaTime = Time;
+	Input.Camera = MainCamera.GatherInput(Time);
+	if (bCameraPoseOverride)
+	{
+		Input.Camera.bOverridePose = true;
+		Input.Camera.PosePosition = CameraPosePosition;
+		Input.Camera.PoseYaw = CameraPoseYaw;
+		Input.Camera.PosePitch = CameraPosePitch;
+	}
+	Input.ModelRotation = Model.GetRotation();
+	Input.Light = Light.GetConstants();
+	Input.Blur = Blur.GetParams();
+	FrameInputs.Publish();
+}
+
+void FApplication::RunSimulationStep() noexcept
+{
+	if (!FrameInputs.Update())
+	{
+		return;
+	}
+	const auto Start = GetHighResolutionTime();
+	const auto& Input = FrameInputs.GetReadBuffer();
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::CAMERA);
+		MainCamera.OnUpdate(Input.Camera);
+	}
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::MODEL);
+		Model.OnUpdate(Input.DeltaTime, Input.ModelRotation);
+	}
+
+	auto& State = FrameStates.GetWriteBuffer();
+	State.Frame = Input.Frame;
+	MainCamera.WriteState(State.Camera);
+	Model.WriteState(State.Model);
+	State.Light = Input.Light;
+	State.Blur = Input.Blur;
+	FrameStates.Publish();
+
+	SimulationMilliseconds.store(static_cast<float>((GetHighResolutionTime() - Start) * 1000.0), std::memory_order_relaxed);
+	SimulatedFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FApplication::StartUpdateThread()
+{
+	UpdateThread.Start([this]()
+	{
+		RunSimulationStep();
+	});
+}
+
 void FApplication::OnGui() noexcept
 {
-	Blur.OnGui();
-	Model.OnGui();
-	Light.OnGui();
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::BLUR);
+		Blur.OnGui();
+	}
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::MODEL);
+		Model.OnGui();
+	}
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::LIGHT);
+		Light.OnGui();
+	}
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::MATERIAL);
+		TextureCache.OnGui();
+	}
+	Renderer.GetStatistics().OnGui();
+
+	ImGui::Begin("Memory");
+	{
+		ImGui::Text("Heap allocations last frame: %llu", static_cast<unsigned long long>(FrameHeapAllocations));
+		ImGui::Text("Frames with heap allocations after warmup: %llu", static_cast<unsigned long long>(FramesWithHeapAllocations));
+		if (ImGui::Button("Reset"))
+		{
+			FramesWithHeapAllocations = 0;
+		}
+		ImGui::Separator();
+		FMemoryTracker::Get().OnGui();
+		ImGui::Separator();
+		OnAllocatorGui();
+	}
+	ImGui::End();
+
+	OnJobsGui();
+	OnFramePipelineGui();
+
+	ImGui::Begin("Frame Capture");
+	{
+		ImGui::InputText("File", CaptureGuiFileName, sizeof(CaptureGuiFileName));
+		if (Renderer.IsCaptureRequested())
+		{
+			ImGui::Text("Capturing...");
+		}
+		else if (ImGui::Button("Capture Next Frame"))
+		{
+			Renderer.RequestCapture(CaptureGuiFileName);
+		}
+	}
+	ImGui::End();
 
 	ImGui::Begin("Render Window");
 	{
@@ -113,17 +373,161 @@ void FApplication::OnGui() noexcept
 	}
 	ImGui::End();
 
-	TexGen.OnGui();
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::TEXGEN);
+		TexGen.OnGui();
+	}
 }
 
 void FApplication::TearDown() noexcept
 {
-	ImGui_ImplDX11_Shutdown();
-	ImGui_ImplWin32_Shutdown();
+	UpdateThread.Stop();
+
+	if (bHasWindow)
+	{
+		ImGui_ImplDX11_Shutdown();
+		ImGui_ImplWin32_Shutdown();
+	}
 	ImGui::DestroyContext();
 
 	Renderer.DestroyRenderTarget(BackBuffer);
 	Renderer.DestroyRenderTarget(SceneRenderTarget);
+
+	FMemoryTracker::Get().Flush(GetHighResolutionTime());
+	if (RenderStatisticsFileName != nullptr)
+	{
+		Renderer.GetStatistics().WriteJson(RenderStatisticsFileName);
+	}
+
+	JobSystem.Shutdown();
+}
+
+void FApplication::OnJobsGui() noexcept
+{
+	ImGui::Begin("Jobs");
+	{
+		ImGui::Text("Threads: %zu", JobSystem.GetThreadCount());
+		ImGui::Columns(3);
+		ImGui::Text("Worker"); ImGui::NextColumn();
+		ImGui::Text("Executed"); ImGui::NextColumn();
+		ImGui::Text("Stolen"); ImGui::NextColumn();
+		ImGui::Separator();
+		for (size_t Worker = 0; Worker < JobSystem.GetThreadCount(); ++Worker)
+		{
+			const auto Statistics = JobSystem.GetWorkerStatistics(Worker);
+			ImGui::Text("%zu", Worker); ImGui::NextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(Statistics.Executed)); ImGui::NextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(Statistics.Stolen)); ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+		ImGui::Separator();
+
+		if (ImGui::Button("Run Benchmark"))
+		{
+			JobBenchmark = FJobSystem::RunBenchmark(JobSystem.GetThreadCount(), 100000);
+		}
+		if (!JobBenchmark.ForkJoinMilliseconds.empty())
+		{
+			ImGui::Text("Spawn: %.1f ns per job", JobBenchmark.SpawnNanoseconds);
+			ImGui::Text("Steal: %.1f ns per job", JobBenchmark.StealNanoseconds);
+			float Speedups[64]{};
+			const auto Count = std::min<size_t>(JobBenchmark.ForkJoinMilliseconds.size(), 64);
+			for (size_t Threads = 0; Threads < Count; ++Threads)
+			{
+				Speedups[Threads] = static_cast<float>(JobBenchmark.ForkJoinMilliseconds[0] / JobBenchmark.ForkJoinMilliseconds[Threads]);
+				ImGui::Text("%zu threads: %.2f ms, %.2fx", Threads + 1, JobBenchmark.ForkJoinMilliseconds[Threads], Speedups[Threads]);
+			}
+			ImGui::PlotLines("Fork/join speedup", Speedups, static_cast<int>(Count), 0, nullptr, 0.0f, static_cast<float>(Count), ImVec2(0, 80));
+		}
+	}
+	ImGui::End();
+}
+
+void FApplication::OnFramePipelineGui() noexcept
+{
+	ImGui::Begin("Frame Pipeline");
+	{
+		if (ImGui::Checkbox("Update Thread", &bThreadedUpdate))
+		{
+			if (bThreadedUpdate)
+			{
+				StartUpdateThread();
+			}
+			else
+			{
+				UpdateThread.Stop();
+			}
+		}
+		ImGui::Text("Simulated frames: %llu", static_cast<unsigned long long>(SimulatedFrames.load(std::memory_order_relaxed)));
+		ImGui::Text("Simulation step: %.3f ms", SimulationMilliseconds.load(std::memory_order_relaxed));
+		ImGui::Text("Rendering state of frame %llu, %llu frames behind", static_cast<unsigned long long>(RenderedFrame), static_cast<unsigned long long>(FrameIndex - RenderedFrame));
+		ImGui::Text("Frames rendered with a repeated state: %llu", static_cast<unsigned long long>(RepeatedStates));
+		ImGui::Separator();
+
+		ImGui::SliderFloat("Update Load (ms)", &PipelineUpdateMilliseconds, 0.0f, 16.0f);
+		ImGui::SliderFloat("Render Load (ms)", &PipelineRenderMilliseconds, 0.0f, 16.0f);
+		if (ImGui::Button("Run Benchmark"))
+		{
+			PipelineBenchmark = RunFramePipelineBenchmark(PipelineUpdateMilliseconds, PipelineRenderMilliseconds, 120);
+		}
+		if (PipelineBenchmark.SerialFramesPerSecond > 0.0)
+		{
+			ImGui::Text("Serial: %.1f fps", PipelineBenchmark.SerialFramesPerSecond);
+			ImGui::Text("Pipelined: %.1f fps, %.2fx", PipelineBenchmark.PipelinedFramesPerSecond, PipelineBenchmark.PipelinedFramesPerSecond / PipelineBenchmark.SerialFramesPerSecond);
+			ImGui::Text("Repeated snapshots: %llu", static_cast<unsigned long long>(PipelineBenchmark.RepeatedSnapshots));
+			ImGui::Text("Torn snapshots: %llu, out of order: %llu", static_cast<unsigned long long>(PipelineBenchmark.TornSnapshots), static_cast<unsigned long long>(PipelineBenchmark.OutOfOrderSnapshots));
+		}
+	}
+	ImGui::End();
+}
+
+void FApplication::SetRenderStatisticsOutput(const char* FileName) noexcept
+{
+	RenderStatisticsFileName = FileName;
+}
+
+void FApplication::SetCaptureOutput(const char* FileName, const uint64_t Frame) noexcept
+{
+	CaptureFileName = FileName;
+	CaptureFrame = Frame;
+}
+
+void FApplication::SetThreadedUpdate(const bool bThreaded) noexcept
+{
+	bThreadedUpdate = bThreaded;
+}
+
+void FApplication::SetScene(const char* FileName) noexcept
+{
+	SceneFileName = FileName;
+}
+
+void FApplication::SetSoftwareRendering(const bool bSoftware) noexcept
+{
+	bSoftwareRendering = bSoftware;
+}
+
+void FApplication::SetCameraPose(const DirectX::XMFLOAT3& Position, const float Yaw, const float Pitch) noexcept
+{
+	bCameraPoseOverride = true;
+	CameraPosePosition = Position;
+	CameraPoseYaw = Yaw;
+	CameraPosePitch = Pitch;
+}
+
+EErrorCode FApplication::PlayCameraPath(const char* FileName, const float TimeStep, const bool bLoop)
+{
+	return MainCamera.PlayPath(FileName, TimeStep, bLoop) ? EErrorCode::OK : EErrorCode::FAIL;
+}
+
+uint64_t FApplication::GetCameraPathFrameCount() const noexcept
+{
+	return MainCamera.GetPlaybackFrameCount();
+}
+
+uint64_t FApplication::GetFramesWithHeapAllocations() const noexcept
+{
+	return FramesWithHeapAllocations;
 }
 
 void FApplication::Resize(const uint32_t Width, const uint32_t Height) const noexcept
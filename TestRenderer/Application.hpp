@@ -2,37 +2,140 @@
 
 #define NOMINMAX
 #include <windows.h>
+#include "Platform.hpp"
 #include "Renderer.hpp"
 #include "Camera.hpp"
 #include "BlurMaterial.hpp"
 #include "Model.hpp"
 #include "TexGen.hpp"
 #include "Light.hpp"
+#include "TextureCache.hpp"
+#include "Allocators.hpp"
+#include "MemoryTracker.hpp"
+#include "JobSystem.hpp"
+#include "TripleBuffer.hpp"
+#include "FramePipeline.hpp"
+
+#include <atomic>
 
 class FApplication
 {
 public:
-	EErrorCode Setup(const HWND HWnd, const uint32_t Width, const uint32_t Height);
+	// without a window the application renders offscreen and never builds gui frames
+	EErrorCode Setup(FPlatform& Platform);
+	// one iteration of the main loop, BeginFrame through Present
+	void RunFrame(const float DeltaTime) noexcept;
 
 	void OnRender() noexcept;
 	void OnUpdate(const float Time) noexcept;
 	void OnGui() noexcept;
 	
+	// called once per iteration of the main loop before any other per frame work
+	void BeginFrame() noexcept;
+
 	void TearDown() noexcept;
 	void Resize(const uint32_t Width, const uint32_t Height) const noexcept;
 	EErrorCode Present() const noexcept;
 
+	// render statistics are written as json to FileName on TearDown, FileName must outlive the application
+	void SetRenderStatisticsOutput(const char* FileName) noexcept;
+	// the renderer calls of the frame after Frame are captured to FileName
+	void SetCaptureOutput(const char* FileName, const uint64_t Frame) noexcept;
+	// runs the simulation on this thread between gui and render instead of on the update thread
+	void SetThreadedUpdate(const bool bThreaded) noexcept;
+	// both have to be set before Setup, FileName must outlive the application
+	void SetScene(const char* FileName) noexcept;
+	void SetSoftwareRendering(const bool bSoftware) noexcept;
+	// takes the camera over from the gui input from the next OnUpdate on
+	void SetCameraPose(const DirectX::XMFLOAT3& Position, const float Yaw, const float Pitch) noexcept;
+	// the camera follows the recorded path, TimeStep seconds of it per frame, a camera pose wins over it
+	EErrorCode PlayCameraPath(const char* FileName, const float TimeStep, const bool bLoop);
+	// frames PlayCameraPath takes to reach the end of the path
+	uint64_t GetCameraPathFrameCount() const noexcept;
+	// frames that allocated on the heap, counted from WARMUP_FRAME_COUNT frames after Setup on
+	uint64_t GetFramesWithHeapAllocations() const noexcept;
+
 	static double GetHighResolutionTime() noexcept;
 
 private:
+	// everything the simulation needs from this thread, copied once per frame in OnUpdate
+	struct SFrameInput
+	{
+		uint64_t Frame;
+		float DeltaTime;
+		FCamera::SInput Camera;
+		DirectX::XMFLOAT3 ModelRotation;
+		FLight::SLightConstantBuffer Light;
+		SBlurParams Blur;
+	};
+
+	// result of one simulation step, never written again once published
+	struct SFrameState
+	{
+		uint64_t Frame;
+		FCamera::SState Camera;
+		FModel::SState Model;
+		FLight::SLightConstantBuffer Light;
+		SBlurParams Blur;
+	};
+
+	// consumes the newest input and publishes the state made from it, on the update thread
+	// while it runs and inline in OnUpdate otherwise
+	void RunSimulationStep() noexcept;
+	void PublishFrameInput(const float Time) noexcept;
+	void StartUpdateThread();
+	void OnJobsGui() noexcept;
+	void OnFramePipelineGui() noexcept;
+
+	// declared first so it outlives every subsystem below
+	FJobSystem JobSystem;
+	SJobBenchmark JobBenchmark{};
+
 	SRenderTarget BackBuffer{};
 	SRenderTarget SceneRenderTarget{};
+	// transient per frame data, everything allocated from it is gone by the next BeginFrame
+	FArenaAllocator FrameAllocator{ "Frame", 1 << 20 };
+
 	FRenderer Renderer{};
-	Generator::FTexGen TexGen{ Renderer };
+	FTextureCache TextureCache{ Renderer };
+	Generator::FTexGen TexGen{ Renderer, FrameAllocator };
 	FCamera MainCamera{ Renderer };
 	
 	FBlurMaterial Blur{ Renderer };
 	
-	FModel Model{ Renderer, MainCamera};
+	FModel Model{ Renderer, MainCamera, TextureCache };
 	FLight Light{ Renderer };
+
+	// frame N + 1 is simulated while frame N renders, this thread only ever renders whole snapshots
+	TTripleBuffer<SFrameInput> FrameInputs;
+	TTripleBuffer<SFrameState> FrameStates;
+	FUpdateThread UpdateThread;
+	bool bThreadedUpdate = true;
+	std::atomic<uint64_t> SimulatedFrames{ 0 };
+	std::atomic<float> SimulationMilliseconds{ 0.0f };
+	uint64_t RenderedFrame = 0;
+	uint64_t RepeatedStates = 0;
+	SFramePipelineBenchmark PipelineBenchmark{};
+	float PipelineUpdateMilliseconds = 4.0f;
+	float PipelineRenderMilliseconds = 4.0f;
+
+	bool bHasWindow = false;
+	bool bSoftwareRendering = false;
+	const char* SceneFileName = "Mesh/radio/Auna_Radio.obj";
+	bool bCameraPoseOverride = false;
+	DirectX::XMFLOAT3 CameraPosePosition{};
+	float CameraPoseYaw = 0.0f;
+	float CameraPosePitch = 0.0f;
+
+	static constexpr uint32_t WARMUP_FRAME_COUNT = 120;
+	uint64_t FrameIndex = 0;
+	uint64_t LastHeapAllocationCount = 0;
+	uint64_t FrameHeapAllocations = 0;
+	uint64_t FramesWithHeapAllocations = 0;
+
+	const char* RenderStatisticsFileName = nullptr;
+
+	const char* CaptureFileName = nullptr;
+	uint64_t CaptureFrame = 0;
+	char CaptureGuiFileName[260] = "frame.rcap";
 };
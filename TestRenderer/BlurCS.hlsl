@@ -0,0 +1,106 @@
+// Directional blur pass as a compute shader, mirrors BlurXPS/BlurYPS with the pass already
+// selected on the CPU. TiledMain caches the tile and its apron in groupshared memory and is
+// used while every tap stays inside the apron, DirectMain samples the texture for longer blurs.
+#define TILE_SIZE 16
+#define APRON 16
+#define CACHE_SIZE (TILE_SIZE + 2 * APRON)
+
+SamplerState LinearSampler : register(s0);
+Texture2D Input : register(t0);
+Texture2D Mask : register(t1);
+RWTexture2D<float4> Output : register(u0);
+
+cbuffer Parameters : register(b0)
+{
+	float Smooth;
+	float SampleCount;
+	float Amount;
+	uint bTiled;
+	float2 Direction;
+	float2 TexelSize;
+	uint Width;
+	uint Height;
+	float2 Padding;
+}
+
+// half precision rgba, keeps the cache at 18KB
+groupshared uint2 Cache[CACHE_SIZE * CACHE_SIZE];
+
+uint2 Pack(float4 Value)
+{
+	return uint2(f32tof16(Value.x) | (f32tof16(Value.y) << 16), f32tof16(Value.z) | (f32tof16(Value.w) << 16));
+}
+
+float4 Unpack(uint2 Value)
+{
+	return float4(f16tof32(Value.x), f16tof32(Value.x >> 16), f16tof32(Value.y), f16tof32(Value.y >> 16));
+}
+
+float WeightFunction(float X)
+{
+	return pow(2.71828, -(X * X) * (Smooth * Smooth) * 64.0);
+}
+
+float4 FetchCached(int2 CacheCoordinate)
+{
+	return Unpack(Cache[CacheCoordinate.y * CACHE_SIZE + CacheCoordinate.x]);
+}
+
+float4 SampleCached(float2 TexCoord, int2 CacheOrigin)
+{
+	float2 Position = TexCoord * float2(Width, Height) - 0.5;
+	float2 Base = floor(Position);
+	float2 Fraction = Position - Base;
+	int2 CacheCoordinate = int2(Base) - CacheOrigin;
+	float4 Top = lerp(FetchCached(CacheCoordinate), FetchCached(CacheCoordinate + int2(1, 0)), Fraction.x);
+	float4 Bottom = lerp(FetchCached(CacheCoordinate + int2(0, 1)), FetchCached(CacheCoordinate + int2(1, 1)), Fraction.x);
+	return lerp(Top, Bottom, Fraction.y);
+}
+
+float4 SampleInput(float2 TexCoord, int2 CacheOrigin, bool bCached)
+{
+	return bCached ? SampleCached(TexCoord, CacheOrigin) : Input.SampleLevel(LinearSampler, TexCoord, 0);
+}
+
+void Blur(uint2 Pixel, int2 CacheOrigin, bool bCached)
+{
+	if (Pixel.x >= Width || Pixel.y >= Height)
+	{
+		return;
+	}
+
+	float2 TexCoord = (float2(Pixel) + 0.5) * TexelSize;
+	float Increment = 1.0 / SampleCount;
+
+	float WeightAccumulator = WeightFunction(0);
+	float4 Center = SampleInput(TexCoord, CacheOrigin, bCached);
+	float4 Accumulator = Center * WeightAccumulator;
+	for (float X = Increment; X < 1.0; X += Increment)
+	{
+		float2 Offset = X * Amount * Direction;
+		float Weight = WeightFunction(X);
+		Accumulator += (SampleInput(TexCoord + Offset, CacheOrigin, bCached) + SampleInput(TexCoord - Offset, CacheOrigin, bCached)) * Weight;
+		WeightAccumulator += Weight * 2.0;
+	}
+	Output[Pixel] = lerp(Center, Accumulator / WeightAccumulator, Mask.SampleLevel(LinearSampler, TexCoord, 0).r);
+}
+
+[numthreads(TILE_SIZE, TILE_SIZE, 1)]
+void TiledMain(uint3 GroupId : SV_GroupID, uint3 DispatchThreadId : SV_DispatchThreadID, uint GroupIndex : SV_GroupIndex)
+{
+	int2 CacheOrigin = int2(GroupId.xy * TILE_SIZE) - APRON;
+	for (uint Index = GroupIndex; Index < CACHE_SIZE * CACHE_SIZE; Index += TILE_SIZE * TILE_SIZE)
+	{
+		int2 Texel = clamp(CacheOrigin + int2(Index % CACHE_SIZE, Index / CACHE_SIZE), int2(0, 0), int2(Width - 1, Height - 1));
+		Cache[Index] = Pack(Input.Load(int3(Texel, 0)));
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	Blur(DispatchThreadId.xy, CacheOrigin, true);
+}
+
+[numthreads(TILE_SIZE, TILE_SIZE, 1)]
+void DirectMain(uint3 DispatchThreadId : SV_DispatchThreadID)
+{
+	Blur(DispatchThreadId.xy, int2(0, 0), false);
+}
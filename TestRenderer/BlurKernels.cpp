@@ -0,0 +1,131 @@
+#include "BlurKernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	float WeightFunction(const float X, const float Smooth) noexcept
+	{
+		return std::pow(2.71828f, -(X * X) * (Smooth * Smooth) * 64.0f);
+	}
+
+	DirectX::XMFLOAT4 Lerp(const DirectX::XMFLOAT4& A, const DirectX::XMFLOAT4& B, const float T) noexcept
+	{
+		return { A.x + (B.x - A.x) * T, A.y + (B.y - A.y) * T, A.z + (B.z - A.z) * T, A.w + (B.w - A.w) * T };
+	}
+
+	// bilinear taps out of the tile cache, which was filled with clamped texels
+	DirectX::XMFLOAT4 SampleCached(const FBlurKernel::SGroupShared& Shared, const SBlurPassParams& Params, const int32_t CacheOriginX, const int32_t CacheOriginY, const float U, const float V) noexcept
+	{
+		const float X = U * Params.Width - 0.5f;
+		const float Y = V * Params.Height - 0.5f;
+		const float BaseX = std::floor(X);
+		const float BaseY = std::floor(Y);
+		const float FractionX = X - BaseX;
+		const float FractionY = Y - BaseY;
+		const int32_t CacheX = static_cast<int32_t>(BaseX) - CacheOriginX;
+		const int32_t CacheY = static_cast<int32_t>(BaseY) - CacheOriginY;
+		const auto* Row = Shared.Cache + CacheY * BLUR_CACHE_SIZE + CacheX;
+		const auto Top = Lerp(Row[0], Row[1], FractionX);
+		const auto Bottom = Lerp(Row[BLUR_CACHE_SIZE], Row[BLUR_CACHE_SIZE + 1], FractionX);
+		return Lerp(Top, Bottom, FractionY);
+	}
+}
+
+SBlurPassParams MakeBlurPassParams(const SBlurParams& Params, const bool bVertical, const uint32_t Width, const uint32_t Height) noexcept
+{
+	const float Samples = bVertical ? Params.SamplesY : Params.SamplesX;
+	const float Power = bVertical ? Params.PowerY : Params.PowerX;
+	const float Angle = (bVertical ? Params.DirectionY : Params.DirectionX) * 355.0f / 113.0f;
+
+	SBlurPassParams PassParams{};
+	PassParams.Smooth = Params.Smooth;
+	PassParams.SampleCount = Samples * 255.0f + 1.0f;
+	PassParams.Amount = Params.Size * Params.Size * Power;
+	PassParams.Direction = { std::cos(Angle), std::sin(Angle) };
+	PassParams.TexelSize = { 1.0f / Width, 1.0f / Height };
+	PassParams.Width = Width;
+	PassParams.Height = Height;
+
+	// furthest tap in texels plus one for the bilinear footprint
+	const float Reach = PassParams.Amount * std::max(std::fabs(PassParams.Direction.x) * Width, std::fabs(PassParams.Direction.y) * Height);
+	PassParams.bTiled = std::ceil(Reach) + 1.0f <= static_cast<float>(BLUR_APRON) ? 1 : 0;
+	return PassParams;
+}
+
+DirectX::XMFLOAT4 SampleLinearClamp(const SCpuTexture& Texture, const float U, const float V) noexcept
+{
+	const float X = U * Texture.Width - 0.5f;
+	const float Y = V * Texture.Height - 0.5f;
+	const float BaseX = std::floor(X);
+	const float BaseY = std::floor(Y);
+	const float FractionX = X - BaseX;
+	const float FractionY = Y - BaseY;
+
+	const auto Fetch = [&Texture](const int32_t TexelX, const int32_t TexelY)
+	{
+		const auto ClampedX = std::min(std::max(TexelX, 0), static_cast<int32_t>(Texture.Width) - 1);
+		const auto ClampedY = std::min(std::max(TexelY, 0), static_cast<int32_t>(Texture.Height) - 1);
+		return Texture.Pixels[ClampedY * Texture.Width + ClampedX];
+	};
+	const auto IntegerX = static_cast<int32_t>(BaseX);
+	const auto IntegerY = static_cast<int32_t>(BaseY);
+	const auto Top = Lerp(Fetch(IntegerX, IntegerY), Fetch(IntegerX + 1, IntegerY), FractionX);
+	const auto Bottom = Lerp(Fetch(IntegerX, IntegerY + 1), Fetch(IntegerX + 1, IntegerY + 1), FractionX);
+	return Lerp(Top, Bottom, FractionY);
+}
+
+void FBlurKernel::Execute(const uint32_t Phase, const SComputeThread& Thread, SGroupShared& Shared) const noexcept
+{
+	const int32_t CacheOriginX = static_cast<int32_t>(Thread.GroupId[0] * BLUR_TILE_SIZE) - static_cast<int32_t>(BLUR_APRON);
+	const int32_t CacheOriginY = static_cast<int32_t>(Thread.GroupId[1] * BLUR_TILE_SIZE) - static_cast<int32_t>(BLUR_APRON);
+
+	if (Phase == 0)
+	{
+		if (Params.bTiled)
+		{
+			for (uint32_t Index = Thread.GroupIndex; Index < BLUR_CACHE_SIZE * BLUR_CACHE_SIZE; Index += THREADS_X * THREADS_Y)
+			{
+				const auto X = std::min(std::max(CacheOriginX + static_cast<int32_t>(Index % BLUR_CACHE_SIZE), 0), static_cast<int32_t>(Input.Width) - 1);
+				const auto Y = std::min(std::max(CacheOriginY + static_cast<int32_t>(Index / BLUR_CACHE_SIZE), 0), static_cast<int32_t>(Input.Height) - 1);
+				Shared.Cache[Index] = Input.Pixels[Y * Input.Width + X];
+			}
+		}
+		return;
+	}
+
+	if (Thread.DispatchThreadId[0] >= Params.Width || Thread.DispatchThreadId[1] >= Params.Height)
+	{
+		return;
+	}
+
+	const float U = (Thread.DispatchThreadId[0] + 0.5f) * Params.TexelSize.x;
+	const float V = (Thread.DispatchThreadId[1] + 0.5f) * Params.TexelSize.y;
+	const auto Sample = [&](const float SampleU, const float SampleV)
+	{
+		return Params.bTiled ? SampleCached(Shared, Params, CacheOriginX, CacheOriginY, SampleU, SampleV) : SampleLinearClamp(Input, SampleU, SampleV);
+	};
+
+	const float Increment = 1.0f / Params.SampleCount;
+	float WeightAccumulator = WeightFunction(0.0f, Params.Smooth);
+	const auto Center = Sample(U, V);
+	DirectX::XMFLOAT4 Accumulator{ Center.x * WeightAccumulator, Center.y * WeightAccumulator, Center.z * WeightAccumulator, Center.w * WeightAccumulator };
+	for (float X = Increment; X < 1.0f; X += Increment)
+	{
+		const float OffsetU = X * Params.Amount * Params.Direction.x;
+		const float OffsetV = X * Params.Amount * Params.Direction.y;
+		const float Weight = WeightFunction(X, Params.Smooth);
+		const auto Forward = Sample(U + OffsetU, V + OffsetV);
+		const auto Backward = Sample(U - OffsetU, V - OffsetV);
+		Accumulator.x += (Forward.x + Backward.x) * Weight;
+		Accumulator.y += (Forward.y + Backward.y) * Weight;
+		Accumulator.z += (Forward.z + Backward.z) * Weight;
+		Accumulator.w += (Forward.w + Backward.w) * Weight;
+		WeightAccumulator += Weight * 2.0f;
+	}
+
+	const float InverseWeight = 1.0f / WeightAccumulator;
+	const DirectX::XMFLOAT4 Blurred{ Accumulator.x * InverseWeight, Accumulator.y * InverseWeight, Accumulator.z * InverseWeight, Accumulator.w * InverseWeight };
+	Output[Thread.DispatchThreadId[1] * Params.Width + Thread.DispatchThreadId[0]] = Lerp(Center, Blurred, SampleLinearClamp(Mask, U, V).x);
+}
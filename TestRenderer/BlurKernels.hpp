@@ -0,0 +1,71 @@
+#pragma once
+
+#include "ComputeExecutor.hpp"
+#include <DirectXMath.h>
+#include <cstdint>
+
+struct SBlurParams
+{
+	float Smooth = 0.963f;			// 0.0 -> box filter, > 0.0 for gaussian
+	float Size = 0.643f;				// length of the blur (global)
+	float SamplesX = 0.352f;			// number of samples to take
+	float SamplesY = 0.536f;			// number of samples to take
+	float DirectionX = 0.488f;		// direction of blur
+	float DirectionY = 0.664f;		// direction of blur
+	float PowerX = 0.376f;			// length of the blur
+	float PowerY = 0.423f;			// length of the blur
+};
+
+// Constant buffer of BlurCS.hlsl, one directional pass with everything derived up front
+struct SBlurPassParams
+{
+	float Smooth;
+	float SampleCount;
+	float Amount;
+	uint32_t bTiled;
+	DirectX::XMFLOAT2 Direction;
+	DirectX::XMFLOAT2 TexelSize;
+	uint32_t Width;
+	uint32_t Height;
+	DirectX::XMFLOAT2 Padding;
+};
+
+static constexpr uint32_t BLUR_TILE_SIZE = 16;
+// texels loaded around a tile, passes reaching further sample the texture directly
+static constexpr uint32_t BLUR_APRON = 16;
+static constexpr uint32_t BLUR_CACHE_SIZE = BLUR_TILE_SIZE + 2 * BLUR_APRON;
+
+SBlurPassParams MakeBlurPassParams(const SBlurParams& Params, const bool bVertical, const uint32_t Width, const uint32_t Height) noexcept;
+
+struct SCpuTexture
+{
+	uint32_t Width;
+	uint32_t Height;
+	const DirectX::XMFLOAT4* Pixels;
+};
+
+// bilinear filtering with clamp addressing, like LinearSampler in slot 0
+DirectX::XMFLOAT4 SampleLinearClamp(const SCpuTexture& Texture, const float U, const float V) noexcept;
+
+// CPU version of BlurCS.hlsl for DispatchOnCpu, phase 0 fills the tile cache and phase 1 blurs.
+// The cache holds floats where the shader packs halves, so the tiled and direct passes agree
+// exactly here and with the shader only within half precision.
+struct FBlurKernel
+{
+	static constexpr uint32_t THREADS_X = BLUR_TILE_SIZE;
+	static constexpr uint32_t THREADS_Y = BLUR_TILE_SIZE;
+	static constexpr uint32_t THREADS_Z = 1;
+	static constexpr uint32_t PHASE_COUNT = 2;
+
+	struct SGroupShared
+	{
+		DirectX::XMFLOAT4 Cache[BLUR_CACHE_SIZE * BLUR_CACHE_SIZE];
+	};
+
+	void Execute(const uint32_t Phase, const SComputeThread& Thread, SGroupShared& Shared) const noexcept;
+
+	SBlurPassParams Params;
+	SCpuTexture Input;
+	SCpuTexture Mask;
+	DirectX::XMFLOAT4* Output;
+};
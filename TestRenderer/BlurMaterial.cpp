@@ -19,7 +19,13 @@ FBlurMaterial::~FBlurMaterial()
 	InternalRenderer.DestroyRenderTarget(RenderTarget);
 	InternalRenderer.DestroyRenderTarget(FinalRenderTarget);
 
-	InternalRenderer.DestroyTexture(MaskTexture);
+	InternalRenderer.DestroyTexture(DefaultMaskTexture);
+
+	InternalRenderer.DestroyShader(BlurTiledShader);
+	InternalRenderer.DestroyShader(BlurDirectShader);
+	InternalRenderer.DestroyBuffer(BlurPassConstantBuffer);
+	InternalRenderer.DestroyRenderTarget(ComputeTarget);
+	InternalRenderer.DestroyRenderTarget(FinalComputeTarget);
 }
 
 EErrorCode FBlurMaterial::Initialize(const uint32_t Width, const uint32_t Height) noexcept
@@ -45,14 +51,27 @@ EErrorCode FBlurMaterial::Initialize(const uint32_t Width, const uint32_t Height
 		memset(MaskBuffer + (Row * Width), 0, Width);
 		memset(MaskBuffer + (Row * Width + static_cast<uint32_t>(Width * 0.5f)), 255, static_cast<uint32_t>(Width * 0.5f));
 	}
-	Result = InternalRenderer.CreateTextureFromMemory(MaskBuffer, Width, Height, 1, DXGI_FORMAT_R8_UNORM, MaskTexture);
+	Result = InternalRenderer.CreateTextureFromMemory(MaskBuffer, Width, Height, 1, DXGI_FORMAT_R8_UNORM, DefaultMaskTexture);
 	delete[] MaskBuffer;
 	CHECK_RESULT();
+	MaskTexture = DefaultMaskTexture;
 
 	Result = InternalRenderer.CreateRenderTarget(Width, Height, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, RenderTarget);
 	CHECK_RESULT();
 	Result = InternalRenderer.CreateRenderTarget(Width, Height, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, FinalRenderTarget);
 	CHECK_RESULT();
+
+	Result = InternalRenderer.CreateComputeShader(L"BlurCS.hlsl", "TiledMain", BlurTiledShader);
+	CHECK_RESULT();
+	Result = InternalRenderer.CreateComputeShader(L"BlurCS.hlsl", "DirectMain", BlurDirectShader);
+	CHECK_RESULT();
+	Result = InternalRenderer.CreateConstantBufferWithData(MakeBlurPassParams(BlurParams, false, Width, Height), BlurPassConstantBuffer);
+	CHECK_RESULT();
+	// srgb formats can not be bound for unordered access
+	Result = InternalRenderer.CreateReadWriteTexture(Width, Height, DXGI_FORMAT_R16G16B16A16_FLOAT, ComputeTarget);
+	CHECK_RESULT();
+	Result = InternalRenderer.CreateReadWriteTexture(Width, Height, DXGI_FORMAT_R16G16B16A16_FLOAT, FinalComputeTarget);
+	CHECK_RESULT();
 	return EErrorCode::OK;
 #undef CHECK_RESULT
 }
@@ -62,6 +81,12 @@ void FBlurMaterial::OnGui() noexcept
 	ImGui::Begin("Blur");
 	{
 		ImGui::Checkbox("Is Enabled", &bIsEnabled);
+		ImGui::Checkbox("Compute Shader", &bUseCompute);
+		if (bUseCompute)
+		{
+			ImGui::SameLine();
+			ImGui::Text("X: %s, Y: %s", bLastPassesTiled[0] ? "tiled" : "direct", bLastPassesTiled[1] ? "tiled" : "direct");
+		}
 		ImGui::SliderFloat("Smooth", &BlurParams.Smooth, 0, 1);
 		ImGui::SliderFloat("Size", &BlurParams.Size, 0, 1);
 		ImGui::SliderFloat2("Samples", static_cast<float*>(&BlurParams.SamplesX), 0.0f, 1.0f);
@@ -71,12 +96,16 @@ void FBlurMaterial::OnGui() noexcept
 	ImGui::End();
 }
 
-void FBlurMaterial::OnRender(const SRenderTarget* RenderTargets, const size_t Count)  noexcept
+void FBlurMaterial::OnRender(const SBlurParams& Params, const SRenderTarget* RenderTargets, const size_t Count)  noexcept
 {
 	assert(RenderTargets != nullptr);
 	assert(Count == 1);
 
-	if (bIsEnabled)
+	if (bIsEnabled && bUseCompute)
+	{
+		RenderCompute(Params, RenderTargets[0]);
+	}
+	else if (bIsEnabled)
 	{
 		//X Pass
 		InternalRenderer.SetRenderTarget(RenderTarget);
@@ -84,7 +113,7 @@ void FBlurMaterial::OnRender(const SRenderTarget* RenderTargets, const size_t Co
 		InternalRenderer.SetViewport(RenderTarget.Width, RenderTarget.Height);
 		InternalRenderer.SetShader(BlurXShader);
 		InternalRenderer.SetConstantBuffer(BlurConstantBuffer, EShaderStage::PIXEL);
-		InternalRenderer.UpdateSubresource(BlurConstantBuffer, &BlurParams, sizeof(SBlurParams));
+		InternalRenderer.UpdateSubresource(BlurConstantBuffer, &Params, sizeof(SBlurParams));
 		InternalRenderer.SetTexture(0, RenderTargets[0]);
 		InternalRenderer.SetTexture(1, MaskTexture);
 		InternalRenderer.SetConstantBuffer({ nullptr, 0 }, EShaderStage::VERTEX);
@@ -98,7 +127,7 @@ void FBlurMaterial::OnRender(const SRenderTarget* RenderTargets, const size_t Co
 		InternalRenderer.SetViewport(FinalRenderTarget.Width, FinalRenderTarget.Height);
 		InternalRenderer.SetShader(BlurYShader);
 		InternalRenderer.SetConstantBuffer(BlurConstantBuffer, EShaderStage::PIXEL);
-		InternalRenderer.UpdateSubresource(BlurConstantBuffer, &BlurParams, sizeof(SBlurParams));
+		InternalRenderer.UpdateSubresource(BlurConstantBuffer, &Params, sizeof(SBlurParams));
 		InternalRenderer.SetTexture(0, RenderTarget);
 		InternalRenderer.SetTexture(1, MaskTexture);
 		InternalRenderer.SetConstantBuffer({ nullptr, 0 }, EShaderStage::VERTEX);
@@ -110,6 +139,30 @@ void FBlurMaterial::OnRender(const SRenderTarget* RenderTargets, const size_t Co
 	}
 }
 
+void FBlurMaterial::RenderCompute(const SBlurParams& Params, const SRenderTarget& Input) noexcept
+{
+	// the scene target may still be bound for output, which would null its shader resource view
+	InternalRenderer.UnbindRenderTargets();
+
+	const SRenderTarget* PassInputs[] = { &Input, &ComputeTarget };
+	const SRenderTarget* PassOutputs[] = { &ComputeTarget, &FinalComputeTarget };
+	for (size_t Pass = 0; Pass < 2; ++Pass)
+	{
+		const auto& Output = *PassOutputs[Pass];
+		const auto PassParams = MakeBlurPassParams(Params, Pass == 1, Output.Width, Output.Height);
+		bLastPassesTiled[Pass] = PassParams.bTiled != 0;
+
+		InternalRenderer.SetShader(PassParams.bTiled ? BlurTiledShader : BlurDirectShader);
+		InternalRenderer.UpdateSubresource(BlurPassConstantBuffer, &PassParams, sizeof(SBlurPassParams));
+		InternalRenderer.SetConstantBuffer(BlurPassConstantBuffer, EShaderStage::COMPUTE);
+		InternalRenderer.SetComputeTexture(0, *PassInputs[Pass]);
+		InternalRenderer.SetComputeTexture(1, MaskTexture);
+		InternalRenderer.SetReadWriteTexture(0, Output);
+		InternalRenderer.Dispatch((Output.Width + BLUR_TILE_SIZE - 1) / BLUR_TILE_SIZE, (Output.Height + BLUR_TILE_SIZE - 1) / BLUR_TILE_SIZE);
+		InternalRenderer.UnbindComputeResources();
+	}
+}
+
 void FBlurMaterial::SetMask(const SRenderTarget& Mask) noexcept
 {
 	MaskTexture = Mask;
@@ -117,10 +170,15 @@ void FBlurMaterial::SetMask(const SRenderTarget& Mask) noexcept
 
 const SRenderTarget& FBlurMaterial::GetResult() const noexcept
 {
-	return FinalRenderTarget;
+	return bUseCompute ? FinalComputeTarget : FinalRenderTarget;
 }
 
 bool FBlurMaterial::IsEnabled() const noexcept
 {
 	return bIsEnabled;
 }
+
+const SBlurParams& FBlurMaterial::GetParams() const noexcept
+{
+	return BlurParams;
+}
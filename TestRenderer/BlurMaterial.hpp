@@ -1,35 +1,27 @@
 #pragma once
 
 #include "Renderer.hpp"
+#include "BlurKernels.hpp"
 
 class FBlurMaterial
 {
-private:
-	struct SBlurParams
-	{
-		float Smooth = 0.963f;			// 0.0 -> box filter, > 0.0 for gaussian
-		float Size = 0.643f;				// length of the blur (global)
-		float SamplesX = 0.352f;			// number of samples to take
-		float SamplesY = 0.536f;			// number of samples to take
-		float DirectionX = 0.488f;		// direction of blur
-		float DirectionY = 0.664f;		// direction of blur
-		float PowerX = 0.376f;			// length of the blur
-		float PowerY = 0.423f;			// length of the blur
-	};
-
 public:
 	explicit FBlurMaterial(FRenderer& Renderer);
 	~FBlurMaterial();
 
 	EErrorCode Initialize(const uint32_t Width, const uint32_t Height) noexcept;
 	void OnGui() noexcept;
-	void OnRender(const SRenderTarget* RenderTargets, const size_t Count) noexcept;
+	// Params comes from the frame snapshot, the gui keeps editing the live ones returned by GetParams
+	void OnRender(const SBlurParams& Params, const SRenderTarget* RenderTargets, const size_t Count) noexcept;
 
 	void SetMask(const SRenderTarget& Mask) noexcept;
 	const SRenderTarget& GetResult() const noexcept;
 	bool IsEnabled() const noexcept;
+	const SBlurParams& GetParams() const noexcept;
 
 private:
+	void RenderCompute(const SBlurParams& Params, const SRenderTarget& Input) noexcept;
+
 	FRenderer& InternalRenderer;
 	SBlurParams BlurParams{};
 	
@@ -41,7 +33,18 @@ private:
 	SRenderTarget RenderTarget{};
 	SRenderTarget FinalRenderTarget{};
 
+	// MaskTexture is DefaultMaskTexture until SetMask, the texture passed to it belongs to the caller
+	SRenderTarget DefaultMaskTexture{};
 	SRenderTarget MaskTexture{};
 
+	// compute path, both passes write linear half float textures
+	SShader BlurTiledShader{};
+	SShader BlurDirectShader{};
+	SBuffer BlurPassConstantBuffer{};
+	SRenderTarget ComputeTarget{};
+	SRenderTarget FinalComputeTarget{};
+	bool bUseCompute = false;
+	bool bLastPassesTiled[2] = { false, false };
+
 	bool bIsEnabled = true;
 };
\ No newline at end of file
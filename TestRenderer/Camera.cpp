@@ -49,37 +49,95 @@ void FCamera::Initialize(const uint32_t Width, const uint32_t Height) noexcept
 	
 }
 
-void FCamera::OnUpdate(const float Time) noexcept
+FCamera::SInput FCamera::GatherInput(const float Time) noexcept
 {
-	using namespace DirectX;
-	
+	auto& Input = GatheredInput;
+	if (bPlaying)
+	{
+		const auto Keyframe = PlaybackPath.Evaluate(PlaybackPath.GetStartTime() + PlaybackStep * PlaybackFrame);
+		Input.bOverridePose = true;
+		Input.PosePosition = DirectX::XMFLOAT3(Keyframe.Position[0], Keyframe.Position[1], Keyframe.Position[2]);
+		Input.PoseYaw = Keyframe.Yaw;
+		Input.PosePitch = Keyframe.Pitch;
+		if (++PlaybackFrame >= GetPlaybackFrameCount())
+		{
+			PlaybackFrame = 0;
+			bPlaying = bLoopPlayback;
+		}
+		return Input;
+	}
+	Input.bOverridePose = false;
+
+	if (bRecording)
+	{
+		if (RecordTime >= NextRecordTime)
+		{
+			SCameraKeyframe Keyframe{};
+			Keyframe.Time = RecordTime;
+			Keyframe.Position[0] = DisplayPosition.x;
+			Keyframe.Position[1] = DisplayPosition.y;
+			Keyframe.Position[2] = DisplayPosition.z;
+			Keyframe.Yaw = DisplayYaw;
+			Keyframe.Pitch = DisplayPitch;
+			RecordedPath.AddKeyframe(Keyframe);
+			NextRecordTime += RECORD_INTERVAL;
+		}
+		RecordTime += Time;
+	}
+
 	auto& Io = ImGui::GetIO();
 	if(!Io.WantCaptureKeyboard && !Io.WantCaptureMouse)
 	{
-		return;
+		return Input;
 	}
 	
 	if (ImGui::IsKeyDown('W'))
 	{
-		BackForward += 15.0f * Time * Speed;
+		Input.BackForward += 15.0f * Time * Speed;
 	}
 	if (ImGui::IsKeyDown('S'))
 	{
-		BackForward -= 15.0f * Time * Speed;
+		Input.BackForward -= 15.0f * Time * Speed;
 	}
 	if (ImGui::IsKeyDown('A'))
 	{
-		LeftRight -= 15.0f * Time * Speed;
+		Input.LeftRight -= 15.0f * Time * Speed;
 	}
 	if (ImGui::IsKeyDown('D'))
 	{
-		LeftRight += 15.0f * Time * Speed;
+		Input.LeftRight += 15.0f * Time * Speed;
 	}
 	if (ImGui::IsMouseDown(0))
 	{
-		Yaw += Io.MouseDelta.x * Time;
-		Pitch += Io.MouseDelta.y * Time;
+		Input.Yaw += Io.MouseDelta.x * Time;
+		Input.Pitch += Io.MouseDelta.y * Time;
 	}
+	return Input;
+}
+
+void FCamera::OnUpdate(const float Time) noexcept
+{
+	OnUpdate(GatherInput(Time));
+}
+
+void FCamera::OnUpdate(const SInput& Input) noexcept
+{
+	using namespace DirectX;
+
+	if (Input.bOverridePose)
+	{
+		Position = DirectX::XMVectorSet(Input.PosePosition.x, Input.PosePosition.y, Input.PosePosition.z, 0.0f);
+		Yaw = Input.PoseYaw;
+		Pitch = Input.PosePitch;
+	}
+	else
+	{
+		BackForward += static_cast<float>(Input.BackForward - AppliedInput.BackForward);
+		LeftRight += static_cast<float>(Input.LeftRight - AppliedInput.LeftRight);
+		Yaw += static_cast<float>(Input.Yaw - AppliedInput.Yaw);
+		Pitch += static_cast<float>(Input.Pitch - AppliedInput.Pitch);
+	}
+	AppliedInput = Input;
 
 	RotationMatrix = DirectX::XMMatrixRotationRollPitchYaw(Pitch, Yaw, 0);
 	Target = DirectX::XMVector3TransformCoord(DefaultForward, RotationMatrix);
@@ -100,9 +158,21 @@ void FCamera::OnUpdate(const float Time) noexcept
 	View = DirectX::XMMatrixLookAtLH(Position, Target, Up);
 }
 
-void FCamera::OnRender() noexcept
+void FCamera::WriteState(SState& State) const noexcept
 {
-	DirectX::XMStoreFloat4(&CameraConstants.Position, Position);
+	DirectX::XMStoreFloat4x4(&State.View, View);
+	DirectX::XMStoreFloat4x4(&State.Projection, Projection);
+	DirectX::XMStoreFloat4(&State.Position, Position);
+	State.Yaw = Yaw;
+	State.Pitch = Pitch;
+}
+
+void FCamera::OnRender(const SState& State) noexcept
+{
+	CameraConstants.Position = State.Position;
+	DisplayPosition = State.Position;
+	DisplayYaw = State.Yaw;
+	DisplayPitch = State.Pitch;
 	InternalRenderer.SetConstantBuffer(ConstantBuffer, EShaderStage::PIXEL);
 	InternalRenderer.UpdateSubresource(ConstantBuffer, &CameraConstants, sizeof(SCameraConstants));
 }
@@ -111,14 +181,94 @@ void FCamera::OnGui() noexcept
 {
 	ImGui::Begin("Camera");
 	{
-		DirectX::XMFLOAT4 TempVector;
-		DirectX::XMStoreFloat4(&TempVector, Position);
+		DirectX::XMFLOAT4 TempVector = DisplayPosition;
 		ImGui::DragFloat3("Position", &TempVector.x);
 		ImGui::InputFloat("Speed Factor", &Speed);
+		ImGui::Separator();
+
+		ImGui::InputText("Path", PathFileName, sizeof(PathFileName));
+		if (bRecording)
+		{
+			ImGui::Text("Recording, %zu keyframes", RecordedPath.GetKeyframeCount());
+			if (ImGui::Button("Stop and Save"))
+			{
+				StopRecording(PathFileName);
+			}
+		}
+		else if (bPlaying)
+		{
+			ImGui::Text("Playing frame %llu of %llu", static_cast<unsigned long long>(PlaybackFrame), static_cast<unsigned long long>(GetPlaybackFrameCount()));
+			if (ImGui::Button("Stop"))
+			{
+				StopPlayback();
+			}
+		}
+		else
+		{
+			if (ImGui::Button("Record"))
+			{
+				StartRecording();
+			}
+			ImGui::SameLine();
+			if (ImGui::Button("Play"))
+			{
+				PlayPath(PathFileName, 1.0f / 60.0f, bLoopPlayback);
+			}
+			ImGui::SameLine();
+			ImGui::Checkbox("Loop", &bLoopPlayback);
+		}
 	}
 	ImGui::End();
 }
 
+void FCamera::StartRecording() noexcept
+{
+	RecordedPath.Clear();
+	bRecording = true;
+	RecordTime = 0.0f;
+	NextRecordTime = 0.0f;
+}
+
+bool FCamera::StopRecording(const char* FileName) noexcept
+{
+	bRecording = false;
+	return RecordedPath.Save(FileName);
+}
+
+bool FCamera::PlayPath(const char* FileName, const float TimeStep, const bool bLoop)
+{
+	bPlaying = false;
+	if (!PlaybackPath.Load(FileName) || PlaybackPath.IsEmpty() || TimeStep <= 0.0f)
+	{
+		return false;
+	}
+	bPlaying = true;
+	bLoopPlayback = bLoop;
+	PlaybackStep = TimeStep;
+	PlaybackFrame = 0;
+	return true;
+}
+
+void FCamera::StopPlayback() noexcept
+{
+	bPlaying = false;
+	PlaybackFrame = 0;
+}
+
+bool FCamera::IsPlaying() const noexcept
+{
+	return bPlaying;
+}
+
+uint64_t FCamera::GetPlaybackFrameCount() const noexcept
+{
+	if (PlaybackPath.IsEmpty() || PlaybackStep <= 0.0f)
+	{
+		return 0;
+	}
+	return static_cast<uint64_t>(PlaybackPath.GetDuration() / PlaybackStep) + 1;
+}
+
 DirectX::XMMATRIX FCamera::GetViewMatrix() const noexcept
 {
 	return View;
@@ -3,6 +3,7 @@
 #include <DirectXMath.h>
 #include "imgui/imgui.h"
 #include "Renderer.hpp"
+#include "CameraPath.hpp"
 
 class FCamera
 {
@@ -11,11 +12,52 @@ public:
 
 	~FCamera();
 
+	// movement summed up since Initialize, gathered from ImGui on the thread that owns it. Sums
+	// instead of per frame deltas let an update skip inputs without losing any movement.
+	struct SInput
+	{
+		double BackForward;
+		double LeftRight;
+		double Yaw;
+		double Pitch;
+		// scripted cameras replace position and orientation instead of moving them
+		bool bOverridePose;
+		DirectX::XMFLOAT3 PosePosition;
+		float PoseYaw;
+		float PosePitch;
+	};
+
+	// what rendering needs from the camera, copied out after each update
+	struct SState
+	{
+		DirectX::XMFLOAT4X4 View;
+		DirectX::XMFLOAT4X4 Projection;
+		DirectX::XMFLOAT4 Position;
+		float Yaw;
+		float Pitch;
+	};
+
+	static constexpr float RECORD_INTERVAL = 0.2f;
+
 	void Initialize(const uint32_t Width, const uint32_t Height) noexcept;
+	SInput GatherInput(const float Time) noexcept;
 	void OnUpdate(const float Time) noexcept;
-	void OnRender() noexcept;
+	void OnUpdate(const SInput& Input) noexcept;
+	void WriteState(SState& State) const noexcept;
+	void OnRender(const SState& State) noexcept;
 	void OnGui() noexcept;
 
+	// Recording samples the rendered camera every RECORD_INTERVAL seconds. Playback replaces the
+	// gui input, each gathered input advances the path by TimeStep whatever the frame took.
+	// All of them belong to the thread gathering the input.
+	void StartRecording() noexcept;
+	bool StopRecording(const char* FileName) noexcept;
+	bool PlayPath(const char* FileName, const float TimeStep, const bool bLoop);
+	void StopPlayback() noexcept;
+	bool IsPlaying() const noexcept;
+	// inputs it takes to play the loaded path once
+	uint64_t GetPlaybackFrameCount() const noexcept;
+
 	DirectX::XMMATRIX GetViewMatrix() const noexcept;
 	DirectX::XMMATRIX GetProjectionMatrix() const noexcept;
 
@@ -39,10 +81,30 @@ private:
 		DirectX::XMFLOAT4 Position;
 	};
 	SCameraConstants CameraConstants{};
+	// last rendered state, Position, Yaw and Pitch themselves belong to the update
+	DirectX::XMFLOAT4 DisplayPosition{};
+	float DisplayYaw = 0.0f;
+	float DisplayPitch = 0.0f;
 	SBuffer ConstantBuffer{};
 
 	float Speed = 1.0f;
 
+	// GatheredInput belongs to the gathering thread, AppliedInput to the updating one
+	SInput GatheredInput{};
+	SInput AppliedInput{};
+
+	FCameraPath RecordedPath;
+	bool bRecording = false;
+	float RecordTime = 0.0f;
+	float NextRecordTime = 0.0f;
+
+	FCameraPath PlaybackPath;
+	bool bPlaying = false;
+	bool bLoopPlayback = false;
+	float PlaybackStep = 0.0f;
+	uint64_t PlaybackFrame = 0;
+	char PathFileName[260] = "camera.path";
+
 	float LeftRight = 0.0f;
 	float BackForward = 0.0f;
 	float Yaw = 0.0f;
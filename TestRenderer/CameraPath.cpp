@@ -0,0 +1,156 @@
+#include "CameraPath.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+namespace
+{
+	constexpr size_t CHANNEL_COUNT = 5;
+
+	float GetChannel(const SCameraKeyframe& Keyframe, const size_t Channel) noexcept
+	{
+		return Channel < 3 ? Keyframe.Position[Channel] : Channel == 3 ? Keyframe.Yaw : Keyframe.Pitch;
+	}
+
+	void SetChannel(SCameraKeyframe& Keyframe, const size_t Channel, const float Value) noexcept
+	{
+		if (Channel < 3)
+		{
+			Keyframe.Position[Channel] = Value;
+		}
+		else if (Channel == 3)
+		{
+			Keyframe.Yaw = Value;
+		}
+		else
+		{
+			Keyframe.Pitch = Value;
+		}
+	}
+}
+
+void FCameraPath::Clear() noexcept
+{
+	Keyframes.clear();
+}
+
+void FCameraPath::AddKeyframe(const SCameraKeyframe& Keyframe)
+{
+	Keyframes.push_back(Keyframe);
+}
+
+SCameraKeyframe FCameraPath::Evaluate(const float Time) const noexcept
+{
+	if (Keyframes.empty())
+	{
+		return SCameraKeyframe{};
+	}
+	if (Time <= Keyframes.front().Time || Keyframes.size() == 1)
+	{
+		return Keyframes.front();
+	}
+	if (Time >= Keyframes.back().Time)
+	{
+		return Keyframes.back();
+	}
+
+	// Keyframes[Index] <= Time < Keyframes[Index + 1]
+	const auto Next = std::upper_bound(Keyframes.begin(), Keyframes.end(), Time, [](const float Lhs, const SCameraKeyframe& Rhs) { return Lhs < Rhs.Time; });
+	const size_t Index = static_cast<size_t>(Next - Keyframes.begin()) - 1;
+	const auto& K0 = Keyframes[Index > 0 ? Index - 1 : Index];
+	const auto& K1 = Keyframes[Index];
+	const auto& K2 = Keyframes[Index + 1];
+	const auto& K3 = Keyframes[std::min(Index + 2, Keyframes.size() - 1)];
+
+	// cubic Hermite with Catmull-Rom tangents, the tangents are divided by the time they span so
+	// unevenly spaced keyframes do not make the camera speed up or overshoot
+	const float Span = K2.Time - K1.Time;
+	const float S = Span > 0.0f ? (Time - K1.Time) / Span : 0.0f;
+	const float S2 = S * S;
+	const float S3 = S2 * S;
+	const float H00 = 2.0f * S3 - 3.0f * S2 + 1.0f;
+	const float H10 = S3 - 2.0f * S2 + S;
+	const float H01 = -2.0f * S3 + 3.0f * S2;
+	const float H11 = S3 - S2;
+	const float TangentSpan1 = K2.Time - K0.Time;
+	const float TangentSpan2 = K3.Time - K1.Time;
+
+	SCameraKeyframe Result{};
+	Result.Time = Time;
+	for (size_t Channel = 0; Channel < CHANNEL_COUNT; ++Channel)
+	{
+		const float P0 = GetChannel(K0, Channel);
+		const float P1 = GetChannel(K1, Channel);
+		const float P2 = GetChannel(K2, Channel);
+		const float P3 = GetChannel(K3, Channel);
+		const float M1 = TangentSpan1 > 0.0f ? (P2 - P0) / TangentSpan1 * Span : 0.0f;
+		const float M2 = TangentSpan2 > 0.0f ? (P3 - P1) / TangentSpan2 * Span : 0.0f;
+		SetChannel(Result, Channel, H00 * P1 + H10 * M1 + H01 * P2 + H11 * M2);
+	}
+	return Result;
+}
+
+bool FCameraPath::Save(const char* FileName) const noexcept
+{
+	FILE* File = fopen(FileName, "w");
+	if (File == nullptr)
+	{
+		return false;
+	}
+	fprintf(File, "camerapath %u\n", VERSION);
+	for (const auto& Keyframe : Keyframes)
+	{
+		// 9 significant digits round trip a float exactly, a replayed path hits the same views
+		fprintf(File, "key %.9g %.9g %.9g %.9g %.9g %.9g\n", Keyframe.Time, Keyframe.Position[0], Keyframe.Position[1], Keyframe.Position[2], Keyframe.Yaw, Keyframe.Pitch);
+	}
+	const bool bWritten = ferror(File) == 0;
+	fclose(File);
+	return bWritten;
+}
+
+bool FCameraPath::Load(const char* FileName)
+{
+	FILE* File = fopen(FileName, "r");
+	if (File == nullptr)
+	{
+		return false;
+	}
+	uint32_t Version = 0;
+	std::vector<SCameraKeyframe> Loaded;
+	bool bValid = fscanf(File, " camerapath %u", &Version) == 1 && Version == VERSION;
+	SCameraKeyframe Keyframe{};
+	while (bValid && fscanf(File, " key %f %f %f %f %f %f", &Keyframe.Time, &Keyframe.Position[0], &Keyframe.Position[1], &Keyframe.Position[2], &Keyframe.Yaw, &Keyframe.Pitch) == 6)
+	{
+		bValid = Loaded.empty() || Keyframe.Time >= Loaded.back().Time;
+		Loaded.push_back(Keyframe);
+	}
+	bValid = bValid && feof(File);
+	fclose(File);
+	if (!bValid)
+	{
+		return false;
+	}
+	Keyframes = std::move(Loaded);
+	return true;
+}
+
+bool FCameraPath::IsEmpty() const noexcept
+{
+	return Keyframes.empty();
+}
+
+size_t FCameraPath::GetKeyframeCount() const noexcept
+{
+	return Keyframes.size();
+}
+
+float FCameraPath::GetStartTime() const noexcept
+{
+	return Keyframes.empty() ? 0.0f : Keyframes.front().Time;
+}
+
+float FCameraPath::GetDuration() const noexcept
+{
+	return Keyframes.empty() ? 0.0f : Keyframes.back().Time - Keyframes.front().Time;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct SCameraKeyframe
+{
+	float Time;
+	float Position[3];
+	// radians, not wrapped so interpolation never takes the long way around
+	float Yaw;
+	float Pitch;
+};
+
+// Keyframes sorted by time, evaluated with a Catmull-Rom spline through all of them. Stored as
+// text, one "key <time> <x> <y> <z> <yaw> <pitch>" line per keyframe after a version line.
+class FCameraPath
+{
+public:
+	static constexpr uint32_t VERSION = 1;
+
+	void Clear() noexcept;
+	// keyframes have to be added in increasing time
+	void AddKeyframe(const SCameraKeyframe& Keyframe);
+	// clamps to the first and last keyframe outside the path
+	SCameraKeyframe Evaluate(const float Time) const noexcept;
+
+	bool Save(const char* FileName) const noexcept;
+	bool Load(const char* FileName);
+
+	bool IsEmpty() const noexcept;
+	size_t GetKeyframeCount() const noexcept;
+	float GetStartTime() const noexcept;
+	float GetDuration() const noexcept;
+
+private:
+	std::vector<SCameraKeyframe> Keyframes;
+};
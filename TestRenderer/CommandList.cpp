@@ -0,0 +1,239 @@
+#include "CommandList.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+FCommandList::FCommandList(const uint32_t SortKey) noexcept : SortKey(SortKey)
+{
+}
+
+void FCommandList::Reset(const uint32_t NewSortKey) noexcept
+{
+	SortKey = NewSortKey;
+	Commands.clear();
+	Payload.clear();
+}
+
+uint32_t FCommandList::GetSortKey() const noexcept
+{
+	return SortKey;
+}
+
+size_t FCommandList::GetCommandCount() const noexcept
+{
+	return Commands.size();
+}
+
+const FCommandList::SCommand& FCommandList::GetCommand(const size_t Index) const noexcept
+{
+	return Commands[Index];
+}
+
+FCommandList::SCommand& FCommandList::Push(const ECommand Type)
+{
+	Commands.emplace_back();
+	auto& Command = Commands.back();
+	Command.Type = Type;
+	return Command;
+}
+
+void FCommandList::ClearRenderTarget(const SRenderTarget& RenderTarget, const DirectX::XMFLOAT4& Colour)
+{
+	auto& Clear = Push(ECommand::CLEAR_RENDER_TARGET).Clear;
+	Clear.RenderTargetView = RenderTarget.RenderTargetView;
+	Clear.Colour[0] = Colour.x;
+	Clear.Colour[1] = Colour.y;
+	Clear.Colour[2] = Colour.z;
+	Clear.Colour[3] = Colour.w;
+}
+
+void FCommandList::ClearDepthStencil(const SRenderTarget& RenderTarget, const uint32_t ClearFlags, const float Depth, const uint8_t Stencil)
+{
+	auto& Clear = Push(ECommand::CLEAR_DEPTH_STENCIL).Clear;
+	Clear.DepthStencilView = RenderTarget.DepthStencilView;
+	Clear.ClearFlags = ClearFlags;
+	Clear.Depth = Depth;
+	Clear.Stencil = Stencil;
+}
+
+void FCommandList::SetConstantBuffer(const SBuffer& ConstantBuffer, const EShaderStage ShaderStage, const size_t Slot)
+{
+	auto& Binding = Push(ECommand::SET_CONSTANT_BUFFER).BufferBinding;
+	Binding.Buffer = ConstantBuffer.Buffer;
+	Binding.Stride = ConstantBuffer.Stride;
+	Binding.Slot = static_cast<uint32_t>(Slot);
+	Binding.Stage = ShaderStage;
+}
+
+void FCommandList::UpdateSubresource(const SBuffer& Buffer, const void* Data, const size_t ByteSize)
+{
+	auto& Upload = Push(ECommand::UPDATE_SUBRESOURCE).Upload;
+	Upload.Buffer = Buffer.Buffer;
+	Upload.PayloadOffset = static_cast<uint32_t>((Payload.size() + 15) & ~size_t(15));
+	Upload.ByteSize = static_cast<uint32_t>(ByteSize);
+	Payload.resize(Upload.PayloadOffset + ByteSize);
+	memcpy(Payload.data() + Upload.PayloadOffset, Data, ByteSize);
+}
+
+void FCommandList::SetViewport(const uint32_t Width, const uint32_t Height, const uint32_t XOffset, const uint32_t YOffset, const float MinDepth, const float MaxDepth)
+{
+	Push(ECommand::SET_VIEWPORT).Viewport = { Width, Height, XOffset, YOffset, MinDepth, MaxDepth };
+}
+
+void FCommandList::SetShader(const SShader& Shader)
+{
+	Push(ECommand::SET_SHADER).ShaderBinding = { Shader.Vertex, Shader.Pixel, Shader.Compute, Shader.Layout, Shader.Stage };
+}
+
+void FCommandList::SetRenderTarget(const SRenderTarget& RenderTarget)
+{
+	auto& Clear = Push(ECommand::SET_RENDER_TARGET).Clear;
+	Clear.RenderTargetView = RenderTarget.RenderTargetView;
+	Clear.DepthStencilView = RenderTarget.DepthStencilView;
+}
+
+void FCommandList::SetTexture(const uint32_t Slot, const SRenderTarget& Texture)
+{
+	Push(ECommand::SET_TEXTURE).TextureBinding = { Texture.ShaderResourceView, nullptr, Slot };
+}
+
+void FCommandList::SetPrimitiveTopology(const uint32_t PrimitiveTopology)
+{
+	Push(ECommand::SET_PRIMITIVE_TOPOLOGY).Topology = PrimitiveTopology;
+}
+
+void FCommandList::SetVertexBuffer(const size_t StartSlot, const SBuffer& Buffer, const uint32_t Offset)
+{
+	Push(ECommand::SET_VERTEX_BUFFER).BufferBinding = { Buffer.Buffer, Buffer.Stride, Offset, static_cast<uint32_t>(StartSlot), EShaderStage::VERTEX };
+}
+
+void FCommandList::SetIndexBuffer(const size_t StartSlot, const SBuffer& Buffer, const uint32_t Offset)
+{
+	Push(ECommand::SET_INDEX_BUFFER).BufferBinding = { Buffer.Buffer, Buffer.Stride, Offset, static_cast<uint32_t>(StartSlot), EShaderStage::VERTEX };
+}
+
+void FCommandList::SetComputeTexture(const uint32_t Slot, const SRenderTarget& Texture)
+{
+	Push(ECommand::SET_COMPUTE_TEXTURE).TextureBinding = { Texture.ShaderResourceView, nullptr, Slot };
+}
+
+void FCommandList::SetReadWriteTexture(const uint32_t Slot, const SRenderTarget& Texture)
+{
+	Push(ECommand::SET_READ_WRITE_TEXTURE).TextureBinding = { nullptr, Texture.UnorderedAccessView, Slot };
+}
+
+void FCommandList::UnbindComputeResources()
+{
+	Push(ECommand::UNBIND_COMPUTE_RESOURCES);
+}
+
+void FCommandList::Dispatch(const uint32_t GroupCountX, const uint32_t GroupCountY, const uint32_t GroupCountZ)
+{
+	auto& Command = Push(ECommand::DISPATCH);
+	Command.GroupCount[0] = GroupCountX;
+	Command.GroupCount[1] = GroupCountY;
+	Command.GroupCount[2] = GroupCountZ;
+}
+
+void FCommandList::Draw(const size_t VertexCount, const size_t VertexLocationStart)
+{
+	Push(ECommand::DRAW).Draw = { static_cast<uint32_t>(VertexCount), static_cast<uint32_t>(VertexLocationStart), 0 };
+}
+
+void FCommandList::DrawIndexed(const size_t IndexCount, const size_t IndexLocationStart, const size_t VertexLocationBase)
+{
+	Push(ECommand::DRAW_INDEXED).Draw = { static_cast<uint32_t>(IndexCount), static_cast<uint32_t>(IndexLocationStart), static_cast<uint32_t>(VertexLocationBase) };
+}
+
+void SortCommandLists(const FCommandList* const* CommandLists, const size_t Count, std::vector<const FCommandList*>& Order)
+{
+	Order.assign(CommandLists, CommandLists + Count);
+	std::stable_sort(Order.begin(), Order.end(), [](const FCommandList* Lhs, const FCommandList* Rhs)
+	{
+		return Lhs->GetSortKey() < Rhs->GetSortKey();
+	});
+}
+
+void RecordBenchmarkDraws(FCommandList& CommandList, const size_t Begin, const size_t End)
+{
+	const SBuffer VertexBuffer{ reinterpret_cast<ID3D11Buffer*>(0x1000), 48 };
+	const SBuffer IndexBuffer{ reinterpret_cast<ID3D11Buffer*>(0x2000), 4 };
+	const SBuffer ConstantBuffer{ reinterpret_cast<ID3D11Buffer*>(0x3000), 0 };
+	const float Transform[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+	for (size_t Draw = Begin; Draw < End; ++Draw)
+	{
+		CommandList.SetConstantBuffer(ConstantBuffer, EShaderStage::VERTEX);
+		CommandList.UpdateSubresource(ConstantBuffer, Transform, sizeof(Transform));
+		CommandList.SetVertexBuffer(0, VertexBuffer, 0);
+		CommandList.SetIndexBuffer(0, IndexBuffer, 0);
+		CommandList.DrawIndexed(36);
+	}
+}
+
+std::vector<SRecordingBenchmark> RunRecordingBenchmark(const size_t DrawCount, const uint32_t MaximumThreads, const uint32_t Repetitions)
+{
+	SShader Shader{};
+	Shader.Stage = EShaderStage::VERTEX | EShaderStage::PIXEL;
+
+	// padded so the vectors of neighbouring lists never share a cache line
+	struct SPaddedCommandList
+	{
+		FCommandList CommandList;
+		uint8_t Padding[64];
+	};
+	std::vector<SPaddedCommandList> CommandLists(MaximumThreads);
+	std::vector<SRecordingBenchmark> Results;
+	for (uint32_t ThreadCount = 1; ThreadCount <= MaximumThreads; ++ThreadCount)
+	{
+		double BestMilliseconds = 0.0;
+		for (uint32_t Repetition = 0; Repetition < Repetitions; ++Repetition)
+		{
+			// workers are started up front and released together, thread creation is not timed
+			std::atomic<uint32_t> ReadyCount{ 0 };
+			std::atomic<bool> bStart{ false };
+			std::vector<std::thread> Workers;
+			for (uint32_t Thread = 0; Thread < ThreadCount; ++Thread)
+			{
+				Workers.emplace_back([&, Thread]()
+				{
+					auto& CommandList = CommandLists[Thread].CommandList;
+					const size_t Begin = DrawCount * Thread / ThreadCount;
+					const size_t End = DrawCount * (Thread + 1) / ThreadCount;
+					++ReadyCount;
+					while (!bStart.load(std::memory_order_acquire))
+					{
+						std::this_thread::yield();
+					}
+
+					CommandList.Reset(Thread);
+					CommandList.SetShader(Shader);
+					RecordBenchmarkDraws(CommandList, Begin, End);
+				});
+			}
+			while (ReadyCount.load() != ThreadCount)
+			{
+				std::this_thread::yield();
+			}
+
+			const auto Start = std::chrono::high_resolution_clock::now();
+			bStart.store(true, std::memory_order_release);
+			for (auto& Worker : Workers)
+			{
+				Worker.join();
+			}
+			const auto Milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - Start).count();
+			BestMilliseconds = Repetition == 0 ? Milliseconds : std::min(BestMilliseconds, Milliseconds);
+		}
+
+		SRecordingBenchmark Result{};
+		Result.ThreadCount = ThreadCount;
+		Result.Milliseconds = BestMilliseconds;
+		Result.DrawsPerMillisecond = BestMilliseconds > 0.0 ? DrawCount / BestMilliseconds : 0.0;
+		Result.Speedup = Results.empty() ? 1.0 : Results.front().Milliseconds / std::max(BestMilliseconds, 1e-9);
+		Results.push_back(Result);
+	}
+	return Results;
+}
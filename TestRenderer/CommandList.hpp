@@ -0,0 +1,187 @@
+#pragma once
+
+#include "RenderResources.hpp"
+#include <DirectXMath.h>
+#include <vector>
+
+class FRenderer;
+
+enum class ECommandBackend : uint8_t
+{
+	// lists are replayed through FRenderer on the immediate context
+	RECORDED,
+	// lists are translated into D3D11 deferred contexts on worker threads and executed in order
+	DEFERRED_CONTEXT
+};
+
+// Records FRenderer calls without touching the device, so every thread can fill a list of its
+// own. FRenderer::Submit merges lists by sort key and, for equal keys, by the order they are
+// passed in, so the result never depends on which thread finished first. Only raw resource
+// pointers are stored, resources have to outlive the submit. Recording never touches Direct3D,
+// only Execute does and it is built with FRenderer. With DEFERRED_CONTEXT no state
+// carries over from the immediate context or between lists, each list binds what it uses, and
+// the immediate context has the state it had before the submit again afterwards.
+class FCommandList
+{
+public:
+	explicit FCommandList(const uint32_t SortKey = 0) noexcept;
+
+	// keeps the storage, steady state recording does not allocate
+	void Reset(const uint32_t SortKey) noexcept;
+	uint32_t GetSortKey() const noexcept;
+	size_t GetCommandCount() const noexcept;
+
+	void ClearRenderTarget(const SRenderTarget& RenderTarget, const DirectX::XMFLOAT4& Colour);
+	void ClearDepthStencil(const SRenderTarget& RenderTarget, const uint32_t ClearFlags, const float Depth, const uint8_t Stencil);
+
+	void SetConstantBuffer(const SBuffer& ConstantBuffer, const EShaderStage ShaderStage, const size_t Slot = 0);
+	// Data is copied into the list
+	void UpdateSubresource(const SBuffer& Buffer, const void* Data, const size_t ByteSize);
+	void SetViewport(const uint32_t Width, const uint32_t Height, const uint32_t XOffset = 0, const uint32_t YOffset = 0, const float MinDepth = 0.0f, const float MaxDepth = 1.0f);
+	void SetShader(const SShader& Shader);
+	void SetRenderTarget(const SRenderTarget& RenderTarget);
+	void SetTexture(const uint32_t Slot, const SRenderTarget& Texture);
+	// a D3D11_PRIMITIVE_TOPOLOGY
+	void SetPrimitiveTopology(const uint32_t PrimitiveTopology);
+	void SetVertexBuffer(const size_t StartSlot, const SBuffer& Buffer, const uint32_t Offset);
+	void SetIndexBuffer(const size_t StartSlot, const SBuffer& Buffer, const uint32_t Offset);
+
+	void SetComputeTexture(const uint32_t Slot, const SRenderTarget& Texture);
+	void SetReadWriteTexture(const uint32_t Slot, const SRenderTarget& Texture);
+	void UnbindComputeResources();
+	void Dispatch(const uint32_t GroupCountX, const uint32_t GroupCountY, const uint32_t GroupCountZ = 1);
+
+	void Draw(const size_t VertexCount, const size_t VertexLocationStart);
+	void DrawIndexed(const size_t IndexCount, const size_t IndexLocationStart = 0, const size_t VertexLocationBase = 0);
+
+	// replays the commands through Renderer, the immediate one or one wrapping a deferred context
+	void Execute(const FRenderer& Renderer) const noexcept;
+
+	enum class ECommand : uint8_t
+	{
+		CLEAR_RENDER_TARGET,
+		CLEAR_DEPTH_STENCIL,
+		SET_CONSTANT_BUFFER,
+		UPDATE_SUBRESOURCE,
+		SET_VIEWPORT,
+		SET_SHADER,
+		SET_RENDER_TARGET,
+		SET_TEXTURE,
+		SET_PRIMITIVE_TOPOLOGY,
+		SET_VERTEX_BUFFER,
+		SET_INDEX_BUFFER,
+		SET_COMPUTE_TEXTURE,
+		SET_READ_WRITE_TEXTURE,
+		UNBIND_COMPUTE_RESOURCES,
+		DISPATCH,
+		DRAW,
+		DRAW_INDEXED
+	};
+
+	struct SClear
+	{
+		ID3D11RenderTargetView* RenderTargetView;
+		ID3D11DepthStencilView* DepthStencilView;
+		float Colour[4];
+		uint32_t ClearFlags;
+		float Depth;
+		uint8_t Stencil;
+	};
+
+	struct SBufferBinding
+	{
+		ID3D11Buffer* Buffer;
+		uint32_t Stride;
+		uint32_t Offset;
+		uint32_t Slot;
+		EShaderStage Stage;
+	};
+
+	struct SUpload
+	{
+		ID3D11Buffer* Buffer;
+		uint32_t PayloadOffset;
+		uint32_t ByteSize;
+	};
+
+	struct SViewport
+	{
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t XOffset;
+		uint32_t YOffset;
+		float MinDepth;
+		float MaxDepth;
+	};
+
+	struct SShaderBinding
+	{
+		ID3D11VertexShader* Vertex;
+		ID3D11PixelShader* Pixel;
+		ID3D11ComputeShader* Compute;
+		ID3D11InputLayout* Layout;
+		EShaderStage Stage;
+	};
+
+	struct STextureBinding
+	{
+		ID3D11ShaderResourceView* ShaderResourceView;
+		ID3D11UnorderedAccessView* UnorderedAccessView;
+		uint32_t Slot;
+	};
+
+	struct SDraw
+	{
+		uint32_t Count;
+		uint32_t Start;
+		uint32_t Base;
+	};
+
+	struct SCommand
+	{
+		ECommand Type;
+		union
+		{
+			SClear Clear;
+			SBufferBinding BufferBinding;
+			SUpload Upload;
+			SViewport Viewport;
+			SShaderBinding ShaderBinding;
+			STextureBinding TextureBinding;
+			uint32_t Topology;
+			uint32_t GroupCount[3];
+			SDraw Draw;
+		};
+	};
+
+	// the recorded commands in order, UPDATE_SUBRESOURCE data is not part of them
+	const SCommand& GetCommand(const size_t Index) const noexcept;
+
+private:
+	SCommand& Push(const ECommand Type);
+
+	uint32_t SortKey;
+	std::vector<SCommand> Commands;
+	// constant data, 16 byte aligned per upload
+	std::vector<uint8_t> Payload;
+};
+
+// the order FRenderer::Submit executes lists in, by sort key and lists with equal keys in the
+// order they are passed in
+void SortCommandLists(const FCommandList* const* CommandLists, const size_t Count, std::vector<const FCommandList*>& Order);
+
+struct SRecordingBenchmark
+{
+	uint32_t ThreadCount;
+	double Milliseconds;
+	double DrawsPerMillisecond;
+	double Speedup;
+};
+
+// Records the draws [Begin, End) of the recording benchmark, a constant upload, buffer bindings and
+// an indexed draw each. Recording only copies pointers, so the resources are made up.
+void RecordBenchmarkDraws(FCommandList& CommandList, const size_t Begin, const size_t End);
+
+// Records DrawCount draws split across 1 to MaximumThreads lists, each on its own thread, the
+// best of Repetitions runs is kept per thread count. Only recording is timed, nothing is submitted.
+std::vector<SRecordingBenchmark> RunRecordingBenchmark(const size_t DrawCount, const uint32_t MaximumThreads, const uint32_t Repetitions);
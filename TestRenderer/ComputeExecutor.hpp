@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Parallel.hpp"
+#include <cstdint>
+
+// The system values a compute shader thread sees
+struct SComputeThread
+{
+	uint32_t GroupId[3];
+	uint32_t GroupThreadId[3];
+	uint32_t DispatchThreadId[3];
+	uint32_t GroupIndex;
+};
+
+// Runs a kernel over the same grid FRenderer::Dispatch would, on the CPU. TKernel provides
+// THREADS_X/Y/Z, PHASE_COUNT, an SGroupShared type standing in for groupshared memory and
+// Execute(Phase, Thread, Shared). A GroupMemoryBarrierWithGroupSync in the shader becomes a
+// phase boundary: every thread of a group finishes a phase before any starts the next one.
+// Groups are independent and run in parallel.
+template <typename TKernel>
+void DispatchOnCpu(const TKernel& Kernel, const uint32_t GroupCountX, const uint32_t GroupCountY, const uint32_t GroupCountZ = 1)
+{
+	const size_t GroupCount = static_cast<size_t>(GroupCountX) * GroupCountY * GroupCountZ;
+	ParallelFor(GroupCount, 1, [&Kernel, GroupCountX, GroupCountY](const size_t Begin, const size_t End)
+	{
+		// large tiles do not belong on a worker's stack
+		auto Shared = new typename TKernel::SGroupShared();
+		for (size_t Group = Begin; Group < End; ++Group)
+		{
+			SComputeThread Thread{};
+			Thread.GroupId[0] = static_cast<uint32_t>(Group % GroupCountX);
+			Thread.GroupId[1] = static_cast<uint32_t>(Group / GroupCountX % GroupCountY);
+			Thread.GroupId[2] = static_cast<uint32_t>(Group / GroupCountX / GroupCountY);
+			for (uint32_t Phase = 0; Phase < TKernel::PHASE_COUNT; ++Phase)
+			{
+				Thread.GroupIndex = 0;
+				for (uint32_t Z = 0; Z < TKernel::THREADS_Z; ++Z)
+				{
+					for (uint32_t Y = 0; Y < TKernel::THREADS_Y; ++Y)
+					{
+						for (uint32_t X = 0; X < TKernel::THREADS_X; ++X, ++Thread.GroupIndex)
+						{
+							Thread.GroupThreadId[0] = X;
+							Thread.GroupThreadId[1] = Y;
+							Thread.GroupThreadId[2] = Z;
+							Thread.DispatchThreadId[0] = Thread.GroupId[0] * TKernel::THREADS_X + X;
+							Thread.DispatchThreadId[1] = Thread.GroupId[1] * TKernel::THREADS_Y + Y;
+							Thread.DispatchThreadId[2] = Thread.GroupId[2] * TKernel::THREADS_Z + Z;
+							Kernel.Execute(Phase, Thread, *Shared);
+						}
+					}
+				}
+			}
+		}
+		delete Shared;
+	});
+}
@@ -14,14 +14,14 @@ struct VOut
 	float3 Bitangent : BITANGENT;
 };
 
-VOut main(float4 Position : POSITION, float3 Normal : NORMAL, float2 TexCoord : TEXCOORD, float3 Tangent : TANGENT, float3 Bitangent : BITANGENT)
+VOut main(float4 Position : POSITION, float3 Normal : NORMAL, float2 TexCoord : TEXCOORD, float4 Tangent : TANGENT)
 {
 	VOut Output;
 	matrix WorldViewProj = mul(mul(World, View), Projection);
 	Output.Position = mul(Position, WorldViewProj);
 	Output.Normal = mul(Normal, (float3x3)World);
-	Output.Tangent = mul(Tangent, (float3x3)World);
+	Output.Tangent = mul(Tangent.xyz, (float3x3)World);
 	Output.TexCoord = TexCoord;
-	Output.Bitangent = Bitangent;
+	Output.Bitangent = cross(Output.Normal, Output.Tangent) * Tangent.w;
 	return Output;
 }
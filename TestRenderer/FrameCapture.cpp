@@ -0,0 +1,244 @@
+#include "FrameCapture.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+FFrameCapture::FFrameCapture(ID3D11Device* Device, ID3D11DeviceContext* DeviceContext, const char* FileName)
+	: Device(Device)
+	, DeviceContext(DeviceContext)
+	, FileName(FileName)
+{
+}
+
+void FFrameCapture::BeginCall(const ECaptureCall Call)
+{
+	CallStart = Calls.size();
+	SCaptureCallHeader Header{};
+	Header.Call = Call;
+	WriteBytes(&Header, sizeof(Header));
+}
+
+void FFrameCapture::Write(const uint32_t Value)
+{
+	WriteBytes(&Value, sizeof(Value));
+}
+
+void FFrameCapture::Write(const float Value)
+{
+	WriteBytes(&Value, sizeof(Value));
+}
+
+void FFrameCapture::WriteBytes(const void* Data, const uint32_t Size)
+{
+	const auto Offset = Calls.size();
+	// payloads stay 4 byte aligned
+	Calls.resize(Offset + ((Size + 3) & ~3u));
+	memcpy(Calls.data() + Offset, Data, Size);
+}
+
+void FFrameCapture::EndCall()
+{
+	auto Header = reinterpret_cast<SCaptureCallHeader*>(Calls.data() + CallStart);
+	Header->PayloadSize = static_cast<uint32_t>(Calls.size() - CallStart - sizeof(SCaptureCallHeader));
+	++CallCount;
+}
+
+uint32_t FFrameCapture::AddResource(ID3D11Resource* Resource)
+{
+	if (Resource == nullptr)
+	{
+		return CAPTURE_INVALID_ID;
+	}
+	const auto Found = Ids.find(Resource);
+	if (Found != Ids.end())
+	{
+		return Found->second;
+	}
+
+	SCaptureResourceHeader Header{};
+	std::vector<uint8_t> Data;
+	if (!ReadBack(Resource, Header, Data))
+	{
+		// still numbered so the calls stay consistent, the replayer sees an empty resource
+		Data.clear();
+	}
+	Header.DataSize = static_cast<uint32_t>(Data.size());
+	return AddRecord(Resource, Header, Data.data());
+}
+
+uint32_t FFrameCapture::AddView(ID3D11View* View)
+{
+	if (View == nullptr)
+	{
+		return CAPTURE_INVALID_ID;
+	}
+	ID3D11Resource* Resource = nullptr;
+	View->GetResource(&Resource);
+	const auto Id = AddResource(Resource);
+	Resource->Release();
+	return Id;
+}
+
+uint32_t FFrameCapture::AddObject(const void* Object, const ECaptureResource Type, const std::vector<uint8_t>& Data)
+{
+	if (Object == nullptr)
+	{
+		return CAPTURE_INVALID_ID;
+	}
+	const auto Found = Ids.find(Object);
+	if (Found != Ids.end())
+	{
+		return Found->second;
+	}
+
+	SCaptureResourceHeader Header{};
+	Header.Type = Type;
+	Header.Width = static_cast<uint32_t>(Data.size());
+	Header.DataSize = static_cast<uint32_t>(Data.size());
+	return AddRecord(Object, Header, Data.data());
+}
+
+uint32_t FFrameCapture::AddRecord(const void* Object, SCaptureResourceHeader& Header, const void* Data)
+{
+	Header.Id = ResourceCount++;
+	Ids.emplace(Object, Header.Id);
+
+	const auto Offset = Resources.size();
+	Resources.resize(Offset + sizeof(Header) + Header.DataSize);
+	memcpy(Resources.data() + Offset, &Header, sizeof(Header));
+	if (Header.DataSize > 0)
+	{
+		memcpy(Resources.data() + Offset + sizeof(Header), Data, Header.DataSize);
+	}
+	return Header.Id;
+}
+
+bool FFrameCapture::ReadBack(ID3D11Resource* Resource, SCaptureResourceHeader& Header, std::vector<uint8_t>& Data) const
+{
+	D3D11_RESOURCE_DIMENSION Dimension;
+	Resource->GetType(&Dimension);
+	if (Dimension == D3D11_RESOURCE_DIMENSION_BUFFER)
+	{
+		D3D11_BUFFER_DESC Desc{};
+		static_cast<ID3D11Buffer*>(Resource)->GetDesc(&Desc);
+		Header.Type = ECaptureResource::BUFFER;
+		Header.Width = Desc.ByteWidth;
+		Header.Height = 1;
+		Header.ArraySize = 1;
+		Header.MipLevels = 1;
+		Header.Stride = Desc.StructureByteStride;
+		Header.BindFlags = Desc.BindFlags;
+
+		D3D11_BUFFER_DESC StagingDesc = Desc;
+		StagingDesc.Usage = D3D11_USAGE_STAGING;
+		StagingDesc.BindFlags = 0;
+		StagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		ID3D11Buffer* Staging = nullptr;
+		if (Device->CreateBuffer(&StagingDesc, nullptr, &Staging) != S_OK)
+		{
+			return false;
+		}
+		DeviceContext->CopyResource(Staging, Resource);
+		D3D11_MAPPED_SUBRESOURCE Mapped{};
+		const bool bMapped = DeviceContext->Map(Staging, 0, D3D11_MAP_READ, 0, &Mapped) == S_OK;
+		if (bMapped)
+		{
+			Data.resize(Desc.ByteWidth);
+			memcpy(Data.data(), Mapped.pData, Desc.ByteWidth);
+			DeviceContext->Unmap(Staging, 0);
+		}
+		Staging->Release();
+		return bMapped;
+	}
+
+	if (Dimension != D3D11_RESOURCE_DIMENSION_TEXTURE2D)
+	{
+		return false;
+	}
+
+	D3D11_TEXTURE2D_DESC Desc{};
+	static_cast<ID3D11Texture2D*>(Resource)->GetDesc(&Desc);
+	Header.Type = ECaptureResource::TEXTURE;
+	Header.Width = Desc.Width;
+	Header.Height = Desc.Height;
+	Header.ArraySize = Desc.ArraySize;
+	Header.MipLevels = Desc.MipLevels;
+	Header.Format = Desc.Format;
+	Header.BindFlags = Desc.BindFlags;
+
+	const auto TexelSize = GetCaptureFormatSize(Desc.Format);
+	if (TexelSize == 0)
+	{
+		return false;
+	}
+
+	D3D11_TEXTURE2D_DESC StagingDesc = Desc;
+	StagingDesc.Usage = D3D11_USAGE_STAGING;
+	StagingDesc.BindFlags = 0;
+	StagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	StagingDesc.MiscFlags &= D3D11_RESOURCE_MISC_TEXTURECUBE;
+	ID3D11Texture2D* Staging = nullptr;
+	if (Device->CreateTexture2D(&StagingDesc, nullptr, &Staging) != S_OK)
+	{
+		return false;
+	}
+	DeviceContext->CopyResource(Staging, Resource);
+
+	bool bMapped = true;
+	for (UINT Slice = 0; Slice < Desc.ArraySize && bMapped; ++Slice)
+	{
+		for (UINT Mip = 0; Mip < Desc.MipLevels; ++Mip)
+		{
+			const auto Subresource = D3D11CalcSubresource(Mip, Slice, Desc.MipLevels);
+			D3D11_MAPPED_SUBRESOURCE Mapped{};
+			if (DeviceContext->Map(Staging, Subresource, D3D11_MAP_READ, 0, &Mapped) != S_OK)
+			{
+				bMapped = false;
+				break;
+			}
+			const auto Width = std::max(1u, Desc.Width >> Mip);
+			const auto Height = std::max(1u, Desc.Height >> Mip);
+			const auto RowSize = Width * TexelSize;
+			const auto Offset = Data.size();
+			Data.resize(Offset + static_cast<size_t>(RowSize) * Height);
+			for (UINT Row = 0; Row < Height; ++Row)
+			{
+				memcpy(Data.data() + Offset + static_cast<size_t>(Row) * RowSize, static_cast<const uint8_t*>(Mapped.pData) + static_cast<size_t>(Row) * Mapped.RowPitch, RowSize);
+			}
+			DeviceContext->Unmap(Staging, Subresource);
+		}
+	}
+	Staging->Release();
+	return bMapped;
+}
+
+bool FFrameCapture::Save() const
+{
+	FILE* File = fopen(FileName.c_str(), "wb");
+	if (File == nullptr)
+	{
+		return false;
+	}
+
+	SCaptureFileHeader Header{};
+	Header.Magic = CAPTURE_MAGIC;
+	Header.Version = CAPTURE_VERSION;
+	Header.ResourceCount = ResourceCount;
+	Header.CallCount = CallCount;
+	bool bWritten = fwrite(&Header, sizeof(Header), 1, File) == 1;
+	bWritten = bWritten && (Resources.empty() || fwrite(Resources.data(), Resources.size(), 1, File) == 1);
+	bWritten = bWritten && (Calls.empty() || fwrite(Calls.data(), Calls.size(), 1, File) == 1);
+	fclose(File);
+	return bWritten;
+}
+
+const std::string& FFrameCapture::GetFileName() const noexcept
+{
+	return FileName;
+}
+
+uint32_t FFrameCapture::GetCallCount() const noexcept
+{
+	return CallCount;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "FrameCaptureFormat.hpp"
+#include <d3d11.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Serializes the FRenderer calls of one frame. A resource is added the first time a call uses
+// it, together with its contents read back at that point. Only captured calls write resources,
+// so that is the state the resource had when the frame started.
+class FFrameCapture
+{
+public:
+	FFrameCapture(ID3D11Device* Device, ID3D11DeviceContext* DeviceContext, const char* FileName);
+
+	FFrameCapture(const FFrameCapture&) = delete;
+	FFrameCapture& operator=(const FFrameCapture&) = delete;
+
+	void BeginCall(const ECaptureCall Call);
+	void Write(const uint32_t Value);
+	void Write(const float Value);
+	void WriteBytes(const void* Data, const uint32_t Size);
+	void EndCall();
+
+	// ids of already captured resources are returned as is, null maps to CAPTURE_INVALID_ID
+	uint32_t AddResource(ID3D11Resource* Resource);
+	uint32_t AddView(ID3D11View* View);
+	// shaders and input layouts, whose creation data FRenderer keeps around
+	uint32_t AddObject(const void* Object, const ECaptureResource Type, const std::vector<uint8_t>& Data);
+
+	bool Save() const;
+	const std::string& GetFileName() const noexcept;
+	uint32_t GetCallCount() const noexcept;
+
+private:
+	uint32_t AddRecord(const void* Object, SCaptureResourceHeader& Header, const void* Data);
+	bool ReadBack(ID3D11Resource* Resource, SCaptureResourceHeader& Header, std::vector<uint8_t>& Data) const;
+
+	ID3D11Device* Device;
+	ID3D11DeviceContext* DeviceContext;
+	std::string FileName;
+
+	std::unordered_map<const void*, uint32_t> Ids;
+	std::vector<uint8_t> Resources;
+	std::vector<uint8_t> Calls;
+	uint32_t ResourceCount = 0;
+	uint32_t CallCount = 0;
+	size_t CallStart = 0;
+};
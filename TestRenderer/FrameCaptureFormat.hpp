@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of the capture files written by FFrameCapture and read by the Replayer. Kept free of
+// Windows headers so the replayer builds anywhere. All values are little endian.
+//
+// SCaptureFileHeader
+// ResourceCount x (SCaptureResourceHeader, DataSize bytes)
+// CallCount x (SCaptureCallHeader, PayloadSize bytes)
+//
+// Resources are numbered in the order the frame first uses them. Buffer data is the contents,
+// texture data is every subresource, slice major, with tightly packed rows, shader data is the
+// bytecode and input layout data is a list of SCaptureInputElement.
+
+static constexpr uint32_t CAPTURE_MAGIC = 0x50414352; // "RCAP"
+static constexpr uint32_t CAPTURE_VERSION = 1;
+// stands in for null resources
+static constexpr uint32_t CAPTURE_INVALID_ID = 0xFFFFFFFF;
+
+enum class ECaptureResource : uint8_t
+{
+	BUFFER,
+	TEXTURE,
+	VERTEX_SHADER,
+	PIXEL_SHADER,
+	COMPUTE_SHADER,
+	INPUT_LAYOUT
+};
+
+// Payloads are sequences of 32 bit values, ids refer to resources, floats are stored as is.
+enum class ECaptureCall : uint8_t
+{
+	CLEAR_RENDER_TARGET,		// Texture, R, G, B, A
+	CLEAR_DEPTH_STENCIL,		// Texture, ClearFlags, Depth, Stencil
+	UNBIND_RENDER_TARGETS,
+	SET_CONSTANT_BUFFER,		// Buffer, Stage, Slot
+	SET_VIEWPORT,				// Width, Height, XOffset, YOffset, MinDepth, MaxDepth
+	SET_SHADER,					// Stage, VertexShader, InputLayout, PixelShader, ComputeShader
+	SET_RENDER_TARGETS,			// Count, DepthTexture, Count x Texture
+	SET_TEXTURE,				// Slot, Texture
+	SET_PRIMITIVE_TOPOLOGY,		// Topology
+	SET_VERTEX_BUFFER,			// Slot, Buffer, Stride, Offset
+	SET_INDEX_BUFFER,			// Buffer, Offset, indices are always 32 bit
+	SET_COMPUTE_TEXTURE,		// Slot, Texture
+	SET_COMPUTE_BUFFER,			// Slot, Buffer
+	SET_READ_WRITE_TEXTURE,		// Slot, Texture
+	SET_READ_WRITE_BUFFER,		// Slot, Buffer
+	UNBIND_COMPUTE_RESOURCES,
+	DISPATCH,					// GroupCountX, GroupCountY, GroupCountZ
+	DRAW,						// VertexCount, VertexLocationStart
+	DRAW_INDEXED,				// IndexCount, IndexLocationStart, VertexLocationBase
+	UPDATE_SUBRESOURCE,			// Buffer, ByteSize, ByteSize bytes padded to 4
+	COUNT
+};
+
+struct SCaptureFileHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t ResourceCount;
+	uint32_t CallCount;
+};
+
+struct SCaptureResourceHeader
+{
+	uint32_t Id;
+	ECaptureResource Type;
+	uint8_t Reserved[3];
+	// byte size for buffers
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t ArraySize;
+	uint32_t MipLevels;
+	// DXGI_FORMAT value
+	uint32_t Format;
+	uint32_t Stride;
+	uint32_t BindFlags;
+	uint32_t DataSize;
+};
+
+struct SCaptureCallHeader
+{
+	ECaptureCall Call;
+	uint8_t Reserved[3];
+	uint32_t PayloadSize;
+};
+
+struct SCaptureInputElement
+{
+	char SemanticName[32];
+	uint32_t SemanticIndex;
+	uint32_t Format;
+	uint32_t InputSlot;
+	uint32_t AlignedByteOffset;
+};
+
+inline const char* GetCaptureCallName(const ECaptureCall Call) noexcept
+{
+	switch (Call)
+	{
+	case ECaptureCall::CLEAR_RENDER_TARGET: return "ClearRenderTarget";
+	case ECaptureCall::CLEAR_DEPTH_STENCIL: return "ClearDepthStencil";
+	case ECaptureCall::UNBIND_RENDER_TARGETS: return "UnbindRenderTargets";
+	case ECaptureCall::SET_CONSTANT_BUFFER: return "SetConstantBuffer";
+	case ECaptureCall::SET_VIEWPORT: return "SetViewport";
+	case ECaptureCall::SET_SHADER: return "SetShader";
+	case ECaptureCall::SET_RENDER_TARGETS: return "SetRenderTargets";
+	case ECaptureCall::SET_TEXTURE: return "SetTexture";
+	case ECaptureCall::SET_PRIMITIVE_TOPOLOGY: return "SetPrimitiveTopology";
+	case ECaptureCall::SET_VERTEX_BUFFER: return "SetVertexBuffer";
+	case ECaptureCall::SET_INDEX_BUFFER: return "SetIndexBuffer";
+	case ECaptureCall::SET_COMPUTE_TEXTURE: return "SetComputeTexture";
+	case ECaptureCall::SET_COMPUTE_BUFFER: return "SetComputeBuffer";
+	case ECaptureCall::SET_READ_WRITE_TEXTURE: return "SetReadWriteTexture";
+	case ECaptureCall::SET_READ_WRITE_BUFFER: return "SetReadWriteBuffer";
+	case ECaptureCall::UNBIND_COMPUTE_RESOURCES: return "UnbindComputeResources";
+	case ECaptureCall::DISPATCH: return "Dispatch";
+	case ECaptureCall::DRAW: return "Draw";
+	case ECaptureCall::DRAW_INDEXED: return "DrawIndexed";
+	case ECaptureCall::UPDATE_SUBRESOURCE: return "UpdateSubresource";
+	default: return "Unknown";
+	}
+}
+
+// bytes per texel of the DXGI formats the renderer creates, 0 for anything else
+inline uint32_t GetCaptureFormatSize(const uint32_t Format) noexcept
+{
+	switch (Format)
+	{
+	case 2: return 16;				// R32G32B32A32_FLOAT
+	case 6: return 12;				// R32G32B32_FLOAT
+	case 10:						// R16G16B16A16_FLOAT
+	case 11:						// R16G16B16A16_UNORM
+	case 16: return 8;				// R32G32_FLOAT
+	case 28:						// R8G8B8A8_UNORM
+	case 29:						// R8G8B8A8_UNORM_SRGB
+	case 40:						// D32_FLOAT
+	case 41:						// R32_FLOAT
+	case 42:						// R32_UINT
+	case 44:						// R24G8_TYPELESS
+	case 45:						// D24_UNORM_S8_UINT
+	case 87:						// B8G8R8A8_UNORM
+	case 91: return 4;				// B8G8R8A8_UNORM_SRGB
+	case 54:						// R16_FLOAT
+	case 56:						// R16_UNORM
+	case 57: return 2;				// R16_UINT
+	case 61: return 1;				// R8_UNORM
+	default: return 0;
+	}
+}
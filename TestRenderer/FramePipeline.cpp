@@ -0,0 +1,211 @@
+#include "FramePipeline.hpp"
+#include "TripleBuffer.hpp"
+
+#include <chrono>
+#include <memory>
+
+FUpdateThread::~FUpdateThread()
+{
+	Stop();
+}
+
+void FUpdateThread::Start(std::function<void()> InStep)
+{
+	Stop();
+	Step = std::move(InStep);
+	bPending = false;
+	bQuit = false;
+	Thread = std::thread(&FUpdateThread::ThreadMain, this);
+}
+
+void FUpdateThread::Stop() noexcept
+{
+	if (!Thread.joinable())
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		bQuit = true;
+	}
+	Condition.notify_one();
+	Thread.join();
+}
+
+void FUpdateThread::Notify() noexcept
+{
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		bPending = true;
+	}
+	Condition.notify_one();
+}
+
+bool FUpdateThread::IsRunning() const noexcept
+{
+	return Thread.joinable();
+}
+
+void FUpdateThread::ThreadMain() noexcept
+{
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			Condition.wait(Lock, [this]() { return bPending || bQuit; });
+			if (bQuit)
+			{
+				return;
+			}
+			bPending = false;
+		}
+		Step();
+	}
+}
+
+namespace
+{
+	using FClock = std::chrono::steady_clock;
+
+	// the fields are written and checked spread over the loads, a snapshot shared between the
+	// threads would show fields of two frames
+	static constexpr size_t SNAPSHOT_FIELDS = 32;
+
+	struct SSnapshot
+	{
+		uint64_t Frame;
+		uint64_t Fields[SNAPSHOT_FIELDS];
+	};
+
+	struct SChecks
+	{
+		uint64_t LastFrame = 0;
+		uint64_t Torn = 0;
+		uint64_t OutOfOrder = 0;
+	};
+
+	void Spin(const FClock::time_point Until) noexcept
+	{
+		while (FClock::now() < Until)
+		{
+		}
+	}
+
+	FClock::duration ToDuration(const double Milliseconds) noexcept
+	{
+		return std::chrono::duration_cast<FClock::duration>(std::chrono::duration<double, std::milli>(Milliseconds));
+	}
+
+	void SimulateUpdate(SSnapshot& Snapshot, const uint64_t Frame, const FClock::duration Load) noexcept
+	{
+		const auto Start = FClock::now();
+		Snapshot.Frame = Frame;
+		for (size_t Field = 0; Field < SNAPSHOT_FIELDS; ++Field)
+		{
+			Spin(Start + Load * (Field + 1) / SNAPSHOT_FIELDS);
+			Snapshot.Fields[Field] = Frame * SNAPSHOT_FIELDS + Field;
+		}
+	}
+
+	void SimulateRender(const SSnapshot& Snapshot, SChecks& Checks, const FClock::duration Load) noexcept
+	{
+		const auto Start = FClock::now();
+		const auto Frame = Snapshot.Frame;
+		bool bTorn = false;
+		for (size_t Field = 0; Field < SNAPSHOT_FIELDS; ++Field)
+		{
+			Spin(Start + Load * (Field + 1) / SNAPSHOT_FIELDS);
+			bTorn |= Snapshot.Fields[Field] != Frame * SNAPSHOT_FIELDS + Field;
+		}
+		bTorn |= Snapshot.Frame != Frame;
+		Checks.Torn += bTorn;
+		Checks.OutOfOrder += Frame < Checks.LastFrame;
+		Checks.LastFrame = Frame;
+	}
+}
+
+SFramePipelineRun RunSerialFrames(const double UpdateMilliseconds, const double RenderMilliseconds, const uint32_t FrameCount)
+{
+	const auto UpdateLoad = ToDuration(UpdateMilliseconds);
+	const auto RenderLoad = ToDuration(RenderMilliseconds);
+	SSnapshot Snapshot{};
+	SChecks Checks{};
+	const auto Start = FClock::now();
+	for (uint64_t Frame = 1; Frame <= FrameCount; ++Frame)
+	{
+		SimulateUpdate(Snapshot, Frame, UpdateLoad);
+		SimulateRender(Snapshot, Checks, RenderLoad);
+	}
+
+	SFramePipelineRun Run{};
+	Run.Seconds = std::chrono::duration<double>(FClock::now() - Start).count();
+	Run.TornSnapshots = Checks.Torn;
+	Run.OutOfOrderSnapshots = Checks.OutOfOrder;
+	return Run;
+}
+
+SFramePipelineRun RunPipelinedFrames(const double UpdateMilliseconds, const double RenderMilliseconds, const uint32_t FrameCount)
+{
+	const auto UpdateLoad = ToDuration(UpdateMilliseconds);
+	const auto RenderLoad = ToDuration(RenderMilliseconds);
+	// a few KiB of padded slots, kept off the stack of whoever runs the benchmark
+	auto Inputs = std::make_unique<TTripleBuffer<uint64_t>>();
+	auto Snapshots = std::make_unique<TTripleBuffer<SSnapshot>>();
+	FUpdateThread Thread;
+	Thread.Start([&Inputs, &Snapshots, UpdateLoad]()
+	{
+		if (!Inputs->Update())
+		{
+			return;
+		}
+		SimulateUpdate(Snapshots->GetWriteBuffer(), Inputs->GetReadBuffer(), UpdateLoad);
+		Snapshots->Publish();
+	});
+
+	SFramePipelineRun Run{};
+	SChecks Checks{};
+	uint64_t FreshFrames = 0;
+	uint64_t Frame = 0;
+	const auto Start = FClock::now();
+	while (FreshFrames < FrameCount)
+	{
+		Inputs->GetWriteBuffer() = ++Frame;
+		Inputs->Publish();
+		Thread.Notify();
+
+		if (Snapshots->Update())
+		{
+			++FreshFrames;
+		}
+		else if (Checks.LastFrame > 0)
+		{
+			++Run.RepeatedSnapshots;
+		}
+		if (Snapshots->GetReadBuffer().Frame > 0)
+		{
+			SimulateRender(Snapshots->GetReadBuffer(), Checks, RenderLoad);
+		}
+	}
+	Run.Seconds = std::chrono::duration<double>(FClock::now() - Start).count();
+	Thread.Stop();
+	Run.TornSnapshots = Checks.Torn;
+	Run.OutOfOrderSnapshots = Checks.OutOfOrder;
+	return Run;
+}
+
+SFramePipelineBenchmark RunFramePipelineBenchmark(const double UpdateMilliseconds, const double RenderMilliseconds, const uint32_t FrameCount)
+{
+	SFramePipelineBenchmark Result{};
+	if (FrameCount == 0)
+	{
+		return Result;
+	}
+	const auto Serial = RunSerialFrames(UpdateMilliseconds, RenderMilliseconds, FrameCount);
+	const auto Pipelined = RunPipelinedFrames(UpdateMilliseconds, RenderMilliseconds, FrameCount);
+	Result.SerialFramesPerSecond = FrameCount / Serial.Seconds;
+	Result.PipelinedFramesPerSecond = FrameCount / Pipelined.Seconds;
+	Result.RepeatedSnapshots = Pipelined.RepeatedSnapshots;
+	Result.TornSnapshots = Serial.TornSnapshots + Pipelined.TornSnapshots;
+	Result.OutOfOrderSnapshots = Serial.OutOfOrderSnapshots + Pipelined.OutOfOrderSnapshots;
+	return Result;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Runs Step on a thread of its own once per Notify. Notifications arriving while a step runs are
+// merged into one more step, the step picks up the newest input from a triple buffer anyway.
+// The mutex only guards the wakeup, the frame data itself never goes through it.
+class FUpdateThread
+{
+public:
+	FUpdateThread() = default;
+	~FUpdateThread();
+
+	FUpdateThread(const FUpdateThread&) = delete;
+	FUpdateThread& operator=(const FUpdateThread&) = delete;
+
+	void Start(std::function<void()> Step);
+	// returns once the running step finished, pending notifications are dropped
+	void Stop() noexcept;
+	void Notify() noexcept;
+	bool IsRunning() const noexcept;
+
+private:
+	void ThreadMain() noexcept;
+
+	std::function<void()> Step;
+	std::thread Thread;
+	std::mutex Mutex;
+	std::condition_variable Condition;
+	bool bPending = false;
+	bool bQuit = false;
+};
+
+struct SFramePipelineBenchmark
+{
+	double SerialFramesPerSecond = 0.0;
+	// frames rendered with a snapshot the render side had not seen before
+	double PipelinedFramesPerSecond = 0.0;
+	// frames rendered again with the previous snapshot because the update was not done yet
+	uint64_t RepeatedSnapshots = 0;
+	// snapshots mixing fields of different frames or older than one rendered before, both have to stay 0
+	uint64_t TornSnapshots = 0;
+	uint64_t OutOfOrderSnapshots = 0;
+};
+
+struct SFramePipelineRun
+{
+	double Seconds = 0.0;
+	uint64_t RepeatedSnapshots = 0;
+	uint64_t TornSnapshots = 0;
+	uint64_t OutOfOrderSnapshots = 0;
+};
+
+// FrameCount frames of synthetic busy update and render loads one after the other on the calling
+// thread
+SFramePipelineRun RunSerialFrames(const double UpdateMilliseconds, const double RenderMilliseconds, const uint32_t FrameCount);
+// the same until FrameCount frames were rendered with a fresh snapshot, with the update on an
+// FUpdateThread handing snapshots over through a triple buffer and the calling thread rendering
+SFramePipelineRun RunPipelinedFrames(const double UpdateMilliseconds, const double RenderMilliseconds, const uint32_t FrameCount);
+// both of the above
+SFramePipelineBenchmark RunFramePipelineBenchmark(const double UpdateMilliseconds, const double RenderMilliseconds, const uint32_t FrameCount);
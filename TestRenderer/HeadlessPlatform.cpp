@@ -0,0 +1,49 @@
+#include "HeadlessPlatform.hpp"
+
+FHeadlessPlatform::FHeadlessPlatform(const uint32_t Width, const uint32_t Height, const uint64_t FrameCount, const double TimeStep) noexcept
+	: Width(Width)
+	, Height(Height)
+	, FrameCount(FrameCount)
+	, TimeStep(TimeStep)
+{
+}
+
+bool FHeadlessPlatform::PumpEvents() noexcept
+{
+	if (Frame >= FrameCount)
+	{
+		return false;
+	}
+	++Frame;
+	return true;
+}
+
+double FHeadlessPlatform::GetTime() noexcept
+{
+	return static_cast<double>(Frame) * TimeStep;
+}
+
+uint32_t FHeadlessPlatform::GetWidth() const noexcept
+{
+	return Width;
+}
+
+uint32_t FHeadlessPlatform::GetHeight() const noexcept
+{
+	return Height;
+}
+
+bool FHeadlessPlatform::ConsumeResize() noexcept
+{
+	return false;
+}
+
+void* FHeadlessPlatform::GetNativeWindow() const noexcept
+{
+	return nullptr;
+}
+
+uint64_t FHeadlessPlatform::GetFrame() const noexcept
+{
+	return Frame;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Platform.hpp"
+
+// No window and no input. Time advances by a fixed step per pumped frame so runs are repeatable,
+// PumpEvents returns false after FrameCount frames.
+class FHeadlessPlatform final : public FPlatform
+{
+public:
+	explicit FHeadlessPlatform(const uint32_t Width, const uint32_t Height, const uint64_t FrameCount, const double TimeStep = 1.0 / 60.0) noexcept;
+
+	bool PumpEvents() noexcept override;
+	double GetTime() noexcept override;
+	uint32_t GetWidth() const noexcept override;
+	uint32_t GetHeight() const noexcept override;
+	bool ConsumeResize() noexcept override;
+	void* GetNativeWindow() const noexcept override;
+
+	uint64_t GetFrame() const noexcept;
+
+private:
+	uint32_t Width;
+	uint32_t Height;
+	uint64_t FrameCount;
+	double TimeStep;
+	uint64_t Frame = 0;
+};
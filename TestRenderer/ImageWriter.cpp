@@ -0,0 +1,410 @@
+#include "ImageWriter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	// deflate stored blocks hold at most this many bytes
+	constexpr uint32_t STORED_BLOCK_SIZE = 65535;
+	// rows go into IDAT chunks of about this size
+	constexpr size_t CHUNK_SIZE = 1 << 22;
+
+	uint32_t UpdateCrc(uint32_t Crc, const uint8_t* Data, const size_t Size) noexcept
+	{
+		static const auto Table = []()
+		{
+			std::array<uint32_t, 256> Values{};
+			for (uint32_t Index = 0; Index < 256; ++Index)
+			{
+				uint32_t Value = Index;
+				for (int Bit = 0; Bit < 8; ++Bit)
+				{
+					Value = Value & 1 ? 0xEDB88320u ^ Value >> 1 : Value >> 1;
+				}
+				Values[Index] = Value;
+			}
+			return Values;
+		}();
+		for (size_t Index = 0; Index < Size; ++Index)
+		{
+			Crc = Table[(Crc ^ Data[Index]) & 0xFF] ^ Crc >> 8;
+		}
+		return Crc;
+	}
+
+	uint32_t UpdateAdler(const uint32_t Adler, const uint8_t* Data, size_t Size) noexcept
+	{
+		uint32_t A = Adler & 0xFFFF;
+		uint32_t B = Adler >> 16;
+		while (Size > 0)
+		{
+			// the most bytes before B can overflow 32 bits
+			const size_t Count = std::min<size_t>(Size, 5552);
+			for (size_t Index = 0; Index < Count; ++Index)
+			{
+				A += Data[Index];
+				B += A;
+			}
+			A %= 65521;
+			B %= 65521;
+			Data += Count;
+			Size -= Count;
+		}
+		return B << 16 | A;
+	}
+
+	void PutBigEndian(uint8_t* Data, const uint32_t Value) noexcept
+	{
+		Data[0] = static_cast<uint8_t>(Value >> 24);
+		Data[1] = static_cast<uint8_t>(Value >> 16);
+		Data[2] = static_cast<uint8_t>(Value >> 8);
+		Data[3] = static_cast<uint8_t>(Value);
+	}
+
+	// the Size lowest bytes of Value, EXR is little endian
+	void Append(std::vector<uint8_t>& Data, const uint64_t Value, const size_t Size)
+	{
+		for (size_t Byte = 0; Byte < Size; ++Byte)
+		{
+			Data.push_back(static_cast<uint8_t>(Value >> Byte * 8));
+		}
+	}
+
+	// with its terminating zero
+	void AppendString(std::vector<uint8_t>& Data, const char* String)
+	{
+		Data.insert(Data.end(), String, String + strlen(String) + 1);
+	}
+
+	void AppendAttribute(std::vector<uint8_t>& Data, const char* Name, const char* Type, const uint32_t Size)
+	{
+		AppendString(Data, Name);
+		AppendString(Data, Type);
+		Append(Data, Size, 4);
+	}
+
+	// rounds to nearest even, Value is finite and not negative
+	uint16_t FloatToHalf(const float Value) noexcept
+	{
+		uint32_t Bits;
+		memcpy(&Bits, &Value, sizeof(Bits));
+		const int32_t Exponent = static_cast<int32_t>(Bits >> 23 & 0xFF) - 127 + 15;
+		uint32_t Mantissa = Bits & 0x7FFFFF;
+		if (Exponent >= 31)
+		{
+			return 0x7C00;
+		}
+		if (Exponent < -10)
+		{
+			return 0;
+		}
+		// a denormal half keeps the implicit bit in its mantissa
+		uint32_t Shift = 13;
+		uint32_t Half = static_cast<uint32_t>(std::max(Exponent, 0)) << 10;
+		if (Exponent <= 0)
+		{
+			Mantissa |= 0x800000;
+			Shift = static_cast<uint32_t>(14 - Exponent);
+		}
+		Half |= Mantissa >> Shift;
+		const uint32_t Rest = Mantissa & ((1u << Shift) - 1);
+		const uint32_t HalfWay = 1u << (Shift - 1);
+		// a carry out of the mantissa moves into the exponent, which is the rounded value
+		if (Rest > HalfWay || (Rest == HalfWay && (Half & 1) != 0))
+		{
+			++Half;
+		}
+		return static_cast<uint16_t>(Half);
+	}
+
+	// halfs of the 8 bit values, decoded from sRGB for color and as they are for alpha
+	const std::array<uint16_t, 256>& GetHalfTable(const bool bIsColor)
+	{
+		static const auto Tables = []()
+		{
+			std::array<std::array<uint16_t, 256>, 2> Values{};
+			for (uint32_t Index = 0; Index < 256; ++Index)
+			{
+				const float Value = Index / 255.0f;
+				Values[0][Index] = FloatToHalf(Value);
+				Values[1][Index] = FloatToHalf(Value <= 0.04045f ? Value / 12.92f : std::pow((Value + 0.055f) / 1.055f, 2.4f));
+			}
+			return Values;
+		}();
+		return Tables[bIsColor ? 1 : 0];
+	}
+}
+
+FPngWriter::~FPngWriter()
+{
+	Close();
+}
+
+bool FPngWriter::WriteChunk(const char* Type, const uint8_t* Data, const size_t Size) noexcept
+{
+	uint8_t Header[8];
+	PutBigEndian(Header, static_cast<uint32_t>(Size));
+	std::copy(Type, Type + 4, Header + 4);
+	uint8_t Crc[4];
+	PutBigEndian(Crc, ~UpdateCrc(UpdateCrc(~0u, Header + 4, 4), Data, Size));
+	bFailed = bFailed || fwrite(Header, sizeof(Header), 1, File) != 1 || (Size > 0 && fwrite(Data, Size, 1, File) != 1) || fwrite(Crc, sizeof(Crc), 1, File) != 1;
+	BytesWritten += sizeof(Header) + Size + sizeof(Crc);
+	return !bFailed;
+}
+
+bool FPngWriter::Open(const char* FileName, const uint32_t InWidth, const uint32_t InHeight)
+{
+	Close();
+	// a row, its filter byte and 4 bytes per pixel, has to fit the 31 bit sizes of the format
+	if (InWidth == 0 || InHeight == 0 || InWidth > (1u << 29) || InHeight > (1u << 31) - 1)
+	{
+		return false;
+	}
+	File = fopen(FileName, "wb");
+	if (File == nullptr)
+	{
+		return false;
+	}
+	Width = InWidth;
+	Height = InHeight;
+	RowsWritten = 0;
+	bFailed = false;
+	BytesWritten = 0;
+	Adler = 1;
+	BlockLeft = 0;
+	DataLeft = static_cast<uint64_t>(Height) * (1 + static_cast<uint64_t>(Width) * 4);
+
+	static const uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	bFailed = fwrite(Signature, sizeof(Signature), 1, File) != 1;
+	BytesWritten = sizeof(Signature);
+	// 8 bits per channel, color type 6 is RGBA, no interlacing
+	uint8_t Header[13] = {};
+	PutBigEndian(Header, Width);
+	PutBigEndian(Header + 4, Height);
+	Header[8] = 8;
+	Header[9] = 6;
+	const uint8_t Srgb = 0;
+	return WriteChunk("IHDR", Header, sizeof(Header)) && WriteChunk("sRGB", &Srgb, 1);
+}
+
+bool FPngWriter::WriteRows(const uint32_t* Pixels, const uint32_t RowCount)
+{
+	if (File == nullptr || bFailed || RowCount > Height - RowsWritten)
+	{
+		return false;
+	}
+	const size_t RowSize = 1 + static_cast<size_t>(Width) * 4;
+	const uint32_t ChunkRows = static_cast<uint32_t>(std::max<size_t>(1, CHUNK_SIZE / RowSize));
+	for (uint32_t First = 0; First < RowCount; First += ChunkRows)
+	{
+		const uint32_t Count = std::min(ChunkRows, RowCount - First);
+		Chunk.clear();
+		if (RowsWritten == 0 && First == 0)
+		{
+			// zlib header, deflate with a 32K window and no preset dictionary
+			Chunk.push_back(0x78);
+			Chunk.push_back(0x01);
+		}
+		for (uint32_t Row = 0; Row < Count; ++Row)
+		{
+			// filter type none, then the pixels byte by byte
+			const uint32_t* Source = Pixels + static_cast<size_t>(First + Row) * Width;
+			RowBytes.resize(RowSize);
+			RowBytes[0] = 0;
+			for (uint32_t X = 0; X < Width; ++X)
+			{
+				RowBytes[1 + X * 4] = static_cast<uint8_t>(Source[X]);
+				RowBytes[2 + X * 4] = static_cast<uint8_t>(Source[X] >> 8);
+				RowBytes[3 + X * 4] = static_cast<uint8_t>(Source[X] >> 16);
+				RowBytes[4 + X * 4] = static_cast<uint8_t>(Source[X] >> 24);
+			}
+			Adler = UpdateAdler(Adler, RowBytes.data(), RowSize);
+
+			// with a block header wherever a block ends
+			for (size_t Byte = 0; Byte < RowSize;)
+			{
+				if (BlockLeft == 0)
+				{
+					BlockLeft = static_cast<uint32_t>(std::min<uint64_t>(DataLeft, STORED_BLOCK_SIZE));
+					const uint8_t BlockHeader[5] = { static_cast<uint8_t>(DataLeft == BlockLeft ? 1 : 0), static_cast<uint8_t>(BlockLeft), static_cast<uint8_t>(BlockLeft >> 8),
+						static_cast<uint8_t>(~BlockLeft), static_cast<uint8_t>(~BlockLeft >> 8) };
+					Chunk.insert(Chunk.end(), BlockHeader, BlockHeader + sizeof(BlockHeader));
+				}
+				const size_t Run = std::min<size_t>(BlockLeft, RowSize - Byte);
+				Chunk.insert(Chunk.end(), RowBytes.begin() + Byte, RowBytes.begin() + Byte + Run);
+				Byte += Run;
+				BlockLeft -= static_cast<uint32_t>(Run);
+				DataLeft -= Run;
+			}
+		}
+		RowsWritten += Count;
+		if (RowsWritten == Height)
+		{
+			Chunk.resize(Chunk.size() + 4);
+			PutBigEndian(Chunk.data() + Chunk.size() - 4, Adler);
+		}
+		if (!WriteChunk("IDAT", Chunk.data(), Chunk.size()))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FPngWriter::Close() noexcept
+{
+	if (File == nullptr)
+	{
+		return false;
+	}
+	const bool bComplete = RowsWritten == Height && WriteChunk("IEND", nullptr, 0);
+	bFailed = fclose(File) != 0 || bFailed;
+	File = nullptr;
+	Chunk = std::vector<uint8_t>();
+	RowBytes = std::vector<uint8_t>();
+	return bComplete && !bFailed;
+}
+
+FExrWriter::~FExrWriter()
+{
+	Close();
+}
+
+bool FExrWriter::Write(const std::vector<uint8_t>& Data) noexcept
+{
+	bFailed = bFailed || (!Data.empty() && fwrite(Data.data(), Data.size(), 1, File) != 1);
+	BytesWritten += Data.size();
+	return !bFailed;
+}
+
+bool FExrWriter::Open(const char* FileName, const uint32_t InWidth, const uint32_t InHeight)
+{
+	Close();
+	// the size of a block, four channels of two bytes per pixel, is a 32 bit int
+	if (InWidth == 0 || InHeight == 0 || InWidth > (1u << 27) || InHeight > (1u << 31) - 1)
+	{
+		return false;
+	}
+	File = fopen(FileName, "wb");
+	if (File == nullptr)
+	{
+		return false;
+	}
+	Width = InWidth;
+	Height = InHeight;
+	RowsWritten = 0;
+	bFailed = false;
+	BytesWritten = 0;
+
+	// magic number, version 2 with none of the flags: a single part scanline image
+	Blocks.clear();
+	Append(Blocks, 20000630, 4);
+	Append(Blocks, 2, 4);
+	// channels are listed by name, each is half (1), not linearly perceived, not subsampled
+	AppendAttribute(Blocks, "channels", "chlist", 4 * 18 + 1);
+	for (const char* Channel : { "A", "B", "G", "R" })
+	{
+		AppendString(Blocks, Channel);
+		Append(Blocks, 1, 4);
+		Append(Blocks, 0, 4);
+		Append(Blocks, 1, 4);
+		Append(Blocks, 1, 4);
+	}
+	Blocks.push_back(0);
+	AppendAttribute(Blocks, "compression", "compression", 1);
+	Blocks.push_back(0);
+	for (const char* Window : { "dataWindow", "displayWindow" })
+	{
+		AppendAttribute(Blocks, Window, "box2i", 16);
+		Append(Blocks, 0, 4);
+		Append(Blocks, 0, 4);
+		Append(Blocks, Width - 1, 4);
+		Append(Blocks, Height - 1, 4);
+	}
+	// increasing y
+	AppendAttribute(Blocks, "lineOrder", "lineOrder", 1);
+	Blocks.push_back(0);
+	AppendAttribute(Blocks, "pixelAspectRatio", "float", 4);
+	Append(Blocks, 0x3F800000, 4);
+	AppendAttribute(Blocks, "screenWindowCenter", "v2f", 8);
+	Append(Blocks, 0, 8);
+	AppendAttribute(Blocks, "screenWindowWidth", "float", 4);
+	Append(Blocks, 0x3F800000, 4);
+	Blocks.push_back(0);
+
+	// every block is the same size, its y and data size followed by the row
+	const uint64_t BlockSize = 8 + static_cast<uint64_t>(Width) * 8;
+	const uint64_t FirstBlock = Blocks.size() + static_cast<uint64_t>(Height) * 8;
+	for (uint32_t Y = 0; Y < Height; ++Y)
+	{
+		Append(Blocks, FirstBlock + Y * BlockSize, 8);
+		if (Blocks.size() >= CHUNK_SIZE)
+		{
+			if (!Write(Blocks))
+			{
+				return false;
+			}
+			Blocks.clear();
+		}
+	}
+	return Write(Blocks);
+}
+
+bool FExrWriter::WriteRows(const uint32_t* Pixels, const uint32_t RowCount)
+{
+	if (File == nullptr || bFailed || RowCount > Height - RowsWritten)
+	{
+		return false;
+	}
+	const auto& Alpha = GetHalfTable(false);
+	const auto& Color = GetHalfTable(true);
+	Blocks.clear();
+	for (uint32_t Row = 0; Row < RowCount; ++Row)
+	{
+		const uint32_t* Source = Pixels + static_cast<size_t>(Row) * Width;
+		Append(Blocks, RowsWritten + Row, 4);
+		Append(Blocks, Width * 8, 4);
+		// channels one after the other in the order of the list, alpha first
+		const size_t Start = Blocks.size();
+		Blocks.resize(Start + static_cast<size_t>(Width) * 8);
+		uint8_t* Channels = Blocks.data() + Start;
+		for (uint32_t Channel = 0; Channel < 4; ++Channel)
+		{
+			const auto& Table = Channel == 0 ? Alpha : Color;
+			const uint32_t Shift = 24 - Channel * 8;
+			uint8_t* Destination = Channels + static_cast<size_t>(Channel) * Width * 2;
+			for (uint32_t X = 0; X < Width; ++X)
+			{
+				const uint16_t Half = Table[Source[X] >> Shift & 0xFF];
+				Destination[X * 2] = static_cast<uint8_t>(Half);
+				Destination[X * 2 + 1] = static_cast<uint8_t>(Half >> 8);
+			}
+		}
+		if (Blocks.size() >= CHUNK_SIZE || Row + 1 == RowCount)
+		{
+			if (!Write(Blocks))
+			{
+				return false;
+			}
+			Blocks.clear();
+		}
+	}
+	RowsWritten += RowCount;
+	return true;
+}
+
+bool FExrWriter::Close() noexcept
+{
+	if (File == nullptr)
+	{
+		return false;
+	}
+	const bool bComplete = RowsWritten == Height;
+	bFailed = fclose(File) != 0 || bFailed;
+	File = nullptr;
+	Blocks = std::vector<uint8_t>();
+	return bComplete && !bFailed;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Writes an 8 bit RGBA PNG a few rows at a time, so images larger than memory can be written as
+// they are produced. The pixel data goes into stored deflate blocks, uncompressed, which is
+// what makes it possible to stream without a compressor. Color is tagged sRGB.
+class FPngWriter
+{
+public:
+	FPngWriter() = default;
+	~FPngWriter();
+
+	FPngWriter(const FPngWriter&) = delete;
+	FPngWriter& operator=(const FPngWriter&) = delete;
+
+	bool Open(const char* FileName, const uint32_t Width, const uint32_t Height);
+	// RowCount rows of Width pixels from the top down, red in the lowest byte like STexGenImage
+	bool WriteRows(const uint32_t* Pixels, const uint32_t RowCount);
+	// false when a write failed or rows are missing, the file is incomplete then
+	bool Close() noexcept;
+
+	uint64_t GetBytesWritten() const noexcept { return BytesWritten; }
+
+private:
+	bool WriteChunk(const char* Type, const uint8_t* Data, const size_t Size) noexcept;
+
+	FILE* File = nullptr;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t RowsWritten = 0;
+	bool bFailed = false;
+	uint64_t BytesWritten = 0;
+	// of the filtered rows, which the zlib stream ends with
+	uint32_t Adler = 1;
+	// stored block bytes left until the next block header
+	uint32_t BlockLeft = 0;
+	uint64_t DataLeft = 0;
+	std::vector<uint8_t> Chunk;
+	std::vector<uint8_t> RowBytes;
+};
+
+// Writes a scanline OpenEXR image with half float RGBA channels a few rows at a time, like FPngWriter
+// and from the same pixels. Blocks are uncompressed, one row each, so the offset table at the start
+// of the file is known before any row is. The sRGB color is decoded to linear, which EXR readers
+// expect, alpha is stored as it is.
+class FExrWriter
+{
+public:
+	FExrWriter() = default;
+	~FExrWriter();
+
+	FExrWriter(const FExrWriter&) = delete;
+	FExrWriter& operator=(const FExrWriter&) = delete;
+
+	bool Open(const char* FileName, const uint32_t Width, const uint32_t Height);
+	bool WriteRows(const uint32_t* Pixels, const uint32_t RowCount);
+	bool Close() noexcept;
+
+	uint64_t GetBytesWritten() const noexcept { return BytesWritten; }
+
+private:
+	bool Write(const std::vector<uint8_t>& Data) noexcept;
+
+	FILE* File = nullptr;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t RowsWritten = 0;
+	bool bFailed = false;
+	uint64_t BytesWritten = 0;
+	std::vector<uint8_t> Blocks;
+};
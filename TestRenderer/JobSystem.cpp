@@ -0,0 +1,482 @@
+#include "JobSystem.hpp"
+
+#include <cassert>
+#include <chrono>
+
+namespace
+{
+	thread_local FJobSystem* CurrentSystem = nullptr;
+	thread_local size_t CurrentWorker = 0;
+
+	// failed steal rounds before an idle worker goes to sleep
+	constexpr uint32_t SPIN_COUNT = 64;
+}
+
+bool FJobDeque::Push(SJob* Job) noexcept
+{
+	const int64_t B = Bottom.load(std::memory_order_relaxed);
+	const int64_t T = Top.load(std::memory_order_acquire);
+	if (B - T >= static_cast<int64_t>(CAPACITY))
+	{
+		return false;
+	}
+	Jobs[B & MASK].store(Job, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	Bottom.store(B + 1, std::memory_order_relaxed);
+	return true;
+}
+
+SJob* FJobDeque::Pop() noexcept
+{
+	const int64_t B = Bottom.load(std::memory_order_relaxed) - 1;
+	Bottom.store(B, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t T = Top.load(std::memory_order_relaxed);
+	if (T > B)
+	{
+		Bottom.store(B + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	SJob* Job = Jobs[B & MASK].load(std::memory_order_relaxed);
+	if (T == B)
+	{
+		// last job, a thief may be taking it at the same time
+		if (!Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			Job = nullptr;
+		}
+		Bottom.store(B + 1, std::memory_order_relaxed);
+	}
+	return Job;
+}
+
+SJob* FJobDeque::Steal() noexcept
+{
+	int64_t T = Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64_t B = Bottom.load(std::memory_order_acquire);
+	if (T >= B)
+	{
+		return nullptr;
+	}
+
+	SJob* Job = Jobs[T & MASK].load(std::memory_order_relaxed);
+	if (!Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		return nullptr;
+	}
+	return Job;
+}
+
+bool FJobDeque::IsEmpty() const noexcept
+{
+	return Bottom.load(std::memory_order_relaxed) <= Top.load(std::memory_order_relaxed);
+}
+
+FJobSystem::~FJobSystem()
+{
+	Shutdown();
+}
+
+void FJobSystem::Initialize(size_t Count)
+{
+	if (!Workers.empty())
+	{
+		return;
+	}
+	ThreadCount = Count > 0 ? Count : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+	Workers.reserve(ThreadCount);
+	for (size_t Worker = 0; Worker < ThreadCount; ++Worker)
+	{
+		std::unique_ptr<SWorker> NewWorker(new SWorker());
+		NewWorker->Jobs.reset(new SJob[MAX_JOBS_PER_WORKER]);
+		for (size_t Job = 0; Job < MAX_JOBS_PER_WORKER; ++Job)
+		{
+			NewWorker->Jobs[Job].UnfinishedJobs.store(0, std::memory_order_relaxed);
+			NewWorker->Jobs[Job].bIsRun.store(false, std::memory_order_relaxed);
+		}
+		NewWorker->Random = static_cast<uint32_t>(Worker * 2654435761u + 1);
+		Workers.push_back(std::move(NewWorker));
+	}
+
+	PreviousSystem = CurrentSystem;
+	PreviousWorker = CurrentWorker;
+	CurrentSystem = this;
+	CurrentWorker = 0;
+
+	bQuit.store(false);
+	Threads.reserve(ThreadCount - 1);
+	for (size_t Worker = 1; Worker < ThreadCount; ++Worker)
+	{
+		Threads.emplace_back(&FJobSystem::WorkerMain, this, Worker);
+	}
+}
+
+void FJobSystem::Shutdown() noexcept
+{
+	if (Workers.empty())
+	{
+		return;
+	}
+
+	bQuit.store(true);
+	{
+		std::lock_guard<std::mutex> Lock(SleepMutex);
+		SleepCondition.notify_all();
+	}
+	for (auto& Thread : Threads)
+	{
+		Thread.join();
+	}
+	Threads.clear();
+	Workers.clear();
+	ThreadCount = 0;
+
+	CurrentSystem = PreviousSystem;
+	CurrentWorker = PreviousWorker;
+}
+
+SJob* FJobSystem::AllocateJob(SJob* Parent) noexcept
+{
+	assert(CurrentSystem == this && "jobs can only be created on worker threads");
+	auto& Worker = *Workers[CurrentWorker];
+
+	// a slot still holding a job that was never run would only free up once its creator runs it,
+	// which may be after this allocation, so such slots are skipped
+	SJob* Job = nullptr;
+	for (size_t Skipped = 0; ; ++Skipped)
+	{
+		Job = &Worker.Jobs[Worker.NextJob++ & (MAX_JOBS_PER_WORKER - 1)];
+		if (Job->UnfinishedJobs.load(std::memory_order_acquire) == 0 || Job->bIsRun.load(std::memory_order_acquire))
+		{
+			break;
+		}
+		assert(Skipped < MAX_JOBS_PER_WORKER && "every job slot of this worker holds a job that was not run yet");
+	}
+
+	// the ring wrapped around onto a job that has not finished yet, help until it has
+	while (Job->UnfinishedJobs.load(std::memory_order_acquire) > 0)
+	{
+		if (!ExecuteOne())
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	Job->Function = nullptr;
+	Job->Parent = Parent;
+	Job->UnfinishedJobs.store(1, std::memory_order_relaxed);
+	Job->Dependencies.store(1, std::memory_order_relaxed);
+	Job->ContinuationCount.store(0, std::memory_order_relaxed);
+	Job->bIsRun.store(false, std::memory_order_relaxed);
+	if (Parent)
+	{
+		Parent->UnfinishedJobs.fetch_add(1, std::memory_order_relaxed);
+	}
+	return Job;
+}
+
+void FJobSystem::AddDependency(SJob* Job, SJob* Prerequisite) noexcept
+{
+	const auto Index = Prerequisite->ContinuationCount.fetch_add(1, std::memory_order_relaxed);
+	assert(Index < SJob::MAX_CONTINUATIONS);
+	Prerequisite->Continuations[Index] = Job;
+	Job->Dependencies.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FJobSystem::Run(SJob* Job) noexcept
+{
+	Job->bIsRun.store(true, std::memory_order_release);
+	if (Job->Dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		Push(Job);
+	}
+}
+
+void FJobSystem::Wait(const SJob* Job) noexcept
+{
+	while (!IsFinished(Job))
+	{
+		if (!ExecuteOne())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+bool FJobSystem::IsFinished(const SJob* Job) const noexcept
+{
+	return Job->UnfinishedJobs.load(std::memory_order_acquire) == 0;
+}
+
+bool FJobSystem::IsLocalDequeEmpty() const noexcept
+{
+	return Workers[CurrentWorker]->Deque.IsEmpty();
+}
+
+void FJobSystem::Push(SJob* Job) noexcept
+{
+	if (!Workers[CurrentWorker]->Deque.Push(Job))
+	{
+		// a full deque has plenty of work to steal already
+		Execute(Job);
+		return;
+	}
+	WakeWorkers();
+}
+
+SJob* FJobSystem::GetJob() noexcept
+{
+	auto& Worker = *Workers[CurrentWorker];
+	if (SJob* Job = Worker.Deque.Pop())
+	{
+		return Job;
+	}
+
+	// xorshift, each worker starts its round of steals at a different victim
+	Worker.Random ^= Worker.Random << 13;
+	Worker.Random ^= Worker.Random >> 17;
+	Worker.Random ^= Worker.Random << 5;
+	const size_t Start = Worker.Random % ThreadCount;
+	for (size_t Offset = 0; Offset < ThreadCount; ++Offset)
+	{
+		const size_t Victim = (Start + Offset) % ThreadCount;
+		if (Victim == CurrentWorker)
+		{
+			continue;
+		}
+		if (SJob* Job = Workers[Victim]->Deque.Steal())
+		{
+			Worker.Stolen.store(Worker.Stolen.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return Job;
+		}
+	}
+	return nullptr;
+}
+
+bool FJobSystem::ExecuteOne() noexcept
+{
+	SJob* Job = GetJob();
+	if (Job == nullptr)
+	{
+		return false;
+	}
+	Execute(Job);
+	return true;
+}
+
+void FJobSystem::Execute(SJob* Job) noexcept
+{
+	Job->Function(*Job);
+	auto& Worker = *Workers[CurrentWorker];
+	Worker.Executed.store(Worker.Executed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	Finish(Job);
+}
+
+void FJobSystem::Finish(SJob* Job) noexcept
+{
+	// the slot can be reused as soon as the count reaches zero, so everything needed
+	// afterwards is read before
+	SJob* Parent = Job->Parent;
+	const auto ContinuationCount = Job->ContinuationCount.load(std::memory_order_relaxed);
+	SJob* Continuations[SJob::MAX_CONTINUATIONS];
+	std::copy(Job->Continuations, Job->Continuations + ContinuationCount, Continuations);
+
+	if (Job->UnfinishedJobs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+	{
+		return;
+	}
+
+	for (uint32_t Index = 0; Index < ContinuationCount; ++Index)
+	{
+		if (Continuations[Index]->Dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			Push(Continuations[Index]);
+		}
+	}
+	if (Parent)
+	{
+		Finish(Parent);
+	}
+}
+
+void FJobSystem::WakeWorkers() noexcept
+{
+	WakeGeneration.fetch_add(1);
+	if (SleepingWorkers.load() > 0)
+	{
+		std::lock_guard<std::mutex> Lock(SleepMutex);
+		SleepCondition.notify_one();
+	}
+}
+
+void FJobSystem::WorkerMain(const size_t Worker) noexcept
+{
+	CurrentSystem = this;
+	CurrentWorker = Worker;
+
+	uint32_t IdleRounds = 0;
+	while (!bQuit.load(std::memory_order_acquire))
+	{
+		if (ExecuteOne())
+		{
+			IdleRounds = 0;
+			continue;
+		}
+		if (++IdleRounds < SPIN_COUNT)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// a push after reading the generation changes it, so nothing is missed between the
+		// last look at the deques and going to sleep
+		const auto Generation = WakeGeneration.load();
+		if (ExecuteOne())
+		{
+			IdleRounds = 0;
+			continue;
+		}
+		std::unique_lock<std::mutex> Lock(SleepMutex);
+		SleepingWorkers.fetch_add(1);
+		SleepCondition.wait(Lock, [this, Generation]() { return bQuit.load() || WakeGeneration.load() != Generation; });
+		SleepingWorkers.fetch_sub(1);
+		IdleRounds = 0;
+	}
+
+	CurrentSystem = nullptr;
+}
+
+size_t FJobSystem::GetThreadCount() const noexcept
+{
+	return ThreadCount;
+}
+
+SJobWorkerStatistics FJobSystem::GetWorkerStatistics(const size_t Worker) const noexcept
+{
+	SJobWorkerStatistics Statistics;
+	Statistics.Executed = Workers[Worker]->Executed.load(std::memory_order_relaxed);
+	Statistics.Stolen = Workers[Worker]->Stolen.load(std::memory_order_relaxed);
+	return Statistics;
+}
+
+FJobSystem* FJobSystem::GetCurrent() noexcept
+{
+	return CurrentSystem;
+}
+
+namespace
+{
+	// roughly 20us of dependent floating point work
+	float ForkJoinLeaf(const uint32_t Seed) noexcept
+	{
+		float Value = static_cast<float>(Seed);
+		for (uint32_t Iteration = 0; Iteration < 8192; ++Iteration)
+		{
+			Value = Value * 0.999f + 0.5f;
+		}
+		return Value;
+	}
+
+	void ForkJoin(FJobSystem& System, SJob* Parent, const uint32_t Depth, const uint32_t Seed, std::atomic<uint32_t>& Sink) noexcept
+	{
+		if (Depth == 0)
+		{
+			Sink.fetch_add(static_cast<uint32_t>(ForkJoinLeaf(Seed)), std::memory_order_relaxed);
+			return;
+		}
+		for (uint32_t Child = 0; Child < 2; ++Child)
+		{
+			System.Run(System.CreateJob([&System, Parent, Depth, Seed, Child, &Sink]()
+			{
+				ForkJoin(System, Parent, Depth - 1, Seed * 2 + Child, Sink);
+			}, Parent));
+		}
+	}
+}
+
+void FJobSystem::RunEmptyJobs(const size_t JobCount, const bool bHelp) noexcept
+{
+	SJob* Root = CreateJob([]() {});
+	for (size_t Job = 0; Job < JobCount; ++Job)
+	{
+		Run(CreateJob([]() {}, Root));
+	}
+	Run(Root);
+	if (bHelp)
+	{
+		Wait(Root);
+		return;
+	}
+	while (!IsFinished(Root))
+	{
+		std::this_thread::yield();
+	}
+}
+
+uint32_t FJobSystem::RunForkJoin(const uint32_t Depth) noexcept
+{
+	std::atomic<uint32_t> Sink{ 0 };
+	SJob* Root = CreateJob([]() {});
+	ForkJoin(*this, Root, Depth, 1, Sink);
+	Run(Root);
+	Wait(Root);
+	return Sink.load();
+}
+
+SJobBenchmark FJobSystem::RunBenchmark(const size_t MaximumThreads, const size_t JobCount)
+{
+	using FClock = std::chrono::steady_clock;
+	// every round stays well inside one worker's job ring
+	static constexpr size_t ROUND_SIZE = MAX_JOBS_PER_WORKER / 4;
+	// 2^10 leaves, the whole tree is spawned from a single root
+	static constexpr uint32_t FORK_JOIN_DEPTH = 10;
+	static constexpr uint32_t FORK_JOIN_REPETITIONS = 3;
+
+	SJobBenchmark Result;
+	const size_t RoundCount = std::max<size_t>(1, JobCount / ROUND_SIZE);
+	const auto SpawnRounds = [RoundCount](FJobSystem& System, const bool bHelp)
+	{
+		const auto Start = FClock::now();
+		for (size_t Round = 0; Round < RoundCount; ++Round)
+		{
+			System.RunEmptyJobs(ROUND_SIZE, bHelp);
+		}
+		return std::chrono::duration<double, std::nano>(FClock::now() - Start).count() / static_cast<double>(RoundCount * (ROUND_SIZE + 1));
+	};
+
+	{
+		FJobSystem System;
+		System.Initialize(1);
+		SpawnRounds(System, true);
+		Result.SpawnNanoseconds = SpawnRounds(System, true);
+	}
+	{
+		FJobSystem System;
+		System.Initialize(std::max<size_t>(2, MaximumThreads));
+		SpawnRounds(System, false);
+		Result.StealNanoseconds = SpawnRounds(System, false);
+	}
+
+	for (size_t Threads = 1; Threads <= std::max<size_t>(1, MaximumThreads); ++Threads)
+	{
+		FJobSystem System;
+		System.Initialize(Threads);
+		double Best = 0.0;
+		for (uint32_t Repetition = 0; Repetition <= FORK_JOIN_REPETITIONS; ++Repetition)
+		{
+			const auto Start = FClock::now();
+			System.RunForkJoin(FORK_JOIN_DEPTH);
+			const double Milliseconds = std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+			// the first run only warms the workers up
+			if (Repetition == 1 || (Repetition > 1 && Milliseconds < Best))
+			{
+				Best = Milliseconds;
+			}
+		}
+		Result.ForkJoinMilliseconds.push_back(Best);
+	}
+	return Result;
+}
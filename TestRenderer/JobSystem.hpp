@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A job is a small callable stored inline together with its bookkeeping. A job finishes once
+// it ran and all of its children finished, jobs waiting on it through AddDependency start then.
+struct SJob
+{
+	static constexpr size_t MAX_CONTINUATIONS = 4;
+	static constexpr size_t DATA_SIZE = 64;
+
+	void (*Function)(SJob&);
+	SJob* Parent;
+	// itself plus unfinished children
+	std::atomic<int32_t> UnfinishedJobs;
+	// unfinished prerequisites plus one held until Run is called
+	std::atomic<int32_t> Dependencies;
+	std::atomic<uint32_t> ContinuationCount;
+	// set by Run, a job that was created but not run yet can not finish on its own
+	std::atomic<bool> bIsRun;
+	SJob* Continuations[MAX_CONTINUATIONS];
+	alignas(std::max_align_t) unsigned char Data[DATA_SIZE];
+};
+
+// Chase-Lev work stealing deque of fixed capacity. The owning worker pushes and pops at the
+// bottom, every other worker steals from the top.
+class FJobDeque
+{
+public:
+	static constexpr size_t CAPACITY = 4096;
+
+	// false when full
+	bool Push(SJob* Job) noexcept;
+	SJob* Pop() noexcept;
+	SJob* Steal() noexcept;
+	bool IsEmpty() const noexcept;
+
+private:
+	static constexpr int64_t MASK = CAPACITY - 1;
+	static_assert((CAPACITY & (CAPACITY - 1)) == 0, "deque capacity must be a power of two");
+
+	// thieves hammer Top while the owner works on Bottom, padding keeps them on separate cache lines
+	std::atomic<int64_t> Top{ 0 };
+	char TopPadding[64]{};
+	std::atomic<int64_t> Bottom{ 0 };
+	char BottomPadding[64]{};
+	std::atomic<SJob*> Jobs[CAPACITY]{};
+};
+
+struct SJobWorkerStatistics
+{
+	uint64_t Executed = 0;
+	uint64_t Stolen = 0;
+};
+
+struct SJobBenchmark
+{
+	// create, run and finish one empty job on a single thread
+	double SpawnNanoseconds = 0.0;
+	// per empty job when the spawning thread only waits and every job is stolen
+	double StealNanoseconds = 0.0;
+	// recursive fork/join workload, index is thread count - 1
+	std::vector<double> ForkJoinMilliseconds;
+};
+
+// Work stealing job system. The thread calling Initialize becomes worker 0 and only runs jobs
+// while it waits in Wait or ParallelFor, the other workers are threads of their own that sleep
+// when there is nothing to steal. Jobs can only be created and run from worker threads.
+class FJobSystem
+{
+public:
+	// Jobs live in a ring per worker, a slot is reused once its job finished. Any number of jobs
+	// that were run can be created, when the ring wraps the creating worker helps until the slot
+	// is free. Jobs that were created but not run yet, a root whose children are still being
+	// spawned for example, are skipped, at most MAX_JOBS_PER_WORKER - 1 of them may be pending
+	// on one worker at a time.
+	static constexpr size_t MAX_JOBS_PER_WORKER = 4096;
+
+	FJobSystem() = default;
+	~FJobSystem();
+
+	FJobSystem(const FJobSystem&) = delete;
+	FJobSystem& operator=(const FJobSystem&) = delete;
+
+	// ThreadCount includes the calling thread, 0 uses every hardware thread
+	void Initialize(size_t ThreadCount = 0);
+	void Shutdown() noexcept;
+
+	template <typename TFunction>
+	SJob* CreateJob(TFunction&& Function, SJob* Parent = nullptr) noexcept;
+	// Job starts after Prerequisite finished, neither may have been run yet
+	void AddDependency(SJob* Job, SJob* Prerequisite) noexcept;
+	void Run(SJob* Job) noexcept;
+	// runs other jobs on the calling thread until Job finished
+	void Wait(const SJob* Job) noexcept;
+	bool IsFinished(const SJob* Job) const noexcept;
+
+	// Same contract as the free ParallelFor. Ranges start at a size adapted to the thread count
+	// and are halved whenever the running worker's deque is empty, which only happens once
+	// another worker stole from it, so idle workers pull the splitting down to where it pays.
+	template <typename TFunction>
+	void ParallelFor(const size_t Count, const size_t MinimumBatchSize, TFunction Function);
+
+	size_t GetThreadCount() const noexcept;
+	SJobWorkerStatistics GetWorkerStatistics(const size_t Worker) const noexcept;
+
+	// the job system the calling thread works for, nullptr for any other thread
+	static FJobSystem* GetCurrent() noexcept;
+
+	// builds a job system of its own for every measurement, the calling thread joins each of them
+	static SJobBenchmark RunBenchmark(const size_t MaximumThreads, const size_t JobCount);
+	// the workloads RunBenchmark times, for harnesses timing them themselves. JobCount empty children
+	// of one root, waited for by helping with them or by only yielding so other workers steal all.
+	void RunEmptyJobs(const size_t JobCount, const bool bHelp) noexcept;
+	// fork/join tree of 2^Depth leaves of roughly 20us each, spawned from a single root. Returns a
+	// sum over the leaves, the same on any number of threads.
+	uint32_t RunForkJoin(const uint32_t Depth) noexcept;
+
+private:
+	struct SWorker
+	{
+		FJobDeque Deque;
+		std::unique_ptr<SJob[]> Jobs;
+		size_t NextJob = 0;
+		uint32_t Random = 0;
+		std::atomic<uint64_t> Executed{ 0 };
+		std::atomic<uint64_t> Stolen{ 0 };
+	};
+
+	SJob* AllocateJob(SJob* Parent) noexcept;
+	bool IsLocalDequeEmpty() const noexcept;
+	void Push(SJob* Job) noexcept;
+	SJob* GetJob() noexcept;
+	bool ExecuteOne() noexcept;
+	void Execute(SJob* Job) noexcept;
+	void Finish(SJob* Job) noexcept;
+	void WorkerMain(const size_t Worker) noexcept;
+	void WakeWorkers() noexcept;
+
+	template <typename TFunction>
+	static void ExecuteRange(FJobSystem& System, SJob* Parent, TFunction& Function, size_t Begin, size_t End, const size_t BatchSize);
+
+	std::vector<std::unique_ptr<SWorker>> Workers;
+	size_t ThreadCount = 0;
+	std::vector<std::thread> Threads;
+	std::atomic<bool> bQuit{ false };
+
+	// sleeping workers wait for the generation to change, see WakeWorkers
+	std::mutex SleepMutex;
+	std::condition_variable SleepCondition;
+	std::atomic<uint64_t> WakeGeneration{ 0 };
+	std::atomic<uint32_t> SleepingWorkers{ 0 };
+
+	// the binding of the initializing thread before Initialize, restored by Shutdown
+	FJobSystem* PreviousSystem = nullptr;
+	size_t PreviousWorker = 0;
+};
+
+template <typename TFunction>
+SJob* FJobSystem::CreateJob(TFunction&& Function, SJob* Parent) noexcept
+{
+	using TStored = std::decay_t<TFunction>;
+	static_assert(sizeof(TStored) <= SJob::DATA_SIZE, "job function does not fit into the job");
+	static_assert(alignof(TStored) <= alignof(std::max_align_t), "job function is over aligned");
+
+	SJob* Job = AllocateJob(Parent);
+	new (Job->Data) TStored(std::forward<TFunction>(Function));
+	Job->Function = [](SJob& Self)
+	{
+		auto& Stored = *reinterpret_cast<TStored*>(Self.Data);
+		Stored();
+		Stored.~TStored();
+	};
+	return Job;
+}
+
+template <typename TFunction>
+void FJobSystem::ExecuteRange(FJobSystem& System, SJob* Parent, TFunction& Function, size_t Begin, size_t End, const size_t BatchSize)
+{
+	while (Begin < End)
+	{
+		if (End - Begin >= 2 * BatchSize && System.IsLocalDequeEmpty())
+		{
+			const size_t Middle = Begin + (End - Begin) / 2;
+			System.Run(System.CreateJob([&System, Parent, &Function, Middle, End, BatchSize]()
+			{
+				ExecuteRange(System, Parent, Function, Middle, End, BatchSize);
+			}, Parent));
+			End = Middle;
+			continue;
+		}
+		const size_t BatchEnd = std::min(End, Begin + BatchSize);
+		Function(Begin, BatchEnd);
+		Begin = BatchEnd;
+	}
+}
+
+template <typename TFunction>
+void FJobSystem::ParallelFor(const size_t Count, const size_t MinimumBatchSize, TFunction Function)
+{
+	static constexpr size_t BATCHES_PER_THREAD = 16;
+	const size_t BatchSize = std::max(std::max<size_t>(1, MinimumBatchSize), Count / (ThreadCount * BATCHES_PER_THREAD));
+	if (Count <= BatchSize || ThreadCount <= 1)
+	{
+		Function(size_t(0), Count);
+		return;
+	}
+
+	SJob* Root = CreateJob([]() {});
+	ExecuteRange(*this, Root, Function, 0, Count, BatchSize);
+	Run(Root);
+	Wait(Root);
+}
@@ -18,16 +18,21 @@ void FLight::Initialize(const uint32_t Width, const uint32_t Height) noexcept
 	InternalRenderer.CreateConstantBufferWithData(LightConstantBuffer, ConstantBuffer);
 }
 
-void FLight::OnRender() noexcept
+void FLight::OnRender(const SLightConstantBuffer& Constants) noexcept
 {
 	InternalRenderer.SetConstantBuffer(ConstantBuffer, EShaderStage::PIXEL, 1);
-	InternalRenderer.UpdateSubresource(ConstantBuffer, &LightConstantBuffer, sizeof(SLightConstantBuffer));
+	InternalRenderer.UpdateSubresource(ConstantBuffer, &Constants, sizeof(SLightConstantBuffer));
 }
 
 void FLight::OnUpdate(const float Time) noexcept
 {
 }
 
+const FLight::SLightConstantBuffer& FLight::GetConstants() const noexcept
+{
+	return LightConstantBuffer;
+}
+
 void FLight::OnGui() noexcept
 {
 	ImGui::Begin("Lights");
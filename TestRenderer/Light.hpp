@@ -6,12 +6,6 @@ class FLight
 public:
 	explicit FLight(FRenderer& Renderer);
 
-	void Initialize(const uint32_t Width, const uint32_t Height) noexcept;
-
-	void OnRender() noexcept;
-	void OnUpdate(const float Time) noexcept;
-	void OnGui() noexcept;
-private:
 	static constexpr uint8_t MAX_LIGHTS = 8;
 	struct SLightData
 	{
@@ -26,6 +20,16 @@ private:
 		uint8_t LightCount;
 	};
 
+	void Initialize(const uint32_t Width, const uint32_t Height) noexcept;
+
+	// renders the constants of a snapshot, the gui edits the live ones returned by GetConstants
+	void OnRender(const SLightConstantBuffer& Constants) noexcept;
+	void OnUpdate(const float Time) noexcept;
+	void OnGui() noexcept;
+
+	const SLightConstantBuffer& GetConstants() const noexcept;
+
+private:
 	SLightConstantBuffer LightConstantBuffer{};
 
 	SBuffer ConstantBuffer{};
@@ -8,5 +8,6 @@ cbuffer Params:register(b0)
 float4 main(float4 Position : SV_POSITION, float2 TexCoord : TEXCOORD0) : SV_TARGET0
 {
 	//return Texture.Sample(Sampler, TexCoord * Repeat * 255.0f);
-	return Texture.Sample(Sampler, TexCoord * Repeat);
+	// every node writes grey, reading red converts single channel inputs
+	return Texture.Sample(Sampler, TexCoord * Repeat).r;
 }
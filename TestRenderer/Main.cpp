@@ -4,143 +4,80 @@
 
 #define WITH_EDITOR 1
 #include "Application.hpp"
-#include <chrono>
-#define IMGUI_DEFINE_MATH_OPERATORS
-#include "imgui/imgui_impl_win32.h"
-#include "imgui/imgui_impl_dx11.h"
+#include "Win32Platform.hpp"
+#include <cstdio>
+#include <cstring>
 
-uint32_t Width = 1600;
-uint32_t Height = 900;
+const uint32_t Width = 1600;
+const uint32_t Height = 900;
 
 FApplication Application{};
 
-extern LRESULT ImGui_ImplWin32_WndProcHandler(HWND HWnd, UINT Msg, WPARAM WParam, LPARAM LParam);
-
-LRESULT CALLBACK WindowProc(const HWND HWnd, const UINT Message, const WPARAM WParam, const LPARAM LParam)
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nShowCmd)
 {
-	if (ImGui_ImplWin32_WndProcHandler(HWnd, Message, WParam, LParam))
-	{
-		return true;
-	}
-	switch (Message)
+	// -memcsv=<file> [-memcsvinterval=<seconds>] appends per tag memory totals to a csv while running
+	if (const char* CsvArgument = strstr(lpCmdLine, "-memcsv="))
 	{
-	case WM_DESTROY:
-	{
-		PostQuitMessage(0);
-		return 0;
-	}
-	case WM_SIZE:
-	{
-		if (WParam != SIZE_MINIMIZED)
+		char CsvFileName[MAX_PATH]{};
+		double CsvInterval = 1.0;
+		sscanf(CsvArgument, "-memcsv=%259s", CsvFileName);
+		if (const char* IntervalArgument = strstr(lpCmdLine, "-memcsvinterval="))
 		{
-			Width = static_cast<uint32_t>(LOWORD(LParam));
-			Height = static_cast<uint32_t>(HIWORD(LParam));
-			Application.Resize(Width, Height);
+			sscanf(IntervalArgument, "-memcsvinterval=%lf", &CsvInterval);
 		}
+		FMemoryTracker::Get().SetCsvOutput(CsvFileName, CsvInterval);
 	}
-	default:
+
+	// -renderstats=<file> writes per frame and per pass render counters as json on exit
+	static char RenderStatisticsFileName[MAX_PATH]{};
+	if (const char* StatisticsArgument = strstr(lpCmdLine, "-renderstats="))
 	{
-		break;
+		sscanf(StatisticsArgument, "-renderstats=%259s", RenderStatisticsFileName);
+		Application.SetRenderStatisticsOutput(RenderStatisticsFileName);
 	}
-	}
-	return DefWindowProc(HWnd, Message, WParam, LParam);
-}
-
-int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nShowCmd)
-{
-	ImGui_ImplWin32_EnableDpiAwareness();
-	WNDCLASSEX WindowClass{};
-	WindowClass.cbSize = sizeof(WNDCLASSEX);
-	WindowClass.style = CS_HREDRAW | CS_VREDRAW;
-	WindowClass.lpfnWndProc = WindowProc;
-	WindowClass.hInstance = hInstance;
-	WindowClass.hCursor = LoadCursor(nullptr, IDC_ARROW);
-	WindowClass.lpszClassName = "WindowClass";
-	RegisterClassEx(&WindowClass);
 
-	RECT WindowRect = { 0, 0, static_cast<LONG>(Width), static_cast<LONG>(Height)};
-	AdjustWindowRect(&WindowRect, WS_OVERLAPPEDWINDOW, FALSE);
-
-	const auto HWnd = CreateWindowEx(0, "WindowClass", "Test Renderer", WS_OVERLAPPEDWINDOW, 300, 300, WindowRect.right - WindowRect.left, WindowRect.bottom - WindowRect.top, nullptr, nullptr, hInstance, nullptr);
-	ShowWindow(HWnd, nShowCmd);
-	UpdateWindow(HWnd);
-	Application.Setup(HWnd, Width, Height);
-
-	double Time = INFINITY;
-	
-	MSG Msg{};
-	while (TRUE)
+	// -capture=<file> [-captureframe=<n>] writes every renderer call of the frame after frame n, 120 by default
+	static char CaptureFileName[MAX_PATH]{};
+	if (const char* CaptureArgument = strstr(lpCmdLine, "-capture="))
 	{
-		if (PeekMessage(&Msg, nullptr, 0, 0, PM_REMOVE))
+		unsigned long long CaptureFrame = 120;
+		sscanf(CaptureArgument, "-capture=%259s", CaptureFileName);
+		if (const char* FrameArgument = strstr(lpCmdLine, "-captureframe="))
 		{
-			TranslateMessage(&Msg);
-			DispatchMessage(&Msg);
-
-			if (Msg.message == WM_QUIT)
-			{
-				break;
-			}
+			sscanf(FrameArgument, "-captureframe=%llu", &CaptureFrame);
 		}
-		
-		auto& Io = ImGui::GetIO();
-
-		ImGui_ImplDX11_NewFrame();
-		ImGui_ImplWin32_NewFrame();
-		ImGui::NewFrame();
-
-		auto WindowFlags = ImGuiWindowFlags_MenuBar | ImGuiWindowFlags_NoDocking;
+		Application.SetCaptureOutput(CaptureFileName, CaptureFrame);
+	}
 
-		const auto Viewport = ImGui::GetMainViewport();
-		ImGui::SetNextWindowPos(Viewport->Pos);
-		ImGui::SetNextWindowSize(Viewport->Size);
-		ImGui::SetNextWindowViewport(Viewport->ID);
-		ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0.0f);
-		ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
-		WindowFlags |= ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoCollapse;
-		WindowFlags |= ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove;
-		WindowFlags |= ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoNavFocus;
+	// -serialupdate simulates each frame on the main thread right before it is rendered
+	if (strstr(lpCmdLine, "-serialupdate"))
+	{
+		Application.SetThreadedUpdate(false);
+	}
 
-		bool Open = true;
-		ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
-		ImGui::Begin("DockSpace", &Open, WindowFlags);
-		ImGui::PopStyleVar();
-		ImGui::PopStyleVar(2);
+	FWin32Platform Platform;
+	if (Platform.Initialize(hInstance, Width, Height, nShowCmd) != EErrorCode::OK)
+	{
+		return 1;
+	}
+	Application.Setup(Platform);
 
-		if (Io.ConfigFlags & ImGuiConfigFlags_DockingEnable)
+	double Time = Platform.GetTime();
+	while (Platform.PumpEvents())
+	{
+		if (Platform.ConsumeResize())
 		{
-			const auto DockspaceId = ImGui::GetID("MyDockSpace");
-			ImGui::DockSpace(DockspaceId, ImVec2(0.0f, 0.0f), ImGuiDockNodeFlags_None);
-		}
-		ImGui::End();
-
-		// initialize time
-		if (Time == INFINITY) {
-			Time = Application.GetHighResolutionTime();
+			Application.Resize(Platform.GetWidth(), Platform.GetHeight());
 		}
 
-		// calculate time difference
-		const auto CurrentTime = Application.GetHighResolutionTime();
+		const auto CurrentTime = Platform.GetTime();
 		const auto DeltaTime = CurrentTime - Time;
 		Time = CurrentTime;
 
-		// update application
-		Application.OnGui();
-		Application.OnUpdate(static_cast<float>(DeltaTime));
-		Application.OnRender();
-
-		ImGui::Render();
-		ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
-		if (Io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
-		{
-			ImGui::UpdatePlatformWindows();
-			ImGui::RenderPlatformWindowsDefault();
-		}
-
-		Application.Present();
-		
+		Application.RunFrame(static_cast<float>(DeltaTime));
 	}
 
 	Application.TearDown();
 	
-	return Msg.wParam;
+	return Platform.GetExitCode();
 }
\ No newline at end of file
@@ -5,18 +5,17 @@
 
 #include <assimp/material.h>
 
-FMaterial::FMaterial(FRenderer& Renderer): InternalRenderer(Renderer)
+FMaterial::FMaterial(FRenderer& Renderer, FTextureCache& TextureCache): InternalRenderer(Renderer), InternalTextureCache(TextureCache)
 {
 }
 
 FMaterial::~FMaterial()
 {
-	InternalRenderer.DestroyTexture(Albedo);
-	InternalRenderer.DestroyTexture(Metalness);
-	InternalRenderer.DestroyTexture(Roughness);
-	InternalRenderer.DestroyTexture(Normal);
+	InternalTextureCache.Release(Albedo);
+	InternalTextureCache.Release(Metalness);
+	InternalTextureCache.Release(Roughness);
+	InternalTextureCache.Release(Normal);
 
-	InternalRenderer.DestroyShader(Shader);
 	InternalRenderer.DestroyBuffer(ConstantBuffer);
 }
 
@@ -26,23 +25,12 @@ void FMaterial::Initialize(const uint32_t Width, const uint32_t Height) noexcept
 	{
 		return;
 	}
-	D3D11_INPUT_ELEMENT_DESC InputElementDescriptors[] =
-	{
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 32, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 44, D3D11_INPUT_PER_VERTEX_DATA, 0},
-	};
-
+	FMemoryTagScope MemoryTag(EMemoryTag::MATERIAL);
 	uint8_t ShockingPink[4] = {252, 15, 192, 255};
-	InternalRenderer.CreateTextureFromMemory(ShockingPink, 1, 1, 4, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, Albedo);
-	InternalRenderer.CreateTextureFromMemory(ShockingPink, 1, 1, 4, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, Metalness);
-	InternalRenderer.CreateTextureFromMemory(ShockingPink, 1, 1, 4, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, Roughness);
-	InternalRenderer.CreateTextureFromMemory(ShockingPink, 1, 1, 4, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, Normal);
-	InternalRenderer.CreateVertexShader(L"DefaultVS.hlsl", "main", InputElementDescriptors, 5, Shader);
-	InternalRenderer.CreatePixelShader(L"DefaultPS.hlsl", "main", Shader);
-
+	InternalTextureCache.AcquireFromMemory("ShockingPink", ShockingPink, 1, 1, 4, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, Albedo);
+	InternalTextureCache.AcquireFromMemory("ShockingPink", ShockingPink, 1, 1, 4, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, Metalness);
+	InternalTextureCache.AcquireFromMemory("ShockingPink", ShockingPink, 1, 1, 4, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, Roughness);
+	InternalTextureCache.AcquireFromMemory("ShockingPink", ShockingPink, 1, 1, 4, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, Normal);
 	InternalRenderer.CreateConstantBufferWithData(MaterialConstantBuffer, ConstantBuffer);
 
 	bIsInitialized = true;
@@ -50,6 +38,7 @@ void FMaterial::Initialize(const uint32_t Width, const uint32_t Height) noexcept
 
 void FMaterial::LoadMaterial(const std::string& RootDir, const aiMaterial* Material) noexcept
 {
+	FMemoryTagScope MemoryTag(EMemoryTag::MATERIAL);
 	aiString FileName{};
 	Material->GetTexture(aiTextureType_DIFFUSE, 0, &FileName);
 	auto Path = RootDir + std::string(FileName.C_Str());
@@ -97,12 +86,14 @@ void FMaterial::ReloadTexture(const DXGI_FORMAT Format, SRenderTarget& RenderTar
 
 void FMaterial::ReloadTexture(const char* FileName, const DXGI_FORMAT Format, SRenderTarget& RenderTarget) const noexcept
 {
+	FMemoryTagScope MemoryTag(EMemoryTag::MATERIAL);
 	SRenderTarget TemporaryRenderTarget;
 
-	const auto Result = InternalRenderer.CreateTextureFromFile(FileName, Format, TemporaryRenderTarget);
+	// acquire before release so reloading the same file keeps the cached texture alive
+	const auto Result = InternalTextureCache.Acquire(FileName, Format, TemporaryRenderTarget);
 	if (Result == EErrorCode::OK)
 	{
-		InternalRenderer.DestroyTexture(RenderTarget);
+		InternalTextureCache.Release(RenderTarget);
 		RenderTarget = TemporaryRenderTarget;
 	}
 }
@@ -164,7 +155,6 @@ void FMaterial::OnGui() noexcept
 
 void FMaterial::OnRender(const SRenderTarget* RenderTargets, const size_t Count) noexcept
 {
-	InternalRenderer.SetShader(Shader);
 	InternalRenderer.SetConstantBuffer(ConstantBuffer, EShaderStage::PIXEL, 2);
 	InternalRenderer.UpdateSubresource(ConstantBuffer, &MaterialConstantBuffer, sizeof(struct SMaterialConstantBuffer));
 
@@ -173,3 +163,14 @@ void FMaterial::OnRender(const SRenderTarget* RenderTargets, const size_t Count)
 	InternalRenderer.SetTexture(2, Roughness);
 	InternalRenderer.SetTexture(3, Normal);
 }
+
+void FMaterial::OnRender(FCommandList& CommandList) const
+{
+	CommandList.SetConstantBuffer(ConstantBuffer, EShaderStage::PIXEL, 2);
+	CommandList.UpdateSubresource(ConstantBuffer, &MaterialConstantBuffer, sizeof(struct SMaterialConstantBuffer));
+
+	CommandList.SetTexture(0, Albedo);
+	CommandList.SetTexture(1, Metalness);
+	CommandList.SetTexture(2, Roughness);
+	CommandList.SetTexture(3, Normal);
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Renderer.hpp"
+#include "TextureCache.hpp"
+#include "CommandList.hpp"
 #include <string>
 
 struct aiMaterial;
@@ -8,7 +10,7 @@ struct aiMaterial;
 class FMaterial
 {
 public:
-	explicit FMaterial(FRenderer& Renderer);
+	explicit FMaterial(FRenderer& Renderer, FTextureCache& TextureCache);
 
 	~FMaterial();
 	
@@ -19,15 +21,17 @@ public:
 	void Initialize(const uint32_t Width, const uint32_t Height) noexcept;
 	void OnGui() noexcept;
 	void OnRender(const SRenderTarget* RenderTargets = nullptr, const size_t Count = 0) noexcept;
+	// same bindings recorded into a list, safe to call from several threads at once
+	void OnRender(FCommandList& CommandList) const;
 
 private:
 	FRenderer& InternalRenderer;
+	FTextureCache& InternalTextureCache;
 
 	SRenderTarget Albedo{};
 	SRenderTarget Metalness{};
 	SRenderTarget Roughness{};
 	SRenderTarget Normal{};
-	SShader Shader{};
 	SBuffer ConstantBuffer{};
 
 	enum class EIlluminationModel : uint32_t
@@ -0,0 +1,345 @@
+#include "MemoryTracker.hpp"
+
+#include "imgui/imgui.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace
+{
+	constexpr size_t TAG_COUNT = static_cast<size_t>(EMemoryTag::COUNT);
+
+	// keeps the payload at malloc's 16 byte alignment
+	struct alignas(16) SAllocationHeader
+	{
+		uint64_t Size;
+		EMemoryTag Tag;
+	};
+
+	// constant initialized, so allocations made during static initialization are safe to count
+	struct SCounters
+	{
+		std::atomic<uint64_t> CpuBytes[TAG_COUNT];
+		std::atomic<uint64_t> CpuPeakBytes[TAG_COUNT];
+		std::atomic<uint64_t> CpuAllocations[TAG_COUNT];
+		std::atomic<uint64_t> GpuBytes[TAG_COUNT];
+		std::atomic<uint64_t> GpuPeakBytes[TAG_COUNT];
+		std::atomic<uint64_t> GpuResources[TAG_COUNT];
+		std::atomic<uint64_t> HeapAllocations;
+	};
+	SCounters Counters{};
+
+	thread_local EMemoryTag CurrentTag = EMemoryTag::UNTAGGED;
+
+	void UpdatePeak(std::atomic<uint64_t>& Peak, const uint64_t Value) noexcept
+	{
+		auto Current = Peak.load(std::memory_order_relaxed);
+		while (Value > Current && !Peak.compare_exchange_weak(Current, Value, std::memory_order_relaxed))
+		{
+		}
+	}
+}
+
+const char* GetMemoryTagName(const EMemoryTag Tag) noexcept
+{
+	switch (Tag)
+	{
+	case EMemoryTag::UNTAGGED: return "Untagged";
+	case EMemoryTag::MODEL: return "Model";
+	case EMemoryTag::MATERIAL: return "Material";
+	case EMemoryTag::TEXGEN: return "TexGen";
+	case EMemoryTag::BLUR: return "Blur";
+	case EMemoryTag::CAMERA: return "Camera";
+	case EMemoryTag::LIGHT: return "Light";
+	case EMemoryTag::IMGUI: return "ImGui";
+	default: return "Unknown";
+	}
+}
+
+FMemoryTagScope::FMemoryTagScope(const EMemoryTag Tag) noexcept : PreviousTag(CurrentTag)
+{
+	CurrentTag = Tag;
+}
+
+FMemoryTagScope::~FMemoryTagScope()
+{
+	CurrentTag = PreviousTag;
+}
+
+EMemoryTag GetCurrentMemoryTag() noexcept
+{
+	return CurrentTag;
+}
+
+void* TrackedAllocate(const size_t Size, const EMemoryTag Tag) noexcept
+{
+	auto Header = static_cast<SAllocationHeader*>(malloc(sizeof(SAllocationHeader) + Size));
+	if (Header == nullptr)
+	{
+		return nullptr;
+	}
+	Header->Size = Size;
+	Header->Tag = Tag;
+
+	const auto Index = static_cast<size_t>(Tag);
+	Counters.HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	Counters.CpuAllocations[Index].fetch_add(1, std::memory_order_relaxed);
+	UpdatePeak(Counters.CpuPeakBytes[Index], Counters.CpuBytes[Index].fetch_add(Size, std::memory_order_relaxed) + Size);
+	return Header + 1;
+}
+
+void TrackedFree(void* Memory) noexcept
+{
+	if (Memory == nullptr)
+	{
+		return;
+	}
+	auto Header = static_cast<SAllocationHeader*>(Memory) - 1;
+	Counters.CpuBytes[static_cast<size_t>(Header->Tag)].fetch_sub(Header->Size, std::memory_order_relaxed);
+	free(Header);
+}
+
+uint64_t GetHeapAllocationCount() noexcept
+{
+	return Counters.HeapAllocations.load(std::memory_order_relaxed);
+}
+
+void* ImGuiAllocate(size_t Size, void* /*UserData*/)
+{
+	return TrackedAllocate(Size, EMemoryTag::IMGUI);
+}
+
+void ImGuiFree(void* Memory, void* /*UserData*/)
+{
+	TrackedFree(Memory);
+}
+
+FMemoryTracker& FMemoryTracker::Get() noexcept
+{
+	static FMemoryTracker Tracker;
+	return Tracker;
+}
+
+void FMemoryTracker::OnGpuAllocation(const EMemoryTag Tag, const uint64_t Bytes) noexcept
+{
+	const auto Index = static_cast<size_t>(Tag);
+	Counters.GpuResources[Index].fetch_add(1, std::memory_order_relaxed);
+	UpdatePeak(Counters.GpuPeakBytes[Index], Counters.GpuBytes[Index].fetch_add(Bytes, std::memory_order_relaxed) + Bytes);
+}
+
+void FMemoryTracker::OnGpuFree(const EMemoryTag Tag, const uint64_t Bytes) noexcept
+{
+	const auto Index = static_cast<size_t>(Tag);
+	Counters.GpuResources[Index].fetch_sub(1, std::memory_order_relaxed);
+	Counters.GpuBytes[Index].fetch_sub(Bytes, std::memory_order_relaxed);
+}
+
+FMemoryTracker::STagStatistics FMemoryTracker::GetStatistics(const EMemoryTag Tag) const noexcept
+{
+	const auto Index = static_cast<size_t>(Tag);
+	STagStatistics Statistics{};
+	Statistics.CpuBytes = Counters.CpuBytes[Index].load(std::memory_order_relaxed);
+	Statistics.CpuPeakBytes = Counters.CpuPeakBytes[Index].load(std::memory_order_relaxed);
+	Statistics.CpuAllocations = Counters.CpuAllocations[Index].load(std::memory_order_relaxed);
+	Statistics.GpuBytes = Counters.GpuBytes[Index].load(std::memory_order_relaxed);
+	Statistics.GpuPeakBytes = Counters.GpuPeakBytes[Index].load(std::memory_order_relaxed);
+	Statistics.GpuResources = Counters.GpuResources[Index].load(std::memory_order_relaxed);
+	Statistics.AllocationsPerSecond = AllocationsPerSecond[Index];
+	return Statistics;
+}
+
+void FMemoryTracker::OnFrame(const double Time) noexcept
+{
+	// rates are averaged over roughly half a second so they stay readable
+	if (LastSampleTime < 0.0 || Time - LastSampleTime >= 0.5)
+	{
+		const double Elapsed = Time - LastSampleTime;
+		for (size_t Index = 0; Index < TAG_COUNT; ++Index)
+		{
+			const auto Allocations = Counters.CpuAllocations[Index].load(std::memory_order_relaxed);
+			AllocationsPerSecond[Index] = LastSampleTime < 0.0 ? 0.0f : static_cast<float>((Allocations - LastAllocations[Index]) / Elapsed);
+			LastAllocations[Index] = Allocations;
+		}
+		LastSampleTime = Time;
+	}
+
+	if (CsvFileName[0] != '\0' && (LastCsvTime < 0.0 || Time - LastCsvTime >= CsvInterval))
+	{
+		WriteCsv(CsvFileName, Time);
+		LastCsvTime = Time;
+	}
+}
+
+void FMemoryTracker::SetCsvOutput(const char* FileName, const double IntervalSeconds) noexcept
+{
+	if (FileName == nullptr)
+	{
+		CsvFileName[0] = '\0';
+		return;
+	}
+	strncpy(CsvFileName, FileName, sizeof(CsvFileName) - 1);
+	CsvFileName[sizeof(CsvFileName) - 1] = '\0';
+	CsvInterval = IntervalSeconds;
+	LastCsvTime = -1.0;
+}
+
+bool FMemoryTracker::WriteCsv(const char* FileName, const double Time) const noexcept
+{
+	FILE* File = fopen(FileName, "a");
+	if (File == nullptr)
+	{
+		return false;
+	}
+
+	// header only for a fresh file, so periodic dumps append to one table
+	fseek(File, 0, SEEK_END);
+	if (ftell(File) == 0)
+	{
+		fprintf(File, "Time,Tag,CpuBytes,CpuPeakBytes,CpuAllocations,AllocationsPerSecond,GpuBytes,GpuPeakBytes,GpuResources\n");
+	}
+	WriteCsvRows(File, Time);
+	fclose(File);
+	return true;
+}
+
+void FMemoryTracker::Flush(const double Time) noexcept
+{
+	if (CsvFileName[0] != '\0')
+	{
+		WriteCsv(CsvFileName, Time);
+		LastCsvTime = Time;
+	}
+}
+
+void FMemoryTracker::WriteCsvRows(FILE* File, const double Time) const noexcept
+{
+	for (size_t Index = 0; Index < TAG_COUNT; ++Index)
+	{
+		const auto Tag = static_cast<EMemoryTag>(Index);
+		const auto Statistics = GetStatistics(Tag);
+		fprintf(File, "%.3f,%s,%llu,%llu,%llu,%.1f,%llu,%llu,%llu\n", Time, GetMemoryTagName(Tag),
+			static_cast<unsigned long long>(Statistics.CpuBytes),
+			static_cast<unsigned long long>(Statistics.CpuPeakBytes),
+			static_cast<unsigned long long>(Statistics.CpuAllocations),
+			Statistics.AllocationsPerSecond,
+			static_cast<unsigned long long>(Statistics.GpuBytes),
+			static_cast<unsigned long long>(Statistics.GpuPeakBytes),
+			static_cast<unsigned long long>(Statistics.GpuResources));
+	}
+}
+
+void FMemoryTracker::Mark() noexcept
+{
+	for (size_t Index = 0; Index < TAG_COUNT; ++Index)
+	{
+		MarkedStatistics[Index] = GetStatistics(static_cast<EMemoryTag>(Index));
+	}
+	bHasMark = true;
+}
+
+void FMemoryTracker::OnGui() noexcept
+{
+	if (ImGui::Button("Mark"))
+	{
+		Mark();
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Dump CSV"))
+	{
+		WriteCsv("MemoryReport.csv", LastSampleTime);
+	}
+
+	ImGui::Columns(bHasMark ? 8 : 6, "MemoryTags");
+	const char* Headers[] = { "Tag", "CPU KB", "CPU Peak KB", "Alloc/s", "GPU KB", "GPU Peak KB", "CPU Growth KB", "GPU Growth KB" };
+	for (int Column = 0; Column < ImGui::GetColumnsCount(); ++Column)
+	{
+		ImGui::Text("%s", Headers[Column]);
+		ImGui::NextColumn();
+	}
+	ImGui::Separator();
+
+	for (size_t Index = 0; Index < TAG_COUNT; ++Index)
+	{
+		const auto Tag = static_cast<EMemoryTag>(Index);
+		const auto Statistics = GetStatistics(Tag);
+		ImGui::Text("%s", GetMemoryTagName(Tag));
+		ImGui::NextColumn();
+		ImGui::Text("%.1f", Statistics.CpuBytes / 1024.0);
+		ImGui::NextColumn();
+		ImGui::Text("%.1f", Statistics.CpuPeakBytes / 1024.0);
+		ImGui::NextColumn();
+		ImGui::Text("%.0f", Statistics.AllocationsPerSecond);
+		ImGui::NextColumn();
+		ImGui::Text("%.1f (%llu)", Statistics.GpuBytes / 1024.0, static_cast<unsigned long long>(Statistics.GpuResources));
+		ImGui::NextColumn();
+		ImGui::Text("%.1f", Statistics.GpuPeakBytes / 1024.0);
+		ImGui::NextColumn();
+		if (bHasMark)
+		{
+			// anything that keeps growing after a mark without a matching free is a leak candidate
+			const double CpuGrowth = (static_cast<double>(Statistics.CpuBytes) - MarkedStatistics[Index].CpuBytes) / 1024.0;
+			const double GpuGrowth = (static_cast<double>(Statistics.GpuBytes) - MarkedStatistics[Index].GpuBytes) / 1024.0;
+			ImGui::TextColored(CpuGrowth > 0.0 ? ImVec4(1.0f, 0.4f, 0.4f, 1.0f) : ImVec4(1.0f, 1.0f, 1.0f, 1.0f), "%+.1f", CpuGrowth);
+			ImGui::NextColumn();
+			ImGui::TextColored(GpuGrowth > 0.0 ? ImVec4(1.0f, 0.4f, 0.4f, 1.0f) : ImVec4(1.0f, 1.0f, 1.0f, 1.0f), "%+.1f", GpuGrowth);
+			ImGui::NextColumn();
+		}
+	}
+	ImGui::Columns(1);
+}
+
+// replaceable global allocation functions, everything is tagged with the calling thread's scope
+void* operator new(size_t Size)
+{
+	if (void* Memory = TrackedAllocate(Size ? Size : 1, CurrentTag))
+	{
+		return Memory;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t Size)
+{
+	return operator new(Size);
+}
+
+void* operator new(size_t Size, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(Size ? Size : 1, CurrentTag);
+}
+
+void* operator new[](size_t Size, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(Size ? Size : 1, CurrentTag);
+}
+
+void operator delete(void* Memory) noexcept
+{
+	TrackedFree(Memory);
+}
+
+void operator delete[](void* Memory) noexcept
+{
+	TrackedFree(Memory);
+}
+
+void operator delete(void* Memory, size_t) noexcept
+{
+	TrackedFree(Memory);
+}
+
+void operator delete[](void* Memory, size_t) noexcept
+{
+	TrackedFree(Memory);
+}
+
+void operator delete(void* Memory, const std::nothrow_t&) noexcept
+{
+	TrackedFree(Memory);
+}
+
+void operator delete[](void* Memory, const std::nothrow_t&) noexcept
+{
+	TrackedFree(Memory);
+}
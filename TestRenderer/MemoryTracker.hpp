@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+enum class EMemoryTag : uint8_t
+{
+	UNTAGGED = 0,
+	MODEL,
+	MATERIAL,
+	TEXGEN,
+	BLUR,
+	CAMERA,
+	LIGHT,
+	IMGUI,
+	COUNT
+};
+
+const char* GetMemoryTagName(const EMemoryTag Tag) noexcept;
+
+// Attributes every heap allocation and FRenderer resource created on this thread to Tag
+// until the scope ends, scopes nest.
+class FMemoryTagScope
+{
+public:
+	explicit FMemoryTagScope(const EMemoryTag Tag) noexcept;
+	~FMemoryTagScope();
+
+	FMemoryTagScope(const FMemoryTagScope&) = delete;
+	FMemoryTagScope& operator=(const FMemoryTagScope&) = delete;
+
+private:
+	EMemoryTag PreviousTag;
+};
+
+EMemoryTag GetCurrentMemoryTag() noexcept;
+
+// Heap allocation with a small header recording size and tag, global new and delete go
+// through these as well
+void* TrackedAllocate(const size_t Size, const EMemoryTag Tag) noexcept;
+void TrackedFree(void* Memory) noexcept;
+
+// Every tracked heap allocation bumps this counter
+uint64_t GetHeapAllocationCount() noexcept;
+
+// Signatures match ImGui::SetAllocatorFunctions, allocations are tagged IMGUI
+void* ImGuiAllocate(size_t Size, void* UserData);
+void ImGuiFree(void* Memory, void* UserData);
+
+class FMemoryTracker
+{
+public:
+	struct STagStatistics
+	{
+		uint64_t CpuBytes = 0;
+		uint64_t CpuPeakBytes = 0;
+		uint64_t CpuAllocations = 0;
+		uint64_t GpuBytes = 0;
+		uint64_t GpuPeakBytes = 0;
+		uint64_t GpuResources = 0;
+		float AllocationsPerSecond = 0.0f;
+	};
+
+	static FMemoryTracker& Get() noexcept;
+
+	void OnGpuAllocation(const EMemoryTag Tag, const uint64_t Bytes) noexcept;
+	void OnGpuFree(const EMemoryTag Tag, const uint64_t Bytes) noexcept;
+
+	STagStatistics GetStatistics(const EMemoryTag Tag) const noexcept;
+
+	// samples allocation rates and writes the periodic csv dump if one is configured
+	void OnFrame(const double Time) noexcept;
+	void SetCsvOutput(const char* FileName, const double IntervalSeconds) noexcept;
+	bool WriteCsv(const char* FileName, const double Time) const noexcept;
+	// writes a final row set to the configured csv regardless of the interval
+	void Flush(const double Time) noexcept;
+
+	// remembers current totals so the panel can show growth, which is how leaks show up
+	void Mark() noexcept;
+	void OnGui() noexcept;
+
+private:
+	FMemoryTracker() = default;
+
+	void WriteCsvRows(FILE* File, const double Time) const noexcept;
+
+	static constexpr size_t TAG_COUNT = static_cast<size_t>(EMemoryTag::COUNT);
+
+	uint64_t LastAllocations[TAG_COUNT]{};
+	float AllocationsPerSecond[TAG_COUNT]{};
+	double LastSampleTime = -1.0;
+
+	STagStatistics MarkedStatistics[TAG_COUNT]{};
+	bool bHasMark = false;
+
+	char CsvFileName[260]{};
+	double CsvInterval = 0.0;
+	double LastCsvTime = -1.0;
+};
@@ -0,0 +1,24 @@
+#include "MeshImport.hpp"
+
+#include <assimp/scene.h>
+
+void ExtractTangentSpaceInput(const aiMesh* Mesh, TArenaVector<DirectX::XMFLOAT3>& Positions, TArenaVector<DirectX::XMFLOAT2>& TexCoords, TArenaVector<uint32_t>& Indices)
+{
+	Positions.resize(Mesh->mNumVertices);
+	TexCoords.resize(Mesh->mNumVertices);
+	for (size_t i = 0; i < Mesh->mNumVertices; ++i)
+	{
+		Positions[i] = { Mesh->mVertices[i].x, Mesh->mVertices[i].y, Mesh->mVertices[i].z };
+		TexCoords[i] = Mesh->mTextureCoords[0] ? DirectX::XMFLOAT2(Mesh->mTextureCoords[0][i].x, Mesh->mTextureCoords[0][i].y) : DirectX::XMFLOAT2(0.0f, 0.0f);
+	}
+	Indices.clear();
+	Indices.reserve(Mesh->mNumFaces * 3);
+	for (size_t i = 0; i < Mesh->mNumFaces; ++i)
+	{
+		const aiFace& Face = Mesh->mFaces[i];
+		if (Face.mNumIndices == 3)
+		{
+			Indices.insert(Indices.end(), Face.mIndices, Face.mIndices + 3);
+		}
+	}
+}
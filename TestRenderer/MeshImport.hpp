@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Allocators.hpp"
+#include <DirectXMath.h>
+#include <assimp/postprocess.h>
+#include <cstdint>
+
+struct aiMesh;
+
+// Post processing FModel imports with, normals and tangents come from GenerateTangentSpace
+static constexpr unsigned int MESH_IMPORT_FLAGS =
+	aiProcess_Triangulate |
+	aiProcess_ConvertToLeftHanded |
+	aiProcess_GenUVCoords |
+	aiProcess_ImproveCacheLocality |
+	aiProcess_FindInvalidData |
+	aiProcess_OptimizeMeshes |
+	aiProcess_OptimizeGraph |
+	aiProcess_JoinIdenticalVertices |
+	aiProcess_FindDegenerates;
+
+// Positions, first texture coordinate set and the triangles of Mesh, faces that are not
+// triangles are skipped
+void ExtractTangentSpaceInput(const aiMesh* Mesh, TArenaVector<DirectX::XMFLOAT3>& Positions, TArenaVector<DirectX::XMFLOAT2>& TexCoords, TArenaVector<uint32_t>& Indices);
@@ -1,56 +1,107 @@
 #include "Model.hpp"
+#include "RadixSort.hpp"
+#include "TangentSpace.hpp"
+#include "MeshImport.hpp"
+#include "Parallel.hpp"
 
 #define NOMINMAX
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <tchar.h>
+#include <cfloat>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
 
-FModel::FModel(FRenderer& Renderer, FCamera& Camera) : InternalRenderer(Renderer), InternalCamera(Camera)
+namespace
+{
+	double MillisecondsSince(const std::chrono::high_resolution_clock::time_point Start) noexcept
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - Start).count();
+	}
+
+	float AngleBetween(const DirectX::XMVECTOR A, const DirectX::XMVECTOR B) noexcept
+	{
+		const float Cosine = DirectX::XMVectorGetX(DirectX::XMVector3Dot(DirectX::XMVector3Normalize(A), DirectX::XMVector3Normalize(B)));
+		return std::acos(Cosine < -1.0f ? -1.0f : Cosine > 1.0f ? 1.0f : Cosine) * 180.0f / 3.14159265f;
+	}
+}
+
+FModel::FModel(FRenderer& Renderer, FCamera& Camera, FTextureCache& TextureCache) : InternalRenderer(Renderer), InternalCamera(Camera), InternalTextureCache(TextureCache)
 {
 }
 
 FModel::~FModel()
 {
-	for (auto& Mesh : Meshes)
-	{
-		InternalRenderer.DestroyBuffer(Mesh.VertexBuffer);
-		InternalRenderer.DestroyBuffer(Mesh.IndexBuffer);
-	}
+	DestroyMeshes();
+	Materials.clear();
+	InternalRenderer.DestroyShader(Shader);
 	InternalRenderer.DestroyBuffer(TransformConstantBuffer);
 }
 
 EErrorCode FModel::Initialize(const char* Path, const uint32_t Width, const uint32_t Height)
 {
 	FilePath = Path;
-	Material.Initialize(Width, Height);
+	const auto ImportStart = std::chrono::high_resolution_clock::now();
+	ImportTimings.TangentSpaceMilliseconds = 0.0;
+
 	Assimp::Importer Importer;
-	const aiScene* Scene = Importer.ReadFile(Path,
-		aiProcess_Triangulate |
-		aiProcess_ConvertToLeftHanded |
-		aiProcess_CalcTangentSpace |
-		aiProcess_GenUVCoords |
-		aiProcess_ForceGenNormals |
-		aiProcess_ImproveCacheLocality |
-		aiProcess_FindInvalidData |
-		aiProcess_OptimizeMeshes |
-		aiProcess_OptimizeGraph |
-		aiProcess_JoinIdenticalVertices |
-		aiProcess_GenNormals |
-		aiProcess_FindDegenerates);
+	const aiScene* Scene = Importer.ReadFile(Path, MESH_IMPORT_FLAGS);
 	
 	if (!Scene || Scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !Scene->mRootNode)
 	{
 		return EErrorCode::FAIL;
 	}
 	
+	if (Shader.Vertex == nullptr)
+	{
+		D3D11_INPUT_ELEMENT_DESC InputElementDescriptors[] =
+		{
+			{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"TANGENT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 32, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		};
+		InternalRenderer.CreateVertexShader(L"DefaultVS.hlsl", "main", InputElementDescriptors, 4, Shader);
+		InternalRenderer.CreatePixelShader(L"DefaultPS.hlsl", "main", Shader);
+	}
+
+	// build the new table before dropping the old one so textures shared between both stay cached
+	const auto RootDir = FilePath.substr(0, FilePath.find_last_of("/\\") + 1);
+	std::vector<std::unique_ptr<FMaterial>> NewMaterials;
+	NewMaterials.reserve(Scene->mNumMaterials);
+	for (size_t i = 0; i < Scene->mNumMaterials; ++i)
+	{
+		auto Material = std::make_unique<FMaterial>(InternalRenderer, InternalTextureCache);
+		Material->Initialize(Width, Height);
+		Material->LoadMaterial(RootDir, Scene->mMaterials[i]);
+		NewMaterials.push_back(std::move(Material));
+	}
+	Materials = std::move(NewMaterials);
+	SelectedMaterial = 0;
+
 	ProcessNode(Scene->mRootNode, Scene);
+	SelectOccluders();
+	AssignStateIds();
 
-	PerFrame.World = DirectX::XMMatrixTranspose(DirectX::XMMatrixIdentity());
-	PerFrame.View = DirectX::XMMatrixTranspose(InternalCamera.GetViewMatrix());
-	PerFrame.Projection = DirectX::XMMatrixTranspose(InternalCamera.GetProjectionMatrix());
+	ImportTimings.ImportMilliseconds = MillisecondsSince(ImportStart);
+	ImportArena.Trim();
+
+	DrawItems.resize(Meshes.size());
+	DrawItemsScratch.resize(Meshes.size());
 
-	InternalRenderer.CreateConstantBufferWithData(PerFrame, TransformConstantBuffer);
+	// PerFrame belongs to the update, which may be running while a mesh is loaded from the gui
+	if (TransformConstantBuffer.Buffer == nullptr)
+	{
+		SPerFrame Transform{};
+		Transform.World = DirectX::XMMatrixIdentity();
+		Transform.View = DirectX::XMMatrixIdentity();
+		Transform.Projection = DirectX::XMMatrixIdentity();
+		InternalRenderer.CreateConstantBufferWithData(Transform, TransformConstantBuffer);
+	}
 	return EErrorCode::OK;
 }
 
@@ -69,80 +120,197 @@ void FModel::ProcessNode(aiNode* Node, const aiScene* Scene)
 
 FModel::SMesh FModel::ProcessMesh(aiMesh* Mesh, const aiScene* Scene)
 {
-	const auto Vertices = new SVertex[Mesh->mNumVertices];
-	std::vector<uint32_t> Indices;
+	FArenaScope Scope(ImportArena);
+	TArenaVector<DirectX::XMFLOAT3> Positions{ TArenaAdaptor<DirectX::XMFLOAT3>(ImportArena) };
+	TArenaVector<DirectX::XMFLOAT2> TexCoords{ TArenaAdaptor<DirectX::XMFLOAT2>(ImportArena) };
+	TArenaVector<uint32_t> InputIndices{ TArenaAdaptor<uint32_t>(ImportArena) };
+	ExtractTangentSpaceInput(Mesh, Positions, TexCoords, InputIndices);
 
-	for (size_t i = 0; i < Mesh->mNumVertices; ++i)
+	STangentSpaceInput Input{};
+	Input.Positions = Positions.data();
+	Input.TexCoords = TexCoords.data();
+	Input.VertexCount = Positions.size();
+	Input.Indices = InputIndices.data();
+	Input.IndexCount = InputIndices.size();
+
+	TArenaVector<SVertex> Vertices{ TArenaAdaptor<SVertex>(ImportArena) };
+	TArenaVector<uint32_t> Indices{ TArenaAdaptor<uint32_t>(ImportArena) };
+	const auto TangentSpaceStart = std::chrono::high_resolution_clock::now();
+	GenerateTangentSpace(ImportArena, Input, SmoothingAngle, Vertices, Indices);
+	ImportTimings.TangentSpaceMilliseconds += MillisecondsSince(TangentSpaceStart);
+
+	SMesh TempMesh{};
+	TempMesh.BoundsMin = { FLT_MAX, FLT_MAX, FLT_MAX };
+	TempMesh.BoundsMax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (const auto& Vertex : Vertices)
 	{
-		SVertex Vertex{};
-		Vertex.Position.x = Mesh->mVertices[i].x;
-		Vertex.Position.y = Mesh->mVertices[i].y;
-		Vertex.Position.z = Mesh->mVertices[i].z;
+		DirectX::XMStoreFloat3(&TempMesh.BoundsMin, DirectX::XMVectorMin(DirectX::XMLoadFloat3(&TempMesh.BoundsMin), DirectX::XMLoadFloat3(&Vertex.Position)));
+		DirectX::XMStoreFloat3(&TempMesh.BoundsMax, DirectX::XMVectorMax(DirectX::XMLoadFloat3(&TempMesh.BoundsMax), DirectX::XMLoadFloat3(&Vertex.Position)));
+	}
+	TempMesh.MaterialIndex = Mesh->mMaterialIndex;
+	TempMesh.Shader = &Shader;
+	TempMesh.OccluderPositions.assign(Positions.begin(), Positions.end());
+	TempMesh.OccluderIndices.assign(InputIndices.begin(), InputIndices.end());
 
-		Vertex.Normal.x = Mesh->mNormals[i].x;
-		Vertex.Normal.y = Mesh->mNormals[i].y;
-		Vertex.Normal.z = Mesh->mNormals[i].z;
+	InternalRenderer.CreateVertexBufferWithData(Vertices.data(), Vertices.size(), TempMesh.VertexBuffer);
+	InternalRenderer.CreateIndexBufferWithData(Indices.data(), Indices.size(), TempMesh.IndexBuffer);
+	TempMesh.IndexCount = Indices.size();
 
-		if (Mesh->mTextureCoords[0])
-		{
-			Vertex.TexCoord.x = Mesh->mTextureCoords[0][i].x;
-			Vertex.TexCoord.y = Mesh->mTextureCoords[0][i].y;
-		}
-		else
-		{
-			Vertex.TexCoord = { 0.0f, 0.0f };
-		}
-		
-		if (Mesh->mTangents)
-		{
-			Vertex.Tangent.x = Mesh->mTangents[i].x;
-			Vertex.Tangent.y = Mesh->mTangents[i].y;
-			Vertex.Tangent.z = Mesh->mTangents[i].z;
-		}
-		else
-		{
-			Vertex.Tangent = { 0, 0, 0 };
-		}
-		
-		if (Mesh->mBitangents)
+	return TempMesh;
+}
+
+void FModel::DestroyMeshes() noexcept
+{
+	for (auto& Mesh : Meshes)
+	{
+		InternalRenderer.DestroyBuffer(Mesh.VertexBuffer);
+		InternalRenderer.DestroyBuffer(Mesh.IndexBuffer);
+	}
+	Meshes.clear();
+	DrawItemCount = 0;
+}
+
+void FModel::SelectOccluders() noexcept
+{
+	// the largest meshes hide the most, everything else drops its cpu copy
+	std::vector<std::pair<float, size_t>> Sizes(Meshes.size());
+	for (size_t i = 0; i < Meshes.size(); ++i)
+	{
+		const auto Extent = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&Meshes[i].BoundsMax), DirectX::XMLoadFloat3(&Meshes[i].BoundsMin));
+		Sizes[i] = { DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(Extent)), i };
+	}
+	const auto OccluderCount = std::min(Sizes.size(), static_cast<size_t>(std::max(MaximumOccluders, 0)));
+	std::partial_sort(Sizes.begin(), Sizes.begin() + OccluderCount, Sizes.end(), [](const std::pair<float, size_t>& A, const std::pair<float, size_t>& B) { return A.first > B.first; });
+	for (size_t i = OccluderCount; i < Sizes.size(); ++i)
+	{
+		auto& Mesh = Meshes[Sizes[i].second];
+		std::vector<DirectX::XMFLOAT3>().swap(Mesh.OccluderPositions);
+		std::vector<uint32_t>().swap(Mesh.OccluderIndices);
+	}
+}
+
+void FModel::AssignStateIds() noexcept
+{
+	std::unordered_map<const void*, uint32_t> ShaderIds;
+	std::unordered_map<const void*, uint32_t> VertexBufferIds;
+	for (auto& Mesh : Meshes)
+	{
+		Mesh.ShaderId = ShaderIds.emplace(Mesh.Shader, static_cast<uint32_t>(ShaderIds.size())).first->second;
+		Mesh.VertexBufferId = VertexBufferIds.emplace(Mesh.VertexBuffer.Buffer, static_cast<uint32_t>(VertexBufferIds.size())).first->second;
+	}
+}
+
+void FModel::ValidateTangentSpace() noexcept
+{
+	// no welding or reordering, so corner i of both imports refers to the same face corner
+	const unsigned int BaseFlags = aiProcess_Triangulate | aiProcess_ConvertToLeftHanded | aiProcess_GenUVCoords;
+
+	Assimp::Importer Importer;
+	Importer.SetPropertyFloat(AI_CONFIG_PP_GSN_MAX_SMOOTHING_ANGLE, SmoothingAngle);
+	Importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, aiComponent_NORMALS | aiComponent_TANGENTS_AND_BITANGENTS);
+	const aiScene* Source = Importer.ReadFile(FilePath, BaseFlags | aiProcess_RemoveComponent);
+	if (!Source || Source->mFlags & AI_SCENE_FLAGS_INCOMPLETE)
+	{
+		Validation.bValid = false;
+		return;
+	}
+
+	FArenaScope Scope(ImportArena);
+	std::vector<TArenaVector<SVertex>> GeneratedVertices(Source->mNumMeshes, TArenaVector<SVertex>{ TArenaAdaptor<SVertex>(ImportArena) });
+	std::vector<TArenaVector<uint32_t>> GeneratedIndices(Source->mNumMeshes, TArenaVector<uint32_t>{ TArenaAdaptor<uint32_t>(ImportArena) });
+	const auto GeneratorStart = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < Source->mNumMeshes; ++i)
+	{
+		TArenaVector<DirectX::XMFLOAT3> Positions{ TArenaAdaptor<DirectX::XMFLOAT3>(ImportArena) };
+		TArenaVector<DirectX::XMFLOAT2> TexCoords{ TArenaAdaptor<DirectX::XMFLOAT2>(ImportArena) };
+		TArenaVector<uint32_t> InputIndices{ TArenaAdaptor<uint32_t>(ImportArena) };
+		ExtractTangentSpaceInput(Source->mMeshes[i], Positions, TexCoords, InputIndices);
+
+		STangentSpaceInput Input{};
+		Input.Positions = Positions.data();
+		Input.TexCoords = TexCoords.data();
+		Input.VertexCount = Positions.size();
+		Input.Indices = InputIndices.data();
+		Input.IndexCount = InputIndices.size();
+		GenerateTangentSpace(ImportArena, Input, SmoothingAngle, GeneratedVertices[i], GeneratedIndices[i]);
+	}
+	Validation.GeneratorMilliseconds = MillisecondsSince(GeneratorStart);
+
+	// ApplyPostProcessing reuses the already imported scene so only the generation steps are timed
+	const auto AssimpStart = std::chrono::high_resolution_clock::now();
+	const aiScene* Reference = Importer.ApplyPostProcessing((SmoothingAngle > 0.0f ? aiProcess_GenSmoothNormals : aiProcess_GenNormals) | aiProcess_CalcTangentSpace);
+	Validation.AssimpMilliseconds = MillisecondsSince(AssimpStart);
+	if (!Reference)
+	{
+		Validation.bValid = false;
+		return;
+	}
+
+	Validation = STangentSpaceValidation{ true, 0, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, Validation.AssimpMilliseconds, Validation.GeneratorMilliseconds };
+	double NormalErrorSum = 0.0;
+	double TangentErrorSum = 0.0;
+	size_t HandednessMismatches = 0;
+	for (size_t i = 0; i < Reference->mNumMeshes; ++i)
+	{
+		const aiMesh* Mesh = Reference->mMeshes[i];
+		if (!Mesh->mNormals || !Mesh->mTangents)
 		{
-			Vertex.Bitangent.x = Mesh->mBitangents[i].x;
-			Vertex.Bitangent.y = Mesh->mBitangents[i].y;
-			Vertex.Bitangent.z = Mesh->mBitangents[i].z;
+			continue;
 		}
-		else
+		size_t Corner = 0;
+		for (size_t Face = 0; Face < Mesh->mNumFaces; ++Face)
 		{
-			Vertex.Bitangent = { 0, 0, 0 };
+			if (Mesh->mFaces[Face].mNumIndices != 3)
+			{
+				continue;
+			}
+			for (size_t j = 0; j < 3; ++j, ++Corner)
+			{
+				const auto Index = Mesh->mFaces[Face].mIndices[j];
+				const auto& Generated = GeneratedVertices[i][GeneratedIndices[i][Corner]];
+				const auto Normal = DirectX::XMVectorSet(Mesh->mNormals[Index].x, Mesh->mNormals[Index].y, Mesh->mNormals[Index].z, 0.0f);
+				const auto Tangent = DirectX::XMVectorSet(Mesh->mTangents[Index].x, Mesh->mTangents[Index].y, Mesh->mTangents[Index].z, 0.0f);
+				const auto Bitangent = DirectX::XMVectorSet(Mesh->mBitangents[Index].x, Mesh->mBitangents[Index].y, Mesh->mBitangents[Index].z, 0.0f);
+
+				const float NormalError = AngleBetween(Normal, DirectX::XMLoadFloat3(&Generated.Normal));
+				const float TangentError = AngleBetween(Tangent, DirectX::XMLoadFloat4(&Generated.Tangent));
+				Validation.MaximumNormalError = NormalError > Validation.MaximumNormalError ? NormalError : Validation.MaximumNormalError;
+				Validation.MaximumTangentError = TangentError > Validation.MaximumTangentError ? TangentError : Validation.MaximumTangentError;
+				NormalErrorSum += NormalError;
+				TangentErrorSum += TangentError;
+
+				const auto Reconstructed = DirectX::XMVectorScale(DirectX::XMVector3Cross(DirectX::XMLoadFloat3(&Generated.Normal), DirectX::XMLoadFloat4(&Generated.Tangent)), Generated.Tangent.w);
+				HandednessMismatches += DirectX::XMVectorGetX(DirectX::XMVector3Dot(Reconstructed, Bitangent)) < 0.0f ? 1 : 0;
+			}
 		}
-		Vertices[i] = Vertex;
+		Validation.CornerCount += Corner;
 	}
-	for (size_t i = 0; i < Mesh->mNumFaces; ++i)
+
+	if (Validation.CornerCount > 0)
 	{
-		const aiFace Face = Mesh->mFaces[i];
-		for (size_t j = 0; j < Face.mNumIndices; ++j)
-		{
-			Indices.push_back(Face.mIndices[j]);
-		}
+		Validation.MeanNormalError = static_cast<float>(NormalErrorSum / Validation.CornerCount);
+		Validation.MeanTangentError = static_cast<float>(TangentErrorSum / Validation.CornerCount);
+		Validation.HandednessMismatch = static_cast<float>(HandednessMismatches) * 100.0f / Validation.CornerCount;
 	}
-	Material.LoadMaterial(FilePath.substr(0, FilePath.find_last_of("/\\") + 1),
-	                      Scene->mMaterials[Mesh->mMaterialIndex]);
-
-	SMesh TempMesh{};
-	InternalRenderer.CreateVertexBufferWithData(Vertices, Mesh->mNumVertices, TempMesh.VertexBuffer);
-	InternalRenderer.CreateIndexBufferWithData(Indices.data(), Indices.size(), TempMesh.IndexBuffer);
-	TempMesh.IndexCount = Indices.size();
-	delete[] Vertices;
-
-	return TempMesh;
 }
 
-void FModel::OnUpdate(const float Time) noexcept
+void FModel::OnUpdate(const float Time, const DirectX::XMFLOAT3& ModelRotation) noexcept
 {
-	PerFrame.World = DirectX::XMMatrixTranspose(DirectX::XMMatrixRotationRollPitchYaw(Rotation.x, Rotation.y, Rotation.z));
+	PerFrame.World = DirectX::XMMatrixTranspose(DirectX::XMMatrixRotationRollPitchYaw(ModelRotation.x, ModelRotation.y, ModelRotation.z));
 	PerFrame.View = DirectX::XMMatrixTranspose(InternalCamera.GetViewMatrix());
 	PerFrame.Projection = DirectX::XMMatrixTranspose(InternalCamera.GetProjectionMatrix());
 }
 
+void FModel::WriteState(SState& State) const noexcept
+{
+	State.PerFrame = PerFrame;
+}
+
+const DirectX::XMFLOAT3& FModel::GetRotation() const noexcept
+{
+	return Rotation;
+}
+
 void FModel::OnGui() noexcept
 {
 	ImGui::Begin("Model");
@@ -164,34 +332,214 @@ void FModel::OnGui() noexcept
 			OpenFileName.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST;
 			if (GetOpenFileName(&OpenFileName) == TRUE)
 			{
-				for (auto& Mesh : Meshes)
-				{
-					InternalRenderer.DestroyBuffer(Mesh.VertexBuffer);
-					InternalRenderer.DestroyBuffer(Mesh.IndexBuffer);
-				}
-				Meshes.clear();
+				DestroyMeshes();
 				Initialize(OpenFileName.lpstrFile, 0, 0);
 			}
 		}
 		ImGui::DragFloat3("Rotation", &Rotation.x, 0.001f);
-		Material.OnGui();
+
+		ImGui::SliderFloat("Smoothing Angle", &SmoothingAngle, 0.0f, 180.0f);
+		if (ImGui::Button("Reload"))
+		{
+			const auto Path = FilePath;
+			DestroyMeshes();
+			Initialize(Path.c_str(), 0, 0);
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Validate against Assimp"))
+		{
+			ValidateTangentSpace();
+			ImportArena.Trim();
+		}
+		ImGui::Text("Import: %.2f ms (tangent space %.2f ms)", ImportTimings.ImportMilliseconds, ImportTimings.TangentSpaceMilliseconds);
+		if (Validation.bValid)
+		{
+			ImGui::Text("Generation: %.2f ms, Assimp %.2f ms", Validation.GeneratorMilliseconds, Validation.AssimpMilliseconds);
+			ImGui::Text("Normal error: max %.3f, mean %.3f deg", Validation.MaximumNormalError, Validation.MeanNormalError);
+			ImGui::Text("Tangent error: max %.3f, mean %.3f deg", Validation.MaximumTangentError, Validation.MeanTangentError);
+			ImGui::Text("Handedness mismatch: %.2f%% of %u corners", Validation.HandednessMismatch, static_cast<uint32_t>(Validation.CornerCount));
+		}
+
+		ImGui::Checkbox("Occlusion Culling", &bOcclusionCulling);
+		ImGui::SameLine();
+		bool bUseAvx2 = OcclusionCuller.IsUsingAvx2();
+		if (ImGui::Checkbox("AVX2", &bUseAvx2))
+		{
+			OcclusionCuller.SetUseAvx2(bUseAvx2);
+		}
+		ImGui::SliderInt("Occluders (on reload)", &MaximumOccluders, 0, 64);
+		if (bOcclusionCulling)
+		{
+			const auto& Culling = OcclusionCuller.GetStatistics();
+			const auto Rejected = Culling.FrustumCulled + Culling.OcclusionCulled;
+			ImGui::Text("Occluder triangles: %u (%u rasterized)", Culling.OccluderTriangles, Culling.RasterizedTriangles);
+			ImGui::Text("Raster: %.3f ms, test: %.3f ms", Culling.RasterMilliseconds, Culling.TestMilliseconds);
+			ImGui::Text("Rejected: %u of %u (%.1f%%, %u frustum, %u occluded)", Rejected, Culling.TestedBounds,
+				Culling.TestedBounds > 0 ? Rejected * 100.0f / Culling.TestedBounds : 0.0f, Culling.FrustumCulled, Culling.OcclusionCulled);
+		}
+
+		ImGui::Checkbox("Parallel Recording", &bParallelRecording);
+		ImGui::SameLine();
+		ImGui::SliderInt("Threads", &RecordingThreads, 1, 16);
+		if (ImGui::Button("Benchmark Recording (10k draws)"))
+		{
+			// up to the threads of the job system parallel recording runs on
+			const auto JobSystem = FJobSystem::GetCurrent();
+			RecordingBenchmark = RunRecordingBenchmark(10000, JobSystem ? static_cast<uint32_t>(JobSystem->GetThreadCount()) : 1u, 5);
+		}
+		for (const auto& Result : RecordingBenchmark)
+		{
+			ImGui::Text("%2u threads: %.3f ms, %.0f draws/ms, %.2fx", Result.ThreadCount, Result.Milliseconds, Result.DrawsPerMillisecond, Result.Speedup);
+		}
+
+		ImGui::Text("Draws: %u", SortedStateChanges.Draws);
+		ImGui::Text("Shader binds: %u -> %u", UnsortedStateChanges.ShaderBinds, SortedStateChanges.ShaderBinds);
+		ImGui::Text("Material binds: %u -> %u", UnsortedStateChanges.MaterialBinds, SortedStateChanges.MaterialBinds);
+		ImGui::Text("Vertex buffer binds: %u -> %u", UnsortedStateChanges.VertexBufferBinds, SortedStateChanges.VertexBufferBinds);
+
+		if (!Materials.empty())
+		{
+			ImGui::SliderInt("Material", &SelectedMaterial, 0, static_cast<int>(Materials.size()) - 1);
+			Materials[SelectedMaterial]->OnGui();
+		}
 		InternalCamera.OnGui();
 	}
 	ImGui::End();
 }
 
-void FModel::OnRender(const SRenderTarget* RenderTargets, const size_t Count)  noexcept
+void FModel::BuildDrawList(const SPerFrame& Transform) noexcept
 {
-	Material.OnRender();
-	InternalCamera.OnRender();
+	const auto WorldView = DirectX::XMMatrixMultiply(DirectX::XMMatrixTranspose(Transform.World), DirectX::XMMatrixTranspose(Transform.View));
+	const auto WorldViewProjection = DirectX::XMMatrixMultiply(WorldView, DirectX::XMMatrixTranspose(Transform.Projection));
+	if (bOcclusionCulling)
+	{
+		OcclusionCuller.BeginFrame();
+		for (const auto& Mesh : Meshes)
+		{
+			if (!Mesh.OccluderIndices.empty())
+			{
+				OcclusionCuller.RenderOccluder(Mesh.OccluderPositions.data(), Mesh.OccluderPositions.size(), Mesh.OccluderIndices.data(), Mesh.OccluderIndices.size(), WorldViewProjection);
+			}
+		}
+		OcclusionCuller.EndOccluders();
+	}
+
+	DrawItemCount = 0;
+	for (size_t i = 0; i < Meshes.size(); ++i)
+	{
+		const auto& Mesh = Meshes[i];
+		if (bOcclusionCulling && !OcclusionCuller.IsVisible(Mesh.BoundsMin, Mesh.BoundsMax, WorldViewProjection))
+		{
+			continue;
+		}
+		const auto Center = DirectX::XMVectorScale(DirectX::XMVectorAdd(DirectX::XMLoadFloat3(&Mesh.BoundsMin), DirectX::XMLoadFloat3(&Mesh.BoundsMax)), 0.5f);
+		const auto ViewDepth = DirectX::XMVectorGetZ(DirectX::XMVector3TransformCoord(Center, WorldView));
+
+		// positive floats sort like integers, keep the top 24 bits for front to back order
+		uint32_t DepthBits = 0;
+		const float ClampedDepth = ViewDepth > 0.0f ? ViewDepth : 0.0f;
+		memcpy(&DepthBits, &ClampedDepth, sizeof(DepthBits));
+
+		// ids past their bits only group worse, binds follow the state actually bound
+		const uint64_t ShaderId = Mesh.ShaderId & 0xFF;
+		const uint64_t MaterialId = Mesh.MaterialIndex & 0xFFFF;
+		const uint64_t VertexBufferId = Mesh.VertexBufferId & 0xFFFF;
+		auto& Item = DrawItems[DrawItemCount++];
+		Item.SortKey = (ShaderId << 56) | (MaterialId << 40) | (static_cast<uint64_t>(DepthBits >> 7) << 16) | VertexBufferId;
+		Item.MeshIndex = static_cast<uint32_t>(i);
+	}
+
+	UnsortedStateChanges = CountStateChanges();
+	RadixSort64(DrawItems.data(), DrawItemsScratch.data(), DrawItemCount, [](const SDrawItem& Item) { return Item.SortKey; });
+	SortedStateChanges = CountStateChanges();
+}
+
+FModel::SBinds FModel::UpdateBoundState(SBoundState& Bound, const SMesh& Mesh) const noexcept
+{
+	// meshes without a material keep the last one bound
+	const FMaterial* Material = Mesh.MaterialIndex < Materials.size() ? Materials[Mesh.MaterialIndex].get() : nullptr;
+	SBinds Binds{};
+	Binds.bShader = Mesh.Shader != Bound.Shader;
+	Binds.bMaterial = Material != nullptr && Material != Bound.Material;
+	Binds.bBuffers = Mesh.VertexBuffer.Buffer != Bound.VertexBuffer || Mesh.IndexBuffer.Buffer != Bound.IndexBuffer;
+	Bound.Shader = Mesh.Shader;
+	Bound.Material = Material != nullptr ? Material : Bound.Material;
+	Bound.VertexBuffer = Mesh.VertexBuffer.Buffer;
+	Bound.IndexBuffer = Mesh.IndexBuffer.Buffer;
+	return Binds;
+}
+
+FModel::SStateChanges FModel::CountStateChanges() const noexcept
+{
+	SStateChanges Changes{};
+	SBoundState Bound{};
+	for (size_t i = 0; i < DrawItemCount; ++i)
+	{
+		const auto Binds = UpdateBoundState(Bound, Meshes[DrawItems[i].MeshIndex]);
+		Changes.ShaderBinds += Binds.bShader;
+		Changes.MaterialBinds += Binds.bMaterial;
+		Changes.VertexBufferBinds += Binds.bBuffers;
+		++Changes.Draws;
+	}
+	return Changes;
+}
 
+void FModel::OnRender(const SState& State, const SRenderTarget* RenderTargets, const size_t Count)  noexcept
+{
 	InternalRenderer.SetConstantBuffer(TransformConstantBuffer, EShaderStage::VERTEX);
-	InternalRenderer.UpdateSubresource(TransformConstantBuffer, &PerFrame, sizeof(SPerFrame));
-	for (auto& Mesh : Meshes)
+	InternalRenderer.UpdateSubresource(TransformConstantBuffer, &State.PerFrame, sizeof(SPerFrame));
+	InternalRenderer.SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	BuildDrawList(State.PerFrame);
+
+	if (!bParallelRecording || DrawItemCount == 0)
+	{
+		RecordDrawItems(InternalRenderer, [](FMaterial& Material) { Material.OnRender(); }, 0, DrawItemCount);
+		return;
+	}
+
+	// the lists inherit the camera, light and transform bindings made above, so they are
+	// replayed on the immediate context rather than through deferred contexts
+	const auto ListCount = std::min<size_t>(std::max(RecordingThreads, 1), DrawItemCount);
+	CommandLists.resize(ListCount);
+	CommandListPointers.resize(ListCount);
+	ParallelFor(ListCount, 1, [this, ListCount](const size_t Begin, const size_t End)
+	{
+		FMemoryTagScope MemoryTag(EMemoryTag::MODEL);
+		for (size_t List = Begin; List < End; ++List)
+		{
+			auto& CommandList = CommandLists[List];
+			CommandList.Reset(static_cast<uint32_t>(List));
+			RecordDrawItems(CommandList, [&CommandList](const FMaterial& Material) { Material.OnRender(CommandList); },
+				DrawItemCount * List / ListCount, DrawItemCount * (List + 1) / ListCount);
+			CommandListPointers[List] = &CommandList;
+		}
+	});
+	InternalRenderer.Submit(CommandListPointers.data(), ListCount, ECommandBackend::RECORDED);
+}
+
+template <typename TTarget, typename TBindMaterial>
+void FModel::RecordDrawItems(TTarget& Target, TBindMaterial&& BindMaterial, const size_t Begin, const size_t End)
+{
+	// the sort only groups the draws, what is rebound follows from what is bound already
+	SBoundState Bound{};
+	for (size_t i = Begin; i < End; ++i)
 	{
-		InternalRenderer.SetVertexBuffer(0, Mesh.VertexBuffer, 0);
-		InternalRenderer.SetIndexBuffer(0, Mesh.IndexBuffer, 0);
-		InternalRenderer.SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-		InternalRenderer.DrawIndexed(Mesh.IndexCount);
+		const auto& Mesh = Meshes[DrawItems[i].MeshIndex];
+		const auto Binds = UpdateBoundState(Bound, Mesh);
+		if (Binds.bShader)
+		{
+			Target.SetShader(*Mesh.Shader);
+		}
+		if (Binds.bMaterial)
+		{
+			BindMaterial(*Materials[Mesh.MaterialIndex]);
+		}
+		if (Binds.bBuffers)
+		{
+			Target.SetVertexBuffer(0, Mesh.VertexBuffer, 0);
+			Target.SetIndexBuffer(0, Mesh.IndexBuffer, 0);
+		}
+		Target.DrawIndexed(Mesh.IndexCount);
 	}
-}
\ No newline at end of file
+}
@@ -2,29 +2,90 @@
 #include "Renderer.hpp"
 #include "Camera.hpp"
 #include "Material.hpp"
+#include "TextureCache.hpp"
+#include "TangentSpace.hpp"
+#include "OcclusionCulling.hpp"
+#include "CommandList.hpp"
 #include <assimp/scene.h>
 #include <DirectXMath.h>
 #include <vector>
+#include <memory>
 
 class FModel
 {
 private:
-	struct SVertex
-	{
-		DirectX::XMFLOAT3 Position;
-		DirectX::XMFLOAT3 Normal;
-		DirectX::XMFLOAT2 TexCoord;
-		DirectX::XMFLOAT3 Tangent;
-		DirectX::XMFLOAT3 Bitangent;
-	};
+	using SVertex = STangentSpaceVertex;
 
 	struct SMesh
 	{
 		SBuffer VertexBuffer;
 		SBuffer IndexBuffer;
 		size_t IndexCount;
+		uint32_t MaterialIndex;
+		// the model's shader, materials do not bring their own
+		const SShader* Shader;
+		// dense ids of the shader and vertex buffer, meshes drawn with the same ones share them
+		uint32_t ShaderId;
+		uint32_t VertexBufferId;
+		DirectX::XMFLOAT3 BoundsMin;
+		DirectX::XMFLOAT3 BoundsMax;
+		// cpu copy of the geometry, only kept for meshes selected as occluders
+		std::vector<DirectX::XMFLOAT3> OccluderPositions;
+		std::vector<uint32_t> OccluderIndices;
+	};
+
+	// sort key layout, most significant first: shader 8 | material 16 | depth 24 | vertex buffer 16.
+	// Every mesh has buffers of its own, above depth they would only keep the draws in mesh order.
+	struct SDrawItem
+	{
+		uint64_t SortKey;
+		uint32_t MeshIndex;
+	};
+
+	struct SStateChanges
+	{
+		uint32_t Draws = 0;
+		uint32_t ShaderBinds = 0;
+		uint32_t MaterialBinds = 0;
+		uint32_t VertexBufferBinds = 0;
+	};
+
+	// what the draws recorded so far left bound, nothing at the start of a list
+	struct SBoundState
+	{
+		const SShader* Shader = nullptr;
+		const FMaterial* Material = nullptr;
+		const ID3D11Buffer* VertexBuffer = nullptr;
+		const ID3D11Buffer* IndexBuffer = nullptr;
+	};
+
+	struct SBinds
+	{
+		bool bShader;
+		bool bMaterial;
+		bool bBuffers;
+	};
+
+	struct SImportTimings
+	{
+		double ImportMilliseconds = 0.0;
+		double TangentSpaceMilliseconds = 0.0;
+	};
+
+	struct STangentSpaceValidation
+	{
+		bool bValid = false;
+		size_t CornerCount = 0;
+		float MaximumNormalError = 0.0f;
+		float MeanNormalError = 0.0f;
+		float MaximumTangentError = 0.0f;
+		float MeanTangentError = 0.0f;
+		float HandednessMismatch = 0.0f;
+		double AssimpMilliseconds = 0.0;
+		double GeneratorMilliseconds = 0.0;
 	};
 
+public:
 	struct SPerFrame
 	{
 		DirectX::XMMATRIX World;
@@ -32,28 +93,80 @@ private:
 		DirectX::XMMATRIX Projection;
 	};
 
-public:
+	// transforms of one update, rendered while the next update runs
+	struct SState
+	{
+		SPerFrame PerFrame;
+	};
 
-	explicit FModel(FRenderer& Renderer, FCamera& Camera);
+	explicit FModel(FRenderer& Renderer, FCamera& Camera, FTextureCache& TextureCache);
 	~FModel();
 	
 	EErrorCode Initialize(const char* Path, const uint32_t Width, const uint32_t Height);
-	void OnUpdate(const float Time) noexcept;
+	void OnUpdate(const float Time, const DirectX::XMFLOAT3& ModelRotation) noexcept;
+	void WriteState(SState& State) const noexcept;
 	void OnGui() noexcept;
-	void OnRender(const SRenderTarget* RenderTargets, const size_t Count) noexcept;
+	// the camera is rendered from its own state beforehand
+	void OnRender(const SState& State, const SRenderTarget* RenderTargets, const size_t Count) noexcept;
+
+	// edited by the gui, handed to OnUpdate by the caller
+	const DirectX::XMFLOAT3& GetRotation() const noexcept;
 
 	void ProcessNode(aiNode* Node, const aiScene* Scene);
 	SMesh ProcessMesh(aiMesh* Mesh, const aiScene* Scene);
 private:
+	void DestroyMeshes() noexcept;
+	void SelectOccluders() noexcept;
+	void AssignStateIds() noexcept;
+	void ValidateTangentSpace() noexcept;
+	void BuildDrawList(const SPerFrame& Transform) noexcept;
+	// BindMaterial(FMaterial&) binds a material to whatever Target records into
+	template <typename TTarget, typename TBindMaterial>
+	void RecordDrawItems(TTarget& Target, TBindMaterial&& BindMaterial, const size_t Begin, const size_t End);
+	// what has to be bound to draw Mesh after the draws that left Bound, which is updated
+	SBinds UpdateBoundState(SBoundState& Bound, const SMesh& Mesh) const noexcept;
+	// binds the first DrawItemCount items in their current order would make
+	SStateChanges CountStateChanges() const noexcept;
+
 	FRenderer& InternalRenderer;
 	FCamera& InternalCamera;
-	FMaterial Material{ InternalRenderer };
+	FTextureCache& InternalTextureCache;
+
+	// indexed by aiMesh::mMaterialIndex
+	std::vector<std::unique_ptr<FMaterial>> Materials;
+	int SelectedMaterial = 0;
+	SShader Shader{};
 
 	DirectX::XMFLOAT3 Rotation;
 
 	std::string FilePath;
 
+	// scratch for ProcessMesh and validation, trimmed once an import is done
+	FArenaAllocator ImportArena{ "Import", 4 << 20 };
+
+	float SmoothingAngle = 0.0f;
+	SImportTimings ImportTimings{};
+	STangentSpaceValidation Validation{};
+
 	std::vector<SMesh> Meshes;
+	std::vector<SDrawItem> DrawItems;
+	std::vector<SDrawItem> DrawItemsScratch;
+	// meshes rejected by culling are left out, only the first DrawItemCount items are valid
+	size_t DrawItemCount = 0;
+
+	FOcclusionCuller OcclusionCuller;
+	bool bOcclusionCulling = true;
+	int MaximumOccluders = 16;
+
+	// draw items split into contiguous ranges, recorded in parallel and replayed in order
+	bool bParallelRecording = false;
+	int RecordingThreads = 4;
+	std::vector<FCommandList> CommandLists;
+	std::vector<const FCommandList*> CommandListPointers;
+	std::vector<SRecordingBenchmark> RecordingBenchmark;
+
+	SStateChanges UnsortedStateChanges{};
+	SStateChanges SortedStateChanges{};
 	
 	SBuffer TransformConstantBuffer{};
 	SPerFrame PerFrame{};
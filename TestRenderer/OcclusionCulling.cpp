@@ -0,0 +1,522 @@
+#include "OcclusionCulling.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define OCCLUSION_HAS_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define OCCLUSION_HAS_AVX2 0
+#endif
+
+// MSVC emits AVX2 intrinsics anywhere, GCC and Clang need the functions marked. Not with FMA, the
+// compilers would contract multiplies and adds, which round differently from the scalar path.
+#if OCCLUSION_HAS_AVX2 && (defined(__GNUC__) || defined(__clang__))
+#define OCCLUSION_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define OCCLUSION_AVX2_TARGET
+#endif
+
+namespace
+{
+	constexpr float MINIMUM_AREA = 1.0e-6f;
+
+	double MillisecondsSince(const std::chrono::high_resolution_clock::time_point Start) noexcept
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - Start).count();
+	}
+
+	// clips a triangle against the near plane, z >= 0 in D3D clip space, and returns the vertex count
+	uint32_t ClipNear(const DirectX::XMFLOAT4* Input, DirectX::XMFLOAT4* Output) noexcept
+	{
+		uint32_t Count = 0;
+		for (uint32_t Index = 0; Index < 3; ++Index)
+		{
+			const auto& Current = Input[Index];
+			const auto& Next = Input[(Index + 1) % 3];
+			const bool bCurrentInside = Current.z >= 0.0f;
+			const bool bNextInside = Next.z >= 0.0f;
+			if (bCurrentInside)
+			{
+				Output[Count++] = Current;
+			}
+			if (bCurrentInside != bNextInside)
+			{
+				const float T = Current.z / (Current.z - Next.z);
+				Output[Count++] = {
+					Current.x + (Next.x - Current.x) * T,
+					Current.y + (Next.y - Current.y) * T,
+					0.0f,
+					Current.w + (Next.w - Current.w) * T
+				};
+			}
+		}
+		return Count;
+	}
+}
+
+FOcclusionCuller::FOcclusionCuller()
+	: bUseAvx2(IsAvx2Supported())
+	, Depth(WIDTH * HEIGHT, 1.0f)
+	, TileMaxDepth(TILES_X * TILES_Y, 1.0f)
+{
+}
+
+void FOcclusionCuller::SetUseAvx2(const bool bUseAvx2) noexcept
+{
+	this->bUseAvx2 = bUseAvx2 && IsAvx2Supported();
+}
+
+bool FOcclusionCuller::IsUsingAvx2() const noexcept
+{
+	return bUseAvx2;
+}
+
+bool FOcclusionCuller::IsAvx2Supported() noexcept
+{
+#if OCCLUSION_HAS_AVX2 && defined(_MSC_VER)
+	int Info[4];
+	__cpuid(Info, 0);
+	if (Info[0] < 7)
+	{
+		return false;
+	}
+	__cpuid(Info, 1);
+	const bool bOsXSave = (Info[2] & (1 << 27)) != 0;
+	const bool bAvx = (Info[2] & (1 << 28)) != 0;
+	// the OS has to save the ymm registers as well
+	if (!bOsXSave || !bAvx || (_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+	__cpuidex(Info, 7, 0);
+	return (Info[1] & (1 << 5)) != 0;
+#elif OCCLUSION_HAS_AVX2
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+void FOcclusionCuller::BeginFrame() noexcept
+{
+	std::fill(Depth.begin(), Depth.end(), 1.0f);
+	Statistics = {};
+}
+
+void FOcclusionCuller::RenderOccluder(const DirectX::XMFLOAT3* Positions, const size_t VertexCount, const uint32_t* Indices, const size_t IndexCount, const DirectX::XMMATRIX& WorldViewProjection) noexcept
+{
+	const auto Start = std::chrono::high_resolution_clock::now();
+
+	// grows to the largest occluder once, then stays
+	ClipVertices.resize(std::max(ClipVertices.size(), VertexCount));
+	for (size_t Index = 0; Index < VertexCount; ++Index)
+	{
+		DirectX::XMStoreFloat4(&ClipVertices[Index], DirectX::XMVector3Transform(DirectX::XMLoadFloat3(&Positions[Index]), WorldViewProjection));
+	}
+
+	STriangleBatch Batch{};
+	const auto AddTriangle = [this, &Batch](const DirectX::XMFLOAT4& V0, const DirectX::XMFLOAT4& V1, const DirectX::XMFLOAT4& V2)
+	{
+		const DirectX::XMFLOAT4* Vertices[3] = { &V0, &V1, &V2 };
+		for (uint32_t Vertex = 0; Vertex < 3; ++Vertex)
+		{
+			const float InverseW = 1.0f / Vertices[Vertex]->w;
+			Batch.X[Vertex][Batch.Count] = (Vertices[Vertex]->x * InverseW * 0.5f + 0.5f) * WIDTH;
+			Batch.Y[Vertex][Batch.Count] = (0.5f - Vertices[Vertex]->y * InverseW * 0.5f) * HEIGHT;
+			Batch.Z[Vertex][Batch.Count] = Vertices[Vertex]->z * InverseW;
+		}
+		if (++Batch.Count == 8)
+		{
+			FlushBatch(Batch);
+		}
+	};
+
+	const size_t TriangleCount = IndexCount / 3;
+	Statistics.OccluderTriangles += static_cast<uint32_t>(TriangleCount);
+	for (size_t Triangle = 0; Triangle < TriangleCount; ++Triangle)
+	{
+		const DirectX::XMFLOAT4 Vertices[3] = {
+			ClipVertices[Indices[Triangle * 3 + 0]],
+			ClipVertices[Indices[Triangle * 3 + 1]],
+			ClipVertices[Indices[Triangle * 3 + 2]]
+		};
+
+		// trivially outside one of the side planes
+		if ((Vertices[0].x > Vertices[0].w && Vertices[1].x > Vertices[1].w && Vertices[2].x > Vertices[2].w) ||
+			(Vertices[0].x < -Vertices[0].w && Vertices[1].x < -Vertices[1].w && Vertices[2].x < -Vertices[2].w) ||
+			(Vertices[0].y > Vertices[0].w && Vertices[1].y > Vertices[1].w && Vertices[2].y > Vertices[2].w) ||
+			(Vertices[0].y < -Vertices[0].w && Vertices[1].y < -Vertices[1].w && Vertices[2].y < -Vertices[2].w))
+		{
+			continue;
+		}
+
+		const uint32_t InsideCount = (Vertices[0].z >= 0.0f) + (Vertices[1].z >= 0.0f) + (Vertices[2].z >= 0.0f);
+		if (InsideCount == 3)
+		{
+			AddTriangle(Vertices[0], Vertices[1], Vertices[2]);
+		}
+		else if (InsideCount > 0)
+		{
+			DirectX::XMFLOAT4 Clipped[4];
+			const auto ClippedCount = ClipNear(Vertices, Clipped);
+			for (uint32_t Vertex = 2; Vertex < ClippedCount; ++Vertex)
+			{
+				AddTriangle(Clipped[0], Clipped[Vertex - 1], Clipped[Vertex]);
+			}
+		}
+	}
+	FlushBatch(Batch);
+
+	Statistics.RasterMilliseconds += MillisecondsSince(Start);
+}
+
+void FOcclusionCuller::FlushBatch(STriangleBatch& Batch) noexcept
+{
+	if (Batch.Count == 0)
+	{
+		return;
+	}
+
+	STriangle Triangles[8];
+	uint32_t Count = 0;
+	if (bUseAvx2)
+	{
+		Count = SetupTrianglesAvx2(Batch, Triangles);
+		for (uint32_t Index = 0; Index < Count; ++Index)
+		{
+			RasterizeAvx2(Triangles[Index]);
+		}
+	}
+	else
+	{
+		Count = SetupTrianglesScalar(Batch, Triangles);
+		for (uint32_t Index = 0; Index < Count; ++Index)
+		{
+			RasterizeScalar(Triangles[Index]);
+		}
+	}
+	Statistics.RasterizedTriangles += Count;
+	Batch.Count = 0;
+}
+
+uint32_t FOcclusionCuller::SetupTrianglesScalar(const STriangleBatch& Batch, STriangle* Triangles) noexcept
+{
+	uint32_t Count = 0;
+	for (uint32_t Lane = 0; Lane < Batch.Count; ++Lane)
+	{
+		const float X0 = Batch.X[0][Lane], X1 = Batch.X[1][Lane], X2 = Batch.X[2][Lane];
+		const float Y0 = Batch.Y[0][Lane], Y1 = Batch.Y[1][Lane], Y2 = Batch.Y[2][Lane];
+
+		// edge i is opposite vertex i, so its value divided by the area is vertex i's weight
+		const float A[3] = { Y1 - Y2, Y2 - Y0, Y0 - Y1 };
+		const float B[3] = { X2 - X1, X0 - X2, X1 - X0 };
+		const float C[3] = { X1 * Y2 - Y1 * X2, X2 * Y0 - Y2 * X0, X0 * Y1 - Y0 * X1 };
+		const float Area = C[0] + C[1] + C[2];
+		if (std::fabs(Area) < MINIMUM_AREA)
+		{
+			continue;
+		}
+
+		auto& Triangle = Triangles[Count];
+		const float InverseArea = 1.0f / Area;
+		Triangle.DepthA = (A[0] * Batch.Z[0][Lane] + A[1] * Batch.Z[1][Lane] + A[2] * Batch.Z[2][Lane]) * InverseArea;
+		Triangle.DepthB = (B[0] * Batch.Z[0][Lane] + B[1] * Batch.Z[1][Lane] + B[2] * Batch.Z[2][Lane]) * InverseArea;
+		Triangle.DepthC = (C[0] * Batch.Z[0][Lane] + C[1] * Batch.Z[1][Lane] + C[2] * Batch.Z[2][Lane]) * InverseArea;
+
+		// both windings are rasterized, flipping makes the inside positive
+		const float Sign = Area < 0.0f ? -1.0f : 1.0f;
+		for (uint32_t Edge = 0; Edge < 3; ++Edge)
+		{
+			Triangle.EdgeA[Edge] = A[Edge] * Sign;
+			Triangle.EdgeB[Edge] = B[Edge] * Sign;
+			Triangle.EdgeC[Edge] = C[Edge] * Sign;
+		}
+
+		Triangle.MinX = std::max(0, static_cast<int32_t>(std::floor(std::min({ X0, X1, X2 }))));
+		Triangle.MinY = std::max(0, static_cast<int32_t>(std::floor(std::min({ Y0, Y1, Y2 }))));
+		Triangle.MaxX = std::min(static_cast<int32_t>(WIDTH) - 1, static_cast<int32_t>(std::ceil(std::max({ X0, X1, X2 }))));
+		Triangle.MaxY = std::min(static_cast<int32_t>(HEIGHT) - 1, static_cast<int32_t>(std::ceil(std::max({ Y0, Y1, Y2 }))));
+		if (Triangle.MinX <= Triangle.MaxX && Triangle.MinY <= Triangle.MaxY)
+		{
+			++Count;
+		}
+	}
+	return Count;
+}
+
+void FOcclusionCuller::RasterizeScalar(const STriangle& Triangle) noexcept
+{
+	for (int32_t Y = Triangle.MinY; Y <= Triangle.MaxY; ++Y)
+	{
+		const float PixelY = Y + 0.5f;
+		float* Row = Depth.data() + static_cast<size_t>(Y) * WIDTH;
+		for (int32_t X = Triangle.MinX; X <= Triangle.MaxX; ++X)
+		{
+			const float PixelX = X + 0.5f;
+			const float E0 = Triangle.EdgeA[0] * PixelX + Triangle.EdgeB[0] * PixelY + Triangle.EdgeC[0];
+			const float E1 = Triangle.EdgeA[1] * PixelX + Triangle.EdgeB[1] * PixelY + Triangle.EdgeC[1];
+			const float E2 = Triangle.EdgeA[2] * PixelX + Triangle.EdgeB[2] * PixelY + Triangle.EdgeC[2];
+			if (E0 >= 0.0f && E1 >= 0.0f && E2 >= 0.0f)
+			{
+				const float PixelDepth = Triangle.DepthA * PixelX + Triangle.DepthB * PixelY + Triangle.DepthC;
+				Row[X] = std::min(Row[X], PixelDepth);
+			}
+		}
+	}
+}
+
+#if OCCLUSION_HAS_AVX2
+// eight triangles are set up at once, one per lane. Every value is computed with the operations of
+// the scalar path in the same order and without fused multiply adds, so both paths produce the
+// same depth buffer bit for bit.
+OCCLUSION_AVX2_TARGET uint32_t FOcclusionCuller::SetupTrianglesAvx2(const STriangleBatch& Batch, STriangle* Triangles) noexcept
+{
+	const __m256 X0 = _mm256_loadu_ps(Batch.X[0]), X1 = _mm256_loadu_ps(Batch.X[1]), X2 = _mm256_loadu_ps(Batch.X[2]);
+	const __m256 Y0 = _mm256_loadu_ps(Batch.Y[0]), Y1 = _mm256_loadu_ps(Batch.Y[1]), Y2 = _mm256_loadu_ps(Batch.Y[2]);
+	const __m256 Z0 = _mm256_loadu_ps(Batch.Z[0]), Z1 = _mm256_loadu_ps(Batch.Z[1]), Z2 = _mm256_loadu_ps(Batch.Z[2]);
+
+	const __m256 A[3] = { _mm256_sub_ps(Y1, Y2), _mm256_sub_ps(Y2, Y0), _mm256_sub_ps(Y0, Y1) };
+	const __m256 B[3] = { _mm256_sub_ps(X2, X1), _mm256_sub_ps(X0, X2), _mm256_sub_ps(X1, X0) };
+	const __m256 C[3] = {
+		_mm256_sub_ps(_mm256_mul_ps(X1, Y2), _mm256_mul_ps(Y1, X2)),
+		_mm256_sub_ps(_mm256_mul_ps(X2, Y0), _mm256_mul_ps(Y2, X0)),
+		_mm256_sub_ps(_mm256_mul_ps(X0, Y1), _mm256_mul_ps(Y0, X1))
+	};
+	const __m256 Area = _mm256_add_ps(_mm256_add_ps(C[0], C[1]), C[2]);
+	const __m256 InverseArea = _mm256_div_ps(_mm256_set1_ps(1.0f), Area);
+
+	alignas(32) float DepthA[8], DepthB[8], DepthC[8];
+	_mm256_store_ps(DepthA, _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(A[0], Z0), _mm256_mul_ps(A[1], Z1)), _mm256_mul_ps(A[2], Z2)), InverseArea));
+	_mm256_store_ps(DepthB, _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(B[0], Z0), _mm256_mul_ps(B[1], Z1)), _mm256_mul_ps(B[2], Z2)), InverseArea));
+	_mm256_store_ps(DepthC, _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(C[0], Z0), _mm256_mul_ps(C[1], Z1)), _mm256_mul_ps(C[2], Z2)), InverseArea));
+
+	// flipping by the area's sign bit makes the inside positive for both windings
+	const __m256 SignMask = _mm256_and_ps(Area, _mm256_set1_ps(-0.0f));
+	alignas(32) float EdgeA[3][8], EdgeB[3][8], EdgeC[3][8];
+	for (uint32_t Edge = 0; Edge < 3; ++Edge)
+	{
+		_mm256_store_ps(EdgeA[Edge], _mm256_xor_ps(A[Edge], SignMask));
+		_mm256_store_ps(EdgeB[Edge], _mm256_xor_ps(B[Edge], SignMask));
+		_mm256_store_ps(EdgeC[Edge], _mm256_xor_ps(C[Edge], SignMask));
+	}
+
+	alignas(32) int32_t MinX[8], MinY[8], MaxX[8], MaxY[8];
+	_mm256_store_si256(reinterpret_cast<__m256i*>(MinX), _mm256_max_epi32(_mm256_setzero_si256(), _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_min_ps(X0, _mm256_min_ps(X1, X2))))));
+	_mm256_store_si256(reinterpret_cast<__m256i*>(MinY), _mm256_max_epi32(_mm256_setzero_si256(), _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_min_ps(Y0, _mm256_min_ps(Y1, Y2))))));
+	_mm256_store_si256(reinterpret_cast<__m256i*>(MaxX), _mm256_min_epi32(_mm256_set1_epi32(WIDTH - 1), _mm256_cvttps_epi32(_mm256_ceil_ps(_mm256_max_ps(X0, _mm256_max_ps(X1, X2))))));
+	_mm256_store_si256(reinterpret_cast<__m256i*>(MaxY), _mm256_min_epi32(_mm256_set1_epi32(HEIGHT - 1), _mm256_cvttps_epi32(_mm256_ceil_ps(_mm256_max_ps(Y0, _mm256_max_ps(Y1, Y2))))));
+
+	const __m256 AbsoluteArea = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), Area);
+	const auto ValidMask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(AbsoluteArea, _mm256_set1_ps(MINIMUM_AREA), _CMP_GE_OQ)));
+
+	uint32_t Count = 0;
+	for (uint32_t Lane = 0; Lane < Batch.Count; ++Lane)
+	{
+		if ((ValidMask & (1u << Lane)) == 0 || MinX[Lane] > MaxX[Lane] || MinY[Lane] > MaxY[Lane])
+		{
+			continue;
+		}
+		auto& Triangle = Triangles[Count++];
+		for (uint32_t Edge = 0; Edge < 3; ++Edge)
+		{
+			Triangle.EdgeA[Edge] = EdgeA[Edge][Lane];
+			Triangle.EdgeB[Edge] = EdgeB[Edge][Lane];
+			Triangle.EdgeC[Edge] = EdgeC[Edge][Lane];
+		}
+		Triangle.DepthA = DepthA[Lane];
+		Triangle.DepthB = DepthB[Lane];
+		Triangle.DepthC = DepthC[Lane];
+		Triangle.MinX = MinX[Lane];
+		Triangle.MinY = MinY[Lane];
+		Triangle.MaxX = MaxX[Lane];
+		Triangle.MaxY = MaxY[Lane];
+	}
+	return Count;
+}
+
+// eight pixels of a row per step, the buffer width is a multiple of eight so blocks never straddle
+// rows. Edges and depth are evaluated per pixel like the scalar path does rather than stepped, so
+// no error accumulates along a row and shared edges leave no cracks.
+OCCLUSION_AVX2_TARGET void FOcclusionCuller::RasterizeAvx2(const STriangle& Triangle) noexcept
+{
+	const int32_t StartX = Triangle.MinX & ~7;
+	const __m256 LaneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+	const __m256 BlockStep = _mm256_set1_ps(8.0f);
+	const __m256 Zero = _mm256_setzero_ps();
+
+	__m256 EdgeA[3], EdgeC[3];
+	for (uint32_t Edge = 0; Edge < 3; ++Edge)
+	{
+		EdgeA[Edge] = _mm256_set1_ps(Triangle.EdgeA[Edge]);
+		EdgeC[Edge] = _mm256_set1_ps(Triangle.EdgeC[Edge]);
+	}
+	const __m256 DepthA = _mm256_set1_ps(Triangle.DepthA);
+	const __m256 DepthC = _mm256_set1_ps(Triangle.DepthC);
+
+	for (int32_t Y = Triangle.MinY; Y <= Triangle.MaxY; ++Y)
+	{
+		const float PixelY = Y + 0.5f;
+		const __m256 EdgeY[3] = {
+			_mm256_set1_ps(Triangle.EdgeB[0] * PixelY),
+			_mm256_set1_ps(Triangle.EdgeB[1] * PixelY),
+			_mm256_set1_ps(Triangle.EdgeB[2] * PixelY)
+		};
+		const __m256 DepthY = _mm256_set1_ps(Triangle.DepthB * PixelY);
+
+		float* Row = Depth.data() + static_cast<size_t>(Y) * WIDTH;
+		__m256 PixelX = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(StartX)), LaneOffsets);
+		for (int32_t X = StartX; X <= Triangle.MaxX; X += 8)
+		{
+			const __m256 E0 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(EdgeA[0], PixelX), EdgeY[0]), EdgeC[0]);
+			const __m256 E1 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(EdgeA[1], PixelX), EdgeY[1]), EdgeC[1]);
+			const __m256 E2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(EdgeA[2], PixelX), EdgeY[2]), EdgeC[2]);
+			const __m256 Inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(E0, Zero, _CMP_GE_OQ), _mm256_cmp_ps(E1, Zero, _CMP_GE_OQ)), _mm256_cmp_ps(E2, Zero, _CMP_GE_OQ));
+			if (_mm256_movemask_ps(Inside) != 0)
+			{
+				const __m256 PixelDepth = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(DepthA, PixelX), DepthY), DepthC);
+				const __m256 Current = _mm256_loadu_ps(Row + X);
+				_mm256_storeu_ps(Row + X, _mm256_blendv_ps(Current, _mm256_min_ps(Current, PixelDepth), Inside));
+			}
+			PixelX = _mm256_add_ps(PixelX, BlockStep);
+		}
+	}
+}
+#else
+uint32_t FOcclusionCuller::SetupTrianglesAvx2(const STriangleBatch& Batch, STriangle* Triangles) noexcept
+{
+	return SetupTrianglesScalar(Batch, Triangles);
+}
+
+void FOcclusionCuller::RasterizeAvx2(const STriangle& Triangle) noexcept
+{
+	RasterizeScalar(Triangle);
+}
+#endif
+
+void FOcclusionCuller::EndOccluders() noexcept
+{
+	const auto Start = std::chrono::high_resolution_clock::now();
+	for (uint32_t TileY = 0; TileY < TILES_Y; ++TileY)
+	{
+		for (uint32_t TileX = 0; TileX < TILES_X; ++TileX)
+		{
+			float MaximumDepth = 0.0f;
+			for (uint32_t Y = 0; Y < TILE_SIZE; ++Y)
+			{
+				const float* Row = Depth.data() + (TileY * TILE_SIZE + Y) * WIDTH + TileX * TILE_SIZE;
+				for (uint32_t X = 0; X < TILE_SIZE; ++X)
+				{
+					MaximumDepth = std::max(MaximumDepth, Row[X]);
+				}
+			}
+			TileMaxDepth[TileY * TILES_X + TileX] = MaximumDepth;
+		}
+	}
+	Statistics.RasterMilliseconds += MillisecondsSince(Start);
+}
+
+bool FOcclusionCuller::IsVisible(const DirectX::XMFLOAT3& BoundsMin, const DirectX::XMFLOAT3& BoundsMax, const DirectX::XMMATRIX& WorldViewProjection) noexcept
+{
+	const auto Start = std::chrono::high_resolution_clock::now();
+	++Statistics.TestedBounds;
+
+	float MinX = FLT_MAX, MinY = FLT_MAX, MaxX = -FLT_MAX, MaxY = -FLT_MAX;
+	float MinDepth = FLT_MAX;
+	uint32_t OutsideMask = 0x3F;
+	bool bCrossesNear = false;
+	for (uint32_t Corner = 0; Corner < 8; ++Corner)
+	{
+		const auto Position = DirectX::XMVectorSet(Corner & 1 ? BoundsMax.x : BoundsMin.x, Corner & 2 ? BoundsMax.y : BoundsMin.y, Corner & 4 ? BoundsMax.z : BoundsMin.z, 1.0f);
+		DirectX::XMFLOAT4 Clip;
+		DirectX::XMStoreFloat4(&Clip, DirectX::XMVector4Transform(Position, WorldViewProjection));
+
+		// a plane only rejects the box if every corner is outside of it
+		OutsideMask &= (Clip.x < -Clip.w ? 1u : 0u) | (Clip.x > Clip.w ? 2u : 0u) | (Clip.y < -Clip.w ? 4u : 0u) |
+			(Clip.y > Clip.w ? 8u : 0u) | (Clip.z < 0.0f ? 16u : 0u) | (Clip.z > Clip.w ? 32u : 0u);
+		if (Clip.z < 0.0f)
+		{
+			bCrossesNear = true;
+			continue;
+		}
+		const float InverseW = 1.0f / Clip.w;
+		const float ScreenX = (Clip.x * InverseW * 0.5f + 0.5f) * WIDTH;
+		const float ScreenY = (0.5f - Clip.y * InverseW * 0.5f) * HEIGHT;
+		MinX = std::min(MinX, ScreenX);
+		MaxX = std::max(MaxX, ScreenX);
+		MinY = std::min(MinY, ScreenY);
+		MaxY = std::max(MaxY, ScreenY);
+		MinDepth = std::min(MinDepth, Clip.z * InverseW);
+	}
+
+	if (OutsideMask != 0)
+	{
+		++Statistics.FrustumCulled;
+		Statistics.TestMilliseconds += MillisecondsSince(Start);
+		return false;
+	}
+	if (bCrossesNear)
+	{
+		Statistics.TestMilliseconds += MillisecondsSince(Start);
+		return true;
+	}
+
+	// one pixel of slack for the occluders being sampled at pixel centers
+	const int32_t PixelMinX = std::max(0, static_cast<int32_t>(std::floor(MinX)) - 1);
+	const int32_t PixelMinY = std::max(0, static_cast<int32_t>(std::floor(MinY)) - 1);
+	const int32_t PixelMaxX = std::min(static_cast<int32_t>(WIDTH) - 1, static_cast<int32_t>(std::ceil(MaxX)) + 1);
+	const int32_t PixelMaxY = std::min(static_cast<int32_t>(HEIGHT) - 1, static_cast<int32_t>(std::ceil(MaxY)) + 1);
+
+	bool bVisible = false;
+	for (int32_t TileY = PixelMinY / TILE_SIZE; TileY <= PixelMaxY / static_cast<int32_t>(TILE_SIZE) && !bVisible; ++TileY)
+	{
+		for (int32_t TileX = PixelMinX / TILE_SIZE; TileX <= PixelMaxX / static_cast<int32_t>(TILE_SIZE) && !bVisible; ++TileX)
+		{
+			// the whole tile is in front of the box, nothing in it can be visible
+			if (TileMaxDepth[TileY * TILES_X + TileX] < MinDepth)
+			{
+				continue;
+			}
+
+			const int32_t BeginY = std::max(PixelMinY, TileY * static_cast<int32_t>(TILE_SIZE));
+			const int32_t EndY = std::min(PixelMaxY, TileY * static_cast<int32_t>(TILE_SIZE) + static_cast<int32_t>(TILE_SIZE) - 1);
+			const int32_t BeginX = std::max(PixelMinX, TileX * static_cast<int32_t>(TILE_SIZE));
+			const int32_t EndX = std::min(PixelMaxX, TileX * static_cast<int32_t>(TILE_SIZE) + static_cast<int32_t>(TILE_SIZE) - 1);
+			for (int32_t Y = BeginY; Y <= EndY && !bVisible; ++Y)
+			{
+				const float* Row = Depth.data() + static_cast<size_t>(Y) * WIDTH;
+				for (int32_t X = BeginX; X <= EndX; ++X)
+				{
+					if (Row[X] >= MinDepth)
+					{
+						bVisible = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	if (!bVisible)
+	{
+		++Statistics.OcclusionCulled;
+	}
+	Statistics.TestMilliseconds += MillisecondsSince(Start);
+	return bVisible;
+}
+
+const FOcclusionCuller::SStatistics& FOcclusionCuller::GetStatistics() const noexcept
+{
+	return Statistics;
+}
+
+const float* FOcclusionCuller::GetDepthBuffer() const noexcept
+{
+	return Depth.data();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Software occlusion culling in the spirit of Masked Occlusion Culling: occluders are
+// rasterized depth only into a low resolution buffer with a per tile maximum, and bounding
+// boxes are tested against it before they are submitted. Depth is NDC z, 0 near and 1 far.
+class FOcclusionCuller
+{
+public:
+	static constexpr uint32_t WIDTH = 320;
+	static constexpr uint32_t HEIGHT = 192;
+	static constexpr uint32_t TILE_SIZE = 8;
+	static constexpr uint32_t TILES_X = WIDTH / TILE_SIZE;
+	static constexpr uint32_t TILES_Y = HEIGHT / TILE_SIZE;
+
+	struct SStatistics
+	{
+		uint32_t OccluderTriangles = 0;
+		uint32_t RasterizedTriangles = 0;
+		uint32_t TestedBounds = 0;
+		uint32_t FrustumCulled = 0;
+		uint32_t OcclusionCulled = 0;
+		double RasterMilliseconds = 0.0;
+		double TestMilliseconds = 0.0;
+	};
+
+	FOcclusionCuller();
+
+	// the AVX2 path is only taken when the CPU supports it, disabling it forces the scalar path
+	void SetUseAvx2(const bool bUseAvx2) noexcept;
+	bool IsUsingAvx2() const noexcept;
+	static bool IsAvx2Supported() noexcept;
+
+	void BeginFrame() noexcept;
+	// Positions are model space, WorldViewProjection is row vector like the rest of DirectXMath
+	void RenderOccluder(const DirectX::XMFLOAT3* Positions, const size_t VertexCount, const uint32_t* Indices, const size_t IndexCount, const DirectX::XMMATRIX& WorldViewProjection) noexcept;
+	// builds the tile maxima, call once all occluders are in and before testing
+	void EndOccluders() noexcept;
+	// false if the box is outside the frustum or entirely behind occluders
+	bool IsVisible(const DirectX::XMFLOAT3& BoundsMin, const DirectX::XMFLOAT3& BoundsMax, const DirectX::XMMATRIX& WorldViewProjection) noexcept;
+
+	const SStatistics& GetStatistics() const noexcept;
+	const float* GetDepthBuffer() const noexcept;
+
+private:
+	struct STriangle
+	{
+		// edge functions, inside when all three are >= 0
+		float EdgeA[3];
+		float EdgeB[3];
+		float EdgeC[3];
+		// depth plane, Depth = DepthA * X + DepthB * Y + DepthC
+		float DepthA;
+		float DepthB;
+		float DepthC;
+		int32_t MinX;
+		int32_t MinY;
+		int32_t MaxX;
+		int32_t MaxY;
+	};
+
+	// screen space vertices of up to eight triangles, structure of arrays
+	struct STriangleBatch
+	{
+		float X[3][8];
+		float Y[3][8];
+		float Z[3][8];
+		uint32_t Count;
+	};
+
+	static uint32_t SetupTrianglesScalar(const STriangleBatch& Batch, STriangle* Triangles) noexcept;
+	static uint32_t SetupTrianglesAvx2(const STriangleBatch& Batch, STriangle* Triangles) noexcept;
+	void RasterizeScalar(const STriangle& Triangle) noexcept;
+	void RasterizeAvx2(const STriangle& Triangle) noexcept;
+	void FlushBatch(STriangleBatch& Batch) noexcept;
+
+	bool bUseAvx2 = false;
+	std::vector<float> Depth;
+	std::vector<float> TileMaxDepth;
+	std::vector<DirectX::XMFLOAT4> ClipVertices;
+	SStatistics Statistics{};
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Splits [0, Count) into contiguous ranges and runs Function(Begin, End) on each of them.
+// Ranges never overlap, so writes to per-item outputs need no synchronization. Worker threads
+// of a job system hand the ranges to it, any other thread starts threads of its own and
+// takes the last range itself.
+template <typename TFunction>
+void ParallelFor(const size_t Count, const size_t MinimumBatchSize, TFunction Function)
+{
+	if (auto JobSystem = FJobSystem::GetCurrent())
+	{
+		JobSystem->ParallelFor(Count, MinimumBatchSize, Function);
+		return;
+	}
+
+	const size_t HardwareThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	const size_t MaximumBatchCount = std::min(HardwareThreads, (Count + MinimumBatchSize - 1) / std::max<size_t>(1, MinimumBatchSize));
+	if (MaximumBatchCount <= 1)
+	{
+		Function(size_t(0), Count);
+		return;
+	}
+
+	const size_t BatchSize = (Count + MaximumBatchCount - 1) / MaximumBatchCount;
+	const size_t BatchCount = (Count + BatchSize - 1) / BatchSize;
+	std::vector<std::thread> Workers;
+	Workers.reserve(BatchCount - 1);
+	for (size_t Batch = 0; Batch + 1 < BatchCount; ++Batch)
+	{
+		const size_t Begin = Batch * BatchSize;
+		const size_t End = std::min(Count, Begin + BatchSize);
+		Workers.emplace_back([&Function, Begin, End]() { Function(Begin, End); });
+	}
+	Function((BatchCount - 1) * BatchSize, Count);
+	for (auto& Worker : Workers)
+	{
+		Worker.join();
+	}
+}
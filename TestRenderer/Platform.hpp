@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+// Windowing, events and time as FApplication sees them. A platform with a window feeds its input
+// to ImGui, the application builds and draws gui frames and presents through a swapchain. Without
+// a window there is no input, no gui and the application renders offscreen.
+class FPlatform
+{
+public:
+	virtual ~FPlatform() = default;
+
+	// dispatches pending events, false once the application should quit
+	virtual bool PumpEvents() noexcept = 0;
+	// seconds, only differences between calls are meaningful
+	virtual double GetTime() noexcept = 0;
+	virtual uint32_t GetWidth() const noexcept = 0;
+	virtual uint32_t GetHeight() const noexcept = 0;
+	// true once for every change of the size since the previous call
+	virtual bool ConsumeResize() noexcept = 0;
+	// HWND on Windows, nullptr for headless platforms
+	virtual void* GetNativeWindow() const noexcept = 0;
+
+	bool HasWindow() const noexcept
+	{
+		return GetNativeWindow() != nullptr;
+	}
+};
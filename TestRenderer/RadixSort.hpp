@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// LSD radix sort over 64 bit keys, one byte per pass. Passes where every key shares the
+// same byte are skipped, so sort keys with mostly constant high bits only pay for the bits
+// that actually differ. Stable, Scratch must hold Count items.
+template <typename TItem, typename TKeyFunction>
+void RadixSort64(TItem* Items, TItem* Scratch, const size_t Count, TKeyFunction Key) noexcept
+{
+	constexpr size_t PASS_COUNT = sizeof(uint64_t);
+	constexpr size_t BUCKET_COUNT = 256;
+
+	if (Count < 2)
+	{
+		return;
+	}
+
+	// build all histograms in one read of the data
+	uint32_t Histograms[PASS_COUNT][BUCKET_COUNT];
+	memset(Histograms, 0, sizeof(Histograms));
+	for (size_t Index = 0; Index < Count; ++Index)
+	{
+		const uint64_t Value = Key(Items[Index]);
+		for (size_t Pass = 0; Pass < PASS_COUNT; ++Pass)
+		{
+			++Histograms[Pass][(Value >> (Pass * 8)) & 0xFF];
+		}
+	}
+
+	TItem* Source = Items;
+	TItem* Destination = Scratch;
+	for (size_t Pass = 0; Pass < PASS_COUNT; ++Pass)
+	{
+		auto& Histogram = Histograms[Pass];
+		const uint64_t FirstDigit = (Key(Source[0]) >> (Pass * 8)) & 0xFF;
+		if (Histogram[FirstDigit] == Count)
+		{
+			continue;
+		}
+
+		uint32_t Offset = 0;
+		for (size_t Bucket = 0; Bucket < BUCKET_COUNT; ++Bucket)
+		{
+			const auto BucketCount = Histogram[Bucket];
+			Histogram[Bucket] = Offset;
+			Offset += BucketCount;
+		}
+
+		for (size_t Index = 0; Index < Count; ++Index)
+		{
+			const uint64_t Digit = (Key(Source[Index]) >> (Pass * 8)) & 0xFF;
+			Destination[Histogram[Digit]++] = Source[Index];
+		}
+
+		TItem* Temporary = Source;
+		Source = Destination;
+		Destination = Temporary;
+	}
+
+	if (Source != Items)
+	{
+		for (size_t Index = 0; Index < Count; ++Index)
+		{
+			Items[Index] = Source[Index];
+		}
+	}
+}
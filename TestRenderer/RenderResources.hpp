@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ShaderStage.hpp"
+#include <cstdint>
+
+// Handles to the resources FRenderer creates. Only the Direct3D interfaces are declared here, so
+// code that stores or records handles without calling into the device builds without Direct3D.
+struct ID3D11Buffer;
+struct ID3D11ShaderResourceView;
+struct ID3D11UnorderedAccessView;
+struct ID3D11RenderTargetView;
+struct ID3D11DepthStencilView;
+struct ID3D11Texture2D;
+struct ID3D11VertexShader;
+struct ID3D11PixelShader;
+struct ID3D11ComputeShader;
+struct ID3D11InputLayout;
+
+struct SBuffer
+{
+	ID3D11Buffer* Buffer;
+	uint32_t Stride;
+	// only set for structured buffers
+	ID3D11ShaderResourceView* ShaderResourceView = nullptr;
+	ID3D11UnorderedAccessView* UnorderedAccessView = nullptr;
+};
+
+struct SRenderTarget
+{
+	mutable ID3D11RenderTargetView* RenderTargetView = nullptr;
+	mutable ID3D11ShaderResourceView* ShaderResourceView = nullptr;
+	mutable ID3D11DepthStencilView* DepthStencilView = nullptr;
+	mutable ID3D11Texture2D* Texture = nullptr;
+	mutable ID3D11Texture2D* DepthTexture = nullptr;
+	mutable ID3D11UnorderedAccessView* UnorderedAccessView = nullptr;
+	mutable uint32_t Width = 0;
+	mutable uint32_t Height = 0;
+};
+
+struct SShader
+{
+	ID3D11VertexShader* Vertex = nullptr;
+	ID3D11PixelShader* Pixel = nullptr;
+	ID3D11ComputeShader* Compute = nullptr;
+	ID3D11InputLayout* Layout = nullptr;
+	EShaderStage Stage;
+};
@@ -0,0 +1,297 @@
+#include "RenderStatistics.hpp"
+
+#include "imgui/imgui.h"
+#include <algorithm>
+#include <cstring>
+
+const char* GetRenderCounterName(const ERenderCounter Counter) noexcept
+{
+	switch (Counter)
+	{
+	case ERenderCounter::DRAW_CALLS: return "Draw Calls";
+	case ERenderCounter::DISPATCHES: return "Dispatches";
+	case ERenderCounter::VERTICES: return "Vertices";
+	case ERenderCounter::INDICES: return "Indices";
+	case ERenderCounter::SHADER_BINDS: return "Shader Binds";
+	case ERenderCounter::CONSTANT_BUFFER_BINDS: return "Constant Buffer Binds";
+	case ERenderCounter::TEXTURE_BINDS: return "Texture Binds";
+	case ERenderCounter::READ_WRITE_BINDS: return "Read Write Binds";
+	case ERenderCounter::VERTEX_BUFFER_BINDS: return "Vertex Buffer Binds";
+	case ERenderCounter::INDEX_BUFFER_BINDS: return "Index Buffer Binds";
+	case ERenderCounter::RENDER_TARGET_BINDS: return "Render Target Binds";
+	case ERenderCounter::VIEWPORT_CHANGES: return "Viewport Changes";
+	case ERenderCounter::TOPOLOGY_CHANGES: return "Topology Changes";
+	case ERenderCounter::CLEARS: return "Clears";
+	case ERenderCounter::UPLOADS: return "Uploads";
+	case ERenderCounter::UPLOAD_BYTES: return "Upload Bytes";
+	case ERenderCounter::RESOURCE_CREATIONS: return "Resource Creations";
+	default: return "Unknown";
+	}
+}
+
+FRenderStatistics::FRenderStatistics() = default;
+
+void FRenderStatistics::Add(const FRenderStatistics& Other) noexcept
+{
+	for (size_t Counter = 0; Counter < COUNTER_COUNT; ++Counter)
+	{
+		Add(static_cast<ERenderCounter>(Counter), Other.Current.Values[Counter]);
+	}
+}
+
+void FRenderStatistics::BeginPass(const char* Name) noexcept
+{
+	auto Pass = FindPass(Name);
+	if (Pass == FRAME)
+	{
+		if (PassCount == MAX_PASSES)
+		{
+			// out of slots, the calls are still counted for the frame
+			ActivePass = FRAME;
+			return;
+		}
+		Pass = PassCount++;
+		Passes[Pass].Name = Name;
+	}
+	ActivePass = Pass;
+}
+
+void FRenderStatistics::EndPass() noexcept
+{
+	ActivePass = FRAME;
+}
+
+void FRenderStatistics::EndFrame() noexcept
+{
+	if (!Histories)
+	{
+		Histories.reset(new SHistory[MAX_PASSES + 1]);
+	}
+
+	LastFrame = Current;
+	memcpy(Histories[MAX_PASSES].Values[HistoryHead], Current.Values, sizeof(Current.Values));
+	Current = {};
+	for (size_t Pass = 0; Pass < PassCount; ++Pass)
+	{
+		Passes[Pass].LastFrame = Passes[Pass].Current;
+		memcpy(Histories[Pass].Values[HistoryHead], Passes[Pass].Current.Values, sizeof(Current.Values));
+		Passes[Pass].Current = {};
+		if (Passes[Pass].HistoryCount < HISTORY_SIZE)
+		{
+			++Passes[Pass].HistoryCount;
+		}
+	}
+
+	HistoryHead = (HistoryHead + 1) % HISTORY_SIZE;
+	HistoryCount = std::min(HistoryCount + 1, HISTORY_SIZE);
+	++FrameCount;
+}
+
+void FRenderStatistics::Reset() noexcept
+{
+	Current = {};
+	LastFrame = {};
+	for (size_t Pass = 0; Pass < PassCount; ++Pass)
+	{
+		Passes[Pass].Current = {};
+		Passes[Pass].LastFrame = {};
+		Passes[Pass].HistoryCount = 0;
+	}
+	HistoryHead = 0;
+	HistoryCount = 0;
+	FrameCount = 0;
+}
+
+size_t FRenderStatistics::GetPassCount() const noexcept
+{
+	return PassCount;
+}
+
+const char* FRenderStatistics::GetPassName(const size_t Pass) const noexcept
+{
+	return Pass < PassCount ? Passes[Pass].Name : "Frame";
+}
+
+size_t FRenderStatistics::FindPass(const char* Name) const noexcept
+{
+	for (size_t Pass = 0; Pass < PassCount; ++Pass)
+	{
+		// pointer compare first, callers almost always pass the same literal
+		if (Passes[Pass].Name == Name || strcmp(Passes[Pass].Name, Name) == 0)
+		{
+			return Pass;
+		}
+	}
+	return FRAME;
+}
+
+const FRenderStatistics::SCounters& FRenderStatistics::GetLastFrame(const size_t Pass) const noexcept
+{
+	return Pass < PassCount ? Passes[Pass].LastFrame : LastFrame;
+}
+
+size_t FRenderStatistics::GetHistoryCount(const size_t Pass) const noexcept
+{
+	return Pass < PassCount ? Passes[Pass].HistoryCount : HistoryCount;
+}
+
+const FRenderStatistics::SHistory& FRenderStatistics::GetHistory(const size_t Pass) const noexcept
+{
+	return Histories[Pass < PassCount ? Pass : MAX_PASSES];
+}
+
+size_t FRenderStatistics::GetHistorySlot(const size_t Frame) const noexcept
+{
+	return (HistoryHead + HISTORY_SIZE - 1 - Frame) % HISTORY_SIZE;
+}
+
+double FRenderStatistics::GetAverage(const ERenderCounter Counter, const size_t Pass) const noexcept
+{
+	const auto Count = GetHistoryCount(Pass);
+	if (Count == 0)
+	{
+		return 0.0;
+	}
+	const auto& History = GetHistory(Pass);
+	const auto Index = static_cast<size_t>(Counter);
+	uint64_t Sum = 0;
+	for (size_t Frame = 0; Frame < Count; ++Frame)
+	{
+		Sum += History.Values[GetHistorySlot(Frame)][Index];
+	}
+	return static_cast<double>(Sum) / Count;
+}
+
+uint64_t FRenderStatistics::GetPercentile(const ERenderCounter Counter, const float Percentile, const size_t Pass) const noexcept
+{
+	const auto Count = GetHistoryCount(Pass);
+	if (Count == 0)
+	{
+		return 0;
+	}
+	const auto& History = GetHistory(Pass);
+	const auto Index = static_cast<size_t>(Counter);
+	uint64_t Values[HISTORY_SIZE];
+	for (size_t Frame = 0; Frame < Count; ++Frame)
+	{
+		Values[Frame] = History.Values[GetHistorySlot(Frame)][Index];
+	}
+
+	const float Clamped = std::min(std::max(Percentile, 0.0f), 100.0f);
+	auto Rank = static_cast<size_t>(Clamped / 100.0f * Count + 0.5f);
+	Rank = Rank > 0 ? Rank - 1 : 0;
+	Rank = std::min(Rank, Count - 1);
+	std::nth_element(Values, Values + Rank, Values + Count);
+	return Values[Rank];
+}
+
+void FRenderStatistics::OnGui() noexcept
+{
+	ImGui::Begin("Render Statistics");
+	{
+		ImGui::Text("Frames recorded: %zu / %zu", HistoryCount, HISTORY_SIZE);
+		if (ImGui::Button("Reset"))
+		{
+			Reset();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Dump JSON"))
+		{
+			WriteJson("RenderStatistics.json");
+		}
+
+		static int SelectedPass = -1;
+		const char* Preview = SelectedPass < 0 ? "Frame" : GetPassName(static_cast<size_t>(SelectedPass));
+		if (ImGui::BeginCombo("Pass", Preview))
+		{
+			if (ImGui::Selectable("Frame", SelectedPass < 0))
+			{
+				SelectedPass = -1;
+			}
+			for (size_t Pass = 0; Pass < PassCount; ++Pass)
+			{
+				if (ImGui::Selectable(Passes[Pass].Name, SelectedPass == static_cast<int>(Pass)))
+				{
+					SelectedPass = static_cast<int>(Pass);
+				}
+			}
+			ImGui::EndCombo();
+		}
+		const auto Pass = SelectedPass < 0 ? FRAME : static_cast<size_t>(SelectedPass);
+
+		ImGui::Columns(6, "RenderCounters");
+		ImGui::Text("Counter");
+		ImGui::NextColumn();
+		ImGui::Text("Last");
+		ImGui::NextColumn();
+		ImGui::Text("Average");
+		ImGui::NextColumn();
+		ImGui::Text("P50");
+		ImGui::NextColumn();
+		ImGui::Text("P95");
+		ImGui::NextColumn();
+		ImGui::Text("P99");
+		ImGui::NextColumn();
+		ImGui::Separator();
+		for (size_t Index = 0; Index < COUNTER_COUNT; ++Index)
+		{
+			const auto Counter = static_cast<ERenderCounter>(Index);
+			ImGui::Text("%s", GetRenderCounterName(Counter));
+			ImGui::NextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(GetLastFrame(Pass)[Counter]));
+			ImGui::NextColumn();
+			ImGui::Text("%.1f", GetAverage(Counter, Pass));
+			ImGui::NextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(GetPercentile(Counter, 50.0f, Pass)));
+			ImGui::NextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(GetPercentile(Counter, 95.0f, Pass)));
+			ImGui::NextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(GetPercentile(Counter, 99.0f, Pass)));
+			ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+	}
+	ImGui::End();
+}
+
+bool FRenderStatistics::WriteJson(const char* FileName) const noexcept
+{
+	FILE* File = fopen(FileName, "w");
+	if (File == nullptr)
+	{
+		return false;
+	}
+	WriteJson(File);
+	fclose(File);
+	return true;
+}
+
+void FRenderStatistics::WriteJson(FILE* File) const noexcept
+{
+	fprintf(File, "{\n\t\"frames\": %llu,\n\t\"history\": %zu,\n\t\"frame\": ", static_cast<unsigned long long>(FrameCount), HistoryCount);
+	WriteCounters(File, FRAME);
+	fprintf(File, ",\n\t\"passes\": {");
+	for (size_t Pass = 0; Pass < PassCount; ++Pass)
+	{
+		fprintf(File, "%s\n\t\t\"%s\": ", Pass > 0 ? "," : "", Passes[Pass].Name);
+		WriteCounters(File, Pass);
+	}
+	fprintf(File, "\n\t}\n}\n");
+}
+
+void FRenderStatistics::WriteCounters(FILE* File, const size_t Pass) const noexcept
+{
+	fprintf(File, "{");
+	for (size_t Index = 0; Index < COUNTER_COUNT; ++Index)
+	{
+		const auto Counter = static_cast<ERenderCounter>(Index);
+		fprintf(File, "%s \"%s\": { \"last\": %llu, \"average\": %.3f, \"p50\": %llu, \"p95\": %llu, \"p99\": %llu }",
+			Index > 0 ? "," : "", GetRenderCounterName(Counter),
+			static_cast<unsigned long long>(GetLastFrame(Pass)[Counter]),
+			GetAverage(Counter, Pass),
+			static_cast<unsigned long long>(GetPercentile(Counter, 50.0f, Pass)),
+			static_cast<unsigned long long>(GetPercentile(Counter, 95.0f, Pass)),
+			static_cast<unsigned long long>(GetPercentile(Counter, 99.0f, Pass)));
+	}
+	fprintf(File, " }");
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+enum class ERenderCounter : uint8_t
+{
+	DRAW_CALLS = 0,
+	DISPATCHES,
+	VERTICES,
+	INDICES,
+	SHADER_BINDS,
+	CONSTANT_BUFFER_BINDS,
+	TEXTURE_BINDS,
+	READ_WRITE_BINDS,
+	VERTEX_BUFFER_BINDS,
+	INDEX_BUFFER_BINDS,
+	RENDER_TARGET_BINDS,
+	VIEWPORT_CHANGES,
+	TOPOLOGY_CHANGES,
+	CLEARS,
+	UPLOADS,
+	UPLOAD_BYTES,
+	RESOURCE_CREATIONS,
+	COUNT
+};
+
+const char* GetRenderCounterName(const ERenderCounter Counter) noexcept;
+
+// Per frame and per pass counters of every device call FRenderer makes. Counting is a plain
+// add into fixed arrays, nothing here touches the heap or the device, so it stays on in
+// release builds and can be fed by any device implementation.
+class FRenderStatistics
+{
+public:
+	static constexpr size_t COUNTER_COUNT = static_cast<size_t>(ERenderCounter::COUNT);
+	static constexpr size_t MAX_PASSES = 16;
+	static constexpr size_t HISTORY_SIZE = 256;
+	// pass index used to query whole frame values
+	static constexpr size_t FRAME = static_cast<size_t>(-1);
+
+	FRenderStatistics();
+
+	struct SCounters
+	{
+		uint64_t Values[COUNTER_COUNT]{};
+
+		uint64_t operator[](const ERenderCounter Counter) const noexcept
+		{
+			return Values[static_cast<size_t>(Counter)];
+		}
+	};
+
+	void Add(const ERenderCounter Counter, const uint64_t Amount = 1) noexcept
+	{
+		Current.Values[static_cast<size_t>(Counter)] += Amount;
+		if (ActivePass != FRAME)
+		{
+			Passes[ActivePass].Current.Values[static_cast<size_t>(Counter)] += Amount;
+		}
+	}
+
+	// adds the open frame of another instance, for statistics recorded on other threads
+	void Add(const FRenderStatistics& Other) noexcept;
+
+	// Name must outlive the statistics, passes are matched by name and do not nest
+	void BeginPass(const char* Name) noexcept;
+	void EndPass() noexcept;
+
+	// closes the frame, pushes its counters into the history and starts a new one
+	void EndFrame() noexcept;
+	void Reset() noexcept;
+
+	size_t GetPassCount() const noexcept;
+	const char* GetPassName(const size_t Pass) const noexcept;
+	size_t FindPass(const char* Name) const noexcept;
+
+	// values of the last completed frame
+	const SCounters& GetLastFrame(const size_t Pass = FRAME) const noexcept;
+	// frames in the history, for a pass only the ones since it was first begun
+	size_t GetHistoryCount(const size_t Pass = FRAME) const noexcept;
+	double GetAverage(const ERenderCounter Counter, const size_t Pass = FRAME) const noexcept;
+	// Percentile in [0, 100] over the recorded history, nearest rank
+	uint64_t GetPercentile(const ERenderCounter Counter, const float Percentile, const size_t Pass = FRAME) const noexcept;
+
+	void OnGui() noexcept;
+	bool WriteJson(const char* FileName) const noexcept;
+	void WriteJson(FILE* File) const noexcept;
+
+private:
+	struct SHistory
+	{
+		uint64_t Values[HISTORY_SIZE][COUNTER_COUNT]{};
+	};
+
+	struct SPass
+	{
+		const char* Name = nullptr;
+		SCounters Current{};
+		SCounters LastFrame{};
+		size_t HistoryCount = 0;
+	};
+
+	const SHistory& GetHistory(const size_t Pass) const noexcept;
+	// slot of the Frame-th most recent frame
+	size_t GetHistorySlot(const size_t Frame) const noexcept;
+	void WriteCounters(FILE* File, const size_t Pass) const noexcept;
+
+	SCounters Current{};
+	SCounters LastFrame{};
+
+	// one history per pass plus the frame's at the end, allocated by the first EndFrame
+	std::unique_ptr<SHistory[]> Histories;
+
+	SPass Passes[MAX_PASSES]{};
+	size_t PassCount = 0;
+	size_t ActivePass = FRAME;
+
+	size_t HistoryHead = 0;
+	size_t HistoryCount = 0;
+	uint64_t FrameCount = 0;
+};
+
+class FRenderPassScope
+{
+public:
+	FRenderPassScope(FRenderStatistics& Statistics, const char* Name) noexcept : Statistics(Statistics)
+	{
+		Statistics.BeginPass(Name);
+	}
+
+	~FRenderPassScope()
+	{
+		Statistics.EndPass();
+	}
+
+	FRenderPassScope(const FRenderPassScope&) = delete;
+	FRenderPassScope& operator=(const FRenderPassScope&) = delete;
+
+private:
+	FRenderStatistics& Statistics;
+};
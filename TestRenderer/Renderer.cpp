@@ -1,14 +1,74 @@
 #include "Renderer.hpp"
+#include "CommandList.hpp"
+#include "Parallel.hpp"
+#include "FrameCapture.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "imgui/imgui_impl_dx11.h"
 #include <d3dcompiler.h>
 #include <string>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+	uint32_t GetBytesPerPixel(const DXGI_FORMAT Format) noexcept
+	{
+		switch (Format)
+		{
+		case DXGI_FORMAT_R32G32B32A32_FLOAT: return 16;
+		case DXGI_FORMAT_R32G32B32_FLOAT: return 12;
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:
+		case DXGI_FORMAT_R16G16B16A16_UNORM:
+		case DXGI_FORMAT_R32G32_FLOAT: return 8;
+		case DXGI_FORMAT_R16_FLOAT:
+		case DXGI_FORMAT_R16_UNORM:
+		case DXGI_FORMAT_R16_UINT: return 2;
+		case DXGI_FORMAT_R8_UNORM: return 1;
+		default: return 4;
+		}
+	}
+}
+
+FRenderer::FRenderer(const FRenderer& Parent, ID3D11DeviceContext* DeferredContext) noexcept
+	: Device(Parent.Device)
+	, DeviceContext(DeferredContext)
+	, Swapchain(nullptr)
+	, LinearWrapSampler(Parent.LinearWrapSampler)
+	, LinearClampSampler(Parent.LinearClampSampler)
+	, bIsDeferred(true)
+{
+	Device->AddRef();
+	LinearWrapSampler->AddRef();
+	LinearClampSampler->AddRef();
+}
+
+FRenderer::FRenderer() = default;
 
 FRenderer::~FRenderer()
 {
-	
-	
+	if (bIsDeferred)
+	{
+		LinearClampSampler->Release();
+		LinearWrapSampler->Release();
+		DeviceContext->Release();
+		Device->Release();
+		return;
+	}
+
+	// the deferred contexts would show up as live objects below
+	DeferredRenderers.clear();
+
+	// anything still registered here was created but never destroyed
+	for (const auto& Allocation : GpuAllocations)
+	{
+		char Message[256];
+		snprintf(Message, sizeof(Message), "Leaked %s %p: %llu bytes, tag %s\n", Allocation.second.Type, Allocation.first,
+			static_cast<unsigned long long>(Allocation.second.Bytes), GetMemoryTagName(Allocation.second.Tag));
+		OutputDebugStringA(Message);
+	}
+
 	ID3D11Debug* d3dDebug = nullptr;
 	if (SUCCEEDED(Device->QueryInterface(__uuidof(ID3D11Debug), (void**)& d3dDebug)))
 	{
@@ -38,8 +98,16 @@ FRenderer::~FRenderer()
 	LinearClampSampler = nullptr;
 	LinearWrapSampler->Release();
 	LinearWrapSampler = nullptr;
-	Swapchain->Release();
-	Swapchain = nullptr;
+	if (Swapchain)
+	{
+		Swapchain->Release();
+		Swapchain = nullptr;
+	}
+	if (FrameQuery)
+	{
+		FrameQuery->Release();
+		FrameQuery = nullptr;
+	}
 	Device->Release();
 	Device = nullptr;
 
@@ -107,6 +175,41 @@ EErrorCode FRenderer::CreateDeviceAndSwapchainForHwnd(HWND WindowHandle, const s
 	BackBuffer.Width = Width;
 	BackBuffer.Height = Height;
 
+	return CreateSamplers();
+}
+
+EErrorCode FRenderer::CreateOffscreenDevice(const uint32_t Width, const uint32_t Height, const bool bSoftware, SRenderTarget& BackBuffer) noexcept
+{
+	UINT CreationFlags = 0;
+#if defined(_DEBUG)
+	CreationFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+	const auto DriverType = bSoftware ? D3D_DRIVER_TYPE_WARP : D3D_DRIVER_TYPE_HARDWARE;
+	HRESULT HResult = D3D11CreateDevice(nullptr, DriverType, nullptr, CreationFlags, nullptr, 0, D3D11_SDK_VERSION, &Device, nullptr, &DeviceContext);
+	if (HResult != S_OK)
+	{
+		return EErrorCode::FAIL;
+	}
+
+	D3D11_QUERY_DESC QueryDesc{};
+	QueryDesc.Query = D3D11_QUERY_EVENT;
+	HResult = Device->CreateQuery(&QueryDesc, &FrameQuery);
+	if (HResult != S_OK)
+	{
+		return EErrorCode::FAIL;
+	}
+
+	const auto Result = CreateSamplers();
+	if (Result != EErrorCode::OK)
+	{
+		return Result;
+	}
+	return CreateRenderTarget(Width, Height, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, BackBuffer);
+}
+
+EErrorCode FRenderer::CreateSamplers() noexcept
+{
 	// create clamp sampler
 	D3D11_SAMPLER_DESC samplerDesc;
 	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
@@ -119,7 +222,7 @@ EErrorCode FRenderer::CreateDeviceAndSwapchainForHwnd(HWND WindowHandle, const s
 	samplerDesc.MinLOD = -FLT_MAX;
 	samplerDesc.MaxLOD = FLT_MAX;
 
-	HResult = Device->CreateSamplerState(&samplerDesc, &LinearClampSampler);
+	auto HResult = Device->CreateSamplerState(&samplerDesc, &LinearClampSampler);
 	if (HResult != S_OK)
 	{
 		return EErrorCode::FAIL;
@@ -147,16 +250,27 @@ EErrorCode FRenderer::CreateIndexBufferWithData(const uint32_t* Data, const size
 
 	Buffer.Stride = sizeof(uint32_t);
 
+	return CreateBuffer(BufferDesc, Data, Buffer);
+}
+
+EErrorCode FRenderer::CreateBuffer(const D3D11_BUFFER_DESC& BufferDesc, const void* Data, SBuffer& Buffer) const noexcept
+{
 	D3D11_SUBRESOURCE_DATA InitialData{};
 	InitialData.pSysMem = Data;
 	InitialData.SysMemPitch = 0;
 	InitialData.SysMemSlicePitch = 0;
 
-	const auto HResult = Device->CreateBuffer(&BufferDesc, &InitialData, &Buffer.Buffer);
+	const auto HResult = Device->CreateBuffer(&BufferDesc, Data ? &InitialData : nullptr, &Buffer.Buffer);
 	if (HResult != S_OK)
 	{
 		return EErrorCode::FAIL;
 	}
+	if (Data)
+	{
+		Statistics.Add(ERenderCounter::UPLOADS);
+		Statistics.Add(ERenderCounter::UPLOAD_BYTES, BufferDesc.ByteWidth);
+	}
+	TrackResource(Buffer.Buffer, BufferDesc.ByteWidth, "Buffer");
 
 	return EErrorCode::OK;
 }
@@ -182,6 +296,8 @@ EErrorCode FRenderer::CreateVertexShader(const wchar_t* FileName, const char* En
 		return EErrorCode::FAIL;
 	}
 	Shader.Vertex->SetPrivateData(WKPDID_D3DDebugObjectName, sizeof(FileName) - 1, FileName);
+	TrackResource(Shader.Vertex, Blob->GetBufferSize(), "Vertex Shader");
+	StoreCaptureData(Shader.Vertex, Blob->GetBufferPointer(), Blob->GetBufferSize());
 	if (InputElementDescriptorArray)
 	{
 		HResult = Device->CreateInputLayout(InputElementDescriptorArray, InputElementCount, Blob->GetBufferPointer(), Blob->GetBufferSize(), &Shader.Layout);
@@ -189,6 +305,18 @@ EErrorCode FRenderer::CreateVertexShader(const wchar_t* FileName, const char* En
 		{
 			return EErrorCode::FAIL;
 		}
+
+		std::vector<SCaptureInputElement> Elements(InputElementCount);
+		for (size_t Index = 0; Index < InputElementCount; ++Index)
+		{
+			const auto& Element = InputElementDescriptorArray[Index];
+			strncpy(Elements[Index].SemanticName, Element.SemanticName, sizeof(Elements[Index].SemanticName) - 1);
+			Elements[Index].SemanticIndex = Element.SemanticIndex;
+			Elements[Index].Format = Element.Format;
+			Elements[Index].InputSlot = Element.InputSlot;
+			Elements[Index].AlignedByteOffset = Element.AlignedByteOffset;
+		}
+		StoreCaptureData(Shader.Layout, Elements.data(), Elements.size() * sizeof(SCaptureInputElement));
 	}
 	Shader.Stage |= EShaderStage::VERTEX;
 	Blob->Release();
@@ -216,11 +344,157 @@ EErrorCode FRenderer::CreatePixelShader(const wchar_t* FileName, const char* Ent
 		return EErrorCode::FAIL;
 	}
 	Shader.Pixel->SetPrivateData(WKPDID_D3DDebugObjectName, sizeof(FileName) - 1, FileName);
+	TrackResource(Shader.Pixel, Blob->GetBufferSize(), "Pixel Shader");
+	StoreCaptureData(Shader.Pixel, Blob->GetBufferPointer(), Blob->GetBufferSize());
 	Shader.Stage |= EShaderStage::PIXEL;
 	Blob->Release();
 	return EErrorCode::OK;
 }
 
+EErrorCode FRenderer::CreatePixelShaderFromSource(const char* Source, const size_t Length, const char* Name, const char* EntryPoint, SShader& Shader) const noexcept
+{
+	ID3DBlob* Blob = nullptr;
+
+	UINT flags = D3DCOMPILE_ENABLE_STRICTNESS;
+#if defined( DEBUG ) || defined( _DEBUG )
+	flags |= D3DCOMPILE_DEBUG;
+#endif
+
+	auto HResult = D3DCompile(Source, Length, Name, nullptr, nullptr, EntryPoint, "ps_5_0", flags, 0, &Blob, nullptr);
+	if (HResult != S_OK)
+	{
+		return EErrorCode::FAIL;
+	}
+
+	HResult = Device->CreatePixelShader(Blob->GetBufferPointer(), Blob->GetBufferSize(), nullptr, &Shader.Pixel);
+	if (HResult != S_OK)
+	{
+		Blob->Release();
+		return EErrorCode::FAIL;
+	}
+	Shader.Pixel->SetPrivateData(WKPDID_D3DDebugObjectName, static_cast<UINT>(strlen(Name)), Name);
+	TrackResource(Shader.Pixel, Blob->GetBufferSize(), "Pixel Shader");
+	StoreCaptureData(Shader.Pixel, Blob->GetBufferPointer(), Blob->GetBufferSize());
+	Shader.Stage |= EShaderStage::PIXEL;
+	Blob->Release();
+	return EErrorCode::OK;
+}
+
+EErrorCode FRenderer::CreateComputeShader(const wchar_t* FileName, const char* EntryPoint, SShader& Shader) const noexcept
+{
+	ID3DBlob* Blob = nullptr;
+
+	UINT flags = D3DCOMPILE_ENABLE_STRICTNESS;
+#if defined( DEBUG ) || defined( _DEBUG )
+	flags |= D3DCOMPILE_DEBUG;
+#endif
+
+	auto HResult = D3DCompileFromFile(FileName, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, EntryPoint, "cs_5_0", flags, 0, &Blob, nullptr);
+	if (HResult != S_OK)
+	{
+		return EErrorCode::FAIL;
+	}
+
+	HResult = Device->CreateComputeShader(Blob->GetBufferPointer(), Blob->GetBufferSize(), nullptr, &Shader.Compute);
+	if (HResult != S_OK)
+	{
+		Blob->Release();
+		return EErrorCode::FAIL;
+	}
+	TrackResource(Shader.Compute, Blob->GetBufferSize(), "Compute Shader");
+	StoreCaptureData(Shader.Compute, Blob->GetBufferPointer(), Blob->GetBufferSize());
+	Shader.Stage |= EShaderStage::COMPUTE;
+	Blob->Release();
+	return EErrorCode::OK;
+}
+
+EErrorCode FRenderer::CreateStructuredBuffer(const uint32_t ElementSize, const uint32_t Count, const void* Data, const bool bReadWrite, SBuffer& Buffer) const noexcept
+{
+	D3D11_BUFFER_DESC BufferDesc{};
+	BufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	BufferDesc.ByteWidth = ElementSize * Count;
+	BufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | (bReadWrite ? D3D11_BIND_UNORDERED_ACCESS : 0);
+	BufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	BufferDesc.StructureByteStride = ElementSize;
+
+	Buffer.Stride = ElementSize;
+	auto Result = CreateBuffer(BufferDesc, Data, Buffer);
+	if (Result != EErrorCode::OK)
+	{
+		return Result;
+	}
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC ShaderResourceViewDesc{};
+	ShaderResourceViewDesc.Format = DXGI_FORMAT_UNKNOWN;
+	ShaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	ShaderResourceViewDesc.Buffer.FirstElement = 0;
+	ShaderResourceViewDesc.Buffer.NumElements = Count;
+	auto HResult = Device->CreateShaderResourceView(Buffer.Buffer, &ShaderResourceViewDesc, &Buffer.ShaderResourceView);
+	if (HResult != S_OK)
+	{
+		return EErrorCode::FAIL;
+	}
+
+	if (bReadWrite)
+	{
+		D3D11_UNORDERED_ACCESS_VIEW_DESC UnorderedAccessViewDesc{};
+		UnorderedAccessViewDesc.Format = DXGI_FORMAT_UNKNOWN;
+		UnorderedAccessViewDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+		UnorderedAccessViewDesc.Buffer.FirstElement = 0;
+		UnorderedAccessViewDesc.Buffer.NumElements = Count;
+		HResult = Device->CreateUnorderedAccessView(Buffer.Buffer, &UnorderedAccessViewDesc, &Buffer.UnorderedAccessView);
+		if (HResult != S_OK)
+		{
+			return EErrorCode::FAIL;
+		}
+	}
+	return EErrorCode::OK;
+}
+
+EErrorCode FRenderer::CreateReadWriteTexture(const uint32_t Width, const uint32_t Height, const DXGI_FORMAT Format, SRenderTarget& Texture) const noexcept
+{
+	D3D11_TEXTURE2D_DESC TextureDesc{};
+	TextureDesc.Width = Width;
+	TextureDesc.Height = Height;
+	TextureDesc.MipLevels = 1;
+	TextureDesc.ArraySize = 1;
+	TextureDesc.Format = Format;
+	TextureDesc.SampleDesc.Count = 1;
+	TextureDesc.Usage = D3D11_USAGE_DEFAULT;
+	TextureDesc.BindFlags = D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_SHADER_RESOURCE;
+	auto HResult = Device->CreateTexture2D(&TextureDesc, nullptr, &Texture.Texture);
+	if (HResult != S_OK)
+	{
+		return EErrorCode::FAIL;
+	}
+	TrackResource(Texture.Texture, static_cast<uint64_t>(Width) * Height * GetBytesPerPixel(Format), "Read Write Texture");
+
+	D3D11_UNORDERED_ACCESS_VIEW_DESC UnorderedAccessViewDesc{};
+	UnorderedAccessViewDesc.Format = Format;
+	UnorderedAccessViewDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
+	UnorderedAccessViewDesc.Texture2D.MipSlice = 0;
+	HResult = Device->CreateUnorderedAccessView(Texture.Texture, &UnorderedAccessViewDesc, &Texture.UnorderedAccessView);
+	if (HResult != S_OK)
+	{
+		return EErrorCode::FAIL;
+	}
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC ShaderResourceViewDesc{};
+	ShaderResourceViewDesc.Format = Format;
+	ShaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	ShaderResourceViewDesc.Texture2D.MostDetailedMip = 0;
+	ShaderResourceViewDesc.Texture2D.MipLevels = 1;
+	HResult = Device->CreateShaderResourceView(Texture.Texture, &ShaderResourceViewDesc, &Texture.ShaderResourceView);
+	if (HResult != S_OK)
+	{
+		return EErrorCode::FAIL;
+	}
+
+	Texture.Width = Width;
+	Texture.Height = Height;
+	return EErrorCode::OK;
+}
+
 EErrorCode FRenderer::CreateRenderTarget(const uint32_t Width, const uint32_t Height, const DXGI_FORMAT Format, SRenderTarget& RenderTarget) const noexcept
 {
 	D3D11_TEXTURE2D_DESC TextureDesc{};
@@ -239,6 +513,7 @@ EErrorCode FRenderer::CreateRenderTarget(const uint32_t Width, const uint32_t He
 	{
 		return EErrorCode::FAIL;
 	}
+	TrackResource(RenderTarget.Texture, static_cast<uint64_t>(Width) * Height * GetBytesPerPixel(Format), "Render Target");
 
 	D3D11_RENDER_TARGET_VIEW_DESC RenderTargetViewDesc{};
 	RenderTargetViewDesc.Format = TextureDesc.Format;
@@ -287,6 +562,7 @@ EErrorCode FRenderer::CreateDepthStencil(const uint32_t Width, const uint32_t He
 	{
 		return EErrorCode::FAIL;
 	}
+	TrackResource(DepthStencil.DepthTexture, static_cast<uint64_t>(Width) * Height * GetBytesPerPixel(Format), "Depth Stencil");
 	HResult = Device->CreateDepthStencilView(DepthStencil.DepthTexture, nullptr, &DepthStencil.DepthStencilView);
 	if (HResult != S_OK)
 	{
@@ -340,6 +616,9 @@ EErrorCode FRenderer::CreateTextureFromMemory(const uint8_t* Data, const uint32_
 	{
 		return EErrorCode::FAIL;
 	}
+	TrackResource(Texture.Texture, static_cast<uint64_t>(Width) * Height * GetBytesPerPixel(Format), "Texture");
+	Statistics.Add(ERenderCounter::UPLOADS);
+	Statistics.Add(ERenderCounter::UPLOAD_BYTES, static_cast<uint64_t>(Subresource.SysMemPitch) * Height);
 
 	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
 	srvDesc.Format = Format;
@@ -442,6 +721,7 @@ EErrorCode FRenderer::CreateCubeMapTexture(const char* Directory, SRenderTarget&
 		stbi_image_free(Images[5].Pixels);
 		return EErrorCode::FAIL;
 	}
+	TrackResource(CubeMap.Texture, static_cast<uint64_t>(TextureDesc.Width) * TextureDesc.Height * TextureDesc.ArraySize * GetBytesPerPixel(TextureDesc.Format), "Cube Map");
 	HResult = Device->CreateShaderResourceView(CubeMap.Texture, &SMViewDesc, &CubeMap.ShaderResourceView);
 	if (HResult != S_OK)
 	{
@@ -481,13 +761,20 @@ void FRenderer::DestroyRenderTarget(SRenderTarget& RenderTarget) const noexcept
 		RenderTarget.DepthStencilView->Release();
 		RenderTarget.DepthStencilView = nullptr;
 	}
+	if (RenderTarget.UnorderedAccessView != nullptr)
+	{
+		RenderTarget.UnorderedAccessView->Release();
+		RenderTarget.UnorderedAccessView = nullptr;
+	}
 	if (RenderTarget.Texture != nullptr)
 	{
+		UntrackResource(RenderTarget.Texture);
 		RenderTarget.Texture->Release();
 		RenderTarget.Texture = nullptr;
 	}
 	if (RenderTarget.DepthTexture != nullptr)
 	{
+		UntrackResource(RenderTarget.DepthTexture);
 		RenderTarget.DepthTexture->Release();
 		RenderTarget.DepthTexture = nullptr;
 	}
@@ -502,6 +789,7 @@ void FRenderer::DestroyTexture(SRenderTarget& Texture) const noexcept
 	}
 	if(Texture.Texture != nullptr)
 	{
+		UntrackResource(Texture.Texture);
 		Texture.Texture->Release();
 		Texture.Texture = nullptr;
 	}
@@ -509,9 +797,21 @@ void FRenderer::DestroyTexture(SRenderTarget& Texture) const noexcept
 
 void FRenderer::DestroyBuffer(SBuffer& Buffer) const noexcept
 {
+	if (Buffer.UnorderedAccessView)
+	{
+		Buffer.UnorderedAccessView->Release();
+		Buffer.UnorderedAccessView = nullptr;
+	}
+	if (Buffer.ShaderResourceView)
+	{
+		Buffer.ShaderResourceView->Release();
+		Buffer.ShaderResourceView = nullptr;
+	}
 	if (Buffer.Buffer)
 	{
+		UntrackResource(Buffer.Buffer);
 		Buffer.Buffer->Release();
+		Buffer.Buffer = nullptr;
 	}
 }
 
@@ -519,16 +819,49 @@ void FRenderer::DestroyShader(SShader& Shader) const noexcept
 {
 	if (Shader.Vertex)
 	{
+		UntrackResource(Shader.Vertex);
 		Shader.Vertex->Release();
+		Shader.Vertex = nullptr;
 	}
 	if (Shader.Pixel)
 	{
+		UntrackResource(Shader.Pixel);
 		Shader.Pixel->Release();
+		Shader.Pixel = nullptr;
 	}
 	if (Shader.Layout)
 	{
+		UntrackResource(Shader.Layout);
 		Shader.Layout->Release();
+		Shader.Layout = nullptr;
+	}
+	if (Shader.Compute)
+	{
+		UntrackResource(Shader.Compute);
+		Shader.Compute->Release();
+		Shader.Compute = nullptr;
+	}
+}
+
+void FRenderer::TrackResource(const void* Resource, const uint64_t Bytes, const char* Type) const noexcept
+{
+	Statistics.Add(ERenderCounter::RESOURCE_CREATIONS);
+	const auto Tag = GetCurrentMemoryTag();
+	std::lock_guard<std::mutex> Lock(GpuAllocationMutex);
+	GpuAllocations[Resource] = { Bytes, Tag, Type };
+	FMemoryTracker::Get().OnGpuAllocation(Tag, Bytes);
+}
+
+void FRenderer::UntrackResource(const void* Resource) const noexcept
+{
+	std::lock_guard<std::mutex> Lock(GpuAllocationMutex);
+	const auto Allocation = GpuAllocations.find(Resource);
+	if (Allocation != GpuAllocations.end())
+	{
+		FMemoryTracker::Get().OnGpuFree(Allocation->second.Tag, Allocation->second.Bytes);
+		GpuAllocations.erase(Allocation);
 	}
+	CaptureData.erase(Resource);
 }
 
 void FRenderer::ResizeBackBuffer(const uint32_t Width, const uint32_t Height, const SRenderTarget& BackBuffer) const noexcept
@@ -553,18 +886,88 @@ void FRenderer::ResizeBackBuffer(const uint32_t Width, const uint32_t Height, co
 	BackBuffer.Height = Height;
 }
 
+EErrorCode FRenderer::ReadBackTexture(const SRenderTarget& Texture, std::vector<uint32_t>& Pixels) const noexcept
+{
+	if (!Texture.Texture || bIsDeferred)
+	{
+		return EErrorCode::INVALIDCALL;
+	}
+	D3D11_TEXTURE2D_DESC Desc{};
+	Texture.Texture->GetDesc(&Desc);
+	if (GetBytesPerPixel(Desc.Format) != sizeof(uint32_t))
+	{
+		return EErrorCode::NOTIMPLEMENTED;
+	}
+
+	D3D11_TEXTURE2D_DESC StagingDesc = Desc;
+	StagingDesc.MipLevels = 1;
+	StagingDesc.ArraySize = 1;
+	StagingDesc.Usage = D3D11_USAGE_STAGING;
+	StagingDesc.BindFlags = 0;
+	StagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	StagingDesc.MiscFlags = 0;
+	ID3D11Texture2D* Staging = nullptr;
+	if (Device->CreateTexture2D(&StagingDesc, nullptr, &Staging) != S_OK)
+	{
+		return EErrorCode::FAIL;
+	}
+	DeviceContext->CopySubresourceRegion(Staging, 0, 0, 0, 0, Texture.Texture, 0, nullptr);
+
+	D3D11_MAPPED_SUBRESOURCE Mapped{};
+	if (DeviceContext->Map(Staging, 0, D3D11_MAP_READ, 0, &Mapped) != S_OK)
+	{
+		Staging->Release();
+		return EErrorCode::FAIL;
+	}
+	Pixels.resize(static_cast<size_t>(Desc.Width) * Desc.Height);
+	for (UINT Row = 0; Row < Desc.Height; ++Row)
+	{
+		memcpy(Pixels.data() + static_cast<size_t>(Row) * Desc.Width, static_cast<const uint8_t*>(Mapped.pData) + static_cast<size_t>(Row) * Mapped.RowPitch, Desc.Width * sizeof(uint32_t));
+	}
+	DeviceContext->Unmap(Staging, 0);
+	Staging->Release();
+	return EErrorCode::OK;
+}
+
 void FRenderer::ClearRenderTarget(const SRenderTarget& RenderTarget, const DirectX::XMFLOAT4& Colour) const noexcept
 {
+	Statistics.Add(ERenderCounter::CLEARS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::CLEAR_RENDER_TARGET);
+		Capture->Write(Capture->AddView(RenderTarget.RenderTargetView));
+		Capture->Write(Colour.x);
+		Capture->Write(Colour.y);
+		Capture->Write(Colour.z);
+		Capture->Write(Colour.w);
+		Capture->EndCall();
+	}
 	DeviceContext->ClearRenderTargetView(RenderTarget.RenderTargetView, &Colour.x);
 }
 
 void FRenderer::ClearDepthStencil(const SRenderTarget& RenderTarget, const uint32_t ClearFlags, const float Depth, const uint8_t Stencil) const noexcept
 {
+	Statistics.Add(ERenderCounter::CLEARS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::CLEAR_DEPTH_STENCIL);
+		Capture->Write(Capture->AddView(RenderTarget.DepthStencilView));
+		Capture->Write(ClearFlags);
+		Capture->Write(Depth);
+		Capture->Write(static_cast<uint32_t>(Stencil));
+		Capture->EndCall();
+	}
 	DeviceContext->ClearDepthStencilView(RenderTarget.DepthStencilView, ClearFlags, Depth, Stencil);
 }
 
 void FRenderer::UnbindRenderTargets() const noexcept
 {
+	Statistics.Add(ERenderCounter::RENDER_TARGET_BINDS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::UNBIND_RENDER_TARGETS);
+		Capture->EndCall();
+	}
 	ID3D11ShaderResourceView* NullSRViews[] = {
 		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
 		nullptr, nullptr, nullptr, nullptr
@@ -577,6 +980,15 @@ void FRenderer::UnbindRenderTargets() const noexcept
 
 void FRenderer::SetConstantBuffer(const SBuffer& ConstantBuffer, const EShaderStage ShaderStage, const size_t Slot) const noexcept
 {
+	Statistics.Add(ERenderCounter::CONSTANT_BUFFER_BINDS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::SET_CONSTANT_BUFFER);
+		Capture->Write(Capture->AddResource(ConstantBuffer.Buffer));
+		Capture->Write(static_cast<uint32_t>(ShaderStage));
+		Capture->Write(static_cast<uint32_t>(Slot));
+		Capture->EndCall();
+	}
 	if ((ShaderStage & EShaderStage::VERTEX) == EShaderStage::VERTEX)
 	{
 		DeviceContext->VSSetConstantBuffers(Slot, 1, &ConstantBuffer.Buffer);
@@ -586,10 +998,27 @@ void FRenderer::SetConstantBuffer(const SBuffer& ConstantBuffer, const EShaderSt
 	{
 		DeviceContext->PSSetConstantBuffers(Slot, 1, &ConstantBuffer.Buffer);
 	}
+
+	if ((ShaderStage & EShaderStage::COMPUTE) == EShaderStage::COMPUTE)
+	{
+		DeviceContext->CSSetConstantBuffers(Slot, 1, &ConstantBuffer.Buffer);
+	}
 }
 
 void FRenderer::SetViewport(const uint32_t Width, const uint32_t Height, const uint32_t XOffset, const uint32_t YOffset, const float MinDepth, const float MaxDepth) const noexcept
 {
+	Statistics.Add(ERenderCounter::VIEWPORT_CHANGES);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::SET_VIEWPORT);
+		Capture->Write(Width);
+		Capture->Write(Height);
+		Capture->Write(XOffset);
+		Capture->Write(YOffset);
+		Capture->Write(MinDepth);
+		Capture->Write(MaxDepth);
+		Capture->EndCall();
+	}
 	D3D11_VIEWPORT Viewport{};
 	Viewport.Width = static_cast<FLOAT>(Width);
 	Viewport.Height = static_cast<FLOAT>(Height);
@@ -603,6 +1032,17 @@ void FRenderer::SetViewport(const uint32_t Width, const uint32_t Height, const u
 
 void FRenderer::SetShader(const SShader& Shader) const noexcept
 {
+	Statistics.Add(ERenderCounter::SHADER_BINDS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::SET_SHADER);
+		Capture->Write(static_cast<uint32_t>(Shader.Stage));
+		Capture->Write(CaptureObject(Shader.Vertex, ECaptureResource::VERTEX_SHADER));
+		Capture->Write(CaptureObject(Shader.Layout, ECaptureResource::INPUT_LAYOUT));
+		Capture->Write(CaptureObject(Shader.Pixel, ECaptureResource::PIXEL_SHADER));
+		Capture->Write(CaptureObject(Shader.Compute, ECaptureResource::COMPUTE_SHADER));
+		Capture->EndCall();
+	}
 	if ((Shader.Stage & EShaderStage::VERTEX) == EShaderStage::VERTEX)
 	{
 		DeviceContext->VSSetShader(Shader.Vertex, nullptr, 0);
@@ -613,15 +1053,41 @@ void FRenderer::SetShader(const SShader& Shader) const noexcept
 	{
 		DeviceContext->PSSetShader(Shader.Pixel, nullptr, 0);
 	}
+
+	if ((Shader.Stage & EShaderStage::COMPUTE) == EShaderStage::COMPUTE)
+	{
+		DeviceContext->CSSetShader(Shader.Compute, nullptr, 0);
+	}
 }
 
 void FRenderer::SetRenderTarget(const SRenderTarget& RenderTarget) const noexcept
 {
+	Statistics.Add(ERenderCounter::RENDER_TARGET_BINDS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::SET_RENDER_TARGETS);
+		Capture->Write(1u);
+		Capture->Write(Capture->AddView(RenderTarget.DepthStencilView));
+		Capture->Write(Capture->AddView(RenderTarget.RenderTargetView));
+		Capture->EndCall();
+	}
 	DeviceContext->OMSetRenderTargets(1, &RenderTarget.RenderTargetView, RenderTarget.DepthStencilView);
 }
 
 void FRenderer::SetRenderTargets(const size_t Count, const SRenderTarget* RenderTarget) const noexcept
 {
+	Statistics.Add(ERenderCounter::RENDER_TARGET_BINDS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::SET_RENDER_TARGETS);
+		Capture->Write(static_cast<uint32_t>(Count));
+		Capture->Write(Capture->AddView(RenderTarget[0].DepthStencilView));
+		for (size_t Index = 0; Index < Count; ++Index)
+		{
+			Capture->Write(Capture->AddView(RenderTarget[Index].RenderTargetView));
+		}
+		Capture->EndCall();
+	}
 	ID3D11RenderTargetView* RenderTargetViewArray[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT];
 
 	for(size_t Index = 0; Index < Count; ++Index)
@@ -634,6 +1100,14 @@ void FRenderer::SetRenderTargets(const size_t Count, const SRenderTarget* Render
 
 void FRenderer::SetTexture(const uint32_t Slot, const SRenderTarget& Texture) const noexcept
 {
+	Statistics.Add(ERenderCounter::TEXTURE_BINDS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::SET_TEXTURE);
+		Capture->Write(Slot);
+		Capture->Write(Capture->AddView(Texture.ShaderResourceView));
+		Capture->EndCall();
+	}
 	ID3D11SamplerState *samplers[] = { LinearClampSampler, LinearWrapSampler };
 	DeviceContext->PSSetShaderResources(Slot, 1, &Texture.ShaderResourceView);
 	DeviceContext->PSSetSamplers(0, 2, samplers);
@@ -641,31 +1115,347 @@ void FRenderer::SetTexture(const uint32_t Slot, const SRenderTarget& Texture) co
 
 void FRenderer::SetPrimitiveTopology(const D3D11_PRIMITIVE_TOPOLOGY PrimitiveTopology) const noexcept
 {
+	Statistics.Add(ERenderCounter::TOPOLOGY_CHANGES);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::SET_PRIMITIVE_TOPOLOGY);
+		Capture->Write(static_cast<uint32_t>(PrimitiveTopology));
+		Capture->EndCall();
+	}
 	DeviceContext->IASetPrimitiveTopology(PrimitiveTopology);
 }
 
 void FRenderer::SetVertexBuffer(const size_t StartSlot, const SBuffer& Buffer, const uint32_t Offset) const noexcept
 {
+	Statistics.Add(ERenderCounter::VERTEX_BUFFER_BINDS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::SET_VERTEX_BUFFER);
+		Capture->Write(static_cast<uint32_t>(StartSlot));
+		Capture->Write(Capture->AddResource(Buffer.Buffer));
+		Capture->Write(Buffer.Stride);
+		Capture->Write(Offset);
+		Capture->EndCall();
+	}
 	DeviceContext->IASetVertexBuffers(StartSlot, 1, &Buffer.Buffer, &Buffer.Stride, &Offset);
 }
 
 void FRenderer::SetIndexBuffer(const size_t StartSlot, const SBuffer& Buffer, const uint32_t Offset) const noexcept
 {
+	Statistics.Add(ERenderCounter::INDEX_BUFFER_BINDS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::SET_INDEX_BUFFER);
+		Capture->Write(Capture->AddResource(Buffer.Buffer));
+		Capture->Write(Offset);
+		Capture->EndCall();
+	}
 	DeviceContext->IASetIndexBuffer(Buffer.Buffer, DXGI_FORMAT_R32_UINT, Offset);
 }
 
+void FRenderer::SetComputeTexture(const uint32_t Slot, const SRenderTarget& Texture) const noexcept
+{
+	Statistics.Add(ERenderCounter::TEXTURE_BINDS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::SET_COMPUTE_TEXTURE);
+		Capture->Write(Slot);
+		Capture->Write(Capture->AddView(Texture.ShaderResourceView));
+		Capture->EndCall();
+	}
+	ID3D11SamplerState *samplers[] = { LinearClampSampler, LinearWrapSampler };
+	DeviceContext->CSSetShaderResources(Slot, 1, &Texture.ShaderResourceView);
+	DeviceContext->CSSetSamplers(0, 2, samplers);
+}
+
+void FRenderer::SetComputeBuffer(const uint32_t Slot, const SBuffer& Buffer) const noexcept
+{
+	Statistics.Add(ERenderCounter::TEXTURE_BINDS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::SET_COMPUTE_BUFFER);
+		Capture->Write(Slot);
+		Capture->Write(Capture->AddView(Buffer.ShaderResourceView));
+		Capture->EndCall();
+	}
+	DeviceContext->CSSetShaderResources(Slot, 1, &Buffer.ShaderResourceView);
+}
+
+void FRenderer::SetReadWriteTexture(const uint32_t Slot, const SRenderTarget& Texture) const noexcept
+{
+	Statistics.Add(ERenderCounter::READ_WRITE_BINDS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::SET_READ_WRITE_TEXTURE);
+		Capture->Write(Slot);
+		Capture->Write(Capture->AddView(Texture.UnorderedAccessView));
+		Capture->EndCall();
+	}
+	DeviceContext->CSSetUnorderedAccessViews(Slot, 1, &Texture.UnorderedAccessView, nullptr);
+}
+
+void FRenderer::SetReadWriteBuffer(const uint32_t Slot, const SBuffer& Buffer) const noexcept
+{
+	Statistics.Add(ERenderCounter::READ_WRITE_BINDS);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::SET_READ_WRITE_BUFFER);
+		Capture->Write(Slot);
+		Capture->Write(Capture->AddView(Buffer.UnorderedAccessView));
+		Capture->EndCall();
+	}
+	DeviceContext->CSSetUnorderedAccessViews(Slot, 1, &Buffer.UnorderedAccessView, nullptr);
+}
+
+void FRenderer::UnbindComputeResources() const noexcept
+{
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::UNBIND_COMPUTE_RESOURCES);
+		Capture->EndCall();
+	}
+	ID3D11ShaderResourceView* NullShaderResourceViews[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT]{};
+	ID3D11UnorderedAccessView* NullUnorderedAccessViews[D3D11_PS_CS_UAV_REGISTER_COUNT]{};
+
+	DeviceContext->CSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, NullShaderResourceViews);
+	DeviceContext->CSSetUnorderedAccessViews(0, D3D11_PS_CS_UAV_REGISTER_COUNT, NullUnorderedAccessViews, nullptr);
+}
+
+void FRenderer::Dispatch(const uint32_t GroupCountX, const uint32_t GroupCountY, const uint32_t GroupCountZ) const noexcept
+{
+	Statistics.Add(ERenderCounter::DISPATCHES);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::DISPATCH);
+		Capture->Write(GroupCountX);
+		Capture->Write(GroupCountY);
+		Capture->Write(GroupCountZ);
+		Capture->EndCall();
+	}
+	DeviceContext->Dispatch(GroupCountX, GroupCountY, GroupCountZ);
+}
+
 void FRenderer::Draw(const size_t VertexCount, const size_t VertexLocationStart) const noexcept
 {
+	Statistics.Add(ERenderCounter::DRAW_CALLS);
+	Statistics.Add(ERenderCounter::VERTICES, VertexCount);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::DRAW);
+		Capture->Write(static_cast<uint32_t>(VertexCount));
+		Capture->Write(static_cast<uint32_t>(VertexLocationStart));
+		Capture->EndCall();
+	}
 	DeviceContext->Draw(VertexCount, VertexLocationStart);
 }
 
 void FRenderer::DrawIndexed(const size_t IndexCount, const size_t IndexLocationStart, const size_t VertexLocationBase) const noexcept
 {
+	Statistics.Add(ERenderCounter::DRAW_CALLS);
+	Statistics.Add(ERenderCounter::INDICES, IndexCount);
+	if (bCapturing)
+	{
+		Capture->BeginCall(ECaptureCall::DRAW_INDEXED);
+		Capture->Write(static_cast<uint32_t>(IndexCount));
+		Capture->Write(static_cast<uint32_t>(IndexLocationStart));
+		Capture->Write(static_cast<uint32_t>(VertexLocationBase));
+		Capture->EndCall();
+	}
 	DeviceContext->DrawIndexed(IndexCount, IndexLocationStart, VertexLocationBase);
 }
 
+EErrorCode FRenderer::CreateDeferredRenderers() const noexcept
+{
+	const size_t Count = std::max<size_t>(1, std::thread::hardware_concurrency());
+	for (size_t Index = 0; Index < Count; ++Index)
+	{
+		ID3D11DeviceContext* DeferredContext = nullptr;
+		if (Device->CreateDeferredContext(0, &DeferredContext) != S_OK)
+		{
+			DeferredRenderers.clear();
+			return EErrorCode::FAIL;
+		}
+		DeferredRenderers.emplace_back(new FRenderer(*this, DeferredContext));
+	}
+	return EErrorCode::OK;
+}
+
+void FCommandList::Execute(const FRenderer& Renderer) const noexcept
+{
+	for (const auto& Command : Commands)
+	{
+		switch (Command.Type)
+		{
+		case ECommand::CLEAR_RENDER_TARGET:
+		{
+			SRenderTarget RenderTarget{};
+			RenderTarget.RenderTargetView = Command.Clear.RenderTargetView;
+			Renderer.ClearRenderTarget(RenderTarget, DirectX::XMFLOAT4(Command.Clear.Colour[0], Command.Clear.Colour[1], Command.Clear.Colour[2], Command.Clear.Colour[3]));
+			break;
+		}
+		case ECommand::CLEAR_DEPTH_STENCIL:
+		{
+			SRenderTarget RenderTarget{};
+			RenderTarget.DepthStencilView = Command.Clear.DepthStencilView;
+			Renderer.ClearDepthStencil(RenderTarget, Command.Clear.ClearFlags, Command.Clear.Depth, Command.Clear.Stencil);
+			break;
+		}
+		case ECommand::SET_CONSTANT_BUFFER:
+			Renderer.SetConstantBuffer({ Command.BufferBinding.Buffer, Command.BufferBinding.Stride }, Command.BufferBinding.Stage, Command.BufferBinding.Slot);
+			break;
+		case ECommand::UPDATE_SUBRESOURCE:
+			Renderer.UpdateSubresource({ Command.Upload.Buffer, 0 }, Payload.data() + Command.Upload.PayloadOffset, Command.Upload.ByteSize);
+			break;
+		case ECommand::SET_VIEWPORT:
+			Renderer.SetViewport(Command.Viewport.Width, Command.Viewport.Height, Command.Viewport.XOffset, Command.Viewport.YOffset, Command.Viewport.MinDepth, Command.Viewport.MaxDepth);
+			break;
+		case ECommand::SET_SHADER:
+		{
+			SShader Shader{};
+			Shader.Vertex = Command.ShaderBinding.Vertex;
+			Shader.Pixel = Command.ShaderBinding.Pixel;
+			Shader.Compute = Command.ShaderBinding.Compute;
+			Shader.Layout = Command.ShaderBinding.Layout;
+			Shader.Stage = Command.ShaderBinding.Stage;
+			Renderer.SetShader(Shader);
+			break;
+		}
+		case ECommand::SET_RENDER_TARGET:
+		{
+			SRenderTarget RenderTarget{};
+			RenderTarget.RenderTargetView = Command.Clear.RenderTargetView;
+			RenderTarget.DepthStencilView = Command.Clear.DepthStencilView;
+			Renderer.SetRenderTarget(RenderTarget);
+			break;
+		}
+		case ECommand::SET_TEXTURE:
+		case ECommand::SET_COMPUTE_TEXTURE:
+		case ECommand::SET_READ_WRITE_TEXTURE:
+		{
+			SRenderTarget Texture{};
+			Texture.ShaderResourceView = Command.TextureBinding.ShaderResourceView;
+			Texture.UnorderedAccessView = Command.TextureBinding.UnorderedAccessView;
+			if (Command.Type == ECommand::SET_TEXTURE)
+			{
+				Renderer.SetTexture(Command.TextureBinding.Slot, Texture);
+			}
+			else if (Command.Type == ECommand::SET_COMPUTE_TEXTURE)
+			{
+				Renderer.SetComputeTexture(Command.TextureBinding.Slot, Texture);
+			}
+			else
+			{
+				Renderer.SetReadWriteTexture(Command.TextureBinding.Slot, Texture);
+			}
+			break;
+		}
+		case ECommand::SET_PRIMITIVE_TOPOLOGY:
+			Renderer.SetPrimitiveTopology(static_cast<D3D11_PRIMITIVE_TOPOLOGY>(Command.Topology));
+			break;
+		case ECommand::SET_VERTEX_BUFFER:
+			Renderer.SetVertexBuffer(Command.BufferBinding.Slot, { Command.BufferBinding.Buffer, Command.BufferBinding.Stride }, Command.BufferBinding.Offset);
+			break;
+		case ECommand::SET_INDEX_BUFFER:
+			Renderer.SetIndexBuffer(Command.BufferBinding.Slot, { Command.BufferBinding.Buffer, Command.BufferBinding.Stride }, Command.BufferBinding.Offset);
+			break;
+		case ECommand::UNBIND_COMPUTE_RESOURCES:
+			Renderer.UnbindComputeResources();
+			break;
+		case ECommand::DISPATCH:
+			Renderer.Dispatch(Command.GroupCount[0], Command.GroupCount[1], Command.GroupCount[2]);
+			break;
+		case ECommand::DRAW:
+			Renderer.Draw(Command.Draw.Count, Command.Draw.Start);
+			break;
+		case ECommand::DRAW_INDEXED:
+			Renderer.DrawIndexed(Command.Draw.Count, Command.Draw.Start, Command.Draw.Base);
+			break;
+		}
+	}
+}
+
+void FRenderer::Submit(const FCommandList* const* CommandLists, const size_t Count, const ECommandBackend Backend) const noexcept
+{
+	SortCommandLists(CommandLists, Count, SubmitOrder);
+
+	// calls made on deferred contexts would bypass a running capture
+	const bool bDeferred = Backend == ECommandBackend::DEFERRED_CONTEXT && !bIsDeferred && !bCapturing && Count > 0 &&
+		(!DeferredRenderers.empty() || CreateDeferredRenderers() == EErrorCode::OK);
+	if (!bDeferred)
+	{
+		for (const auto CommandList : SubmitOrder)
+		{
+			CommandList->Execute(*this);
+		}
+		return;
+	}
+
+	// every worker translates a contiguous run of the sorted lists, so executing the
+	// resulting command lists by worker index keeps the merged order
+	const size_t WorkerCount = std::min(DeferredRenderers.size(), Count);
+	ID3D11CommandList* NativeCommandLists[64]{};
+	const size_t BatchCount = std::min<size_t>(WorkerCount, _countof(NativeCommandLists));
+	ParallelFor(BatchCount, 1, [this, Count, BatchCount, &NativeCommandLists](const size_t Begin, const size_t End)
+	{
+		for (size_t Batch = Begin; Batch < End; ++Batch)
+		{
+			const auto& Deferred = *DeferredRenderers[Batch];
+			for (size_t Index = Count * Batch / BatchCount; Index < Count * (Batch + 1) / BatchCount; ++Index)
+			{
+				SubmitOrder[Index]->Execute(Deferred);
+			}
+			Deferred.DeviceContext->FinishCommandList(FALSE, &NativeCommandLists[Batch]);
+		}
+	});
+
+	// the immediate context gets back what was bound before, so callers need not rebind after a
+	// submit. The deferred contexts start from defaults for every batch either way.
+	for (size_t Batch = 0; Batch < BatchCount; ++Batch)
+	{
+		if (NativeCommandLists[Batch] != nullptr)
+		{
+			DeviceContext->ExecuteCommandList(NativeCommandLists[Batch], TRUE);
+			NativeCommandLists[Batch]->Release();
+		}
+		auto& DeferredStatistics = DeferredRenderers[Batch]->Statistics;
+		Statistics.Add(DeferredStatistics);
+		DeferredStatistics.Reset();
+	}
+}
+
 EErrorCode FRenderer::Present(const size_t SyncInterval, const size_t Flags) const noexcept
 {
+	Statistics.EndFrame();
+
+	if (Capture)
+	{
+		if (bCapturing)
+		{
+			char Message[512];
+			snprintf(Message, sizeof(Message), "%s frame capture %s with %u calls\n", Capture->Save() ? "Wrote" : "Failed to write",
+				Capture->GetFileName().c_str(), Capture->GetCallCount());
+			OutputDebugStringA(Message);
+			Capture.reset();
+			bCapturing = false;
+		}
+		else
+		{
+			bCapturing = true;
+		}
+	}
+
+	if (Swapchain == nullptr)
+	{
+		// nothing throttles an offscreen device, without waiting the CPU would queue up frames
+		DeviceContext->End(FrameQuery);
+		BOOL bDone = FALSE;
+		while (DeviceContext->GetData(FrameQuery, &bDone, sizeof(bDone), 0) == S_FALSE)
+		{
+			std::this_thread::yield();
+		}
+		return EErrorCode::OK;
+	}
+
 	const auto HResult = Swapchain->Present(SyncInterval, Flags);
 	if (HResult != S_OK)
 	{
@@ -673,3 +1463,40 @@ EErrorCode FRenderer::Present(const size_t SyncInterval, const size_t Flags) con
 	}
 	return EErrorCode::OK;
 }
+
+void FRenderer::RequestCapture(const char* FileName) const noexcept
+{
+	if (!Capture && !bIsDeferred)
+	{
+		Capture.reset(new FFrameCapture(Device, DeviceContext, FileName));
+	}
+}
+
+bool FRenderer::IsCaptureRequested() const noexcept
+{
+	return Capture != nullptr;
+}
+
+void FRenderer::StoreCaptureData(const void* Object, const void* Data, const size_t Size) const noexcept
+{
+	std::lock_guard<std::mutex> Lock(GpuAllocationMutex);
+	auto& Stored = CaptureData[Object];
+	Stored.assign(static_cast<const uint8_t*>(Data), static_cast<const uint8_t*>(Data) + Size);
+}
+
+uint32_t FRenderer::CaptureObject(const void* Object, const ECaptureResource Type) const noexcept
+{
+	static const std::vector<uint8_t> Empty;
+	std::lock_guard<std::mutex> Lock(GpuAllocationMutex);
+	const auto Found = CaptureData.find(Object);
+	return Capture->AddObject(Object, Type, Found != CaptureData.end() ? Found->second : Empty);
+}
+
+void FRenderer::CaptureUpload(const SBuffer& Buffer, const void* Data, const size_t ByteSize) const noexcept
+{
+	Capture->BeginCall(ECaptureCall::UPDATE_SUBRESOURCE);
+	Capture->Write(Capture->AddResource(Buffer.Buffer));
+	Capture->Write(static_cast<uint32_t>(ByteSize));
+	Capture->WriteBytes(Data, static_cast<uint32_t>(ByteSize));
+	Capture->EndCall();
+}
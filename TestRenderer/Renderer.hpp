@@ -6,7 +6,15 @@
 
 #include <DirectXMath.h>
 #include <type_traits>
+#include <mutex>
+#include <unordered_map>
+#include <memory>
+#include <vector>
 #include "ShaderStage.hpp"
+#include "RenderResources.hpp"
+#include "MemoryTracker.hpp"
+#include "RenderStatistics.hpp"
+#include "FrameCaptureFormat.hpp"
 
 enum class EErrorCode
 {
@@ -17,35 +25,14 @@ enum class EErrorCode
 	NOTIMPLEMENTED
 };
 
-struct SBuffer
-{
-	ID3D11Buffer* Buffer;
-	uint32_t Stride;
-};
-
-struct SRenderTarget
-{
-	mutable ID3D11RenderTargetView* RenderTargetView = nullptr;
-	mutable ID3D11ShaderResourceView* ShaderResourceView = nullptr;
-	mutable ID3D11DepthStencilView* DepthStencilView = nullptr;
-	mutable ID3D11Texture2D* Texture = nullptr;
-	mutable ID3D11Texture2D* DepthTexture = nullptr;
-	mutable uint32_t Width = 0;
-	mutable uint32_t Height = 0;
-};
-
-struct SShader
-{
-	ID3D11VertexShader* Vertex = nullptr;
-	ID3D11PixelShader* Pixel = nullptr;
-	ID3D11InputLayout* Layout = nullptr;
-	EShaderStage Stage;
-};
+class FCommandList;
+class FFrameCapture;
+enum class ECommandBackend : uint8_t;
 
 class FRenderer
 {
 public:
-	explicit FRenderer() = default;
+	explicit FRenderer();
 	~FRenderer();
 
 	FRenderer(const FRenderer&) = delete;
@@ -56,6 +43,10 @@ public:
 	EErrorCode InitializeImGui() const noexcept;
 
 	EErrorCode CreateDeviceAndSwapchainForHwnd(HWND WindowHandle, const size_t Width, const size_t Height, SRenderTarget& BackBuffer) noexcept;
+	// no window and no swapchain, BackBuffer becomes an ordinary render target and Present waits
+	// for the GPU to finish the frame. bSoftware picks the WARP rasterizer for machines without a GPU.
+	EErrorCode CreateOffscreenDevice(const uint32_t Width, const uint32_t Height, const bool bSoftware, SRenderTarget& BackBuffer) noexcept;
+	EErrorCode CreateBuffer(const D3D11_BUFFER_DESC& BufferDesc, const void* Data, SBuffer& Buffer) const noexcept;
 	template <typename TType>
 	EErrorCode CreateVertexBufferWithData(const TType* Data, const size_t Count, SBuffer& Buffer) const noexcept;
 	EErrorCode CreateIndexBufferWithData(const uint32_t* Data, const size_t Count, SBuffer& Buffer) const noexcept;
@@ -63,6 +54,13 @@ public:
 	EErrorCode CreateConstantBufferWithData(const TType& Data, SBuffer& Buffer) const noexcept;
 	EErrorCode CreateVertexShader(const wchar_t* FileName, const char* EntryPoint, const D3D11_INPUT_ELEMENT_DESC* InputElementDescriptorArray, const size_t InputElementCount, SShader& Shader) const noexcept;
 	EErrorCode CreatePixelShader(const wchar_t* FileName, const char* EntryPoint, SShader& Shader) const noexcept;
+	// HLSL generated at runtime, Name only labels the shader for debuggers
+	EErrorCode CreatePixelShaderFromSource(const char* Source, const size_t Length, const char* Name, const char* EntryPoint, SShader& Shader) const noexcept;
+	EErrorCode CreateComputeShader(const wchar_t* FileName, const char* EntryPoint, SShader& Shader) const noexcept;
+	// Data may be null, read write buffers get an unordered access view as well
+	EErrorCode CreateStructuredBuffer(const uint32_t ElementSize, const uint32_t Count, const void* Data, const bool bReadWrite, SBuffer& Buffer) const noexcept;
+	// texture with shader resource and unordered access views, for compute outputs
+	EErrorCode CreateReadWriteTexture(const uint32_t Width, const uint32_t Height, const DXGI_FORMAT Format, SRenderTarget& Texture) const noexcept;
 	EErrorCode CreateRenderTarget(const uint32_t Width, const uint32_t Height, const DXGI_FORMAT Format, SRenderTarget& RenderTarget) const noexcept;
 	EErrorCode CreateDepthStencil(const uint32_t Width, const uint32_t Height, const DXGI_FORMAT Format, SRenderTarget& DepthStencil) const noexcept;
 	EErrorCode CreateTextureFromFile(const char* FileName, const DXGI_FORMAT Format, SRenderTarget& Texture) const noexcept;
@@ -78,6 +76,10 @@ public:
 	template <typename TType>
 	void UpdateSubresource(const SBuffer& Buffer, const TType* Data, const size_t ByteSize)  const noexcept;
 
+	// copies the first mip of a texture with four bytes per texel back to the CPU, rows tightly packed,
+	// stalls until the GPU finished writing it
+	EErrorCode ReadBackTexture(const SRenderTarget& Texture, std::vector<uint32_t>& Pixels) const noexcept;
+
 	void ClearRenderTarget(const SRenderTarget& RenderTarget, const DirectX::XMFLOAT4& Colour) const noexcept;
 	void ClearDepthStencil(const SRenderTarget& RenderTarget, const uint32_t ClearFlags, const float Depth, const uint8_t Stencil) const noexcept;
 
@@ -93,15 +95,74 @@ public:
 	void SetVertexBuffer(const size_t StartSlot, const SBuffer& Buffer, const uint32_t Offset) const noexcept;
 	void SetIndexBuffer(const size_t StartSlot, const SBuffer& Buffer, const uint32_t Offset) const noexcept;
 
+	void SetComputeTexture(const uint32_t Slot, const SRenderTarget& Texture) const noexcept;
+	void SetComputeBuffer(const uint32_t Slot, const SBuffer& Buffer) const noexcept;
+	void SetReadWriteTexture(const uint32_t Slot, const SRenderTarget& Texture) const noexcept;
+	void SetReadWriteBuffer(const uint32_t Slot, const SBuffer& Buffer) const noexcept;
+	// clears compute shader resource and unordered access slots so outputs can be read elsewhere
+	void UnbindComputeResources() const noexcept;
+	void Dispatch(const uint32_t GroupCountX, const uint32_t GroupCountY, const uint32_t GroupCountZ = 1) const noexcept;
+
 	void Draw(const size_t VertexCount, const size_t VertexLocationStart) const noexcept;
 	void DrawIndexed(const size_t IndexCount, const size_t IndexLocationStart = 0, const size_t VertexLocationBase = 0) const noexcept;
 
+	// merges the lists by sort key, ties keep the order they are passed in, see CommandList.hpp.
+	// RECORDED replays onto the immediate context, the lists' bindings stay. DEFERRED_CONTEXT
+	// leaves the immediate context bound as it was before.
+	void Submit(const FCommandList* const* CommandLists, const size_t Count, const ECommandBackend Backend) const noexcept;
+
 	EErrorCode Present(const size_t SyncInterval = 0, const size_t Flags = 0) const noexcept;
 
+	// the frame after the next Present is written to FileName, see FrameCaptureFormat.hpp
+	void RequestCapture(const char* FileName) const noexcept;
+	bool IsCaptureRequested() const noexcept;
+
+	// counts every call above, frames are closed by Present
+	FRenderStatistics& GetStatistics() const noexcept { return Statistics; }
+
 private:
+	struct SGpuAllocation
+	{
+		uint64_t Bytes;
+		EMemoryTag Tag;
+		const char* Type;
+	};
+
+	// wraps a deferred context of Parent's device, only the Set, Draw and Dispatch calls are valid on it
+	FRenderer(const FRenderer& Parent, ID3D11DeviceContext* DeferredContext) noexcept;
+
+	EErrorCode CreateDeferredRenderers() const noexcept;
+	EErrorCode CreateSamplers() noexcept;
+
+	// creation data a capture needs but the device does not hand out again
+	void StoreCaptureData(const void* Object, const void* Data, const size_t Size) const noexcept;
+	uint32_t CaptureObject(const void* Object, const ECaptureResource Type) const noexcept;
+	void CaptureUpload(const SBuffer& Buffer, const void* Data, const size_t ByteSize) const noexcept;
+
+	// resources are attributed to the memory tag active on the creating thread
+	void TrackResource(const void* Resource, const uint64_t Bytes, const char* Type) const noexcept;
+	void UntrackResource(const void* Resource) const noexcept;
+
+	mutable std::mutex GpuAllocationMutex;
+	mutable std::unordered_map<const void*, SGpuAllocation> GpuAllocations;
+	// shader bytecode and input layouts by object, guarded by GpuAllocationMutex as well
+	mutable std::unordered_map<const void*, std::vector<uint8_t>> CaptureData;
+
+	mutable std::unique_ptr<FFrameCapture> Capture;
+	mutable bool bCapturing = false;
+
+	mutable FRenderStatistics Statistics;
+
+	// one per worker, created on the first deferred submit
+	mutable std::vector<std::unique_ptr<FRenderer>> DeferredRenderers;
+	mutable std::vector<const FCommandList*> SubmitOrder;
+	bool bIsDeferred = false;
+
 	ID3D11Device* Device;
 	ID3D11DeviceContext* DeviceContext;
 	IDXGISwapChain* Swapchain;
+	// offscreen devices only, ended by Present
+	ID3D11Query* FrameQuery = nullptr;
 	ID3D11SamplerState* LinearWrapSampler;
 	ID3D11SamplerState* LinearClampSampler;
 };
@@ -116,18 +177,7 @@ EErrorCode FRenderer::CreateVertexBufferWithData(const TType* Data, const size_t
 
 	Buffer.Stride = sizeof(TType);
 
-	D3D11_SUBRESOURCE_DATA InitialData{};
-	InitialData.pSysMem = Data;
-	InitialData.SysMemPitch = 0;
-	InitialData.SysMemSlicePitch = 0;
-	
-	const auto HResult = Device->CreateBuffer(&BufferDesc, &InitialData, &Buffer.Buffer);
-	if (HResult != S_OK)
-	{
-		return EErrorCode::FAIL;
-	}
-
-	return EErrorCode::OK;
+	return CreateBuffer(BufferDesc, Data, Buffer);
 }
 
 template <typename TType>
@@ -139,10 +189,10 @@ EErrorCode FRenderer::CreateConstantBufferWithData(const TType& Data, SBuffer& B
 	BufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
 	BufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 
-	const auto HResult = Device->CreateBuffer(&BufferDesc, nullptr, &Buffer.Buffer);
-	if (HResult != S_OK)
+	const auto Result = CreateBuffer(BufferDesc, nullptr, Buffer);
+	if (Result != EErrorCode::OK)
 	{
-		return EErrorCode::FAIL;
+		return Result;
 	}
 
 	UpdateSubresource(Buffer, &Data, sizeof(TType));
@@ -152,6 +202,13 @@ EErrorCode FRenderer::CreateConstantBufferWithData(const TType& Data, SBuffer& B
 template <typename TType>
 void FRenderer::UpdateSubresource(const SBuffer& Buffer, const TType* Data, const size_t ByteSize) const noexcept
 {
+	Statistics.Add(ERenderCounter::UPLOADS);
+	Statistics.Add(ERenderCounter::UPLOAD_BYTES, ByteSize);
+	if (bCapturing)
+	{
+		CaptureUpload(Buffer, Data, ByteSize);
+	}
+
 	D3D11_MAPPED_SUBRESOURCE MappedSubresource{};
 	DeviceContext->Map(Buffer.Buffer, NULL, D3D11_MAP_WRITE_DISCARD, NULL, &MappedSubresource);
 	memcpy(MappedSubresource.pData, Data, ByteSize);
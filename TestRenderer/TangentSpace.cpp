@@ -0,0 +1,240 @@
+#include "TangentSpace.hpp"
+#include "Parallel.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+	constexpr size_t TRIANGLE_BATCH_SIZE = 2048;
+
+	struct SPositionKey
+	{
+		uint32_t X, Y, Z;
+
+		bool operator==(const SPositionKey& Other) const noexcept
+		{
+			return X == Other.X && Y == Other.Y && Z == Other.Z;
+		}
+	};
+
+	struct SPositionKeyHash
+	{
+		size_t operator()(const SPositionKey& Key) const noexcept
+		{
+			return (Key.X * 73856093u) ^ (Key.Y * 19349663u) ^ (Key.Z * 83492791u);
+		}
+	};
+
+	SPositionKey MakePositionKey(const DirectX::XMFLOAT3& Position) noexcept
+	{
+		SPositionKey Key{};
+		memcpy(&Key, &Position, sizeof(Key));
+		return Key;
+	}
+
+	uint64_t HashVertex(const STangentSpaceVertex& Vertex) noexcept
+	{
+		const auto Bytes = reinterpret_cast<const uint8_t*>(&Vertex);
+		uint64_t Hash = 14695981039346656037ull;
+		for (size_t Index = 0; Index < sizeof(STangentSpaceVertex); ++Index)
+		{
+			Hash ^= Bytes[Index];
+			Hash *= 1099511628211ull;
+		}
+		return Hash;
+	}
+
+	DirectX::XMVECTOR AnyPerpendicular(const DirectX::XMVECTOR Normal) noexcept
+	{
+		const auto Axis = std::fabs(DirectX::XMVectorGetX(Normal)) < 0.9f ? DirectX::XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f) : DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+		return DirectX::XMVector3Normalize(DirectX::XMVector3Cross(Normal, Axis));
+	}
+}
+
+void GenerateTangentSpace(FArenaAllocator& Arena, const STangentSpaceInput& Input, const float SmoothingAngle, TArenaVector<STangentSpaceVertex>& Vertices, TArenaVector<uint32_t>& Indices)
+{
+	const size_t CornerCount = Input.IndexCount - Input.IndexCount % 3;
+	const size_t TriangleCount = CornerCount / 3;
+	const uint32_t* InputIndices = Input.Indices;
+
+	Vertices.clear();
+	Indices.clear();
+	if (TriangleCount == 0)
+	{
+		return;
+	}
+
+	// vertices arrive welded by position and texture coordinate, smoothing has to look across uv seams
+	TArenaVector<uint32_t> PositionIds(Input.VertexCount, TArenaAdaptor<uint32_t>(Arena));
+	uint32_t PositionCount = 0;
+	{
+		FArenaScope Scope(Arena);
+		using TPositionLookup = std::unordered_map<SPositionKey, uint32_t, SPositionKeyHash, std::equal_to<SPositionKey>, TArenaAdaptor<std::pair<const SPositionKey, uint32_t>>>;
+		TPositionLookup PositionLookup(Input.VertexCount, SPositionKeyHash(), std::equal_to<SPositionKey>(), TArenaAdaptor<std::pair<const SPositionKey, uint32_t>>(Arena));
+		for (size_t Vertex = 0; Vertex < Input.VertexCount; ++Vertex)
+		{
+			const auto Result = PositionLookup.emplace(MakePositionKey(Input.Positions[Vertex]), PositionCount);
+			PositionCount += Result.second ? 1 : 0;
+			PositionIds[Vertex] = Result.first->second;
+		}
+	}
+
+	// corners sharing a position, in counting sort order
+	TArenaVector<uint32_t> AdjacencyOffsets(PositionCount + 1, 0, TArenaAdaptor<uint32_t>(Arena));
+	TArenaVector<uint32_t> Adjacency(CornerCount, TArenaAdaptor<uint32_t>(Arena));
+	for (size_t Corner = 0; Corner < CornerCount; ++Corner)
+	{
+		++AdjacencyOffsets[PositionIds[InputIndices[Corner]] + 1];
+	}
+	for (uint32_t Position = 0; Position < PositionCount; ++Position)
+	{
+		AdjacencyOffsets[Position + 1] += AdjacencyOffsets[Position];
+	}
+	{
+		TArenaVector<uint32_t> Cursor(AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1, TArenaAdaptor<uint32_t>(Arena));
+		for (size_t Corner = 0; Corner < CornerCount; ++Corner)
+		{
+			Adjacency[Cursor[PositionIds[InputIndices[Corner]]]++] = static_cast<uint32_t>(Corner);
+		}
+	}
+
+	TArenaVector<DirectX::XMFLOAT3> FaceNormals(TriangleCount, TArenaAdaptor<DirectX::XMFLOAT3>(Arena));
+	TArenaVector<DirectX::XMFLOAT3> FaceTangents(TriangleCount, TArenaAdaptor<DirectX::XMFLOAT3>(Arena));
+	TArenaVector<float> FaceOrientations(TriangleCount, TArenaAdaptor<float>(Arena));
+	TArenaVector<float> CornerAngles(CornerCount, TArenaAdaptor<float>(Arena));
+
+	ParallelFor(TriangleCount, TRIANGLE_BATCH_SIZE, [&](const size_t Begin, const size_t End)
+	{
+		for (size_t Triangle = Begin; Triangle < End; ++Triangle)
+		{
+			const uint32_t* Corners = InputIndices + Triangle * 3;
+			const auto P0 = DirectX::XMLoadFloat3(&Input.Positions[Corners[0]]);
+			const auto P1 = DirectX::XMLoadFloat3(&Input.Positions[Corners[1]]);
+			const auto P2 = DirectX::XMLoadFloat3(&Input.Positions[Corners[2]]);
+			const auto Edge1 = DirectX::XMVectorSubtract(P1, P0);
+			const auto Edge2 = DirectX::XMVectorSubtract(P2, P0);
+			DirectX::XMStoreFloat3(&FaceNormals[Triangle], DirectX::XMVector3Normalize(DirectX::XMVector3Cross(Edge1, Edge2)));
+
+			// interior angles weight every face by how much of the vertex fan it covers
+			const DirectX::XMVECTOR Points[3] = { P0, P1, P2 };
+			for (size_t Index = 0; Index < 3; ++Index)
+			{
+				const auto A = DirectX::XMVector3Normalize(DirectX::XMVectorSubtract(Points[(Index + 1) % 3], Points[Index]));
+				const auto B = DirectX::XMVector3Normalize(DirectX::XMVectorSubtract(Points[(Index + 2) % 3], Points[Index]));
+				const float Cosine = DirectX::XMVectorGetX(DirectX::XMVector3Dot(A, B));
+				CornerAngles[Triangle * 3 + Index] = std::acos(Cosine < -1.0f ? -1.0f : Cosine > 1.0f ? 1.0f : Cosine);
+			}
+
+			DirectX::XMFLOAT2 UV0{}, UV1{}, UV2{};
+			if (Input.TexCoords)
+			{
+				UV0 = Input.TexCoords[Corners[0]];
+				UV1 = Input.TexCoords[Corners[1]];
+				UV2 = Input.TexCoords[Corners[2]];
+			}
+			const float DeltaU1 = UV1.x - UV0.x;
+			const float DeltaV1 = UV1.y - UV0.y;
+			const float DeltaU2 = UV2.x - UV0.x;
+			const float DeltaV2 = UV2.y - UV0.y;
+			const float SignedArea = DeltaU1 * DeltaV2 - DeltaV1 * DeltaU2;
+
+			// same as MikkTSpace, keep the direction and let the orientation flag carry the sign
+			const float Orientation = SignedArea > 0.0f ? 1.0f : -1.0f;
+			const auto Tangent = DirectX::XMVectorScale(DirectX::XMVectorSubtract(DirectX::XMVectorScale(Edge1, DeltaV2), DirectX::XMVectorScale(Edge2, DeltaV1)), Orientation);
+			DirectX::XMStoreFloat3(&FaceTangents[Triangle], SignedArea != 0.0f ? DirectX::XMVector3Normalize(Tangent) : DirectX::XMVectorZero());
+			FaceOrientations[Triangle] = Orientation;
+		}
+	});
+
+	TArenaVector<DirectX::XMFLOAT3> CornerNormals(CornerCount, TArenaAdaptor<DirectX::XMFLOAT3>(Arena));
+	const float SmoothingCosine = std::cos(SmoothingAngle * 3.14159265f / 180.0f);
+	ParallelFor(TriangleCount, TRIANGLE_BATCH_SIZE, [&](const size_t Begin, const size_t End)
+	{
+		for (size_t Corner = Begin * 3; Corner < End * 3; ++Corner)
+		{
+			if (SmoothingAngle <= 0.0f)
+			{
+				CornerNormals[Corner] = FaceNormals[Corner / 3];
+				continue;
+			}
+
+			const auto FaceNormal = DirectX::XMLoadFloat3(&FaceNormals[Corner / 3]);
+
+			auto Normal = DirectX::XMVectorZero();
+			const auto Position = PositionIds[InputIndices[Corner]];
+			for (uint32_t Neighbour = AdjacencyOffsets[Position]; Neighbour < AdjacencyOffsets[Position + 1]; ++Neighbour)
+			{
+				const auto Other = Adjacency[Neighbour];
+				const auto OtherNormal = DirectX::XMLoadFloat3(&FaceNormals[Other / 3]);
+				if (Other / 3 == Corner / 3 || DirectX::XMVectorGetX(DirectX::XMVector3Dot(FaceNormal, OtherNormal)) >= SmoothingCosine)
+				{
+					Normal = DirectX::XMVectorAdd(Normal, DirectX::XMVectorScale(OtherNormal, CornerAngles[Other]));
+				}
+			}
+			DirectX::XMStoreFloat3(&CornerNormals[Corner], DirectX::XMVector3Normalize(Normal));
+		}
+	});
+
+	// MikkTSpace only shares tangents between corners of the same vertex, normal and orientation
+	TArenaVector<STangentSpaceVertex> CornerVertices(CornerCount, TArenaAdaptor<STangentSpaceVertex>(Arena));
+	ParallelFor(TriangleCount, TRIANGLE_BATCH_SIZE, [&](const size_t Begin, const size_t End)
+	{
+		for (size_t Corner = Begin * 3; Corner < End * 3; ++Corner)
+		{
+			const auto Vertex = InputIndices[Corner];
+			const auto Normal = DirectX::XMLoadFloat3(&CornerNormals[Corner]);
+			const float Orientation = FaceOrientations[Corner / 3];
+
+			auto Tangent = DirectX::XMVectorZero();
+			const auto Position = PositionIds[Vertex];
+			for (uint32_t Neighbour = AdjacencyOffsets[Position]; Neighbour < AdjacencyOffsets[Position + 1]; ++Neighbour)
+			{
+				const auto Other = Adjacency[Neighbour];
+				if (InputIndices[Other] != Vertex || FaceOrientations[Other / 3] != Orientation ||
+					DirectX::XMVectorGetX(DirectX::XMVector3Dot(Normal, DirectX::XMLoadFloat3(&CornerNormals[Other]))) < 0.9999f)
+				{
+					continue;
+				}
+				// project into the tangent plane of this corner before accumulating
+				const auto FaceTangent = DirectX::XMLoadFloat3(&FaceTangents[Other / 3]);
+				const auto Projected = DirectX::XMVectorSubtract(FaceTangent, DirectX::XMVectorScale(Normal, DirectX::XMVectorGetX(DirectX::XMVector3Dot(Normal, FaceTangent))));
+				Tangent = DirectX::XMVectorAdd(Tangent, DirectX::XMVectorScale(DirectX::XMVector3Normalize(Projected), CornerAngles[Other]));
+			}
+			Tangent = DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(Tangent)) > 1e-12f ? DirectX::XMVector3Normalize(Tangent) : AnyPerpendicular(Normal);
+
+			auto& Output = CornerVertices[Corner];
+			Output.Position = Input.Positions[Vertex];
+			Output.Normal = CornerNormals[Corner];
+			Output.TexCoord = Input.TexCoords ? Input.TexCoords[Vertex] : DirectX::XMFLOAT2(0.0f, 0.0f);
+			DirectX::XMStoreFloat4(&Output.Tangent, Tangent);
+			Output.Tangent.w = Orientation;
+		}
+	});
+
+	// weld identical corners back into an indexed mesh, open addressing on the vertex bytes
+	size_t TableSize = 1;
+	while (TableSize < CornerCount * 2)
+	{
+		TableSize <<= 1;
+	}
+	TArenaVector<uint32_t> Table(TableSize, UINT32_MAX, TArenaAdaptor<uint32_t>(Arena));
+	Vertices.reserve(Input.VertexCount);
+	Indices.resize(CornerCount);
+	for (size_t Corner = 0; Corner < CornerCount; ++Corner)
+	{
+		const auto& Vertex = CornerVertices[Corner];
+		size_t Slot = HashVertex(Vertex) & (TableSize - 1);
+		while (Table[Slot] != UINT32_MAX && memcmp(&Vertices[Table[Slot]], &Vertex, sizeof(STangentSpaceVertex)) != 0)
+		{
+			Slot = (Slot + 1) & (TableSize - 1);
+		}
+		if (Table[Slot] == UINT32_MAX)
+		{
+			Table[Slot] = static_cast<uint32_t>(Vertices.size());
+			Vertices.push_back(Vertex);
+		}
+		Indices[Corner] = Table[Slot];
+	}
+}
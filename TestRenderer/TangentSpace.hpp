@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Allocators.hpp"
+#include <DirectXMath.h>
+#include <cstdint>
+
+// Vertex layout produced by GenerateTangentSpace, the bitangent is rebuilt in the vertex
+// shader as cross(Normal, Tangent.xyz) * Tangent.w
+struct STangentSpaceVertex
+{
+	DirectX::XMFLOAT3 Position;
+	DirectX::XMFLOAT3 Normal;
+	DirectX::XMFLOAT2 TexCoord;
+	DirectX::XMFLOAT4 Tangent;
+};
+
+struct STangentSpaceInput
+{
+	const DirectX::XMFLOAT3* Positions = nullptr;
+	const DirectX::XMFLOAT2* TexCoords = nullptr;
+	size_t VertexCount = 0;
+	const uint32_t* Indices = nullptr;
+	size_t IndexCount = 0;
+};
+
+// Generates smoothing angle aware normals and MikkTSpace style tangents for an indexed
+// triangle list. Faces whose normals differ by more than SmoothingAngle degrees do not share
+// a vertex normal, zero gives flat shading. Every corner only writes its own output so the
+// passes run in parallel over triangles without atomics, vertices are welded afterwards.
+// Scratch memory and the outputs live in Arena.
+void GenerateTangentSpace(FArenaAllocator& Arena, const STangentSpaceInput& Input, const float SmoothingAngle, TArenaVector<STangentSpaceVertex>& Vertices, TArenaVector<uint32_t>& Indices);
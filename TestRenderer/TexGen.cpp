@@ -1,10 +1,63 @@
 #include "TexGen.hpp"
-#include <stack>
 
-#define NODE_INPUT1(VariableType, Variable, NodeType, InputName, Statement, DefaultValue) \
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <utility>
+
+namespace
+{
+	// of the node's type and the values edited on it, FTexGenEvaluator adds the inputs
+	uint64_t HashNodeValues(const Generator::SMyNode& Node) noexcept
+	{
+		return Node.HashValues(Generator::HashTexGenBytes(&Node.NodeType, sizeof(Node.NodeType)));
+	}
+
+	uint32_t FindSlot(const std::vector<ImNodes::Ez::SlotInfo>& Slots, const char* Name) noexcept
+	{
+		for (size_t Index = 0; Index < Slots.size(); ++Index)
+		{
+			if (strcmp(Slots[Index].title, Name) == 0)
+			{
+				return static_cast<uint32_t>(Index);
+			}
+		}
+		return Generator::FTexGenSchedule::NO_NODE;
+	}
+
+	const char* const FORMAT_NAMES[] = { "Auto", "R8", "R16", "R16F", "RGBA8", "RGBA16F" };
+	const char* const RESOLUTION_NAMES[] = { "Auto", "256", "512", "1024", "2048", "4096" };
+	const uint32_t RESOLUTIONS[] = { 0, 256, 512, 1024, 2048, 4096 };
+
+	DXGI_FORMAT GetDxgiFormat(const Generator::ETexGenFormat Format) noexcept
+	{
+		switch (Format)
+		{
+		case Generator::ETexGenFormat::R16: return DXGI_FORMAT_R16_UNORM;
+		case Generator::ETexGenFormat::R16F: return DXGI_FORMAT_R16_FLOAT;
+		case Generator::ETexGenFormat::RGBA8: return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+		case Generator::ETexGenFormat::RGBA16F: return DXGI_FORMAT_R16G16B16A16_FLOAT;
+		default: return DXGI_FORMAT_R8_UNORM;
+		}
+	}
+
+	uint32_t GetFormatSize(const Generator::ETexGenFormat Format) noexcept
+	{
+		switch (Format)
+		{
+		case Generator::ETexGenFormat::R16:
+		case Generator::ETexGenFormat::R16F: return 2;
+		case Generator::ETexGenFormat::RGBA8: return 4;
+		case Generator::ETexGenFormat::RGBA16F: return 8;
+		default: return 1;
+		}
+	}
+}
+
+#define NODE_INPUT1(VariableType, Variable, NodeType, Slot, Statement, DefaultValue) \
 VariableType Variable; \
 { \
-	auto Node = GetInputParameterNode<NodeType>(#InputName); \
+	auto Node = GetInput<NodeType>(Slot); \
 	if (Node) \
 	{ \
 		Variable = (Statement); \
@@ -15,9 +68,9 @@ VariableType Variable; \
 	} \
 }
 
-#define NODE_INPUT2(Variable, NodeType, InputName, Statement, DefaultValue) \
+#define NODE_INPUT2(Variable, NodeType, Slot, Statement, DefaultValue) \
 { \
-	auto Node = GetInputParameterNode<NodeType>(#InputName); \
+	auto Node = GetInput<NodeType>(Slot); \
 	if (Node) \
 	{ \
 		Variable = (Statement); \
@@ -73,7 +126,27 @@ void Generator::SOutputNode::Destroy(const FRenderer& Renderer)
 void Generator::SOutputNode::OnUpdate(float Time)
 {
 	// copy last render target to self - mark as ouput
-	NODE_INPUT2(RenderTarget, STextureNode, Input, Node->RenderTarget, {});
+	NODE_INPUT2(RenderTarget, STextureNode, INPUT, Node->GetResult(), {});
+}
+
+void Generator::SOutputNode::AddToCpuGraph(FTexGenCpuGraph& Graph)
+{
+	CpuNode = GetCpuInput(INPUT);
+}
+
+uint64_t Generator::SScalarNode::HashValues(const uint64_t Hash) const
+{
+	return HashTexGenBytes(&Value, sizeof(Value), Hash);
+}
+
+uint64_t Generator::SVector2Node::HashValues(const uint64_t Hash) const
+{
+	return HashTexGenBytes(&Value, sizeof(Value), Hash);
+}
+
+uint64_t Generator::SVector4Node::HashValues(const uint64_t Hash) const
+{
+	return HashTexGenBytes(&Value, sizeof(Value), Hash);
 }
 
 bool Generator::SVector4Node::OnGui()
@@ -87,18 +160,71 @@ bool Generator::STextureNode::OnGui()
 	const auto Size = 100;
 	ImGui::BeginChild("##ImageChild", ImVec2(Size + 16, Size + 16), true,
 	                  ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
-	ImGui::Image(RenderTarget.ShaderResourceView, ImVec2(Size, Size));
+	if (State.bIsFused)
+	{
+		ImGui::TextDisabled("Fused");
+	}
+	else if (RenderTarget.ShaderResourceView == nullptr)
+	{
+		ImGui::TextDisabled(State.RenderedHash != 0 ? "Evicted" : "Not drawn");
+	}
+	else
+	{
+		// single channel formats show in red
+		ImGui::Image(RenderTarget.ShaderResourceView, ImVec2(Size, Size));
+	}
 	ImGui::EndChild();
-	return false;
+	if (NodeType == ENodeType::OUTPUT)
+	{
+		return false;
+	}
+
+	int FormatIndex = static_cast<int>(RequestedFormat);
+	int ResolutionIndex = 0;
+	while (RESOLUTIONS[ResolutionIndex] != RequestedResolution && ResolutionIndex + 1 < IM_ARRAYSIZE(RESOLUTIONS))
+	{
+		++ResolutionIndex;
+	}
+	ImGui::PushItemWidth(Size + 16);
+	if (ImGui::Combo("##Format", &FormatIndex, FORMAT_NAMES, IM_ARRAYSIZE(FORMAT_NAMES)))
+	{
+		RequestedFormat = static_cast<ETexGenFormat>(FormatIndex);
+		bIsOutputChanged = true;
+	}
+	if (ImGui::Combo("##Resolution", &ResolutionIndex, RESOLUTION_NAMES, IM_ARRAYSIZE(RESOLUTION_NAMES)))
+	{
+		RequestedResolution = RESOLUTIONS[ResolutionIndex];
+		bIsOutputChanged = true;
+	}
+	ImGui::PopItemWidth();
+	ImGui::TextDisabled("%s %u", FORMAT_NAMES[static_cast<int>(Format)], Resolution);
+	return bIsOutputChanged;
+}
+
+uint64_t Generator::STextureNode::HashValues(const uint64_t Hash) const
+{
+	return HashTexGenBytes(&Resolution, sizeof(Resolution), HashTexGenBytes(&Format, sizeof(Format), Hash));
 }
 
 EErrorCode Generator::STextureNode::Initialize(const FRenderer& Renderer)
 {
 	char Dummy[128] = { 0 };
+	// whatever was created before a failure is released by Destroy
 	auto Result = Renderer.CreateVertexShader(L"FullScreenTriangleVS.hlsl", "main", nullptr, 0, Shader);
+	if (Result != EErrorCode::OK)
+	{
+		return Result;
+	}
 	Result = Renderer.CreatePixelShader(ShaderName, "main", Shader);
-	Result = Renderer.CreateRenderTarget(1024, 1024, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, RenderTarget);
+	if (Result != EErrorCode::OK)
+	{
+		return Result;
+	}
 	Result = Renderer.CreateConstantBufferWithData(Dummy, ConstantBuffer);
+	if (Result != EErrorCode::OK)
+	{
+		return Result;
+	}
 	this->Renderer = &Renderer;
 	return EErrorCode::OK;
 }
@@ -107,16 +233,74 @@ void Generator::STextureNode::Destroy(const FRenderer& Renderer)
 {
 	Renderer.DestroyShader(Shader);
 	Renderer.DestroyBuffer(ConstantBuffer);
-	//Renderer.DestroyRenderTarget(RenderTarget);
+	// the targets are released by FTexGen, the output may still show them
+}
+
+uint32_t Generator::STextureNode::GetCpuInput(const uint32_t Slot) const
+{
+	auto Node = GetInput<STextureNode>(Slot);
+	return Node ? Node->CpuNode : FTexGenCpuGraph::NO_INPUT;
+}
+
+void Generator::STextureNode::ResolveOutput()
+{
+	const auto Input = GetTextureInput();
+	Format = RequestedFormat != ETexGenFormat::AUTO ? RequestedFormat : DefaultFormat;
+	if (Format == ETexGenFormat::AUTO)
+	{
+		Format = Input ? Input->Format : ETexGenFormat::R8;
+	}
+	Resolution = RequestedResolution != 0 ? RequestedResolution : DefaultResolution;
+	if (Resolution == 0)
+	{
+		Resolution = Input ? Input->Resolution : TEXGEN_DEFAULT_RESOLUTION;
+	}
+}
+
+void Generator::STextureNode::CreateTargets()
+{
+	Renderer->CreateRenderTarget(Resolution, Resolution, GetDxgiFormat(Format), RenderTarget);
+	Renderer->CreateRenderTarget(Resolution, Resolution, GetDxgiFormat(Format), BackRenderTarget);
+	TargetFormat = Format;
+}
+
+void Generator::STextureNode::ReleaseTargets(std::vector<SRenderTarget>& Released)
+{
+	if (!HasTargets())
+	{
+		return;
+	}
+	Released.push_back(RenderTarget);
+	Released.push_back(BackRenderTarget);
+	RenderTarget = {};
+	BackRenderTarget = {};
+	TargetFormat = ETexGenFormat::AUTO;
+	bBackIsNewer = false;
+}
+
+void Generator::STextureNode::Present()
+{
+	if (bBackIsNewer)
+	{
+		std::swap(RenderTarget, BackRenderTarget);
+		bBackIsNewer = false;
+	}
 }
 
 void Generator::STextureNode::OnUpdate(float Time)
 {
-	Renderer->SetRenderTarget(RenderTarget);
-	Renderer->ClearRenderTarget(RenderTarget, DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
-	Renderer->SetViewport(RenderTarget.Width, RenderTarget.Height);
-	Renderer->SetShader(Shader);
-	Renderer->SetConstantBuffer(ConstantBuffer, EShaderStage::PIXEL);
+	Draw(Shader, ConstantBuffer);
+}
+
+void Generator::STextureNode::Draw(const SShader& PassShader, const SBuffer& PassConstantBuffer)
+{
+	// an input read from the back target cannot be the target drawn to, every node has its own
+	bBackIsNewer = true;
+	Renderer->SetRenderTarget(BackRenderTarget);
+	Renderer->ClearRenderTarget(BackRenderTarget, DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+	Renderer->SetViewport(BackRenderTarget.Width, BackRenderTarget.Height);
+	Renderer->SetShader(PassShader);
+	Renderer->SetConstantBuffer(PassConstantBuffer, EShaderStage::PIXEL);
 	Renderer->SetConstantBuffer({nullptr, 0}, EShaderStage::VERTEX);
 	Renderer->SetVertexBuffer(0, {nullptr, 0}, 0);
 	Renderer->SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -124,45 +308,125 @@ void Generator::STextureNode::OnUpdate(float Time)
 	Renderer->UnbindRenderTargets();
 }
 
+void Generator::SRectangleNode::UpdateParams()
+{
+	NODE_INPUT2(Params.Data, SVector4Node, POSITION, Node->Value, DirectX::XMFLOAT4(0.5f, 0.5f, 1.0f, 1.0f));
+	NODE_INPUT2(Params.Chamfer, SScalarNode, CHAMFER, Node->Value, 3.0f);
+	NODE_INPUT2(Params.Falloff, SScalarNode, FALLOFF, Node->Value, 0.0f);
+}
+
 void Generator::SRectangleNode::OnUpdate(float Time)
 {
-	NODE_INPUT2(Params.Data, SVector4Node, Position, Node->Value, DirectX::XMFLOAT4(0.5f, 0.5f, 1.0f, 1.0f));
-	NODE_INPUT2(Params.Chamfer, SScalarNode, Chamfer, Node->Value, 3.0f);
-	NODE_INPUT2(Params.Falloff, SScalarNode, Falloff, Node->Value, 0.0f);
+	UpdateParams();
 	Renderer->UpdateSubresource(ConstantBuffer, &Params, sizeof(Params));
 	STextureNode::OnUpdate(Time);
 }
 
+void Generator::SRectangleNode::AddToCpuGraph(FTexGenCpuGraph& Graph)
+{
+	UpdateParams();
+	CpuNode = Graph.AddRectangle(Params);
+}
+
+uint32_t Generator::SRectangleNode::WriteFusedParams(DirectX::XMFLOAT4* Destination)
+{
+	UpdateParams();
+	memcpy(Destination, &Params, sizeof(Params));
+	return GetFusedVectorCount(NodeType);
+}
+
+void Generator::SLoopNode::UpdateParams()
+{
+	NODE_INPUT2(Params.Repeat, SVector2Node, REPEAT, Node->Value, DirectX::XMFLOAT2(1.0f, 1.0f));
+}
+
 void Generator::SLoopNode::OnUpdate(float Time)
 {
-	NODE_INPUT2(Params.Repeat, SVector2Node, Repeat, Node->Value, DirectX::XMFLOAT2(1.0f, 1.0f));
-	NODE_INPUT1(SRenderTarget, InputTexture, SRectangleNode, Input, Node->RenderTarget, {});
+	UpdateParams();
+	NODE_INPUT1(SRenderTarget, InputTexture, STextureNode, INPUT, Node->GetResult(), {});
 
 	Renderer->SetTexture(0, InputTexture);
 	Renderer->UpdateSubresource(ConstantBuffer, &Params, sizeof(Params));
 	STextureNode::OnUpdate(Time);
 }
 
-void Generator::SSineDist::OnUpdate(float Time)
+void Generator::SLoopNode::AddToCpuGraph(FTexGenCpuGraph& Graph)
 {
-	NODE_INPUT1(DirectX::XMFLOAT2, Count, SVector2Node, Count, Node->Value, {});
-	NODE_INPUT1(DirectX::XMFLOAT2, Amplitude, SVector2Node, Amplitude, Node->Value, {});
-	NODE_INPUT1(SRenderTarget, InputTexture, STextureNode, Input, Node->RenderTarget, {});
+	UpdateParams();
+	CpuNode = Graph.AddLoop(Params, GetCpuInput(INPUT));
+}
+
+uint32_t Generator::SLoopNode::WriteFusedParams(DirectX::XMFLOAT4* Destination)
+{
+	UpdateParams();
+	memcpy(Destination, &Params, sizeof(Params));
+	return GetFusedVectorCount(NodeType);
+}
+
+void Generator::SSineDist::UpdateParams()
+{
+	NODE_INPUT1(DirectX::XMFLOAT2, Count, SVector2Node, COUNT, Node->Value, {});
+	NODE_INPUT1(DirectX::XMFLOAT2, Amplitude, SVector2Node, AMPLITUDE, Node->Value, {});
 
 	Params.CountX = Count.x;
 	Params.CountY = Count.y;
 	Params.AmplX = Amplitude.x;
 	Params.AmplY = Amplitude.y;
+}
+
+void Generator::SSineDist::OnUpdate(float Time)
+{
+	UpdateParams();
+	NODE_INPUT1(SRenderTarget, InputTexture, STextureNode, INPUT, Node->GetResult(), {});
 
 	Renderer->SetTexture(0, InputTexture);
 	Renderer->UpdateSubresource(ConstantBuffer, &Params, sizeof(Params));
 	STextureNode::OnUpdate(Time);
 }
 
-Generator::FTexGen::FTexGen(FRenderer& Renderer)  :
+void Generator::SSineDist::AddToCpuGraph(FTexGenCpuGraph& Graph)
+{
+	UpdateParams();
+	CpuNode = Graph.AddSineDist(Params, GetCpuInput(INPUT));
+}
+
+uint32_t Generator::SSineDist::WriteFusedParams(DirectX::XMFLOAT4* Destination)
+{
+	UpdateParams();
+	memcpy(Destination, &Params, sizeof(Params));
+	return GetFusedVectorCount(NodeType);
+}
+
+void Generator::SEnvMapNode::UpdateParams()
+{
+	NODE_INPUT2(Params.Radius, SVector4Node, RADIUS, Node->Value, DirectX::XMFLOAT4(0.5f, 0.0f, 1.0f, 1.0f));
+}
+
+void Generator::SEnvMapNode::OnUpdate(float Time)
+{
+	UpdateParams();
+	Renderer->UpdateSubresource(ConstantBuffer, &Params, sizeof(Params));
+	STextureNode::OnUpdate(Time);
+}
+
+void Generator::SEnvMapNode::AddToCpuGraph(FTexGenCpuGraph& Graph)
+{
+	UpdateParams();
+	CpuNode = Graph.AddEnvMap(Params);
+}
+
+uint32_t Generator::SEnvMapNode::WriteFusedParams(DirectX::XMFLOAT4* Destination)
+{
+	UpdateParams();
+	memcpy(Destination, &Params, sizeof(Params));
+	return GetFusedVectorCount(NodeType);
+}
+
+Generator::FTexGen::FTexGen(FRenderer& Renderer, FArenaAllocator& FrameAllocator)  :
 	bIsDirty(false),
 	bIsOutputUpdated(false),
 	InternalRenderer(Renderer),
+	InternalFrameAllocator(FrameAllocator),
 	GraphEntryPoint(nullptr)
 {
 }
@@ -171,108 +435,454 @@ Generator::FTexGen::~FTexGen()
 {
 	for (auto& Node : Nodes)
 	{
-		Node->Destroy(InternalRenderer);
+		DestroyNode(Node);
+	}
+	for (auto& FusedShader : FusedShaders)
+	{
+		InternalRenderer.DestroyShader(FusedShader.second);
+	}
+	InternalRenderer.DestroyBuffer(FusedConstantBuffer);
+	for (auto& Target : RetiredTargets)
+	{
+		InternalRenderer.DestroyRenderTarget(Target);
+	}
+	ReleasePendingTargets();
+}
+
+void Generator::FTexGen::ReleasePendingTargets() noexcept
+{
+	for (auto& Target : PendingTargets)
+	{
+		InternalRenderer.DestroyRenderTarget(Target);
 	}
+	PendingTargets.clear();
+}
+
+void Generator::FTexGen::DestroyNode(SMyNode* Node) noexcept
+{
+	if (auto TextureNode = dynamic_cast<STextureNode*>(Node))
+	{
+		TextureNode->ReleaseTargets(RetiredTargets);
+		Evaluator.OnTargetsReleased(TextureNode->State);
+	}
+	Node->Destroy(InternalRenderer);
+	Node->~SMyNode();
+	NodePool.Free(Node);
+}
+
+bool Generator::FTexGen::InitializeNode(SMyNode* Node) noexcept
+{
+	const auto Result = Node->Initialize(InternalRenderer);
+	if (Result == EErrorCode::OK)
+	{
+		return true;
+	}
+	char Message[256];
+	snprintf(Message, sizeof(Message), "Failed to create the %s node (error %d), it is left out of the graph\n", Node->Title, static_cast<int>(Result));
+	OutputDebugStringA(Message);
+	DestroyNode(Node);
+	return false;
 }
 
 EErrorCode Generator::FTexGen::Initialize(const uint32_t Width, const uint32_t Height)
 {
-	auto Node1 = new SVector4Node();
-	Node1->Position.x = -300;
-	Node1->Position.y = 350;
-	Node1->Value.x = 0.75f;
-	Node1->Value.y = 0.5f;
-	Node1->Value.z = 0.5f;
-	Node1->Value.w = 1.0f;
-	Nodes.push_back(Node1);
-
-	auto Node2 = new SScalarNode();
-	Node2->Position.x = -300;
-	Node2->Position.y = 450;
-	Nodes.push_back(Node2);
-
-	auto Node3 = new SRectangleNode();
-	Node3->Position.x = 100;
-	Node3->Position.y = 400;
-	Nodes.push_back(Node3);
-
-	auto Node4 = new SOutputNode();
-	Node4->Position.x = 500;
-	Node4->Position.y = 400;
-	Nodes.push_back(Node4);
-
-	Node3->CreateConnection("Position", *Node1, "Output");
-	Node3->CreateConnection("Chamfer", *Node2, "Output");
-	Node4->CreateConnection("Input", *Node3, "Output");
+	const DirectX::XMFLOAT4 FusedParams[TEXGEN_MAX_FUSED_VECTORS] = {};
+	InternalRenderer.CreateConstantBufferWithData(FusedParams, FusedConstantBuffer);
+	SetGraph(FTexGenGraph::MakeDefault());
+	return EErrorCode::OK;
+}
 
-	for (auto& Node : Nodes)
+void Generator::FTexGen::SetGraph(const FTexGenGraph& Graph)
+{
+	for (auto Node : Nodes)
 	{
-		Node->Initialize(InternalRenderer);
+		DestroyNode(Node);
 	}
+	Nodes.clear();
+	GraphEntryPoint = nullptr;
 
-	GraphEntryPoint = dynamic_cast<SOutputNode*>(Node4);
+	std::vector<SMyNode*> GraphNodes;
+	GraphNodes.reserve(Graph.GetNodes().size());
+	for (const auto& GraphNode : Graph.GetNodes())
+	{
+		auto Node = AvailableNodes.at(GetNodeTypeName(GraphNode.Type))(NodePool);
+		Node->Position = ImVec2(GraphNode.X, GraphNode.Y);
+		if (auto Scalar = dynamic_cast<SScalarNode*>(Node))
+		{
+			Scalar->Value = GraphNode.Value.x;
+		}
+		else if (auto Vector2 = dynamic_cast<SVector2Node*>(Node))
+		{
+			Vector2->Value = DirectX::XMFLOAT2(GraphNode.Value.x, GraphNode.Value.y);
+		}
+		else if (auto Vector4 = dynamic_cast<SVector4Node*>(Node))
+		{
+			Vector4->Value = GraphNode.Value;
+		}
+		else if (auto TextureNode = dynamic_cast<STextureNode*>(Node))
+		{
+			TextureNode->RequestedFormat = GraphNode.Format;
+			TextureNode->RequestedResolution = GraphNode.Resolution;
+		}
+		// a node that failed to initialize stays null here, and so do its connections
+		GraphNodes.push_back(InitializeNode(Node) ? Node : nullptr);
+		if (GraphNodes.back())
+		{
+			Nodes.push_back(Node);
+		}
+	}
+	// the slot titles are what CompileGraph looks the connections up by
+	for (const auto& Edge : Graph.GetEdges())
+	{
+		auto Node = GraphNodes[Edge.Node];
+		auto Input = GraphNodes[Edge.Input];
+		if (Node && Input)
+		{
+			Node->CreateConnection(Node->InputSlots[Edge.Slot].title, *Input, Input->OutputSlots[0].title);
+		}
+	}
+	if (Graph.GetOutput() != FTexGenGraph::NO_NODE)
+	{
+		GraphEntryPoint = static_cast<SOutputNode*>(GraphNodes[Graph.GetOutput()]);
+	}
 	bIsDirty = true;
-	return EErrorCode::OK;
+	bIsGraphChanged = true;
 }
 
-void Generator::FTexGen::OnUpdate(const float Time) noexcept
+void Generator::FTexGen::GetGraph(FTexGenGraph& Graph) const
 {
-	// generate texture only if graph change
-	if (!bIsDirty)
+	Graph.Clear();
+	for (const auto Node : Nodes)
 	{
-		return;
+		auto& GraphNode = Graph.GetNode(Graph.AddNode(Node->NodeType, Node->Position.x, Node->Position.y));
+		if (auto Scalar = dynamic_cast<const SScalarNode*>(Node))
+		{
+			GraphNode.Value.x = Scalar->Value;
+		}
+		else if (auto Vector2 = dynamic_cast<const SVector2Node*>(Node))
+		{
+			GraphNode.Value.x = Vector2->Value.x;
+			GraphNode.Value.y = Vector2->Value.y;
+		}
+		else if (auto Vector4 = dynamic_cast<const SVector4Node*>(Node))
+		{
+			GraphNode.Value = Vector4->Value;
+		}
+		else if (auto TextureNode = dynamic_cast<const STextureNode*>(Node))
+		{
+			GraphNode.Format = TextureNode->RequestedFormat;
+			GraphNode.Resolution = TextureNode->RequestedResolution;
+		}
+	}
+	// connections CompileGraph would ignore are left out, Connect rejects them as well
+	for (size_t Index = 0; Index < Nodes.size(); ++Index)
+	{
+		const auto Node = Nodes[Index];
+		for (const auto& Connection : Node->Connections)
+		{
+			if (Connection.InputNode == Node)
+			{
+				const auto Input = std::find(Nodes.begin(), Nodes.end(), static_cast<SMyNode*>(Connection.OutputNode)) - Nodes.begin();
+				Graph.Connect(static_cast<uint32_t>(Index), FindSlot(Node->InputSlots, Connection.InputSlot), static_cast<uint32_t>(Input));
+			}
+		}
 	}
+	const auto Output = std::find(Nodes.begin(), Nodes.end(), static_cast<SMyNode*>(GraphEntryPoint));
+	if (Output != Nodes.end())
+	{
+		Graph.SetOutput(static_cast<uint32_t>(Output - Nodes.begin()));
+	}
+}
 
-	auto Result = Visit([Time](SMyNode* Node)
+bool Generator::FTexGen::LoadGraph(const char* FileName)
+{
+	FTexGenGraph Graph;
+	if (!Graph.Load(FileName))
 	{
-		Node->OnUpdate(Time);
-		return true;
-	});
+		return false;
+	}
+	SetGraph(Graph);
+	return true;
+}
 
-	if (Result)
+bool Generator::FTexGen::SaveGraph(const char* FileName) const
+{
+	FTexGenGraph Graph;
+	GetGraph(Graph);
+	return Graph.Save(FileName);
+}
+
+void Generator::FTexGen::OnUpdate(const float Time) noexcept
+{
+	if (bIsDirty)
+	{
+		if (bIsGraphChanged)
+		{
+			CompileGraph();
+		}
+		bIsDirty = false;
+		Evaluator.Restart();
+	}
+
+	UpdateTime = Time;
+	if (!Evaluator.Update(*this, TimeBudget))
+	{
+		return;
+	}
+	if (GraphEntryPoint->State.Hash != OutputHash)
 	{
+		OutputHash = GraphEntryPoint->State.Hash;
 		bIsOutputUpdated = true;
 	}
+}
 
-	bIsDirty = false;
+uint64_t Generator::FTexGen::HashValues(const uint32_t Node)
+{
+	return HashNodeValues(*Nodes[Node]);
 }
 
-bool Generator::FTexGen::Visit(std::function<bool(SMyNode* node)> Callback) noexcept
+void Generator::FTexGen::Draw(const uint32_t Node)
 {
-	std::stack<SMyNode*> Stack;
-	std::unordered_set<SMyNode*> Visited;
-	if (!GraphEntryPoint)
+	// only texture nodes other than the output are drawn
+	auto& TextureNode = *static_cast<STextureNode*>(Nodes[Node]);
+	const auto Chain = Fusion.GetChain(Node);
+	if (Chain != FTexGenFusion::NO_CHAIN)
 	{
-		return false;
+		DrawChain(Chain, TextureNode);
+	}
+	else
+	{
+		TextureNode.OnUpdate(UpdateTime);
+	}
+}
+
+void Generator::FTexGen::CreateTargets(const uint32_t Node)
+{
+	static_cast<STextureNode*>(Nodes[Node])->CreateTargets();
+}
+
+void Generator::FTexGen::ReleaseTargets(const uint32_t Node)
+{
+	// the editor drew the node's result into this frame's draw data already
+	static_cast<STextureNode*>(Nodes[Node])->ReleaseTargets(PendingTargets);
+}
+
+void Generator::FTexGen::Present()
+{
+	for (auto TextureNode : ScheduledTextureNodes)
+	{
+		if (TextureNode)
+		{
+			TextureNode->Present();
+		}
 	}
+	GraphEntryPoint->OnUpdate(UpdateTime);
+	// nothing shows them from now on, but this frame's draw data may sample them still
+	PendingTargets.insert(PendingTargets.end(), RetiredTargets.begin(), RetiredTargets.end());
+	RetiredTargets.clear();
+}
+
+void Generator::FTexGen::CompileGraph() noexcept
+{
+	using FClock = std::chrono::high_resolution_clock;
+	const auto Start = FClock::now();
+	bIsGraphChanged = false;
+	ScheduledNodes.clear();
+	ScheduledTextureNodes.clear();
 
-	Stack.push(GraphEntryPoint);
-	while (!Stack.empty())
+	size_t EdgeCapacity = 0;
+	for (size_t Index = 0; Index < Nodes.size(); ++Index)
 	{
-		auto Node = Stack.top();
-		if (Visited.find(Node) == Visited.end())
+		Nodes[Index]->GraphIndex = static_cast<uint32_t>(Index);
+		EdgeCapacity += Nodes[Index]->Connections.size();
+	}
+
+	FArenaScope Scope(InternalFrameAllocator);
+	auto SlotCounts = InternalFrameAllocator.AllocateArray<uint32_t>(Nodes.size() + 1);
+	auto Edges = InternalFrameAllocator.AllocateArray<STexGenEdge>(EdgeCapacity + 1);
+	if (SlotCounts == nullptr || Edges == nullptr)
+	{
+		for (auto Node : Nodes)
 		{
-			Visited.insert(Node);
+			Node->InputCount = 0;
+		}
+		bIsGraphChanged = true;
+		return;
+	}
 
-			// read all children
-			for (const auto& Connection : Node->Connections)
+	// connections are stored on both of their nodes, only the consumer's copy becomes an edge
+	size_t EdgeCount = 0;
+	for (size_t Index = 0; Index < Nodes.size(); ++Index)
+	{
+		const auto Node = Nodes[Index];
+		SlotCounts[Index] = static_cast<uint32_t>(Node->InputSlots.size());
+		for (const auto& Connection : Node->Connections)
+		{
+			if (Connection.InputNode != Node)
 			{
-				Stack.push(static_cast<SMyNode*>(Connection.OutputNode));
+				continue;
 			}
+			const auto Input = static_cast<const SMyNode*>(Connection.OutputNode);
+			const auto Slot = FindSlot(Node->InputSlots, Connection.InputSlot);
+			const auto OutputSlot = FindSlot(Input->OutputSlots, Connection.OutputSlot);
+			if (Slot != FTexGenSchedule::NO_NODE && OutputSlot != FTexGenSchedule::NO_NODE && Node->InputSlots[Slot].kind == Input->OutputSlots[OutputSlot].kind)
+			{
+				Edges[EdgeCount++] = { static_cast<uint32_t>(Index), Slot, Input->GraphIndex };
+			}
+		}
+	}
+	Schedule.Compile(SlotCounts, Nodes.size(), Edges, EdgeCount, GraphEntryPoint ? GraphEntryPoint->GraphIndex : FTexGenSchedule::NO_NODE);
+	NodeStates.resize(Nodes.size());
+	for (size_t Index = 0; Index < Nodes.size(); ++Index)
+	{
+		NodeStates[Index] = &Nodes[Index]->State;
+	}
+	Evaluator.SetGraph(Schedule, NodeStates.data());
 
-			if (Node->Connections.empty())
+	// inputs dropped from the schedule, cycles for example, are left null
+	InputNodes.resize(Schedule.GetInputOffset(static_cast<uint32_t>(Nodes.size())));
+	for (size_t Index = 0; Index < Nodes.size(); ++Index)
+	{
+		const auto Node = Nodes[Index];
+		const auto NodeIndex = static_cast<uint32_t>(Index);
+		const auto Offset = Schedule.GetInputOffset(NodeIndex);
+		const auto Inputs = Schedule.GetInputs(NodeIndex);
+		Node->InputCount = Schedule.GetInputCount(NodeIndex);
+		for (uint32_t Slot = 0; Slot < Node->InputCount; ++Slot)
+		{
+			InputNodes[Offset + Slot] = Inputs[Slot] != FTexGenSchedule::NO_NODE ? Nodes[Inputs[Slot]] : nullptr;
+		}
+		Node->Inputs = InputNodes.data() + Offset;
+	}
+	for (const auto Index : Schedule.GetOrder())
+	{
+		ScheduledNodes.push_back(Nodes[Index]);
+		ScheduledTextureNodes.push_back(dynamic_cast<STextureNode*>(Nodes[Index]));
+	}
+	PlanFusion();
+	UpdateTargets();
+	CompileMilliseconds = std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+}
+
+void Generator::FTexGen::PlanFusion() noexcept
+{
+	FArenaScope Scope(InternalFrameAllocator);
+	auto NodeTypes = InternalFrameAllocator.AllocateArray<ENodeType>(Nodes.size() + 1);
+	auto TextureSlots = InternalFrameAllocator.AllocateArray<uint32_t>(Nodes.size() + 1);
+	Fusion.Clear();
+	if (bIsFusionEnabled && NodeTypes && TextureSlots)
+	{
+		for (size_t Index = 0; Index < Nodes.size(); ++Index)
+		{
+			const auto Node = Nodes[Index];
+			NodeTypes[Index] = Node->NodeType;
+			TextureSlots[Index] = FTexGenSchedule::NO_NODE;
+			for (size_t Slot = 0; Slot < Node->InputSlots.size(); ++Slot)
 			{
-				goto ProcessNode;
+				if (Node->InputSlots[Slot].kind == NodeSlotTexture)
+				{
+					TextureSlots[Index] = static_cast<uint32_t>(Slot);
+					break;
+				}
 			}
 		}
-		else
+		Fusion.Plan(Schedule, NodeTypes, TextureSlots);
+	}
+
+	// a shader failing to compile turns fusion off for this graph, every node draws on its own
+	std::string Key;
+	std::string Hlsl;
+	ChainShaders.assign(Fusion.GetChainCount(), nullptr);
+	for (uint32_t Chain = 0; Chain < Fusion.GetChainCount(); ++Chain)
+	{
+		Fusion.WriteChainKey(Chain, Key);
+		auto Found = FusedShaders.find(Key);
+		if (Found == FusedShaders.end())
 		{
-		ProcessNode:
-			Stack.pop();
-			Callback(Node);
+			SShader Shader{};
+			WriteFusedShader(Fusion.GetChainTypes(Chain), Fusion.GetChainLength(Chain), Hlsl);
+			if (InternalRenderer.CreateVertexShader(L"FullScreenTriangleVS.hlsl", "main", nullptr, 0, Shader) != EErrorCode::OK ||
+				InternalRenderer.CreatePixelShaderFromSource(Hlsl.data(), Hlsl.size(), "TexGenFused", "main", Shader) != EErrorCode::OK)
+			{
+				InternalRenderer.DestroyShader(Shader);
+				Fusion.Clear();
+				ChainShaders.clear();
+				break;
+			}
+			Found = FusedShaders.emplace(Key, Shader).first;
+		}
+		ChainShaders[Chain] = &Found->second;
+	}
+
+	FusedNodeCount = 0;
+	for (auto Node : Nodes)
+	{
+		if (auto TextureNode = dynamic_cast<STextureNode*>(Node))
+		{
+			const auto Chain = Fusion.GetChain(Node->GraphIndex);
+			TextureNode->State.bIsFused = Chain != FTexGenFusion::NO_CHAIN && Fusion.GetChainNodes(Chain)[0] != Node->GraphIndex;
+			FusedNodeCount += TextureNode->State.bIsFused ? 1 : 0;
 		}
 	}
-	return true;
+}
+
+void Generator::FTexGen::UpdateTargets() noexcept
+{
+	// inputs are resolved first, the schedule has them before the nodes reading them. Targets are
+	// created when a node is drawn.
+	LegacyTargetBytes = 0;
+	for (auto TextureNode : ScheduledTextureNodes)
+	{
+		if (TextureNode)
+		{
+			TextureNode->ResolveOutput();
+			auto& State = TextureNode->State;
+			if (TextureNode->HasStaleTargets())
+			{
+				TextureNode->ReleaseTargets(RetiredTargets);
+				Evaluator.OnTargetsReleased(State);
+				State.RenderedHash = 0;
+			}
+			const auto Input = GetDrawInput(*TextureNode);
+			State.DrawInput = Input ? Input->GraphIndex : FTexGenSchedule::NO_NODE;
+			State.TargetBytes = State.bIsDrawn ? 2ull * TextureNode->Resolution * TextureNode->Resolution * GetFormatSize(TextureNode->Format) : 0;
+		}
+	}
+	for (auto Node : Nodes)
+	{
+		if (Node->NodeType != ENodeType::OUTPUT && dynamic_cast<const STextureNode*>(Node))
+		{
+			LegacyTargetBytes += 2ull * TEXGEN_DEFAULT_RESOLUTION * TEXGEN_DEFAULT_RESOLUTION * 4;
+		}
+	}
+}
+
+Generator::STextureNode* Generator::FTexGen::GetDrawInput(const STextureNode& Node) const noexcept
+{
+	const auto Chain = Fusion.GetChain(Node.GraphIndex);
+	if (Chain == FTexGenFusion::NO_CHAIN)
+	{
+		return Node.GetTextureInput();
+	}
+	const auto Source = Fusion.GetChainSource(Chain);
+	return Source != FTexGenSchedule::NO_NODE ? static_cast<STextureNode*>(Nodes[Source]) : nullptr;
+}
+
+void Generator::FTexGen::DrawChain(const uint32_t Chain, STextureNode& Node) noexcept
+{
+	DirectX::XMFLOAT4 Params[TEXGEN_MAX_FUSED_VECTORS] = {};
+	const auto ChainNodes = Fusion.GetChainNodes(Chain);
+	uint32_t VectorCount = 0;
+	for (uint32_t Index = 0, Count = Fusion.GetChainLength(Chain); Index < Count; ++Index)
+	{
+		VectorCount += static_cast<STextureNode*>(Nodes[ChainNodes[Index]])->WriteFusedParams(Params + VectorCount);
+	}
+	InternalRenderer.UpdateSubresource(FusedConstantBuffer, Params, VectorCount * sizeof(DirectX::XMFLOAT4));
+
+	// only nodes with a texture output are connected to texture slots
+	const auto Source = Fusion.GetChainSource(Chain);
+	InternalRenderer.SetTexture(0, Source != FTexGenSchedule::NO_NODE ? static_cast<STextureNode*>(Nodes[Source])->GetResult() : SRenderTarget());
+	Node.Draw(*ChainShaders[Chain], FusedConstantBuffer);
 }
 
 SRenderTarget Generator::FTexGen::GetOutput() const
@@ -280,6 +890,29 @@ SRenderTarget Generator::FTexGen::GetOutput() const
 	return GraphEntryPoint ? GraphEntryPoint->RenderTarget : SRenderTarget();
 }
 
+const Generator::STexGenImage* Generator::FTexGen::EvaluateOnCpu(const uint32_t Width, const uint32_t Height) noexcept
+{
+	if (bIsGraphChanged)
+	{
+		CompileGraph();
+	}
+	if (ScheduledNodes.empty())
+	{
+		return nullptr;
+	}
+
+	// every input of a scheduled node is scheduled before it, so CpuNode is never stale
+	CpuGraph.Clear();
+	for (auto TextureNode : ScheduledTextureNodes)
+	{
+		if (TextureNode)
+		{
+			TextureNode->AddToCpuGraph(CpuGraph);
+		}
+	}
+	return CpuGraph.Evaluate(Width, Height, GraphEntryPoint->CpuNode);
+}
+
 bool Generator::FTexGen::IsOutputUpdated()
 {
 	auto B = bIsOutputUpdated;
@@ -295,6 +928,49 @@ void Generator::FTexGen::OnGui() noexcept
 	const ImGuiStyle& Style = ImGui::GetStyle();
 	if (ImGui::Begin("Texture Generator", nullptr, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse))
 	{
+		ImGui::Text("%u nodes drawn by the last change over %u frames, %llu in total, compiled in %.3f ms", Evaluator.GetLastEvaluationCount(), Evaluator.GetLastFrameCount(),
+		            static_cast<unsigned long long>(Evaluator.GetEvaluationCount()), CompileMilliseconds);
+		ImGui::PushItemWidth(100);
+		ImGui::DragFloat("Budget (ms)", &TimeBudget, 0.1f, 0.0f, 100.0f);
+		ImGui::PopItemWidth();
+		if (Evaluator.IsEvaluating())
+		{
+			ImGui::SameLine();
+			ImGui::Text("evaluating %zu / %zu", Evaluator.GetCursor(), ScheduledNodes.size());
+		}
+		if (ImGui::Checkbox("Fuse chains", &bIsFusionEnabled))
+		{
+			bIsGraphChanged = true;
+			bIsDirty = true;
+		}
+		ImGui::SameLine();
+		ImGui::Text("%u nodes fused into %zu passes", FusedNodeCount, Fusion.GetChainCount());
+		int BudgetMegabytes = static_cast<int>(Evaluator.GetCacheBudget() >> 20);
+		ImGui::PushItemWidth(100);
+		if (ImGui::DragInt("Cache (MB)", &BudgetMegabytes, 1.0f, 1, 4096))
+		{
+			Evaluator.SetCacheBudget(static_cast<uint64_t>(std::max(BudgetMegabytes, 1)) << 20);
+		}
+		ImGui::PopItemWidth();
+		ImGui::SameLine();
+		ImGui::Text("%.2f MB resident, %.2f MB as 1024x1024 RGBA8, %llu evictions, %llu recomputes", Evaluator.GetResidentBytes() / (1024.0 * 1024.0), LegacyTargetBytes / (1024.0 * 1024.0),
+		            static_cast<unsigned long long>(Evaluator.GetEvictionCount()), static_cast<unsigned long long>(Evaluator.GetRecomputeCount()));
+		ImGui::PushItemWidth(200);
+		ImGui::InputText("##GraphFile", GraphFileName, sizeof(GraphFileName));
+		ImGui::PopItemWidth();
+		ImGui::SameLine();
+		if (ImGui::Button("Save"))
+		{
+			GraphFileStatus = SaveGraph(GraphFileName) ? "saved" : "cannot be written";
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Load"))
+		{
+			GraphFileStatus = LoadGraph(GraphFileName) ? "loaded" : "cannot be read";
+		}
+		ImGui::SameLine();
+		ImGui::TextUnformatted(GraphFileStatus);
+
 		// We probably need to keep some state, like positions of nodes/slots for rendering connections.
 		ImNodes::BeginCanvas(&Canvas);
 		for (auto Iterator = Nodes.begin(); Iterator != Nodes.end();)
@@ -311,6 +987,12 @@ void Generator::FTexGen::OnGui() noexcept
 				if (Node->OnGui())
 				{
 					bIsDirty = true;
+					auto TextureNode = dynamic_cast<STextureNode*>(Node);
+					if (TextureNode && TextureNode->bIsOutputChanged)
+					{
+						TextureNode->bIsOutputChanged = false;
+						bIsGraphChanged = true;
+					}
 				}
 
 				// Render output nodes first (order is important)
@@ -324,6 +1006,7 @@ void Generator::FTexGen::OnGui() noexcept
 					static_cast<SMyNode*>(NewConnection.InputNode)->Connections.push_back(NewConnection);
 					static_cast<SMyNode*>(NewConnection.OutputNode)->Connections.push_back(NewConnection);
 					bIsDirty = true;
+					bIsGraphChanged = true;
 				}
 
 				// Render output connections of this node
@@ -343,6 +1026,7 @@ void Generator::FTexGen::OnGui() noexcept
 						static_cast<SMyNode*>(Connection.InputNode)->DeleteConnection(Connection);
 						static_cast<SMyNode*>(Connection.OutputNode)->DeleteConnection(Connection);
 						bIsDirty = true;
+						bIsGraphChanged = true;
 					}
 				}
 			}
@@ -370,9 +1054,10 @@ void Generator::FTexGen::OnGui() noexcept
 					GraphEntryPoint = nullptr;
 				}
 
-				delete Node;
+				DestroyNode(Node);
 				Iterator = Nodes.erase(Iterator);
 				bIsDirty = true;
+				bIsGraphChanged = true;
 			}
 			else
 			{
@@ -393,8 +1078,11 @@ void Generator::FTexGen::OnGui() noexcept
 			{
 				if (ImGui::MenuItem(Desc.first.c_str()))
 				{
-					auto Node = Desc.second();
-					Node->Initialize(InternalRenderer);
+					auto Node = Desc.second(NodePool);
+					if (!InitializeNode(Node))
+					{
+						continue;
+					}
 					Nodes.push_back(Node);
 					ImNodes::AutoPositionNode(Nodes.back());
 
@@ -402,6 +1090,8 @@ void Generator::FTexGen::OnGui() noexcept
 					{
 						GraphEntryPoint = dynamic_cast<SOutputNode *>(Nodes.back());
 					}
+					bIsDirty = true;
+					bIsGraphChanged = true;
 				}
 			}
 			ImGui::Separator();
@@ -419,6 +1109,97 @@ void Generator::FTexGen::OnGui() noexcept
 		ImNodes::EndCanvas();
 	}
 	ImGui::End();
+
+	OnCpuGui();
+}
+
+void Generator::FTexGen::OnCpuGui() noexcept
+{
+	static const char* NODE_NAMES[] = { "Scalar", "Vector2", "Vector4", "Loop", "Rectangle", "SineDist", "EnvMap", "Output" };
+	static const uint32_t RESOLUTIONS[] = { 1024, 2048, 4096 };
+
+	if (ImGui::Begin("TexGen CPU"))
+	{
+		if (ImGui::BeginCombo("Resolution", std::to_string(CpuResolution).c_str()))
+		{
+			for (const auto Resolution : RESOLUTIONS)
+			{
+				if (ImGui::Selectable(std::to_string(Resolution).c_str(), Resolution == CpuResolution))
+				{
+					CpuResolution = Resolution;
+				}
+			}
+			ImGui::EndCombo();
+		}
+
+		using FClock = std::chrono::high_resolution_clock;
+		if (ImGui::Button("Evaluate"))
+		{
+			const auto Start = FClock::now();
+			EvaluateOnCpu(CpuResolution, CpuResolution);
+			CpuPixelCount = static_cast<double>(CpuResolution) * CpuResolution;
+			CpuMilliseconds = std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+		}
+		ImGui::SameLine();
+		// the kernels write RGBA8 sRGB, the output only shows the current graph between evaluations
+		const bool bCanCompare = GraphEntryPoint && GraphEntryPoint->Format == ETexGenFormat::RGBA8;
+		if (ImGui::Button("Compare with GPU") && bCanCompare && !Evaluator.IsEvaluating())
+		{
+			GpuMaximumDifference = -1;
+			GpuMismatchCount = 0;
+			const auto Start = FClock::now();
+			const auto Image = EvaluateOnCpu(GraphEntryPoint->RenderTarget.Width, GraphEntryPoint->RenderTarget.Height);
+			CpuPixelCount = static_cast<double>(GraphEntryPoint->RenderTarget.Width) * GraphEntryPoint->RenderTarget.Height;
+			CpuMilliseconds = std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+			std::vector<uint32_t> GpuPixels;
+			if (Image && InternalRenderer.ReadBackTexture(GraphEntryPoint->RenderTarget, GpuPixels) == EErrorCode::OK && GpuPixels.size() == Image->Pixels.size())
+			{
+				GpuMaximumDifference = 0;
+				for (size_t Index = 0; Index < GpuPixels.size(); ++Index)
+				{
+					int32_t Difference = 0;
+					for (uint32_t Shift = 0; Shift < 32; Shift += 8)
+					{
+						Difference = std::max(Difference, std::abs(static_cast<int32_t>(GpuPixels[Index] >> Shift & 0xFF) - static_cast<int32_t>(Image->Pixels[Index] >> Shift & 0xFF)));
+					}
+					GpuMaximumDifference = std::max(GpuMaximumDifference, Difference);
+					GpuMismatchCount += Difference > 1 ? 1 : 0;
+				}
+			}
+		}
+
+		const auto& Timings = CpuGraph.GetTimings();
+		if (!Timings.empty())
+		{
+			ImGui::Columns(3);
+			ImGui::Text("Node");
+			ImGui::NextColumn();
+			ImGui::Text("ms");
+			ImGui::NextColumn();
+			ImGui::Text("MPixels/s");
+			ImGui::NextColumn();
+			for (const auto& Timing : Timings)
+			{
+				ImGui::Text("%s", NODE_NAMES[static_cast<size_t>(Timing.Type)]);
+				ImGui::NextColumn();
+				ImGui::Text("%.3f", Timing.Milliseconds);
+				ImGui::NextColumn();
+				ImGui::Text("%.1f", Timing.Milliseconds > 0.0 ? CpuPixelCount / Timing.Milliseconds / 1000.0 : 0.0);
+				ImGui::NextColumn();
+			}
+			ImGui::Columns(1);
+			ImGui::Text("Graph: %.3f ms", CpuMilliseconds);
+		}
+		if (!bCanCompare)
+		{
+			ImGui::TextDisabled("Comparing needs an RGBA8 output");
+		}
+		else if (GpuMaximumDifference >= 0)
+		{
+			ImGui::Text("GPU: max difference %d, %zu pixels off by more than 1", GpuMaximumDifference, GpuMismatchCount);
+		}
+	}
+	ImGui::End();
 }
 
 #undef NODE_INPUT1
@@ -1,11 +1,15 @@
 #pragma once
 #include "Renderer.hpp"
+#include "Allocators.hpp"
+#include "TexGenEvaluator.hpp"
+#include "TexGenFusion.hpp"
+#include "TexGenGraph.hpp"
+#include "TexGenKernels.hpp"
+#include "TexGenSchedule.hpp"
 #include <vector>
 #include <map>
 #include <string>
-#include <functional>
-
-#include <unordered_set>
+#include <cstring>
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include "imgui/imgui.h"
 #include "imgui/ImNodesEzRokups.h"
@@ -38,26 +42,6 @@ namespace Generator
 		}
 	};
 
-	enum ENodeSlotTypes
-	{
-		NodeSlotTexture = 1,
-		NodeSlotFloat,
-		NodeSlotFloat2,
-		NodeSlotFloat4
-	};
-
-	enum class ENodeType
-	{
-		SCALAR,
-		VECTOR2,
-		VECTOR4,
-		LOOP,
-		RECTANGLE,
-		SINE,
-		ENVMAP,
-		OUTPUT
-	};
-
 	/// A structure holding node state.
 	struct SMyNode
 	{
@@ -76,28 +60,36 @@ namespace Generator
 
 		ENodeType NodeType;
 
+		/// Node feeding each input slot, null when unconnected. Resolved by FTexGen when the graph is compiled
+		/// and points into its schedule, only valid until the next structural edit.
+		SMyNode* const* Inputs = nullptr;
+		uint32_t InputCount = 0;
+		/// Position in FTexGen::Nodes while compiling.
+		uint32_t GraphIndex = 0;
+
+		/// Hashes of the node and of what it drew, updated by FTexGen's evaluator.
+		STexGenNodeState State;
+
 		explicit SMyNode(const char* Title, const ENodeType NodeType,
 		                 const std::vector<ImNodes::Ez::SlotInfo>& InputSlots,
 		                 const std::vector<ImNodes::Ez::SlotInfo>& OutputSlots);
 
+		virtual ~SMyNode() = default;
+
 		virtual EErrorCode Initialize(const FRenderer& Renderer) { return EErrorCode::OK; };
 		virtual void Destroy(const FRenderer& Renderer) {};
 
 		virtual void OnUpdate(float Time) {};
 		virtual bool OnGui() { return false; }; // returns true if changed
+		/// Folds the values edited on the node itself into Hash, inputs are hashed by FTexGenEvaluator.
+		virtual uint64_t HashValues(const uint64_t Hash) const { return Hash; }
 
+		/// Slot is the index into InputSlots. Connections are only resolved between slots of the same kind and
+		/// each kind is produced by one node type, so T is known from the slot.
 		template<typename T>
-		T* GetInputParameterNode(const char* InputName)
+		T* GetInput(const uint32_t Slot) const
 		{
-			for (const auto& Connection : Connections)
-			{
-				if (std::string(Connection.InputSlot) == InputName)
-				{
-					return dynamic_cast<T*>((T*)Connection.OutputNode);
-				}
-			}
-
-			return nullptr;
+			return Slot < InputCount ? static_cast<T*>(Inputs[Slot]) : nullptr;
 		}
 
 		void CreateConnection(const char* InputSlot, SMyNode& OutputNode, const char* OutputSlot);
@@ -117,6 +109,7 @@ namespace Generator
 		}
 
 		bool OnGui() override;
+		uint64_t HashValues(const uint64_t Hash) const override;
 
 		float Value;
 	};
@@ -144,6 +137,8 @@ namespace Generator
 			return ImGui::DragFloat2("##Vector2NodeValueInput", reinterpret_cast<float *>(&Value), 0.001f);
 		}
 
+		uint64_t HashValues(const uint64_t Hash) const override;
+
 		DirectX::XMFLOAT2 Value;
 	};
 
@@ -158,6 +153,7 @@ namespace Generator
 		}
 
 		bool OnGui() override;
+		uint64_t HashValues(const uint64_t Hash) const override;
 
 		DirectX::XMFLOAT4 Value;
 	};
@@ -169,9 +165,11 @@ namespace Generator
 			, Renderer(nullptr)
 			, ShaderName(ShaderName)
 		{
+			State.bIsDrawn = NodeType != ENodeType::OUTPUT;
 		}
 
 		bool OnGui() override;
+		uint64_t HashValues(const uint64_t Hash) const override;
 
 		EErrorCode Initialize(const FRenderer& Renderer) override;
 
@@ -179,9 +177,58 @@ namespace Generator
 
 		void OnUpdate(float Time) override;
 
+		/// Node whose output this one transforms, its format and resolution are used for AUTO.
+		virtual STextureNode* GetTextureInput() const { return nullptr; }
+		/// Sets Format and Resolution from the requested ones, the defaults or the input, which has to be
+		/// resolved already.
+		void ResolveOutput();
+		/// Targets exist from the first draw until the node is evicted, fused, deleted or its output changes.
+		bool HasTargets() const noexcept { return TargetFormat != ETexGenFormat::AUTO; }
+		bool HasStaleTargets() const noexcept { return HasTargets() && (State.bIsFused || TargetFormat != Format || RenderTarget.Width != Resolution); }
+		/// Creates both targets with Format and Resolution, State.TargetBytes of them.
+		void CreateTargets();
+		/// Appends both targets to Released. State.RenderedHash is kept, a node whose inputs did not change
+		/// can be drawn again from them.
+		void ReleaseTargets(std::vector<SRenderTarget>& Released);
+
+		// adds the node to a CPU graph after its inputs were added, sets CpuNode
+		virtual void AddToCpuGraph(FTexGenCpuGraph& Graph) { CpuNode = FTexGenCpuGraph::NO_INPUT; }
+		// updates the constants and copies them to Destination for a fused shader, returns the float4s
+		// written, GetFusedVectorCount of the node type
+		virtual uint32_t WriteFusedParams(DirectX::XMFLOAT4* Destination) { return 0; }
+
+		/// Draws a full screen triangle into the back target, inputs have to be bound already.
+		void Draw(const SShader& PassShader, const SBuffer& PassConstantBuffer);
+
+		/// What readers of this node see during an evaluation, the back target once it was redrawn.
+		const SRenderTarget& GetResult() const { return bBackIsNewer ? BackRenderTarget : RenderTarget; }
+		/// Makes a redrawn back target the displayed one.
+		void Present();
+
+		/// Displayed by the editor and the output, only changes when a whole evaluation finished.
 		SRenderTarget RenderTarget;
+		/// Drawn into while an evaluation is spread over several frames.
+		SRenderTarget BackRenderTarget;
+		bool bBackIsNewer = false;
+
+		/// What the user picked on the node, AUTO and 0 select the defaults.
+		ETexGenFormat RequestedFormat = ETexGenFormat::AUTO;
+		uint32_t RequestedResolution = 0;
+		/// Set by OnGui when the requested output changed, the graph has to be compiled again.
+		bool bIsOutputChanged = false;
+		/// Resolved when the graph is compiled, the targets have this format and size.
+		ETexGenFormat Format = ETexGenFormat::R8;
+		uint32_t Resolution = TEXGEN_DEFAULT_RESOLUTION;
+		uint32_t CpuNode = FTexGenCpuGraph::NO_INPUT;
 
 	protected:
+		uint32_t GetCpuInput(const uint32_t Slot) const;
+
+		/// AUTO and 0 take the input's.
+		ETexGenFormat DefaultFormat = ETexGenFormat::AUTO;
+		uint32_t DefaultResolution = 0;
+		ETexGenFormat TargetFormat = ETexGenFormat::AUTO;
+
 		const FRenderer* Renderer;
 		const wchar_t* ShaderName;
 		SShader Shader{};
@@ -192,6 +239,8 @@ namespace Generator
 
 	struct SOutputNode : public STextureNode
 	{
+		enum EInput : uint32_t { INPUT };
+
 		SOutputNode()
 			: STextureNode(nullptr, "Output", ENodeType::OUTPUT, {
 				{ "Input", NodeSlotTexture }
@@ -204,16 +253,14 @@ namespace Generator
 		void Destroy(const FRenderer& Renderer) override;
 
 		void OnUpdate(float Time);
+
+		void AddToCpuGraph(FTexGenCpuGraph& Graph) override;
+		STextureNode* GetTextureInput() const override { return GetInput<STextureNode>(INPUT); }
 	};
 
 	struct SRectangleNode : public STextureNode
 	{
-		struct SRectangleParams
-		{
-			DirectX::XMFLOAT4 Data; // X1 Y1 X2 Y2
-			float Chamfer;
-			float Falloff;
-		};
+		enum EInput : uint32_t { POSITION, CHAMFER, FALLOFF };
 
 		SRectangleNode()
 			: STextureNode(L"Rectangle.hlsl", "Rectangle", ENodeType::RECTANGLE, {
@@ -224,19 +271,23 @@ namespace Generator
 					{"Output", NodeSlotTexture}
 				})
 		{
+			DefaultFormat = ETexGenFormat::R8;
+			DefaultResolution = TEXGEN_DEFAULT_RESOLUTION;
 		}
 
 		void OnUpdate(float Time) override;
+		void AddToCpuGraph(FTexGenCpuGraph& Graph) override;
+		uint32_t WriteFusedParams(DirectX::XMFLOAT4* Destination) override;
 
 		SRectangleParams Params{};
+
+	private:
+		void UpdateParams();
 	};
 
 	struct SLoopNode : public STextureNode
 	{
-		struct SLoopParams
-		{
-			DirectX::XMFLOAT2 Repeat;
-		};
+		enum EInput : uint32_t { REPEAT, INPUT };
 
 		SLoopNode()
 			: STextureNode(L"Loop.hlsl", "Loop", ENodeType::LOOP, {
@@ -249,19 +300,19 @@ namespace Generator
 		}
 
 		void OnUpdate(float Time) override;
+		void AddToCpuGraph(FTexGenCpuGraph& Graph) override;
+		uint32_t WriteFusedParams(DirectX::XMFLOAT4* Destination) override;
+		STextureNode* GetTextureInput() const override { return GetInput<STextureNode>(INPUT); }
 
 		SLoopParams Params;
+
+	private:
+		void UpdateParams();
 	};
 
 	struct SSineDist : public STextureNode
 	{
-		struct SSineDistParams
-		{
-			float CountX;
-			float AmplX;
-			float CountY;
-			float AmplY;
-		};
+		enum EInput : uint32_t { COUNT, AMPLITUDE, INPUT };
 
 		explicit SSineDist()
 			: STextureNode(L"SineDist.hlsl", "SineDist", ENodeType::SINE, {
@@ -275,78 +326,223 @@ namespace Generator
 		}
 
 		void OnUpdate(float Time) override;
+		void AddToCpuGraph(FTexGenCpuGraph& Graph) override;
+		uint32_t WriteFusedParams(DirectX::XMFLOAT4* Destination) override;
+		STextureNode* GetTextureInput() const override { return GetInput<STextureNode>(INPUT); }
 
 		SSineDistParams Params{};
+
+	private:
+		void UpdateParams();
 	};
 
-	class FTexGen
+	struct SEnvMapNode : public STextureNode
+	{
+		enum EInput : uint32_t { RADIUS };
+
+		SEnvMapNode()
+			: STextureNode(L"EnvMap.hlsl", "EnvMap", ENodeType::ENVMAP, {
+					{ "Radius", NodeSlotFloat4 },
+				}, {
+					{ "Output", NodeSlotTexture }
+				})
+		{
+			// a radial gradient, used as a height field it bands at 8 bits
+			DefaultFormat = ETexGenFormat::R16;
+			DefaultResolution = TEXGEN_DEFAULT_RESOLUTION;
+		}
+
+		void OnUpdate(float Time) override;
+		void AddToCpuGraph(FTexGenCpuGraph& Graph) override;
+		uint32_t WriteFusedParams(DirectX::XMFLOAT4* Destination) override;
+
+		SEnvMapParams Params{};
+
+	private:
+		void UpdateParams();
+	};
+
+	class FTexGen : private FTexGenBackend
 	{
 	public:
 
-		explicit FTexGen(FRenderer& Renderer);
+		explicit FTexGen(FRenderer& Renderer, FArenaAllocator& FrameAllocator);
 
 		~FTexGen();
 
 		EErrorCode Initialize(const uint32_t Width, const uint32_t Height);
 
-		void OnUpdate(const float Time) noexcept;
+		// replaces every node with the ones of Graph, Initialize sets FTexGenGraph::MakeDefault
+		void SetGraph(const FTexGenGraph& Graph);
+		void GetGraph(FTexGenGraph& Graph) const;
+		// the current graph is kept when the file cannot be read
+		bool LoadGraph(const char* FileName);
+		bool SaveGraph(const char* FileName) const;
 
-		// topologically traverse nodegraph and execute function for each node
-		bool Visit(std::function<bool(SMyNode* node)> Callback) noexcept;
+		void OnUpdate(const float Time) noexcept;
 
 		SRenderTarget GetOutput() const;
 
 		bool IsOutputUpdated();
 
+		// texture nodes drawn since Initialize, nodes with unchanged inputs are not counted
+		uint64_t GetNodeEvaluationCount() const noexcept { return Evaluator.GetEvaluationCount(); }
+
+		// OnUpdate stops drawing nodes once this much CPU time was spent in a frame and goes on in
+		// the next one, at least one node is drawn per frame. 0 evaluates the whole graph at once.
+		void SetTimeBudget(const float Milliseconds) noexcept { TimeBudget = Milliseconds; }
+		bool IsEvaluating() const noexcept { return Evaluator.IsEvaluating(); }
+
+		// bytes the node targets may take, results not needed right now are evicted to stay below and
+		// drawn again when a node reading them is
+		void SetCacheBudget(const uint64_t Bytes) noexcept { Evaluator.SetCacheBudget(Bytes); }
+		uint64_t GetResidentBytes() const noexcept { return Evaluator.GetResidentBytes(); }
+		uint64_t GetEvictionCount() const noexcept { return Evaluator.GetEvictionCount(); }
+		uint64_t GetRecomputeCount() const noexcept { return Evaluator.GetRecomputeCount(); }
+
 		void OnGui() noexcept;
+		// destroys the targets evicted or retired during the last frame, whose views the editor may have
+		// put into that frame's draw data. Called at the start of a frame, after the last one was rendered.
+		void ReleasePendingTargets() noexcept;
+
+		// evaluates the graph with the CPU kernels, null when there is no output or it is not connected
+		const STexGenImage* EvaluateOnCpu(const uint32_t Width, const uint32_t Height) noexcept;
+		const FTexGenCpuGraph& GetCpuGraph() const noexcept { return CpuGraph; }
 
 	private:
+		void OnCpuGui() noexcept;
+
+		static constexpr size_t NODE_SLOT_SIZE = 512;
+
+		template <typename T>
+		static T* CreateNode(FPoolAllocator& Pool)
+		{
+			static_assert(sizeof(T) <= NODE_SLOT_SIZE, "node does not fit into a pool slot");
+			return new (Pool.Allocate()) T();
+		}
+
+		void DestroyNode(SMyNode* Node) noexcept;
+		// logs a failure and destroys the node, which the caller must then not add
+		bool InitializeNode(SMyNode* Node) noexcept;
+
+		// what the evaluator draws with, Node is an index into Nodes
+		uint64_t HashValues(const uint32_t Node) override;
+		void Draw(const uint32_t Node) override;
+		void CreateTargets(const uint32_t Node) override;
+		void ReleaseTargets(const uint32_t Node) override;
+		// shows every back target drawn and retires the targets the output may have shown until now
+		void Present() override;
+
+		// finds the chains to fuse in the compiled schedule and compiles the shaders not cached yet
+		void PlanFusion() noexcept;
+		void DrawChain(const uint32_t Chain, STextureNode& Node) noexcept;
+		// resolves the output of every scheduled texture node, releases targets that no longer match
+		// and tells the evaluator what the nodes read and take
+		void UpdateTargets() noexcept;
+		// node whose result Node samples when drawn, the source of its chain if it is fused
+		STextureNode* GetDrawInput(const STextureNode& Node) const noexcept;
+
+		// resolves the input slots of every node and orders the nodes the output depends on, run
+		// after structural edits only
+		void CompileGraph() noexcept;
+
 		bool bIsDirty;
 		bool bIsOutputUpdated;
 		FRenderer& InternalRenderer;
+		FArenaAllocator& InternalFrameAllocator;
 		SOutputNode* GraphEntryPoint;
-
-		std::map<std::string, SMyNode* (*)()> AvailableNodes{
+		bool bIsGraphChanged = true;
+		FTexGenSchedule Schedule;
+		// the schedule's order and inputs as nodes, texture nodes are repeated to skip the casts
+		std::vector<SMyNode*> ScheduledNodes;
+		std::vector<STextureNode*> ScheduledTextureNodes;
+		std::vector<SMyNode*> InputNodes;
+		// the state of every node in the order of Nodes, what the evaluator reads the schedule with
+		std::vector<STexGenNodeState*> NodeStates;
+		FTexGenEvaluator Evaluator;
+		double CompileMilliseconds = 0.0;
+		uint64_t OutputHash = 0;
+		// the evaluator's passes are spread over frames with this budget, restarted whenever the graph
+		// changes again
+		float TimeBudget = 2.0f;
+		float UpdateTime = 0.0f;
+
+		// chains of warps drawn as one pass, shaders are kept for every chain structure seen so far
+		bool bIsFusionEnabled = true;
+		FTexGenFusion Fusion;
+		std::map<std::string, SShader> FusedShaders;
+		std::vector<const SShader*> ChainShaders;
+		SBuffer FusedConstantBuffer{};
+		uint32_t FusedNodeCount = 0;
+
+		// targets replaced by a compile or of deleted nodes, pending once the evaluation that follows
+		// finished as the output may still show them
+		std::vector<SRenderTarget> RetiredTargets;
+		// evicted and retired targets, destroyed by the next ReleasePendingTargets
+		std::vector<SRenderTarget> PendingTargets;
+		// what the same nodes took when every one had two 1024x1024 RGBA8 targets
+		uint64_t LegacyTargetBytes = 0;
+
+		char GraphFileName[256] = "Default.texgen";
+		const char* GraphFileStatus = "";
+
+		FTexGenCpuGraph CpuGraph;
+		uint32_t CpuResolution = 1024;
+		double CpuMilliseconds = 0.0;
+		double CpuPixelCount = 0.0;
+		// largest difference of a channel and the number of pixels differing by more than one step
+		int32_t GpuMaximumDifference = -1;
+		size_t GpuMismatchCount = 0;
+
+		FPoolAllocator NodePool{ "TexGen Nodes", NODE_SLOT_SIZE, 64 };
+
+		std::map<std::string, SMyNode* (*)(FPoolAllocator&)> AvailableNodes{
+			{
+				"Scalar", [](FPoolAllocator& Pool) -> SMyNode*
+				{
+					return CreateNode<SScalarNode>(Pool);
+				}
+			},
 			{
-				"Scalar", []() -> SMyNode *
+				"Vector2", [](FPoolAllocator& Pool) -> SMyNode*
 				{
-					return new SScalarNode();
+					return CreateNode<SVector2Node>(Pool);
 				}
 			},
 			{
-				"Vector2", []() -> SMyNode*
+				"Vector4", [](FPoolAllocator& Pool) -> SMyNode*
 				{
-					return new SVector2Node();
+					return CreateNode<SVector4Node>(Pool);
 				}
 			},
 			{
-				"Vector4", []() -> SMyNode*
+				"Loop", [](FPoolAllocator& Pool) -> SMyNode*
 				{
-					return new SVector4Node();
+					return CreateNode<SLoopNode>(Pool);
 				}
 			},
 			{
-				"Loop", []() -> SMyNode *
+				"EnvMap", [](FPoolAllocator& Pool) -> SMyNode*
 				{
-					return new SLoopNode();
+					return CreateNode<SEnvMapNode>(Pool);
 				}
 			},
 			{
-				"Rectangle", []() -> SMyNode*
+				"Rectangle", [](FPoolAllocator& Pool) -> SMyNode*
 				{
-					return new SRectangleNode();
+					return CreateNode<SRectangleNode>(Pool);
 				}
 			},
 			{
-				"SineDist", []() -> SMyNode*
+				"SineDist", [](FPoolAllocator& Pool) -> SMyNode*
 				{
-					return new SSineDist();
+					return CreateNode<SSineDist>(Pool);
 				}
 			},
 			{
-				"Output", []() -> SMyNode*
+				"Output", [](FPoolAllocator& Pool) -> SMyNode*
 				{
-					return new SOutputNode();
+					return CreateNode<SOutputNode>(Pool);
 				}
 			},
 		};
@@ -0,0 +1,180 @@
+#include "TexGenEvaluator.hpp"
+
+#include <chrono>
+
+constexpr uint32_t Generator::FTexGenEvaluator::NO_NODE;
+
+uint64_t Generator::HashTexGenBytes(const void* Data, const size_t Size, uint64_t Hash) noexcept
+{
+	for (size_t Index = 0; Index < Size; ++Index)
+	{
+		Hash ^= static_cast<const uint8_t*>(Data)[Index];
+		Hash *= 1099511628211ull;
+	}
+	return Hash;
+}
+
+double Generator::FTexGenBackend::GetMilliseconds()
+{
+	using FClock = std::chrono::high_resolution_clock;
+	return std::chrono::duration<double, std::milli>(FClock::now().time_since_epoch()).count();
+}
+
+void Generator::FTexGenEvaluator::SetGraph(const FTexGenSchedule& InSchedule, STexGenNodeState* const* InStates) noexcept
+{
+	Schedule = &InSchedule;
+	States = InStates;
+}
+
+void Generator::FTexGenEvaluator::Restart() noexcept
+{
+	bIsEvaluating = Schedule && !Schedule->GetOrder().empty();
+	Cursor = 0;
+	PassEvaluationCount = 0;
+	PassFrameCount = 0;
+}
+
+bool Generator::FTexGenEvaluator::Update(FTexGenBackend& Backend, const float Budget)
+{
+	if (!bIsEvaluating)
+	{
+		// the budget may have been lowered
+		MakeRoom(Backend, 0, NO_NODE, NO_NODE);
+		return false;
+	}
+
+	// inputs come first in the schedule, so their hashes are current when a node hashes them
+	const auto& Order = Schedule->GetOrder();
+	const double Start = Backend.GetMilliseconds();
+	++PassFrameCount;
+	while (Cursor < Order.size())
+	{
+		const auto Node = Order[Cursor++];
+		if (!UpdateHash(Node, Backend.HashValues(Node)))
+		{
+			continue;
+		}
+		++PassEvaluationCount;
+		DrawNode(Backend, Node);
+		if (Budget > 0.0f && Backend.GetMilliseconds() - Start >= Budget)
+		{
+			break;
+		}
+	}
+	if (Cursor < Order.size())
+	{
+		return false;
+	}
+
+	// the output's input was skipped if its hash did not change, it may have been evicted while
+	// something else was shown
+	const auto Shown = States[Order.back()]->DrawInput;
+	if (Shown != NO_NODE && States[Shown]->ResidentBytes == 0 && States[Shown]->bIsDrawn && !States[Shown]->bIsFused)
+	{
+		DrawNode(Backend, Shown);
+	}
+	Backend.Present();
+	for (uint32_t Node = 0, Count = static_cast<uint32_t>(Schedule->GetNodeCount()); Node < Count; ++Node)
+	{
+		States[Node]->bIsShown = Node == Shown;
+	}
+	MakeRoom(Backend, 0, NO_NODE, NO_NODE);
+
+	bIsEvaluating = false;
+	EvaluationCount += PassEvaluationCount;
+	LastEvaluationCount = PassEvaluationCount;
+	LastFrameCount = PassFrameCount;
+	return true;
+}
+
+bool Generator::FTexGenEvaluator::UpdateHash(const uint32_t Node, const uint64_t ValueHash) noexcept
+{
+	auto& State = *States[Node];
+	uint64_t Hash = ValueHash;
+	const auto Inputs = Schedule->GetInputs(Node);
+	for (uint32_t Slot = 0, Count = Schedule->GetInputCount(Node); Slot < Count; ++Slot)
+	{
+		const uint64_t InputHash = Inputs[Slot] != NO_NODE ? States[Inputs[Slot]]->Hash : 0;
+		Hash = HashTexGenBytes(&InputHash, sizeof(InputHash), Hash);
+	}
+	State.Hash = Hash;
+	if (!State.bIsDrawn || State.RenderedHash == Hash)
+	{
+		return false;
+	}
+	// drawn by its consumer, its result goes stale and is drawn again once it is no longer fused
+	if (State.bIsFused)
+	{
+		State.RenderedHash = 0;
+		return false;
+	}
+	State.RenderedHash = Hash;
+	return true;
+}
+
+void Generator::FTexGenEvaluator::OnTargetsReleased(STexGenNodeState& State) noexcept
+{
+	ResidentBytes -= State.ResidentBytes;
+	State.ResidentBytes = 0;
+}
+
+void Generator::FTexGenEvaluator::DrawNode(FTexGenBackend& Backend, const uint32_t Node)
+{
+	RecomputeStack.clear();
+	RecomputeStack.push_back(Node);
+	for (auto Input = States[Node]->DrawInput; Input != NO_NODE && States[Input]->ResidentBytes == 0; Input = States[Input]->DrawInput)
+	{
+		RecomputeStack.push_back(Input);
+	}
+	RecomputeCount += RecomputeStack.size() - 1;
+
+	while (!RecomputeStack.empty())
+	{
+		const auto Drawn = RecomputeStack.back();
+		RecomputeStack.pop_back();
+		auto& State = *States[Drawn];
+		const auto Input = State.DrawInput;
+		if (State.ResidentBytes == 0)
+		{
+			MakeRoom(Backend, State.TargetBytes, Drawn, Input);
+			Backend.CreateTargets(Drawn);
+			State.ResidentBytes = State.TargetBytes;
+			ResidentBytes += State.ResidentBytes;
+		}
+		State.LastUsed = ++UseClock;
+		if (Input != NO_NODE)
+		{
+			States[Input]->LastUsed = UseClock;
+		}
+		Backend.Draw(Drawn);
+	}
+}
+
+void Generator::FTexGenEvaluator::MakeRoom(FTexGenBackend& Backend, const uint64_t Bytes, const uint32_t Drawn, const uint32_t Input)
+{
+	const auto Count = Schedule ? static_cast<uint32_t>(Schedule->GetNodeCount()) : 0;
+	while (ResidentBytes + Bytes > CacheBudget)
+	{
+		uint32_t Oldest = NO_NODE;
+		for (uint32_t Node = 0; Node < Count; ++Node)
+		{
+			const auto& State = *States[Node];
+			if (State.ResidentBytes == 0 || Node == Drawn || Node == Input || State.bIsShown)
+			{
+				continue;
+			}
+			if (Oldest == NO_NODE || State.LastUsed < States[Oldest]->LastUsed)
+			{
+				Oldest = Node;
+			}
+		}
+		if (Oldest == NO_NODE)
+		{
+			break;
+		}
+
+		Backend.ReleaseTargets(Oldest);
+		OnTargetsReleased(*States[Oldest]);
+		++EvictionCount;
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "TexGenSchedule.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Generator
+{
+	static constexpr uint64_t TEXGEN_HASH_BASIS = 14695981039346656037ull;
+
+	// FNV-1a, what nodes fold their values into their hash with
+	uint64_t HashTexGenBytes(const void* Data, const size_t Size, uint64_t Hash = TEXGEN_HASH_BASIS) noexcept;
+
+	// What an evaluation keeps of a node from one pass to the next. The node owns it, so it survives
+	// edits that number the nodes differently.
+	struct STexGenNodeState
+	{
+		// of the node's values and the hashes of its inputs, an unchanged hash means the same output
+		uint64_t Hash = 0;
+		// hash of the content of the node's result, 0 while it has none
+		uint64_t RenderedHash = 0;
+		// false for nodes without a result of their own, values and the output
+		bool bIsDrawn = false;
+		// drawn as part of the pass of a node reading it, it has no result
+		bool bIsFused = false;
+		// read by the output, kept while it shows the result
+		bool bIsShown = false;
+		// node whose result this one samples when drawn, set when the graph is compiled
+		uint32_t DrawInput = FTexGenSchedule::NO_NODE;
+		// what the node's targets take once they are created, and what they take now, 0 without
+		uint64_t TargetBytes = 0;
+		uint64_t ResidentBytes = 0;
+		// the evaluator's use clock when the node was last drawn or read, the smallest is evicted first
+		uint64_t LastUsed = 0;
+	};
+
+	// What an evaluation needs of the GPU, FTexGen draws with Direct3D
+	class FTexGenBackend
+	{
+	public:
+		virtual ~FTexGenBackend() = default;
+
+		// hash of the type and the values of Node, folded with HashTexGenBytes
+		virtual uint64_t HashValues(const uint32_t Node) = 0;
+		// draws Node into its back target, the results of its inputs are current
+		virtual void Draw(const uint32_t Node) = 0;
+		// creates the targets of Node before its first draw or after it was evicted
+		virtual void CreateTargets(const uint32_t Node) = 0;
+		// evicts the targets of Node, the node is drawn again when something reads it
+		virtual void ReleaseTargets(const uint32_t Node) = 0;
+		// the pass finished, every back target drawn during it becomes visible at once
+		virtual void Present() = 0;
+		// the time budget is measured with it, from any fixed point
+		virtual double GetMilliseconds();
+	};
+
+	// Decides which nodes of a compiled graph are out of date and draws them, without anything of
+	// the GPU. A node is drawn again only when its own values or the result of one of its inputs
+	// changed, an edit redraws the nodes downstream of it and nothing else. A pass may be spread
+	// over several frames, what it drew only becomes visible once it finished. Results are kept
+	// below a cache budget by evicting the least recently used ones, a node reading an evicted
+	// result draws it again first.
+	class FTexGenEvaluator
+	{
+	public:
+		static constexpr uint32_t NO_NODE = FTexGenSchedule::NO_NODE;
+
+		// States holds one state per node of Schedule, both have to stay alive until the next SetGraph
+		void SetGraph(const FTexGenSchedule& Schedule, STexGenNodeState* const* States) noexcept;
+
+		// starts a pass over the schedule after an edit. Nodes the running pass drew keep their
+		// results and are skipped again unless the edit reached them.
+		void Restart() noexcept;
+		// goes on with the pass until it finished or Budget milliseconds were spent, at least one node
+		// is drawn per call and 0 finishes the pass. True when the pass finished and was presented.
+		// Without a pass it only evicts down to a lowered cache budget.
+		bool Update(FTexGenBackend& Backend, const float Budget);
+		// the backend released the targets of a node itself, because they went stale or the node was
+		// deleted
+		void OnTargetsReleased(STexGenNodeState& State) noexcept;
+
+		// bytes the targets may take, the node being drawn, the one it reads and the shown one are
+		// kept even above it
+		void SetCacheBudget(const uint64_t Bytes) noexcept { CacheBudget = Bytes; }
+		uint64_t GetCacheBudget() const noexcept { return CacheBudget; }
+		uint64_t GetResidentBytes() const noexcept { return ResidentBytes; }
+		uint64_t GetEvictionCount() const noexcept { return EvictionCount; }
+		// nodes drawn again because a node reading them was, their inputs did not change
+		uint64_t GetRecomputeCount() const noexcept { return RecomputeCount; }
+
+		bool IsEvaluating() const noexcept { return bIsEvaluating; }
+		// position of the running pass in the schedule's order
+		size_t GetCursor() const noexcept { return Cursor; }
+		// nodes drawn since the start, nodes with unchanged inputs are not counted
+		uint64_t GetEvaluationCount() const noexcept { return EvaluationCount; }
+		// nodes drawn by the last finished pass and the calls to Update it took
+		uint32_t GetLastEvaluationCount() const noexcept { return LastEvaluationCount; }
+		uint32_t GetLastFrameCount() const noexcept { return LastFrameCount; }
+
+	private:
+		// hashes Node from ValueHash and the hashes of its inputs, true when it has to be drawn
+		bool UpdateHash(const uint32_t Node, const uint64_t ValueHash) noexcept;
+		// draws Node, drawing the evicted nodes it reads first
+		void DrawNode(FTexGenBackend& Backend, const uint32_t Node);
+		// evicts least recently used results until Bytes more fit into the budget, keeping Drawn,
+		// Input and the shown node
+		void MakeRoom(FTexGenBackend& Backend, const uint64_t Bytes, const uint32_t Drawn, const uint32_t Input);
+
+		const FTexGenSchedule* Schedule = nullptr;
+		STexGenNodeState* const* States = nullptr;
+
+		bool bIsEvaluating = false;
+		size_t Cursor = 0;
+		uint32_t PassEvaluationCount = 0;
+		uint32_t PassFrameCount = 0;
+		uint64_t EvaluationCount = 0;
+		uint32_t LastEvaluationCount = 0;
+		uint32_t LastFrameCount = 0;
+
+		// every node reads one texture at most, so the evicted nodes in the way form a path
+		std::vector<uint32_t> RecomputeStack;
+		uint64_t ResidentBytes = 0;
+		uint64_t CacheBudget = 64ull << 20;
+		uint64_t UseClock = 0;
+		uint64_t EvictionCount = 0;
+		uint64_t RecomputeCount = 0;
+	};
+}
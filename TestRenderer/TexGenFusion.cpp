@@ -0,0 +1,210 @@
+#include "TexGenFusion.hpp"
+
+constexpr uint32_t Generator::FTexGenFusion::NO_CHAIN;
+
+namespace
+{
+	bool IsWarp(const Generator::ENodeType NodeType) noexcept
+	{
+		return NodeType == Generator::ENodeType::LOOP || NodeType == Generator::ENodeType::SINE;
+	}
+
+	bool IsGenerator(const Generator::ENodeType NodeType) noexcept
+	{
+		return NodeType == Generator::ENodeType::RECTANGLE || NodeType == Generator::ENodeType::ENVMAP;
+	}
+
+	// P[Base + Offset]
+	std::string Constant(const uint32_t Base, const uint32_t Offset)
+	{
+		return "P[" + std::to_string(Base + Offset) + "]";
+	}
+}
+
+uint32_t Generator::GetFusedVectorCount(const ENodeType NodeType) noexcept
+{
+	switch (NodeType)
+	{
+	case ENodeType::RECTANGLE:
+		return (sizeof(SRectangleParams) + 15) / 16;
+	case ENodeType::ENVMAP:
+		return (sizeof(SEnvMapParams) + 15) / 16;
+	case ENodeType::LOOP:
+		return (sizeof(SLoopParams) + 15) / 16;
+	case ENodeType::SINE:
+		return (sizeof(SSineDistParams) + 15) / 16;
+	default:
+		return 0;
+	}
+}
+
+void Generator::WriteFusedShader(const ENodeType* Types, const uint32_t Count, std::string& Hlsl)
+{
+	uint32_t VectorCount = 0;
+	for (uint32_t Index = 0; Index < Count; ++Index)
+	{
+		VectorCount += GetFusedVectorCount(Types[Index]);
+	}
+
+	Hlsl = "cbuffer Params : register(b0)\n{\n\tfloat4 P[" + std::to_string(VectorCount > 0 ? VectorCount : 1) + "];\n};\n"
+		"SamplerState ClampSampler : register(s0);\n"
+		"SamplerState WrapSampler : register(s1);\n"
+		"Texture2D Texture : register(t0);\n\n"
+		"float4 main(float4 Position : SV_POSITION, float2 t : TEXCOORD0) : SV_TARGET0\n{\n"
+		"\tconst float Pi = 3.14159265;\n";
+
+	// the bodies of the node shaders with t as the coordinate, see Loop.hlsl and the others
+	uint32_t Base = 0;
+	for (uint32_t Index = 0; Index < Count; ++Index)
+	{
+		const auto Type = Types[Index];
+		const bool bIsLast = Index + 1 == Count;
+		if (Type == ENodeType::LOOP)
+		{
+			Hlsl += "\tt *= " + Constant(Base, 0) + ".xy;\n";
+		}
+		else if (Type == ENodeType::SINE)
+		{
+			const auto D = Constant(Base, 0);
+			Hlsl += "\tt += float2(cos(" + D + ".x * Pi * 2 * t.y) * " + D + ".y, cos(" + D + ".z * Pi * 2 * t.x) * " + D + ".w);\n";
+		}
+		else if (Type == ENodeType::RECTANGLE)
+		{
+			const auto Data = Constant(Base, 0);
+			const auto Chamfer = Constant(Base, 1) + ".x";
+			const auto Falloff = Constant(Base, 1) + ".y";
+			Hlsl += "\tfloat dc = (1 + " + Chamfer + ") / 2;\n"
+				"\tfloat2 c = " + Data + ".xy - t + 0.5 / 255.0f;\n"
+				"\tfloat2 d = abs(c / " + Data + ".zw / dc);\n"
+				"\tfloat l = 1 - saturate(sqrt(pow(d.x, 2 / " + Chamfer + ") + pow(d.y, 2 / " + Chamfer + ")));\n"
+				"\treturn pow(abs(l + 0.5), 1 / " + Falloff + " * 10);\n";
+			break;
+		}
+		else if (Type == ENodeType::ENVMAP)
+		{
+			const auto Radius = Constant(Base, 0);
+			Hlsl += "\tfloat d = " + Radius + ".x - " + Radius + ".y;\n"
+				"\tfloat2 scle = (t - 0.5) / (" + Radius + ".zw * " + Radius + ".x);\n"
+				"\treturn 1 + (" + Radius + ".y - length(scle)) / d;\n";
+			break;
+		}
+		else
+		{
+			break;
+		}
+		Base += GetFusedVectorCount(Type);
+
+		// Loop.hlsl reads with the wrapping sampler, SineDist.hlsl with the clamping one
+		const bool bWraps = Type == ENodeType::LOOP;
+		if (bIsLast)
+		{
+			Hlsl += bWraps ? "\treturn Texture.Sample(WrapSampler, t).r;\n" : "\treturn Texture.Sample(ClampSampler, t).r;\n";
+		}
+		else
+		{
+			Hlsl += bWraps ? "\tt = frac(t);\n" : "\tt = saturate(t);\n";
+		}
+	}
+	if (Count == 0)
+	{
+		Hlsl += "\treturn 0;\n";
+	}
+	Hlsl += "}\n";
+}
+
+void Generator::FTexGenFusion::Clear() noexcept
+{
+	NodeChains.clear();
+	ChainOffsets.assign(1, 0);
+	ChainNodes.clear();
+	ChainTypes.clear();
+	Sources.clear();
+}
+
+void Generator::FTexGenFusion::Plan(const FTexGenSchedule& Schedule, const ENodeType* NodeTypes, const uint32_t* TextureSlots)
+{
+	Clear();
+	const auto NodeCount = Schedule.GetNodeCount();
+	const auto& Order = Schedule.GetOrder();
+	NodeChains.assign(NodeCount, NO_CHAIN);
+	Consumers.assign(NodeCount, 0);
+
+	const auto GetTextureInput = [&](const uint32_t Node)
+	{
+		const auto Slot = TextureSlots[Node];
+		return Slot < Schedule.GetInputCount(Node) ? Schedule.GetInputs(Node)[Slot] : FTexGenSchedule::NO_NODE;
+	};
+	// fusible nodes only have a texture output, so every read of one is a texture read
+	for (const auto Node : Order)
+	{
+		const auto Inputs = Schedule.GetInputs(Node);
+		for (uint32_t Slot = 0, Count = Schedule.GetInputCount(Node); Slot < Count; ++Slot)
+		{
+			if (Inputs[Slot] != FTexGenSchedule::NO_NODE)
+			{
+				++Consumers[Inputs[Slot]];
+			}
+		}
+	}
+
+	// consumers come after their inputs in the schedule, walking it backwards starts every chain
+	// at the warp that is drawn
+	for (auto Iterator = Order.rbegin(); Iterator != Order.rend(); ++Iterator)
+	{
+		const auto Last = *Iterator;
+		if (NodeChains[Last] != NO_CHAIN || !IsWarp(NodeTypes[Last]))
+		{
+			continue;
+		}
+
+		const auto Chain = static_cast<uint32_t>(Sources.size());
+		const auto First = ChainNodes.size();
+		auto Node = Last;
+		auto VectorCount = GetFusedVectorCount(NodeTypes[Node]);
+		auto Source = FTexGenSchedule::NO_NODE;
+		for (;;)
+		{
+			ChainNodes.push_back(Node);
+			ChainTypes.push_back(NodeTypes[Node]);
+			NodeChains[Node] = Chain;
+			if (IsGenerator(NodeTypes[Node]))
+			{
+				break;
+			}
+			const auto Input = GetTextureInput(Node);
+			if (Input == FTexGenSchedule::NO_NODE)
+			{
+				break;
+			}
+			const auto InputVectorCount = GetFusedVectorCount(NodeTypes[Input]);
+			if (Consumers[Input] != 1 || NodeChains[Input] != NO_CHAIN || InputVectorCount == 0 || VectorCount + InputVectorCount > TEXGEN_MAX_FUSED_VECTORS)
+			{
+				Source = Input;
+				break;
+			}
+			VectorCount += InputVectorCount;
+			Node = Input;
+		}
+
+		// a single warp is drawn with its own shader
+		if (ChainNodes.size() - First < 2)
+		{
+			NodeChains[Last] = NO_CHAIN;
+			ChainNodes.pop_back();
+			ChainTypes.pop_back();
+			continue;
+		}
+		Sources.push_back(Source);
+		ChainOffsets.push_back(static_cast<uint32_t>(ChainNodes.size()));
+	}
+}
+
+void Generator::FTexGenFusion::WriteChainKey(const uint32_t Chain, std::string& Key) const
+{
+	Key.clear();
+	const auto Types = GetChainTypes(Chain);
+	for (uint32_t Index = 0, Count = GetChainLength(Chain); Index < Count; ++Index)
+	{
+		Key.push_back(static_cast<char>('A' + static_cast<int>(Types[Index])));
+	}
+}
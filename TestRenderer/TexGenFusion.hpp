@@ -0,0 +1,56 @@
+#pragma once
+
+#include "TexGenKernels.hpp"
+#include "TexGenSchedule.hpp"
+
+#include <string>
+
+namespace Generator
+{
+	// the most float4 constants one fused shader reads, longer chains are split
+	static constexpr uint32_t TEXGEN_MAX_FUSED_VECTORS = 32;
+
+	// float4 constants a node takes in a fused shader, its constant buffer padded to whole float4s,
+	// 0 for nodes that cannot be fused
+	uint32_t GetFusedVectorCount(const ENodeType NodeType) noexcept;
+
+	// Pixel shader of a chain, Types runs from the node that is drawn back to its source. Every
+	// warp but the last one moves the coordinate and addresses it like the sampler the unfused node
+	// would have read with, a generator at the end is evaluated at the coordinate, a warp at the end
+	// samples t0. Constants are read in the same order from one float4 array in b0.
+	void WriteFusedShader(const ENodeType* Types, const uint32_t Count, std::string& Hlsl);
+
+	// Finds runs of coordinate warps (Loop, SineDist) and the generator (Rectangle, EnvMap) or warp
+	// they read from, where every node but the last is read by the next one only. Each run is drawn
+	// as one full screen pass by its last node, the others are not drawn at all.
+	class FTexGenFusion
+	{
+	public:
+		static constexpr uint32_t NO_CHAIN = ~0u;
+
+		// TextureSlots holds the input slot each warp reads its texture from, NO_NODE for none
+		void Plan(const FTexGenSchedule& Schedule, const ENodeType* NodeTypes, const uint32_t* TextureSlots);
+		void Clear() noexcept;
+
+		size_t GetChainCount() const noexcept { return Sources.size(); }
+		// chain a node is part of, NO_CHAIN when it is drawn on its own
+		uint32_t GetChain(const uint32_t Node) const noexcept { return Node < NodeChains.size() ? NodeChains[Node] : NO_CHAIN; }
+		// the node that is drawn comes first, every other one is fused into it
+		const uint32_t* GetChainNodes(const uint32_t Chain) const noexcept { return ChainNodes.data() + ChainOffsets[Chain]; }
+		const ENodeType* GetChainTypes(const uint32_t Chain) const noexcept { return ChainTypes.data() + ChainOffsets[Chain]; }
+		uint32_t GetChainLength(const uint32_t Chain) const noexcept { return ChainOffsets[Chain + 1] - ChainOffsets[Chain]; }
+		// node whose texture the chain samples, NO_NODE when it ends with a generator or is unconnected
+		uint32_t GetChainSource(const uint32_t Chain) const noexcept { return Sources[Chain]; }
+		// the same key means the same shader, the types of the nodes as characters
+		void WriteChainKey(const uint32_t Chain, std::string& Key) const;
+
+	private:
+		std::vector<uint32_t> NodeChains;
+		std::vector<uint32_t> ChainOffsets;
+		std::vector<uint32_t> ChainNodes;
+		std::vector<ENodeType> ChainTypes;
+		std::vector<uint32_t> Sources;
+		// reads of each node within the schedule
+		std::vector<uint32_t> Consumers;
+	};
+}
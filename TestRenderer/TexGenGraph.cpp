@@ -0,0 +1,385 @@
+#include "TexGenGraph.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+constexpr uint32_t Generator::FTexGenGraph::NO_NODE;
+
+namespace
+{
+	constexpr uint32_t NO_SLOT = ~0u;
+
+	// the defaults are the ones the UpdateParams of the editor's nodes fall back to
+	const Generator::STexGenSlot LOOP_SLOTS[] = {
+		{ "Repeat", Generator::NodeSlotFloat2, DirectX::XMFLOAT4(1.0f, 1.0f, 0.0f, 0.0f) },
+		{ "Input", Generator::NodeSlotTexture, DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f) },
+	};
+	const Generator::STexGenSlot RECTANGLE_SLOTS[] = {
+		{ "Position", Generator::NodeSlotFloat4, DirectX::XMFLOAT4(0.5f, 0.5f, 1.0f, 1.0f) },
+		{ "Chamfer", Generator::NodeSlotFloat, DirectX::XMFLOAT4(3.0f, 0.0f, 0.0f, 0.0f) },
+		{ "Falloff", Generator::NodeSlotFloat, DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f) },
+	};
+	const Generator::STexGenSlot SINE_SLOTS[] = {
+		{ "Count", Generator::NodeSlotFloat2, DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f) },
+		{ "Amplitude", Generator::NodeSlotFloat2, DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f) },
+		{ "Input", Generator::NodeSlotTexture, DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f) },
+	};
+	const Generator::STexGenSlot ENVMAP_SLOTS[] = {
+		{ "Radius", Generator::NodeSlotFloat4, DirectX::XMFLOAT4(0.5f, 0.0f, 1.0f, 1.0f) },
+	};
+	const Generator::STexGenSlot OUTPUT_SLOTS[] = {
+		{ "Input", Generator::NodeSlotTexture, DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f) },
+	};
+
+	struct SNodeTypeInfo
+	{
+		const char* Name;
+		uint32_t OutputKind;
+		const Generator::STexGenSlot* Slots;
+		uint32_t SlotCount;
+		// the slot of the texture the node transforms, NO_SLOT for generators
+		uint32_t TextureSlot;
+		// what AUTO and 0 select before falling back to the input's, as in the editor's constructors
+		Generator::ETexGenFormat DefaultFormat;
+		uint32_t DefaultResolution;
+	};
+
+	// in ENodeType order
+	const SNodeTypeInfo NODE_TYPES[] = {
+		{ "Scalar", Generator::NodeSlotFloat, nullptr, 0, NO_SLOT, Generator::ETexGenFormat::AUTO, 0 },
+		{ "Vector2", Generator::NodeSlotFloat2, nullptr, 0, NO_SLOT, Generator::ETexGenFormat::AUTO, 0 },
+		{ "Vector4", Generator::NodeSlotFloat4, nullptr, 0, NO_SLOT, Generator::ETexGenFormat::AUTO, 0 },
+		{ "Loop", Generator::NodeSlotTexture, LOOP_SLOTS, 2, 1, Generator::ETexGenFormat::AUTO, 0 },
+		{ "Rectangle", Generator::NodeSlotTexture, RECTANGLE_SLOTS, 3, NO_SLOT, Generator::ETexGenFormat::R8, Generator::TEXGEN_DEFAULT_RESOLUTION },
+		{ "SineDist", Generator::NodeSlotTexture, SINE_SLOTS, 3, 2, Generator::ETexGenFormat::AUTO, 0 },
+		{ "EnvMap", Generator::NodeSlotTexture, ENVMAP_SLOTS, 1, NO_SLOT, Generator::ETexGenFormat::R16, Generator::TEXGEN_DEFAULT_RESOLUTION },
+		{ "Output", 0, OUTPUT_SLOTS, 1, 0, Generator::ETexGenFormat::AUTO, 0 },
+	};
+	constexpr size_t NODE_TYPE_COUNT = sizeof(NODE_TYPES) / sizeof(NODE_TYPES[0]);
+
+	const char* const FORMAT_NAMES[] = { "Auto", "R8", "R16", "R16F", "RGBA8", "RGBA16F" };
+	constexpr size_t FORMAT_COUNT = sizeof(FORMAT_NAMES) / sizeof(FORMAT_NAMES[0]);
+
+	const SNodeTypeInfo& GetInfo(const Generator::ENodeType Type) noexcept
+	{
+		// anything else is taken as the output node, which nothing can read from
+		const auto Index = static_cast<size_t>(Type);
+		return NODE_TYPES[Index < NODE_TYPE_COUNT ? Index : NODE_TYPE_COUNT - 1];
+	}
+}
+
+const char* Generator::GetNodeTypeName(const ENodeType Type) noexcept
+{
+	return static_cast<size_t>(Type) < NODE_TYPE_COUNT ? NODE_TYPES[static_cast<size_t>(Type)].Name : nullptr;
+}
+
+bool Generator::FindNodeType(const char* Name, ENodeType& Type) noexcept
+{
+	for (size_t Index = 0; Index < NODE_TYPE_COUNT; ++Index)
+	{
+		if (strcmp(NODE_TYPES[Index].Name, Name) == 0)
+		{
+			Type = static_cast<ENodeType>(Index);
+			return true;
+		}
+	}
+	return false;
+}
+
+const Generator::STexGenSlot* Generator::GetInputSlots(const ENodeType Type, uint32_t& Count) noexcept
+{
+	const auto& Info = GetInfo(Type);
+	Count = Info.SlotCount;
+	return Info.Slots;
+}
+
+uint32_t Generator::GetOutputKind(const ENodeType Type) noexcept
+{
+	return GetInfo(Type).OutputKind;
+}
+
+const char* Generator::GetFormatName(const ETexGenFormat Format) noexcept
+{
+	return static_cast<size_t>(Format) < FORMAT_COUNT ? FORMAT_NAMES[static_cast<size_t>(Format)] : FORMAT_NAMES[0];
+}
+
+bool Generator::FindFormat(const char* Name, ETexGenFormat& Format) noexcept
+{
+	for (size_t Index = 0; Index < FORMAT_COUNT; ++Index)
+	{
+		if (strcmp(FORMAT_NAMES[Index], Name) == 0)
+		{
+			Format = static_cast<ETexGenFormat>(Index);
+			return true;
+		}
+	}
+	return false;
+}
+
+Generator::FTexGenGraph Generator::FTexGenGraph::MakeDefault()
+{
+	FTexGenGraph Graph;
+	const auto Position = Graph.AddNode(ENodeType::VECTOR4, -300.0f, 350.0f);
+	Graph.GetNode(Position).Value = DirectX::XMFLOAT4(0.75f, 0.5f, 0.5f, 1.0f);
+	const auto Chamfer = Graph.AddNode(ENodeType::SCALAR, -300.0f, 450.0f);
+	const auto Rectangle = Graph.AddNode(ENodeType::RECTANGLE, 100.0f, 400.0f);
+	const auto Output = Graph.AddNode(ENodeType::OUTPUT, 500.0f, 400.0f);
+	Graph.Connect(Rectangle, 0, Position);
+	Graph.Connect(Rectangle, 1, Chamfer);
+	Graph.Connect(Output, 0, Rectangle);
+	Graph.SetOutput(Output);
+	return Graph;
+}
+
+void Generator::FTexGenGraph::Clear() noexcept
+{
+	Nodes.clear();
+	Edges.clear();
+	Output = NO_NODE;
+}
+
+uint32_t Generator::FTexGenGraph::AddNode(const ENodeType Type, const float X, const float Y)
+{
+	Nodes.push_back({ Type, X, Y, DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f), ETexGenFormat::AUTO, 0 });
+	return static_cast<uint32_t>(Nodes.size() - 1);
+}
+
+bool Generator::FTexGenGraph::Connect(const uint32_t Node, const uint32_t Slot, const uint32_t Input)
+{
+	if (Node >= Nodes.size() || Input >= Nodes.size())
+	{
+		return false;
+	}
+	uint32_t SlotCount = 0;
+	const auto Slots = GetInputSlots(Nodes[Node].Type, SlotCount);
+	if (Slot >= SlotCount || static_cast<uint32_t>(Slots[Slot].Kind) != GetOutputKind(Nodes[Input].Type))
+	{
+		return false;
+	}
+	for (auto& Edge : Edges)
+	{
+		if (Edge.Node == Node && Edge.Slot == Slot)
+		{
+			Edge.Input = Input;
+			return true;
+		}
+	}
+	Edges.push_back({ Node, Slot, Input });
+	return true;
+}
+
+bool Generator::FTexGenGraph::SetOutput(const uint32_t Node) noexcept
+{
+	if (Node >= Nodes.size() || Nodes[Node].Type != ENodeType::OUTPUT)
+	{
+		return false;
+	}
+	Output = Node;
+	return true;
+}
+
+bool Generator::FTexGenGraph::Save(const char* FileName) const noexcept
+{
+	FILE* File = fopen(FileName, "w");
+	if (File == nullptr)
+	{
+		return false;
+	}
+	fprintf(File, "texgengraph %u\n", VERSION);
+	for (const auto& Node : Nodes)
+	{
+		// a type without a name could not be loaded again, rather fail than write a broken file
+		const char* TypeName = GetNodeTypeName(Node.Type);
+		if (TypeName == nullptr)
+		{
+			fclose(File);
+			return false;
+		}
+		// 9 significant digits round trip a float exactly, a baked graph gives the editor's pixels
+		fprintf(File, "node %s %.9g %.9g %s %u %.9g %.9g %.9g %.9g\n", TypeName, Node.X, Node.Y, GetFormatName(Node.Format), Node.Resolution,
+			Node.Value.x, Node.Value.y, Node.Value.z, Node.Value.w);
+	}
+	for (const auto& Edge : Edges)
+	{
+		uint32_t SlotCount = 0;
+		fprintf(File, "link %u %s %u\n", Edge.Node, GetInputSlots(Nodes[Edge.Node].Type, SlotCount)[Edge.Slot].Name, Edge.Input);
+	}
+	if (Output != NO_NODE)
+	{
+		fprintf(File, "output %u\n", Output);
+	}
+	const bool bWritten = ferror(File) == 0;
+	fclose(File);
+	return bWritten;
+}
+
+bool Generator::FTexGenGraph::Load(const char* FileName)
+{
+	FILE* File = fopen(FileName, "r");
+	if (File == nullptr)
+	{
+		return false;
+	}
+	uint32_t Version = 0;
+	FTexGenGraph Loaded;
+	bool bValid = fscanf(File, " texgengraph %u", &Version) == 1 && Version == VERSION;
+	char Keyword[16];
+	char Name[32];
+	char Format[16];
+	while (bValid && fscanf(File, " %15s", Keyword) == 1)
+	{
+		// links and the output refer to nodes by their position in the file, so they follow them
+		if (strcmp(Keyword, "node") == 0)
+		{
+			STexGenGraphNode Node{};
+			bValid = fscanf(File, " %31s %f %f %15s %u %f %f %f %f", Name, &Node.X, &Node.Y, Format, &Node.Resolution, &Node.Value.x, &Node.Value.y, &Node.Value.z, &Node.Value.w) == 9 &&
+				FindNodeType(Name, Node.Type) && FindFormat(Format, Node.Format);
+			Loaded.Nodes.push_back(Node);
+		}
+		else if (strcmp(Keyword, "link") == 0)
+		{
+			uint32_t Node = 0;
+			uint32_t Input = 0;
+			bValid = fscanf(File, " %u %31s %u", &Node, Name, &Input) == 3 && Node < Loaded.Nodes.size();
+			uint32_t Slot = 0;
+			uint32_t SlotCount = 0;
+			const auto Slots = bValid ? GetInputSlots(Loaded.Nodes[Node].Type, SlotCount) : nullptr;
+			while (Slot < SlotCount && strcmp(Slots[Slot].Name, Name) != 0)
+			{
+				++Slot;
+			}
+			bValid = bValid && Loaded.Connect(Node, Slot, Input);
+		}
+		else if (strcmp(Keyword, "output") == 0)
+		{
+			uint32_t Node = 0;
+			bValid = fscanf(File, " %u", &Node) == 1 && Loaded.SetOutput(Node);
+		}
+		else
+		{
+			bValid = false;
+		}
+	}
+	bValid = bValid && feof(File);
+	fclose(File);
+	if (!bValid)
+	{
+		return false;
+	}
+	*this = std::move(Loaded);
+	return true;
+}
+
+void Generator::FTexGenGraph::Compile(FTexGenSchedule& Schedule) const
+{
+	std::vector<uint32_t> SlotCounts(Nodes.size() + 1);
+	for (size_t Index = 0; Index < Nodes.size(); ++Index)
+	{
+		GetInputSlots(Nodes[Index].Type, SlotCounts[Index]);
+	}
+	Schedule.Compile(SlotCounts.data(), Nodes.size(), Edges.data(), Edges.size(), Output);
+}
+
+void Generator::FTexGenGraph::ResolveOutput(ETexGenFormat& Format, uint32_t& Resolution) const
+{
+	Format = ETexGenFormat::R8;
+	Resolution = TEXGEN_DEFAULT_RESOLUTION;
+	FTexGenSchedule Schedule;
+	Compile(Schedule);
+	if (Schedule.GetOrder().empty())
+	{
+		return;
+	}
+
+	// inputs come first in the order, so theirs are resolved when a node takes them
+	std::vector<ETexGenFormat> Formats(Nodes.size(), ETexGenFormat::R8);
+	std::vector<uint32_t> Resolutions(Nodes.size(), TEXGEN_DEFAULT_RESOLUTION);
+	for (const auto Node : Schedule.GetOrder())
+	{
+		const auto& Info = GetInfo(Nodes[Node].Type);
+		const auto Input = Info.TextureSlot < Schedule.GetInputCount(Node) ? Schedule.GetInputs(Node)[Info.TextureSlot] : NO_NODE;
+		auto NodeFormat = Nodes[Node].Format != ETexGenFormat::AUTO ? Nodes[Node].Format : Info.DefaultFormat;
+		if (NodeFormat == ETexGenFormat::AUTO)
+		{
+			NodeFormat = Input != NO_NODE ? Formats[Input] : ETexGenFormat::R8;
+		}
+		auto NodeResolution = Nodes[Node].Resolution != 0 ? Nodes[Node].Resolution : Info.DefaultResolution;
+		if (NodeResolution == 0)
+		{
+			NodeResolution = Input != NO_NODE ? Resolutions[Input] : TEXGEN_DEFAULT_RESOLUTION;
+		}
+		Formats[Node] = NodeFormat;
+		Resolutions[Node] = NodeResolution;
+	}
+	Format = Formats[Output];
+	Resolution = Resolutions[Output];
+}
+
+uint32_t Generator::FTexGenGraph::AddToCpuGraph(FTexGenCpuGraph& CpuGraph) const
+{
+	FTexGenSchedule Schedule;
+	Compile(Schedule);
+
+	// inputs dropped by the schedule read the slot defaults like unconnected ones
+	std::vector<uint32_t> CpuNodes(Nodes.size(), FTexGenCpuGraph::NO_INPUT);
+	const auto GetValue = [&](const uint32_t Node, const uint32_t Slot)
+	{
+		const auto Input = Schedule.GetInputs(Node)[Slot];
+		uint32_t SlotCount = 0;
+		return Input != NO_NODE ? Nodes[Input].Value : GetInputSlots(Nodes[Node].Type, SlotCount)[Slot].Default;
+	};
+	const auto GetCpuInput = [&](const uint32_t Node, const uint32_t Slot)
+	{
+		const auto Input = Schedule.GetInputs(Node)[Slot];
+		return Input != NO_NODE ? CpuNodes[Input] : FTexGenCpuGraph::NO_INPUT;
+	};
+	for (const auto Node : Schedule.GetOrder())
+	{
+		switch (Nodes[Node].Type)
+		{
+		case ENodeType::RECTANGLE:
+		{
+			SRectangleParams Params{};
+			Params.Data = GetValue(Node, 0);
+			Params.Chamfer = GetValue(Node, 1).x;
+			Params.Falloff = GetValue(Node, 2).x;
+			CpuNodes[Node] = CpuGraph.AddRectangle(Params);
+			break;
+		}
+		case ENodeType::ENVMAP:
+		{
+			SEnvMapParams Params{};
+			Params.Radius = GetValue(Node, 0);
+			CpuNodes[Node] = CpuGraph.AddEnvMap(Params);
+			break;
+		}
+		case ENodeType::LOOP:
+		{
+			const auto Repeat = GetValue(Node, 0);
+			SLoopParams Params{};
+			Params.Repeat = DirectX::XMFLOAT2(Repeat.x, Repeat.y);
+			CpuNodes[Node] = CpuGraph.AddLoop(Params, GetCpuInput(Node, 1));
+			break;
+		}
+		case ENodeType::SINE:
+		{
+			const auto Count = GetValue(Node, 0);
+			const auto Amplitude = GetValue(Node, 1);
+			SSineDistParams Params{};
+			Params.CountX = Count.x;
+			Params.CountY = Count.y;
+			Params.AmplX = Amplitude.x;
+			Params.AmplY = Amplitude.y;
+			CpuNodes[Node] = CpuGraph.AddSineDist(Params, GetCpuInput(Node, 2));
+			break;
+		}
+		case ENodeType::OUTPUT:
+			CpuNodes[Node] = GetCpuInput(Node, 0);
+			break;
+		default:
+			break;
+		}
+	}
+	return Output != NO_NODE ? CpuNodes[Output] : FTexGenCpuGraph::NO_INPUT;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "TexGenKernels.hpp"
+#include "TexGenSchedule.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace Generator
+{
+	/// Formats a texture node can render to. Every node writes grey, so one channel is enough unless a
+	/// later consumer needs more, RGBA8 is the sRGB format all nodes used to have.
+	enum class ETexGenFormat : uint8_t
+	{
+		AUTO,
+		R8,
+		R16,
+		R16F,
+		RGBA8,
+		RGBA16F
+	};
+
+	static constexpr uint32_t TEXGEN_DEFAULT_RESOLUTION = 1024;
+
+	enum ENodeSlotTypes
+	{
+		NodeSlotTexture = 1,
+		NodeSlotFloat,
+		NodeSlotFloat2,
+		NodeSlotFloat4
+	};
+
+	struct STexGenSlot
+	{
+		const char* Name;
+		ENodeSlotTypes Kind;
+		// what the node reads while the slot is unconnected, the components the kind has
+		DirectX::XMFLOAT4 Default;
+	};
+
+	// the titles of the editor's nodes, "Rectangle" for RECTANGLE
+	const char* GetNodeTypeName(const ENodeType Type) noexcept;
+	bool FindNodeType(const char* Name, ENodeType& Type) noexcept;
+	// input slots in the order the editor's nodes list them, Count is set to their number
+	const STexGenSlot* GetInputSlots(const ENodeType Type, uint32_t& Count) noexcept;
+	// kind of the only output slot, 0 for the output node which has none
+	uint32_t GetOutputKind(const ENodeType Type) noexcept;
+	// "Auto", "R8" and so on
+	const char* GetFormatName(const ETexGenFormat Format) noexcept;
+	bool FindFormat(const char* Name, ETexGenFormat& Format) noexcept;
+
+	struct STexGenGraphNode
+	{
+		ENodeType Type;
+		// position on the editor canvas
+		float X;
+		float Y;
+		// of Scalar, Vector2 and Vector4 nodes, the components they do not have are 0
+		DirectX::XMFLOAT4 Value;
+		// what was picked on a texture node, AUTO and 0 select the defaults
+		ETexGenFormat Format;
+		uint32_t Resolution;
+	};
+
+	// A TexGen node graph without anything of the GPU, what the editor saves and loads and
+	// TexGenBaker bakes. Stored as text after a version line: one
+	// "node <type> <x> <y> <format> <resolution> <value x> <y> <z> <w>" line per node, numbered from
+	// 0 in file order, then "link <node> <slot> <input node>" lines and an "output <node>" line.
+	class FTexGenGraph
+	{
+	public:
+		static constexpr uint32_t VERSION = 1;
+		static constexpr uint32_t NO_NODE = FTexGenSchedule::NO_NODE;
+
+		// the graph the editor starts with, a rectangle with a Vector4 position and a Scalar chamfer
+		static FTexGenGraph MakeDefault();
+
+		void Clear() noexcept;
+		uint32_t AddNode(const ENodeType Type, const float X, const float Y);
+		STexGenGraphNode& GetNode(const uint32_t Node) noexcept { return Nodes[Node]; }
+		// false when a node or the slot does not exist or the output of Input is of another kind than
+		// the slot. A second link into a slot replaces the first.
+		bool Connect(const uint32_t Node, const uint32_t Slot, const uint32_t Input);
+		// false unless Node is an output node
+		bool SetOutput(const uint32_t Node) noexcept;
+
+		bool Save(const char* FileName) const noexcept;
+		bool Load(const char* FileName);
+
+		const std::vector<STexGenGraphNode>& GetNodes() const noexcept { return Nodes; }
+		const std::vector<STexGenEdge>& GetEdges() const noexcept { return Edges; }
+		uint32_t GetOutput() const noexcept { return Output; }
+
+		// format and resolution of the output as the editor resolves them, R8 at
+		// TEXGEN_DEFAULT_RESOLUTION when nothing is connected to it
+		void ResolveOutput(ETexGenFormat& Format, uint32_t& Resolution) const;
+		// adds the nodes the output depends on to CpuGraph, with the parameters the editor's nodes
+		// give their shaders, and returns the node of the output. NO_INPUT when there is no output or
+		// nothing is connected to it.
+		uint32_t AddToCpuGraph(FTexGenCpuGraph& CpuGraph) const;
+
+	private:
+		void Compile(FTexGenSchedule& Schedule) const;
+
+		std::vector<STexGenGraphNode> Nodes;
+		std::vector<STexGenEdge> Edges;
+		uint32_t Output = NO_NODE;
+	};
+}
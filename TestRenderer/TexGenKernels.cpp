@@ -0,0 +1,762 @@
+#include "TexGenKernels.hpp"
+#include "JobSystem.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+constexpr uint32_t Generator::FTexGenCpuGraph::NO_INPUT;
+
+namespace
+{
+	using FClock = std::chrono::high_resolution_clock;
+
+	// HLSL pow is exp2(y * log2(x)), which is what makes zero and infinite exponents of the
+	// default parameters come out like on the GPU
+	DirectX::XMVECTOR Pow(DirectX::FXMVECTOR X, DirectX::FXMVECTOR Y) noexcept
+	{
+		return DirectX::XMVectorExp2(DirectX::XMVectorMultiply(Y, DirectX::XMVectorLog2(X)));
+	}
+
+	const float* GetSrgbDecodeTable() noexcept
+	{
+		static const auto Table = []()
+		{
+			std::array<float, 256> Values{};
+			for (size_t Index = 0; Index < Values.size(); ++Index)
+			{
+				const float Encoded = Index / 255.0f;
+				Values[Index] = Encoded <= 0.04045f ? Encoded / 12.92f : std::pow((Encoded + 0.055f) / 1.055f, 2.4f);
+			}
+			return Values;
+		}();
+		return Table.data();
+	}
+
+	// what the output merger does writing to an sRGB target, before the conversion to 8 bits
+	DirectX::XMVECTOR EncodeSrgb(DirectX::FXMVECTOR Linear) noexcept
+	{
+		const auto Clamped = DirectX::XMVectorSaturate(Linear);
+		const auto Curve = DirectX::XMVectorSubtract(DirectX::XMVectorScale(Pow(Clamped, DirectX::XMVectorReplicate(1.0f / 2.4f)), 1.055f), DirectX::XMVectorReplicate(0.055f));
+		const auto Toe = DirectX::XMVectorScale(Clamped, 12.92f);
+		return DirectX::XMVectorSelect(Curve, Toe, DirectX::XMVectorLessOrEqual(Clamped, DirectX::XMVectorReplicate(0.0031308f)));
+	}
+
+	// NaN becomes zero like in the float to UNORM conversion rules
+	uint32_t ToUnorm8(const float Value) noexcept
+	{
+		return Value > 0.0f ? (Value < 1.0f ? static_cast<uint32_t>(Value * 255.0f + 0.5f) : 255u) : 0u;
+	}
+
+	// Rectangle and EnvMap write the same value to every channel
+	void StoreGray(DirectX::FXMVECTOR Linear, uint32_t* Pixels, const uint32_t Count) noexcept
+	{
+		DirectX::XMFLOAT4 Alpha;
+		DirectX::XMFLOAT4 Color;
+		DirectX::XMStoreFloat4(&Alpha, Linear);
+		DirectX::XMStoreFloat4(&Color, EncodeSrgb(Linear));
+		const float AlphaLanes[4] = { Alpha.x, Alpha.y, Alpha.z, Alpha.w };
+		const float ColorLanes[4] = { Color.x, Color.y, Color.z, Color.w };
+		for (uint32_t Lane = 0; Lane < Count; ++Lane)
+		{
+			const auto Encoded = ToUnorm8(ColorLanes[Lane]);
+			Pixels[Lane] = Encoded | Encoded << 8 | Encoded << 16 | ToUnorm8(AlphaLanes[Lane]) << 24;
+		}
+	}
+
+	uint32_t StoreColor(DirectX::FXMVECTOR Linear) noexcept
+	{
+		DirectX::XMFLOAT4 Alpha;
+		DirectX::XMFLOAT4 Color;
+		DirectX::XMStoreFloat4(&Alpha, Linear);
+		DirectX::XMStoreFloat4(&Color, EncodeSrgb(Linear));
+		return ToUnorm8(Color.x) | ToUnorm8(Color.y) << 8 | ToUnorm8(Color.z) << 16 | ToUnorm8(Alpha.w) << 24;
+	}
+
+	DirectX::XMVECTOR LoadColor(const uint32_t Pixel, const float* DecodeTable) noexcept
+	{
+		return DirectX::XMVectorSet(DecodeTable[Pixel & 0xFF], DecodeTable[Pixel >> 8 & 0xFF], DecodeTable[Pixel >> 16 & 0xFF], (Pixel >> 24) / 255.0f);
+	}
+
+	// an image or a window of one, Width and Height are those of the whole image and the window
+	// starts at StartX, StartY, wrapping around at the right and bottom edges
+	struct SImageView
+	{
+		const uint32_t* Pixels;
+		int32_t Width;
+		int32_t Height;
+		int32_t StartX;
+		int32_t StartY;
+		size_t Stride;
+	};
+
+	SImageView MakeView(const Generator::STexGenImage& Image) noexcept
+	{
+		return { Image.Pixels.data(), static_cast<int32_t>(Image.Width), static_cast<int32_t>(Image.Height), 0, 0, Image.Width };
+	}
+
+	// bilinear filtering like the LinearWrap and LinearClamp samplers, in linear space since
+	// sRGB textures are decoded before they are filtered. Texels are addressed in the whole image
+	// and have to be inside the window.
+	template <bool bWrap>
+	DirectX::XMVECTOR Sample(const SImageView& Image, const float U, const float V, const float* DecodeTable) noexcept
+	{
+		const float X = U * Image.Width - 0.5f;
+		const float Y = V * Image.Height - 0.5f;
+		const float BaseX = std::floor(X);
+		const float BaseY = std::floor(Y);
+		const int32_t Width = Image.Width;
+		const int32_t Height = Image.Height;
+		const auto Address = [](const int32_t Coordinate, const int32_t Size)
+		{
+			return bWrap ? (Coordinate % Size + Size) % Size : std::min(std::max(Coordinate, 0), Size - 1);
+		};
+		const auto Local = [](const int32_t Coordinate, const int32_t Start, const int32_t Size)
+		{
+			const int32_t Offset = Coordinate - Start;
+			return Offset < 0 ? Offset + Size : Offset;
+		};
+		const int32_t X0 = Local(Address(static_cast<int32_t>(BaseX), Width), Image.StartX, Width);
+		const int32_t X1 = Local(Address(static_cast<int32_t>(BaseX) + 1, Width), Image.StartX, Width);
+		const uint32_t* Row0 = Image.Pixels + static_cast<size_t>(Local(Address(static_cast<int32_t>(BaseY), Height), Image.StartY, Height)) * Image.Stride;
+		const uint32_t* Row1 = Image.Pixels + static_cast<size_t>(Local(Address(static_cast<int32_t>(BaseY) + 1, Height), Image.StartY, Height)) * Image.Stride;
+		const auto Top = DirectX::XMVectorLerp(LoadColor(Row0[X0], DecodeTable), LoadColor(Row0[X1], DecodeTable), X - BaseX);
+		const auto Bottom = DirectX::XMVectorLerp(LoadColor(Row1[X0], DecodeTable), LoadColor(Row1[X1], DecodeTable), X - BaseX);
+		return DirectX::XMVectorLerp(Top, Bottom, Y - BaseY);
+	}
+
+	void ResizeImage(Generator::STexGenImage& Image, const uint32_t Width, const uint32_t Height)
+	{
+		Image.Width = Width;
+		Image.Height = Height;
+		Image.Pixels.resize(static_cast<size_t>(Width) * Height);
+	}
+
+	// Function(X, Y, Count, U, V) for every run of up to four pixels in the rows of a tile of
+	// Region, X and Y within the region, with the texture coordinates of their centers in the
+	// Width x Height image in the lanes of U and V. Tiles run in parallel.
+	template <typename TFunction>
+	void ForEachQuad(const Generator::STexGenRegion& Region, const uint32_t Width, const uint32_t Height, TFunction Function)
+	{
+		using namespace Generator;
+		const uint32_t TilesX = (Region.Width + TEXGEN_TILE_SIZE - 1) / TEXGEN_TILE_SIZE;
+		const uint32_t TilesY = (Region.Height + TEXGEN_TILE_SIZE - 1) / TEXGEN_TILE_SIZE;
+		const float InverseWidth = 1.0f / Width;
+		const float InverseHeight = 1.0f / Height;
+		const auto WrapX = [&](const uint32_t X) { return static_cast<float>(Region.X + X < Width ? Region.X + X : Region.X + X - Width); };
+		ParallelFor(static_cast<size_t>(TilesX) * TilesY, 1, [&](const size_t Begin, const size_t End)
+		{
+			for (size_t Tile = Begin; Tile < End; ++Tile)
+			{
+				const uint32_t StartX = static_cast<uint32_t>(Tile % TilesX) * TEXGEN_TILE_SIZE;
+				const uint32_t StartY = static_cast<uint32_t>(Tile / TilesX) * TEXGEN_TILE_SIZE;
+				const uint32_t EndX = std::min(StartX + TEXGEN_TILE_SIZE, Region.Width);
+				const uint32_t EndY = std::min(StartY + TEXGEN_TILE_SIZE, Region.Height);
+				for (uint32_t Y = StartY; Y < EndY; ++Y)
+				{
+					const uint32_t ImageY = Region.Y + Y < Height ? Region.Y + Y : Region.Y + Y - Height;
+					const auto V = DirectX::XMVectorReplicate((ImageY + 0.5f) * InverseHeight);
+					for (uint32_t X = StartX; X < EndX; X += 4)
+					{
+						const auto U = DirectX::XMVectorScale(DirectX::XMVectorSet(WrapX(X) + 0.5f, WrapX(X + 1) + 0.5f, WrapX(X + 2) + 0.5f, WrapX(X + 3) + 0.5f), InverseWidth);
+						Function(X, Y, std::min(4u, EndX - X), U, V);
+					}
+				}
+			}
+		});
+	}
+
+	// Texels of an axis of Size texels that bilinear samples between the coordinates Low and
+	// High read, one more on either side for rounding. The whole axis when the samples are too far
+	// out for float to place them within a texel.
+	void ReadSpan(const double Low, const double High, const uint32_t Size, const bool bWrap, uint32_t& Start, uint32_t& Length) noexcept
+	{
+		const double First = std::floor(Low * Size - 0.5) - 1.0;
+		const double Last = std::floor(High * Size - 0.5) + 2.0;
+		if (!(First <= Last) || std::fabs(First) > 4194304.0 || std::fabs(Last) > 4194304.0 || (bWrap && Last - First + 1.0 >= Size))
+		{
+			Start = 0;
+			Length = Size;
+		}
+		else if (bWrap)
+		{
+			const auto Wrapped = static_cast<int64_t>(First) % Size;
+			Start = static_cast<uint32_t>(Wrapped < 0 ? Wrapped + Size : Wrapped);
+			Length = static_cast<uint32_t>(Last - First + 1.0);
+		}
+		else
+		{
+			Start = static_cast<uint32_t>(std::min(std::max(First, 0.0), Size - 1.0));
+			Length = static_cast<uint32_t>(std::min(std::max(Last, 0.0), Size - 1.0)) - Start + 1;
+		}
+	}
+
+	// texture coordinates of the first and last texel centers of a span, all of the axis when the
+	// span wraps around
+	void GetCoordinates(const uint32_t Start, const uint32_t Length, const uint32_t Size, double& Low, double& High) noexcept
+	{
+		const bool bWraps = Start + Length > Size;
+		Low = ((bWraps ? 0 : Start) + 0.5) / Size;
+		High = ((bWraps ? Size : Start + Length) - 0.5) / Size;
+	}
+
+	// the rows of its input a Loop or SineDist node reads for Count rows of its image from Y on
+	void GetInputRows(const Generator::ENodeType Type, const Generator::SLoopParams& Loop, const Generator::SSineDistParams& SineDist,
+		const uint32_t Y, const uint32_t Count, const uint32_t Height, uint32_t& InputY, uint32_t& InputCount) noexcept
+	{
+		double Low, High;
+		GetCoordinates(Y, Count, Height, Low, High);
+		if (Type == Generator::ENodeType::LOOP)
+		{
+			ReadSpan(std::min(Low * Loop.Repeat.y, High * Loop.Repeat.y), std::max(Low * Loop.Repeat.y, High * Loop.Repeat.y), Height, true, InputY, InputCount);
+		}
+		else
+		{
+			// the cosine moves a coordinate by at most its amplitude
+			ReadSpan(Low - std::fabs(SineDist.AmplY), High + std::fabs(SineDist.AmplY), Height, false, InputY, InputCount);
+		}
+	}
+
+	// The rows of a window from Y on that an earlier window from OldY on holds as well, as an offset
+	// into the new window. Windows wrap around at Height. Only one run is found where the two
+	// overlap twice.
+	bool FindSharedRows(const uint32_t OldY, const uint32_t OldCount, const uint32_t Y, const uint32_t Count, const uint32_t Height, uint32_t& Offset, uint32_t& SharedCount) noexcept
+	{
+		const uint32_t OldOffset = (OldY + Height - Y) % Height;
+		const uint32_t NewOffset = (Y + Height - OldY) % Height;
+		if (OldOffset < Count)
+		{
+			Offset = OldOffset;
+			SharedCount = std::min(OldCount, Count - OldOffset);
+			return true;
+		}
+		if (NewOffset < OldCount)
+		{
+			Offset = 0;
+			SharedCount = std::min(OldCount - NewOffset, Count);
+			return true;
+		}
+		return false;
+	}
+
+	Generator::STexGenRegion GetWholeRegion(const uint32_t Width, const uint32_t Height) noexcept
+	{
+		return { 0, 0, Width, Height };
+	}
+
+	void FillRegion(const Generator::STexGenRegion& Region, uint32_t* Pixels, const size_t Stride) noexcept
+	{
+		for (uint32_t Y = 0; Y < Region.Height; ++Y)
+		{
+			std::fill(Pixels + Y * Stride, Pixels + Y * Stride + Region.Width, 0u);
+		}
+	}
+
+	// the kernels write Region of a Width x Height image to Pixels, rows Stride pixels apart
+
+	void RectangleRegion(const Generator::SRectangleParams& Params, const Generator::STexGenRegion& Region, const uint32_t Width, const uint32_t Height, uint32_t* Pixels, const size_t Stride)
+	{
+		const auto PositionX = DirectX::XMVectorReplicate(Params.Data.x);
+		const auto PositionY = DirectX::XMVectorReplicate(Params.Data.y);
+		const auto SizeX = DirectX::XMVectorReplicate(Params.Data.z);
+		const auto SizeY = DirectX::XMVectorReplicate(Params.Data.w);
+		const auto HalfTexel = DirectX::XMVectorReplicate(0.5f / 255.0f);
+		const auto ChamferScale = DirectX::XMVectorReplicate((1.0f + Params.Chamfer) / 2.0f);
+		const auto Exponent = DirectX::XMVectorReplicate(2.0f / Params.Chamfer);
+		const auto FalloffExponent = DirectX::XMVectorReplicate(1.0f / Params.Falloff * 10.0f);
+		const auto One = DirectX::XMVectorReplicate(1.0f);
+		const auto Half = DirectX::XMVectorReplicate(0.5f);
+		ForEachQuad(Region, Width, Height, [&](const uint32_t X, const uint32_t Y, const uint32_t Count, DirectX::FXMVECTOR U, DirectX::FXMVECTOR V)
+		{
+			// the operations of the shader in the same order, so rounding matches as far as possible
+			const auto CenterX = DirectX::XMVectorAdd(DirectX::XMVectorSubtract(PositionX, U), HalfTexel);
+			const auto CenterY = DirectX::XMVectorAdd(DirectX::XMVectorSubtract(PositionY, V), HalfTexel);
+			const auto DistanceX = DirectX::XMVectorAbs(DirectX::XMVectorDivide(DirectX::XMVectorDivide(CenterX, SizeX), ChamferScale));
+			const auto DistanceY = DirectX::XMVectorAbs(DirectX::XMVectorDivide(DirectX::XMVectorDivide(CenterY, SizeY), ChamferScale));
+			const auto Length = DirectX::XMVectorSubtract(One, DirectX::XMVectorSaturate(DirectX::XMVectorSqrt(DirectX::XMVectorAdd(Pow(DistanceX, Exponent), Pow(DistanceY, Exponent)))));
+			StoreGray(Pow(DirectX::XMVectorAbs(DirectX::XMVectorAdd(Length, Half)), FalloffExponent), Pixels + Y * Stride + X, Count);
+		});
+	}
+
+	void EnvMapRegion(const Generator::SEnvMapParams& Params, const Generator::STexGenRegion& Region, const uint32_t Width, const uint32_t Height, uint32_t* Pixels, const size_t Stride)
+	{
+		const auto& Radius = Params.Radius;
+		const auto Falloff = DirectX::XMVectorReplicate(Radius.x - Radius.y);
+		const auto Inner = DirectX::XMVectorReplicate(Radius.y);
+		const auto ScaleX = DirectX::XMVectorReplicate(Radius.z * Radius.x);
+		const auto ScaleY = DirectX::XMVectorReplicate(Radius.w * Radius.x);
+		const auto One = DirectX::XMVectorReplicate(1.0f);
+		const auto Half = DirectX::XMVectorReplicate(0.5f);
+		ForEachQuad(Region, Width, Height, [&](const uint32_t X, const uint32_t Y, const uint32_t Count, DirectX::FXMVECTOR U, DirectX::FXMVECTOR V)
+		{
+			const auto ScaledX = DirectX::XMVectorDivide(DirectX::XMVectorSubtract(U, Half), ScaleX);
+			const auto ScaledY = DirectX::XMVectorDivide(DirectX::XMVectorSubtract(V, Half), ScaleY);
+			const auto Length = DirectX::XMVectorSqrt(DirectX::XMVectorAdd(DirectX::XMVectorMultiply(ScaledX, ScaledX), DirectX::XMVectorMultiply(ScaledY, ScaledY)));
+			StoreGray(DirectX::XMVectorAdd(One, DirectX::XMVectorDivide(DirectX::XMVectorSubtract(Inner, Length), Falloff)), Pixels + Y * Stride + X, Count);
+		});
+	}
+
+	void LoopRegion(const Generator::SLoopParams& Params, const SImageView& Input, const Generator::STexGenRegion& Region, const uint32_t Width, const uint32_t Height, uint32_t* Pixels, const size_t Stride)
+	{
+		const auto DecodeTable = GetSrgbDecodeTable();
+		const auto RepeatX = DirectX::XMVectorReplicate(Params.Repeat.x);
+		const auto RepeatY = DirectX::XMVectorReplicate(Params.Repeat.y);
+		ForEachQuad(Region, Width, Height, [&](const uint32_t X, const uint32_t Y, const uint32_t Count, DirectX::FXMVECTOR U, DirectX::FXMVECTOR V)
+		{
+			DirectX::XMFLOAT4 SampleU;
+			DirectX::XMFLOAT4 SampleV;
+			DirectX::XMStoreFloat4(&SampleU, DirectX::XMVectorMultiply(U, RepeatX));
+			DirectX::XMStoreFloat4(&SampleV, DirectX::XMVectorMultiply(V, RepeatY));
+			const float LanesU[4] = { SampleU.x, SampleU.y, SampleU.z, SampleU.w };
+			const float LanesV[4] = { SampleV.x, SampleV.y, SampleV.z, SampleV.w };
+			auto Output = Pixels + Y * Stride + X;
+			for (uint32_t Lane = 0; Lane < Count; ++Lane)
+			{
+				Output[Lane] = StoreColor(Sample<true>(Input, LanesU[Lane], LanesV[Lane], DecodeTable));
+			}
+		});
+	}
+
+	void SineDistRegion(const Generator::SSineDistParams& Params, const SImageView& Input, const Generator::STexGenRegion& Region, const uint32_t Width, const uint32_t Height, uint32_t* Pixels, const size_t Stride)
+	{
+		const auto DecodeTable = GetSrgbDecodeTable();
+		const float Pi = 3.14159265f;
+		const auto FrequencyX = DirectX::XMVectorReplicate(Params.CountX * Pi * 2.0f);
+		const auto FrequencyY = DirectX::XMVectorReplicate(Params.CountY * Pi * 2.0f);
+		ForEachQuad(Region, Width, Height, [&](const uint32_t X, const uint32_t Y, const uint32_t Count, DirectX::FXMVECTOR U, DirectX::FXMVECTOR V)
+		{
+			DirectX::XMFLOAT4 SampleU;
+			DirectX::XMFLOAT4 SampleV;
+			DirectX::XMStoreFloat4(&SampleU, DirectX::XMVectorAdd(U, DirectX::XMVectorScale(DirectX::XMVectorCos(DirectX::XMVectorMultiply(FrequencyX, V)), Params.AmplX)));
+			DirectX::XMStoreFloat4(&SampleV, DirectX::XMVectorAdd(V, DirectX::XMVectorScale(DirectX::XMVectorCos(DirectX::XMVectorMultiply(FrequencyY, U)), Params.AmplY)));
+			const float LanesU[4] = { SampleU.x, SampleU.y, SampleU.z, SampleU.w };
+			const float LanesV[4] = { SampleV.x, SampleV.y, SampleV.z, SampleV.w };
+			auto Output = Pixels + Y * Stride + X;
+			for (uint32_t Lane = 0; Lane < Count; ++Lane)
+			{
+				Output[Lane] = StoreColor(Sample<false>(Input, LanesU[Lane], LanesV[Lane], DecodeTable));
+			}
+		});
+	}
+
+	double MillisecondsSince(const FClock::time_point Start) noexcept
+	{
+		return std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+	}
+}
+
+void Generator::GenerateRectangle(const SRectangleParams& Params, const uint32_t Width, const uint32_t Height, STexGenImage& Output)
+{
+	ResizeImage(Output, Width, Height);
+	RectangleRegion(Params, GetWholeRegion(Width, Height), Width, Height, Output.Pixels.data(), Width);
+}
+
+void Generator::GenerateEnvMap(const SEnvMapParams& Params, const uint32_t Width, const uint32_t Height, STexGenImage& Output)
+{
+	ResizeImage(Output, Width, Height);
+	EnvMapRegion(Params, GetWholeRegion(Width, Height), Width, Height, Output.Pixels.data(), Width);
+}
+
+void Generator::GenerateLoop(const SLoopParams& Params, const STexGenImage* Input, const uint32_t Width, const uint32_t Height, STexGenImage& Output)
+{
+	ResizeImage(Output, Width, Height);
+	if (Input == nullptr || Input->Pixels.empty())
+	{
+		std::fill(Output.Pixels.begin(), Output.Pixels.end(), 0u);
+		return;
+	}
+	LoopRegion(Params, MakeView(*Input), GetWholeRegion(Width, Height), Width, Height, Output.Pixels.data(), Width);
+}
+
+void Generator::GenerateSineDist(const SSineDistParams& Params, const STexGenImage* Input, const uint32_t Width, const uint32_t Height, STexGenImage& Output)
+{
+	ResizeImage(Output, Width, Height);
+	if (Input == nullptr || Input->Pixels.empty())
+	{
+		std::fill(Output.Pixels.begin(), Output.Pixels.end(), 0u);
+		return;
+	}
+	SineDistRegion(Params, MakeView(*Input), GetWholeRegion(Width, Height), Width, Height, Output.Pixels.data(), Width);
+}
+
+void Generator::FTexGenCpuGraph::Clear() noexcept
+{
+	NodeCount = 0;
+}
+
+Generator::FTexGenCpuGraph::SNode& Generator::FTexGenCpuGraph::AddNode(const ENodeType Type, const uint32_t Input)
+{
+	if (NodeCount == Nodes.size())
+	{
+		Nodes.emplace_back();
+	}
+	auto& Node = Nodes[NodeCount];
+	Node.Type = Type;
+	// anything not added yet, a node of a cycle for example, reads as unconnected
+	Node.Input = Input < NodeCount ? Input : NO_INPUT;
+	Node.Image = nullptr;
+	++NodeCount;
+	return Node;
+}
+
+uint32_t Generator::FTexGenCpuGraph::AddRectangle(const SRectangleParams& Params)
+{
+	AddNode(ENodeType::RECTANGLE, NO_INPUT).Rectangle = Params;
+	return static_cast<uint32_t>(NodeCount - 1);
+}
+
+uint32_t Generator::FTexGenCpuGraph::AddEnvMap(const SEnvMapParams& Params)
+{
+	AddNode(ENodeType::ENVMAP, NO_INPUT).EnvMap = Params;
+	return static_cast<uint32_t>(NodeCount - 1);
+}
+
+uint32_t Generator::FTexGenCpuGraph::AddLoop(const SLoopParams& Params, const uint32_t Input)
+{
+	AddNode(ENodeType::LOOP, Input).Loop = Params;
+	return static_cast<uint32_t>(NodeCount - 1);
+}
+
+uint32_t Generator::FTexGenCpuGraph::AddSineDist(const SSineDistParams& Params, const uint32_t Input)
+{
+	AddNode(ENodeType::SINE, Input).SineDist = Params;
+	return static_cast<uint32_t>(NodeCount - 1);
+}
+
+Generator::STexGenImage* Generator::FTexGenCpuGraph::AcquireImage()
+{
+	std::lock_guard<std::mutex> Lock(ImageMutex);
+	if (FreeImages.empty())
+	{
+		Images.push_back(std::unique_ptr<STexGenImage>(new STexGenImage()));
+		return Images.back().get();
+	}
+	auto Image = FreeImages.back();
+	FreeImages.pop_back();
+	return Image;
+}
+
+void Generator::FTexGenCpuGraph::ReleaseImage(STexGenImage* Image) noexcept
+{
+	std::lock_guard<std::mutex> Lock(ImageMutex);
+	FreeImages.push_back(Image);
+}
+
+void Generator::FTexGenCpuGraph::RunNode(const uint32_t Index, SJob* Root) noexcept
+{
+	auto& Node = Nodes[Index];
+	const auto Input = Node.Input != NO_INPUT ? Nodes[Node.Input].Image : nullptr;
+	const auto Start = FClock::now();
+	Node.Image = AcquireImage();
+	switch (Node.Type)
+	{
+	case ENodeType::RECTANGLE:
+		GenerateRectangle(Node.Rectangle, Width, Height, *Node.Image);
+		break;
+	case ENodeType::ENVMAP:
+		GenerateEnvMap(Node.EnvMap, Width, Height, *Node.Image);
+		break;
+	case ENodeType::LOOP:
+		GenerateLoop(Node.Loop, Input, Width, Height, *Node.Image);
+		break;
+	case ENodeType::SINE:
+		GenerateSineDist(Node.SineDist, Input, Width, Height, *Node.Image);
+		break;
+	default:
+		break;
+	}
+	Timings[Index] = { Node.Type, MillisecondsSince(Start) };
+
+	if (Node.Input != NO_INPUT && Node.Input != Output && PendingConsumers[Node.Input].fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		ReleaseImage(Input);
+	}
+	if (Index != Output && ConsumerOffsets[Index] == ConsumerOffsets[Index + 1])
+	{
+		ReleaseImage(Node.Image);
+	}
+	if (Root == nullptr)
+	{
+		return;
+	}
+	for (uint32_t Consumer = ConsumerOffsets[Index]; Consumer < ConsumerOffsets[Index + 1]; ++Consumer)
+	{
+		const auto Next = Consumers[Consumer];
+		if (PendingInputs[Next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			JobSystem->Run(JobSystem->CreateJob([this, Next, Root]() { RunNode(Next, Root); }, Root));
+		}
+	}
+}
+
+const Generator::STexGenImage* Generator::FTexGenCpuGraph::Evaluate(const uint32_t Width, const uint32_t Height, const uint32_t Output)
+{
+	this->Width = Width;
+	this->Height = Height;
+	this->Output = Output;
+	JobSystem = FJobSystem::GetCurrent();
+	{
+		std::lock_guard<std::mutex> Lock(ImageMutex);
+		FreeImages.clear();
+		for (const auto& Image : Images)
+		{
+			FreeImages.push_back(Image.get());
+		}
+	}
+	Timings.resize(NodeCount);
+
+	// readers of every node by counting sort, each range is counted up to its end first and
+	// filled back to front, which leaves the offsets at the starts of the ranges
+	ConsumerOffsets.assign(NodeCount + 1, 0);
+	for (size_t Index = 0; Index < NodeCount; ++Index)
+	{
+		if (Nodes[Index].Input != NO_INPUT)
+		{
+			++ConsumerOffsets[Nodes[Index].Input];
+		}
+	}
+	for (size_t Index = 1; Index <= NodeCount; ++Index)
+	{
+		ConsumerOffsets[Index] += ConsumerOffsets[Index - 1];
+	}
+	Consumers.resize(ConsumerOffsets[NodeCount]);
+	for (size_t Index = NodeCount; Index-- > 0;)
+	{
+		if (Nodes[Index].Input != NO_INPUT)
+		{
+			Consumers[--ConsumerOffsets[Nodes[Index].Input]] = static_cast<uint32_t>(Index);
+		}
+	}
+
+	if (CounterCapacity < NodeCount)
+	{
+		CounterCapacity = NodeCount;
+		PendingInputs.reset(new std::atomic<uint32_t>[CounterCapacity]);
+		PendingConsumers.reset(new std::atomic<uint32_t>[CounterCapacity]);
+	}
+	for (size_t Index = 0; Index < NodeCount; ++Index)
+	{
+		PendingInputs[Index].store(Nodes[Index].Input != NO_INPUT ? 1 : 0, std::memory_order_relaxed);
+		PendingConsumers[Index].store(ConsumerOffsets[Index + 1] - ConsumerOffsets[Index], std::memory_order_relaxed);
+	}
+
+	// a finished node starts every reader whose inputs are complete, so independent branches
+	// overlap and a chain runs one node after the other
+	if (JobSystem && JobSystem->GetThreadCount() > 1 && NodeCount > 1)
+	{
+		SJob* Root = JobSystem->CreateJob([]() {});
+		for (uint32_t Index = 0; Index < NodeCount; ++Index)
+		{
+			if (PendingInputs[Index].load(std::memory_order_relaxed) == 0)
+			{
+				JobSystem->Run(JobSystem->CreateJob([this, Index, Root]() { RunNode(Index, Root); }, Root));
+			}
+		}
+		JobSystem->Run(Root);
+		JobSystem->Wait(Root);
+	}
+	else
+	{
+		for (uint32_t Index = 0; Index < NodeCount; ++Index)
+		{
+			RunNode(Index, nullptr);
+		}
+	}
+	return Output < NodeCount ? Nodes[Output].Image : nullptr;
+}
+
+size_t Generator::FTexGenCpuGraph::GetNodeCount() const noexcept
+{
+	return NodeCount;
+}
+
+const std::vector<Generator::FTexGenCpuGraph::SNodeTiming>& Generator::FTexGenCpuGraph::GetTimings() const noexcept
+{
+	return Timings;
+}
+
+void Generator::FTexGenCpuGraph::ReleaseImages() noexcept
+{
+	std::lock_guard<std::mutex> Lock(ImageMutex);
+	for (size_t Index = 0; Index < NodeCount; ++Index)
+	{
+		Nodes[Index].Image = nullptr;
+	}
+	FreeImages.clear();
+	Images.clear();
+	BakeStages.clear();
+	BakeOutput = std::vector<uint32_t>();
+}
+
+size_t Generator::FTexGenCpuGraph::GetImagePoolSize() const noexcept
+{
+	return Images.size();
+}
+
+void Generator::FTexGenCpuGraph::RunStage(const uint32_t Stage, const STexGenRegion& Region, uint32_t* Pixels, const size_t Stride)
+{
+	const auto& Node = Nodes[BakeStages[Stage].Node];
+	if (Node.Type == ENodeType::RECTANGLE)
+	{
+		RectangleRegion(Node.Rectangle, Region, Width, Height, Pixels, Stride);
+		return;
+	}
+	if (Node.Type == ENodeType::ENVMAP)
+	{
+		EnvMapRegion(Node.EnvMap, Region, Width, Height, Pixels, Stride);
+		return;
+	}
+	if (Stage + 1 == BakeStages.size())
+	{
+		FillRegion(Region, Pixels, Stride);
+		return;
+	}
+	const auto& Input = BakeStages[Stage + 1];
+	const SImageView View{ Input.Image.Pixels.data(), static_cast<int32_t>(Width), static_cast<int32_t>(Height), 0, static_cast<int32_t>(Input.Y), Width };
+	if (Node.Type == ENodeType::LOOP)
+	{
+		LoopRegion(Node.Loop, View, Region, Width, Height, Pixels, Stride);
+	}
+	else
+	{
+		SineDistRegion(Node.SineDist, View, Region, Width, Height, Pixels, Stride);
+	}
+}
+
+void Generator::FTexGenCpuGraph::MoveWindow(const uint32_t Stage, const uint32_t Y, const uint32_t RowCount)
+{
+	auto& Input = BakeStages[Stage];
+	if (Input.bIsWhole || (Input.RowCount > 0 && Input.Y == Y && Input.RowCount == RowCount))
+	{
+		return;
+	}
+	if (RowCount == Height)
+	{
+		MakeStageWhole(Stage);
+		return;
+	}
+
+	// rows the window held before move to where they are in the new one, only the others are computed
+	uint32_t Offset = 0;
+	uint32_t SharedCount = 0;
+	auto& Pixels = Input.Image.Pixels;
+	if (Input.RowCount > 0 && FindSharedRows(Input.Y, Input.RowCount, Y, RowCount, Height, Offset, SharedCount))
+	{
+		const uint32_t OldOffset = (Y + Offset + Height - Input.Y) % Height;
+		Pixels.resize(static_cast<size_t>(Width) * std::max(Input.RowCount, RowCount));
+		memmove(Pixels.data() + static_cast<size_t>(Offset) * Width, Pixels.data() + static_cast<size_t>(OldOffset) * Width, static_cast<size_t>(SharedCount) * Width * sizeof(uint32_t));
+	}
+	Pixels.resize(static_cast<size_t>(Width) * RowCount);
+	Input.Image.Width = Width;
+	Input.Image.Height = RowCount;
+	Input.Y = Y;
+	Input.RowCount = RowCount;
+	if (Offset > 0)
+	{
+		BakeBand(Stage, Y, Offset, Pixels.data());
+	}
+	if (Offset + SharedCount < RowCount)
+	{
+		BakeBand(Stage, (Y + Offset + SharedCount) % Height, RowCount - Offset - SharedCount, Pixels.data() + static_cast<size_t>(Offset + SharedCount) * Width);
+	}
+}
+
+void Generator::FTexGenCpuGraph::BakeBand(const uint32_t Stage, const uint32_t Y, const uint32_t RowCount, uint32_t* Pixels)
+{
+	if (Stage + 1 < BakeStages.size())
+	{
+		const auto& Node = Nodes[BakeStages[Stage].Node];
+		uint32_t InputY = 0;
+		uint32_t InputCount = 0;
+		GetInputRows(Node.Type, Node.Loop, Node.SineDist, Y, RowCount, Height, InputY, InputCount);
+		MoveWindow(Stage + 1, InputY, InputCount);
+	}
+	RunStage(Stage, { 0, Y, Width, RowCount }, Pixels, Width);
+	UpdateBakeBytes();
+}
+
+void Generator::FTexGenCpuGraph::MakeStageWhole(const uint32_t Stage)
+{
+	auto& Image = BakeStages[Stage].Image;
+	ResizeImage(Image, Width, Height);
+	for (uint32_t Y = 0; Y < Height; Y += BakeBandHeight)
+	{
+		BakeBand(Stage, Y, std::min(BakeBandHeight, Height - Y), Image.Pixels.data() + static_cast<size_t>(Y) * Width);
+	}
+	BakeStages[Stage].Y = 0;
+	BakeStages[Stage].RowCount = Height;
+	BakeStages[Stage].bIsWhole = true;
+}
+
+void Generator::FTexGenCpuGraph::UpdateBakeBytes() noexcept
+{
+	size_t Bytes = BakeOutput.capacity() * sizeof(uint32_t);
+	for (const auto& Stage : BakeStages)
+	{
+		Bytes += Stage.Image.Pixels.capacity() * sizeof(uint32_t);
+	}
+	BakeBytes = std::max(BakeBytes, Bytes);
+}
+
+bool Generator::FTexGenCpuGraph::Bake(const uint32_t Width, const uint32_t Height, const uint32_t Output, const uint32_t BandHeight, const FTexGenRowWriter& Writer)
+{
+	BakeBytes = 0;
+	if (Output >= NodeCount || Width == 0 || Height == 0 || BandHeight == 0)
+	{
+		return false;
+	}
+	this->Width = Width;
+	this->Height = Height;
+	BakeBandHeight = BandHeight;
+
+	// every node has one input, so what Output reads is a single chain; the images of the stages
+	// stay allocated from the last bake
+	size_t StageCount = 0;
+	for (auto Node = Output; ; Node = Nodes[Node].Input)
+	{
+		if (StageCount == BakeStages.size())
+		{
+			BakeStages.emplace_back();
+		}
+		auto& Stage = BakeStages[StageCount++];
+		Stage.Node = Node;
+		Stage.Y = 0;
+		Stage.RowCount = 0;
+		Stage.bIsWhole = false;
+		const auto Type = Nodes[Node].Type;
+		if (Type == ENodeType::RECTANGLE || Type == ENodeType::ENVMAP || Nodes[Node].Input == NO_INPUT)
+		{
+			break;
+		}
+	}
+	BakeStages.resize(StageCount);
+
+	bool bWritten = true;
+	BakeOutput.resize(static_cast<size_t>(Width) * std::min(BandHeight, Height));
+	for (uint32_t Y = 0; Y < Height && bWritten; Y += BandHeight)
+	{
+		const uint32_t RowCount = std::min(BandHeight, Height - Y);
+		BakeBand(0, Y, RowCount, BakeOutput.data());
+		bWritten = Writer(BakeOutput.data(), RowCount);
+	}
+
+	// whole images are as large as the output, they do not stay around like the windows
+	for (auto& Stage : BakeStages)
+	{
+		if (Stage.bIsWhole)
+		{
+			Stage.Image = STexGenImage();
+			Stage.bIsWhole = false;
+		}
+		Stage.RowCount = 0;
+	}
+	return bWritten;
+}
+
+size_t Generator::FTexGenCpuGraph::GetBakeBytes() const noexcept
+{
+	return BakeBytes;
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class FJobSystem;
+struct SJob;
+
+// Everything the TexGen nodes compute, without Direct3D, so textures can be generated where
+// there is no GPU.
+namespace Generator
+{
+	enum class ENodeType
+	{
+		SCALAR,
+		VECTOR2,
+		VECTOR4,
+		LOOP,
+		RECTANGLE,
+		SINE,
+		ENVMAP,
+		OUTPUT
+	};
+
+	// constant buffers of the node shaders, the CPU kernels take the same values
+	struct SRectangleParams
+	{
+		DirectX::XMFLOAT4 Data; // X1 Y1 X2 Y2
+		float Chamfer;
+		float Falloff;
+	};
+
+	struct SLoopParams
+	{
+		DirectX::XMFLOAT2 Repeat;
+	};
+
+	struct SSineDistParams
+	{
+		float CountX;
+		float AmplX;
+		float CountY;
+		float AmplY;
+	};
+
+	struct SEnvMapParams
+	{
+		DirectX::XMFLOAT4 Radius; // outer, inner, scale X, scale Y
+	};
+
+	// Laid out like the RGBA8 (DXGI_FORMAT_R8G8B8A8_UNORM_SRGB) node targets: red in
+	// the lowest byte, color sRGB encoded and alpha linear.
+	struct STexGenImage
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		std::vector<uint32_t> Pixels;
+	};
+
+	// A window of an image, it wraps around at the right and bottom edges when it reaches past them
+	struct STexGenRegion
+	{
+		uint32_t X;
+		uint32_t Y;
+		uint32_t Width;
+		uint32_t Height;
+	};
+
+	static constexpr uint32_t TEXGEN_TILE_SIZE = 64;
+	// rows of the bands FTexGenCpuGraph::Bake evaluates the output in
+	static constexpr uint32_t TEXGEN_BAKE_BAND_HEIGHT = 256;
+
+	// Takes the rows of a bake from the top down, RowCount rows of the bake's width laid out like
+	// STexGenImage. Returning false stops the bake.
+	using FTexGenRowWriter = std::function<bool(const uint32_t* Pixels, const uint32_t RowCount)>;
+
+	// CPU versions of Rectangle.hlsl, EnvMap.hlsl, Loop.hlsl and SineDist.hlsl. Output is resized
+	// to Width x Height and written in TEXGEN_TILE_SIZE tiles in parallel, four pixels of a row at
+	// a time. A null Input samples as zero like an unbound texture does.
+	void GenerateRectangle(const SRectangleParams& Params, const uint32_t Width, const uint32_t Height, STexGenImage& Output);
+	void GenerateEnvMap(const SEnvMapParams& Params, const uint32_t Width, const uint32_t Height, STexGenImage& Output);
+	void GenerateLoop(const SLoopParams& Params, const STexGenImage* Input, const uint32_t Width, const uint32_t Height, STexGenImage& Output);
+	void GenerateSineDist(const SSineDistParams& Params, const STexGenImage* Input, const uint32_t Width, const uint32_t Height, STexGenImage& Output);
+
+	// A node graph flattened into evaluation order for the kernels above. Nodes without a path
+	// between them run concurrently on the job system of the calling thread, if it has one, and
+	// the tiles of every node are split across the workers as well. Images come from a pool, an
+	// intermediate one goes back as soon as the last node reading it finished, so the memory held
+	// is bounded by the images alive at once instead of by the number of nodes.
+	class FTexGenCpuGraph
+	{
+	public:
+		static constexpr uint32_t NO_INPUT = ~0u;
+
+		struct SNodeTiming
+		{
+			ENodeType Type;
+			double Milliseconds;
+		};
+
+		FTexGenCpuGraph() = default;
+		FTexGenCpuGraph(const FTexGenCpuGraph&) = delete;
+		FTexGenCpuGraph& operator=(const FTexGenCpuGraph&) = delete;
+
+		// keeps the image pool so evaluating again does not reallocate
+		void Clear() noexcept;
+		// each returns the index of the new node, inputs have to be added before the nodes using them
+		uint32_t AddRectangle(const SRectangleParams& Params);
+		uint32_t AddEnvMap(const SEnvMapParams& Params);
+		uint32_t AddLoop(const SLoopParams& Params, const uint32_t Input);
+		uint32_t AddSineDist(const SSineDistParams& Params, const uint32_t Input);
+
+		// runs every node and returns the image of Output, null if Output is not a node. The image
+		// stays valid until the next Evaluate or Clear.
+		const STexGenImage* Evaluate(const uint32_t Width, const uint32_t Height, const uint32_t Output);
+
+		size_t GetNodeCount() const noexcept;
+		// one entry per node of the last Evaluate, in the order the nodes were added
+		const std::vector<SNodeTiming>& GetTimings() const noexcept;
+		// frees the image pool, the image returned by the last Evaluate with it
+		void ReleaseImages() noexcept;
+		// images the pool had to allocate so far, the most that were alive at once
+		size_t GetImagePoolSize() const noexcept;
+
+		// Evaluates Output in bands of BandHeight rows and hands each one to Writer when it is done,
+		// so the image is never in memory whole. Only the nodes Output reads from run, and each one
+		// only for the rows its reader needs: a Loop the rows its repeats land on, a SineDist the
+		// rows grown by its amplitude. A node keeps its rows from one band to the next, so rows that
+		// consecutive bands share are computed once. A node whose reader needs all of its rows at
+		// once is computed in full and kept until the bake ends. The pixels are the ones Evaluate
+		// computes. Returns false if Output is not a node or Writer stopped the bake.
+		bool Bake(const uint32_t Width, const uint32_t Height, const uint32_t Output, const uint32_t BandHeight, const FTexGenRowWriter& Writer);
+		// most bytes the images of the last Bake held at once
+		size_t GetBakeBytes() const noexcept;
+
+	private:
+		struct SNode
+		{
+			ENodeType Type;
+			SRectangleParams Rectangle;
+			SEnvMapParams EnvMap;
+			SLoopParams Loop;
+			SSineDistParams SineDist;
+			uint32_t Input;
+			STexGenImage* Image;
+		};
+
+		// a node Bake runs and the rows of its image it holds, RowCount rows from Y on wrapping
+		// around at the bottom
+		struct SBakeStage
+		{
+			uint32_t Node;
+			uint32_t Y;
+			uint32_t RowCount;
+			bool bIsWhole;
+			STexGenImage Image;
+		};
+
+		SNode& AddNode(const ENodeType Type, const uint32_t Input);
+		void RunNode(const uint32_t Index, SJob* Root) noexcept;
+		STexGenImage* AcquireImage();
+		void ReleaseImage(STexGenImage* Image) noexcept;
+		void BakeBand(const uint32_t Stage, const uint32_t Y, const uint32_t RowCount, uint32_t* Pixels);
+		void MoveWindow(const uint32_t Stage, const uint32_t Y, const uint32_t RowCount);
+		void RunStage(const uint32_t Stage, const STexGenRegion& Region, uint32_t* Pixels, const size_t Stride);
+		void MakeStageWhole(const uint32_t Stage);
+		void UpdateBakeBytes() noexcept;
+
+		std::vector<SNode> Nodes;
+		size_t NodeCount = 0;
+		std::vector<SNodeTiming> Timings;
+
+		// state of the running Evaluate, the readers of node N are Consumers[ConsumerOffsets[N]]
+		// up to Consumers[ConsumerOffsets[N + 1] - 1]
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		uint32_t Output = NO_INPUT;
+		FJobSystem* JobSystem = nullptr;
+		std::vector<uint32_t> ConsumerOffsets;
+		std::vector<uint32_t> Consumers;
+		std::unique_ptr<std::atomic<uint32_t>[]> PendingInputs;
+		std::unique_ptr<std::atomic<uint32_t>[]> PendingConsumers;
+		size_t CounterCapacity = 0;
+
+		std::mutex ImageMutex;
+		std::vector<std::unique_ptr<STexGenImage>> Images;
+		std::vector<STexGenImage*> FreeImages;
+
+		// the nodes of a running Bake from its output back to the node without an input
+		std::vector<SBakeStage> BakeStages;
+		std::vector<uint32_t> BakeOutput;
+		uint32_t BakeBandHeight = TEXGEN_BAKE_BAND_HEIGHT;
+		size_t BakeBytes = 0;
+	};
+}
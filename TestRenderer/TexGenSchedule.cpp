@@ -0,0 +1,76 @@
+#include "TexGenSchedule.hpp"
+
+// out of line definition, C++14 needs one when the constant is bound to a reference
+constexpr uint32_t Generator::FTexGenSchedule::NO_NODE;
+
+namespace
+{
+	enum ENodeState : uint8_t
+	{
+		UNVISITED,
+		ON_PATH,
+		SCHEDULED
+	};
+}
+
+void Generator::FTexGenSchedule::Compile(const uint32_t* SlotCounts, const size_t NodeCount, const STexGenEdge* Edges, const size_t EdgeCount, const uint32_t Output)
+{
+	InputOffsets.resize(NodeCount + 1);
+	uint32_t Offset = 0;
+	for (size_t Node = 0; Node < NodeCount; ++Node)
+	{
+		InputOffsets[Node] = Offset;
+		Offset += SlotCounts[Node];
+	}
+	InputOffsets[NodeCount] = Offset;
+	Inputs.assign(Offset, NO_NODE);
+	for (size_t Index = 0; Index < EdgeCount; ++Index)
+	{
+		const auto& Edge = Edges[Index];
+		if (Edge.Node < NodeCount && Edge.Input < NodeCount && Edge.Slot < SlotCounts[Edge.Node])
+		{
+			Inputs[InputOffsets[Edge.Node] + Edge.Slot] = Edge.Input;
+		}
+	}
+
+	Order.clear();
+	if (Output >= NodeCount)
+	{
+		return;
+	}
+
+	// depth first from the output, a node is scheduled once all of its inputs are
+	States.assign(NodeCount, UNVISITED);
+	Stack.clear();
+	NextSlots.clear();
+	Stack.push_back(Output);
+	NextSlots.push_back(0);
+	States[Output] = ON_PATH;
+	while (!Stack.empty())
+	{
+		const auto Node = Stack.back();
+		auto& Slot = NextSlots.back();
+		if (Slot == GetInputCount(Node))
+		{
+			States[Node] = SCHEDULED;
+			Order.push_back(Node);
+			Stack.pop_back();
+			NextSlots.pop_back();
+			continue;
+		}
+
+		auto& Input = Inputs[InputOffsets[Node] + Slot++];
+		if (Input == NO_NODE || States[Input] == SCHEDULED)
+		{
+			continue;
+		}
+		if (States[Input] == ON_PATH)
+		{
+			Input = NO_NODE;
+			continue;
+		}
+		States[Input] = ON_PATH;
+		Stack.push_back(Input);
+		NextSlots.push_back(0);
+	}
+}
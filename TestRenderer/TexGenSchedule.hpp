@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Generator
+{
+	// input Slot of Node reads the output of Input, all three are indices
+	struct STexGenEdge
+	{
+		uint32_t Node;
+		uint32_t Slot;
+		uint32_t Input;
+	};
+
+	// A node graph compiled into the order it has to be evaluated in. Inputs are stored CSR style,
+	// the slots of node N are Inputs[InputOffsets[N]] to Inputs[InputOffsets[N + 1] - 1], so reading
+	// an input during evaluation is an array lookup. Compiled once per structural edit.
+	class FTexGenSchedule
+	{
+	public:
+		static constexpr uint32_t NO_NODE = ~0u;
+
+		// SlotCounts holds the number of input slots of each node. Edges with out of range indices
+		// are ignored, a second edge into the same slot replaces the first. Edges closing a cycle
+		// are dropped, so every input in the schedule is evaluated before the node reading it.
+		void Compile(const uint32_t* SlotCounts, const size_t NodeCount, const STexGenEdge* Edges, const size_t EdgeCount, const uint32_t Output);
+
+		// nodes Output depends on followed by Output, empty when Output is not a node
+		const std::vector<uint32_t>& GetOrder() const noexcept { return Order; }
+		// NO_NODE for unconnected slots
+		const uint32_t* GetInputs(const uint32_t Node) const noexcept { return Inputs.data() + InputOffsets[Node]; }
+		uint32_t GetInputCount(const uint32_t Node) const noexcept { return InputOffsets[Node + 1] - InputOffsets[Node]; }
+		uint32_t GetInputOffset(const uint32_t Node) const noexcept { return InputOffsets[Node]; }
+		size_t GetNodeCount() const noexcept { return InputOffsets.empty() ? 0 : InputOffsets.size() - 1; }
+
+	private:
+		std::vector<uint32_t> InputOffsets;
+		std::vector<uint32_t> Inputs;
+		std::vector<uint32_t> Order;
+
+		// traversal state, kept so compiling again does not allocate
+		std::vector<uint8_t> States;
+		std::vector<uint32_t> Stack;
+		std::vector<uint32_t> NextSlots;
+	};
+}
@@ -0,0 +1,266 @@
+#include "TextureCache.hpp"
+#include "stb_image.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+
+#if !defined(_WIN32)
+#include <climits>
+#endif
+
+namespace
+{
+	constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+	constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+	uint64_t HashBytes(const uint8_t* Data, const size_t Size, uint64_t Hash = FNV_OFFSET_BASIS) noexcept
+	{
+		for (size_t Index = 0; Index < Size; ++Index)
+		{
+			Hash ^= Data[Index];
+			Hash *= FNV_PRIME;
+		}
+		return Hash;
+	}
+
+	template <typename TType>
+	uint64_t HashValue(const TType& Value, const uint64_t Hash) noexcept
+	{
+		return HashBytes(reinterpret_cast<const uint8_t*>(&Value), sizeof(TType), Hash);
+	}
+
+	std::string CanonicalizePath(const char* FileName)
+	{
+#if defined(_WIN32)
+		char Buffer[_MAX_PATH] = { 0 };
+		std::string Path = _fullpath(Buffer, FileName, _MAX_PATH) ? Buffer : FileName;
+		for (auto& Character : Path)
+		{
+			// NTFS paths are case insensitive and accept both separators
+			Character = Character == '\\' ? '/' : static_cast<char>(std::tolower(static_cast<unsigned char>(Character)));
+		}
+#else
+		char Buffer[PATH_MAX] = { 0 };
+		std::string Path = realpath(FileName, Buffer) ? Buffer : FileName;
+#endif
+		return Path;
+	}
+
+	std::string MakeKey(const std::string& Name, const DXGI_FORMAT Format)
+	{
+		return Name + '|' + std::to_string(static_cast<uint32_t>(Format));
+	}
+
+	bool ReadFile(const char* FileName, std::vector<uint8_t>& Contents)
+	{
+		FILE* File = fopen(FileName, "rb");
+		if (File == nullptr)
+		{
+			return false;
+		}
+		fseek(File, 0, SEEK_END);
+		const auto Size = ftell(File);
+		fseek(File, 0, SEEK_SET);
+		if (Size <= 0)
+		{
+			fclose(File);
+			return false;
+		}
+		Contents.resize(static_cast<size_t>(Size));
+		const auto Read = fread(Contents.data(), 1, Contents.size(), File);
+		fclose(File);
+		return Read == Contents.size();
+	}
+}
+
+FTextureCache::FTextureCache(FRenderer& Renderer) : InternalRenderer(Renderer)
+{
+}
+
+FTextureCache::~FTextureCache()
+{
+	for (auto& Entry : Entries)
+	{
+		InternalRenderer.DestroyTexture(Entry.second.Texture);
+	}
+}
+
+EErrorCode FTextureCache::Acquire(const char* FileName, const DXGI_FORMAT Format, SRenderTarget& Texture) noexcept
+{
+	if (FileName == nullptr || FileName[0] == '\0')
+	{
+		return EErrorCode::INVALIDCALL;
+	}
+
+	const auto Key = MakeKey(CanonicalizePath(FileName), Format);
+	const auto PathIterator = PathLookup.find(Key);
+	if (PathIterator != PathLookup.end())
+	{
+		AddHit(Entries[PathIterator->second], Texture);
+		return EErrorCode::OK;
+	}
+
+	std::vector<uint8_t> Contents;
+	if (!ReadFile(FileName, Contents))
+	{
+		return EErrorCode::FILENOTFOUND;
+	}
+
+	// same image under a different path, alias the path to the existing texture
+	const auto ContentHash = HashValue(Format, HashBytes(Contents.data(), Contents.size()));
+	const auto ContentIterator = ContentLookup.find(ContentHash);
+	if (ContentIterator != ContentLookup.end())
+	{
+		// the hash only finds a candidate, a collision must not hand out another image
+		auto& Entry = Entries[ContentIterator->second];
+		if (Entry.Format == Format && Entry.Source == Contents)
+		{
+			Entry.Keys.push_back(Key);
+			PathLookup.emplace(Key, ContentIterator->second);
+			++Statistics.ContentHits;
+			AddHit(Entry, Texture);
+			return EErrorCode::OK;
+		}
+	}
+
+	int ImageWidth = 0;
+	int ImageHeight = 0;
+	int Components = 0;
+	uint8_t* ImageData = stbi_load_from_memory(Contents.data(), static_cast<int>(Contents.size()), &ImageWidth, &ImageHeight, &Components, 4);
+	if (ImageData == nullptr)
+	{
+		return EErrorCode::FAIL;
+	}
+
+	SRenderTarget NewTexture{};
+	const auto Result = InternalRenderer.CreateTextureFromMemory(ImageData, ImageWidth, ImageHeight, 4, Format, NewTexture);
+	stbi_image_free(ImageData);
+	if (Result != EErrorCode::OK)
+	{
+		return Result;
+	}
+	NewTexture.Width = ImageWidth;
+	NewTexture.Height = ImageHeight;
+
+	AddEntry(Key, ContentHash, static_cast<uint64_t>(ImageWidth) * ImageHeight * 4, Format, std::move(Contents), NewTexture);
+	Texture = NewTexture;
+	return EErrorCode::OK;
+}
+
+EErrorCode FTextureCache::AcquireFromMemory(const char* Name, const uint8_t* Data, const uint32_t Width, const uint32_t Height, const uint8_t Components, const DXGI_FORMAT Format, SRenderTarget& Texture) noexcept
+{
+	const auto Key = MakeKey(std::string("memory:") + Name, Format);
+	const auto PathIterator = PathLookup.find(Key);
+	if (PathIterator != PathLookup.end())
+	{
+		AddHit(Entries[PathIterator->second], Texture);
+		return EErrorCode::OK;
+	}
+
+	SRenderTarget NewTexture{};
+	const auto Result = InternalRenderer.CreateTextureFromMemory(Data, Width, Height, Components, Format, NewTexture);
+	if (Result != EErrorCode::OK)
+	{
+		return Result;
+	}
+	NewTexture.Width = Width;
+	NewTexture.Height = Height;
+
+	const auto ByteSize = static_cast<uint64_t>(Width) * Height * Components;
+	auto ContentHash = HashBytes(Data, static_cast<size_t>(ByteSize));
+	ContentHash = HashValue(Width, HashValue(Height, HashValue(Format, ContentHash)));
+	AddEntry(Key, ContentHash, ByteSize, Format, {}, NewTexture);
+	Texture = NewTexture;
+	return EErrorCode::OK;
+}
+
+void FTextureCache::AddReference(const SRenderTarget& Texture) noexcept
+{
+	const auto Iterator = Entries.find(Texture.ShaderResourceView);
+	if (Iterator != Entries.end())
+	{
+		++Iterator->second.ReferenceCount;
+	}
+}
+
+void FTextureCache::Release(SRenderTarget& Texture) noexcept
+{
+	const auto Iterator = Entries.find(Texture.ShaderResourceView);
+	if (Iterator == Entries.end())
+	{
+		return;
+	}
+
+	Texture = SRenderTarget{};
+
+	auto& Entry = Iterator->second;
+	if (--Entry.ReferenceCount > 0)
+	{
+		return;
+	}
+
+	for (const auto& Key : Entry.Keys)
+	{
+		PathLookup.erase(Key);
+	}
+	// after a collision the hash can belong to another entry
+	const auto ContentIterator = ContentLookup.find(Entry.ContentHash);
+	if (ContentIterator != ContentLookup.end() && ContentIterator->second == Iterator->first)
+	{
+		ContentLookup.erase(ContentIterator);
+	}
+	Statistics.BytesResident -= Entry.ByteSize;
+	InternalRenderer.DestroyTexture(Entry.Texture);
+	Entries.erase(Iterator);
+}
+
+const FTextureCache::SStatistics& FTextureCache::GetStatistics() const noexcept
+{
+	return Statistics;
+}
+
+void FTextureCache::OnGui() noexcept
+{
+	ImGui::Begin("Texture Cache");
+	{
+		ImGui::Text("Textures: %u", static_cast<uint32_t>(Entries.size()));
+		ImGui::Text("Resident: %.2f MB", static_cast<double>(Statistics.BytesResident) / (1024.0 * 1024.0));
+		ImGui::Text("Hits: %llu (by content %llu)", static_cast<unsigned long long>(Statistics.Hits), static_cast<unsigned long long>(Statistics.ContentHits));
+		ImGui::Text("Misses: %llu", static_cast<unsigned long long>(Statistics.Misses));
+		ImGui::Text("Saved: %.2f MB", static_cast<double>(Statistics.BytesSaved) / (1024.0 * 1024.0));
+		ImGui::Separator();
+		for (const auto& Entry : Entries)
+		{
+			ImGui::Text("%3u x %s", Entry.second.ReferenceCount, Entry.second.Keys.front().c_str());
+		}
+	}
+	ImGui::End();
+}
+
+void FTextureCache::AddEntry(const std::string& Key, const uint64_t ContentHash, const uint64_t ByteSize, const DXGI_FORMAT Format, std::vector<uint8_t> Source, const SRenderTarget& Texture) noexcept
+{
+	SEntry Entry{};
+	Entry.Texture = Texture;
+	Entry.Keys.push_back(Key);
+	Entry.ContentHash = ContentHash;
+	Entry.ByteSize = ByteSize;
+	Entry.Format = Format;
+	Entry.Source = std::move(Source);
+	Entry.ReferenceCount = 1;
+
+	PathLookup.emplace(Key, Texture.ShaderResourceView);
+	// keeps the first entry on a collision, the later one is only found by its path
+	ContentLookup.emplace(ContentHash, Texture.ShaderResourceView);
+	Statistics.BytesResident += Entry.ByteSize;
+	++Statistics.Misses;
+	Entries.emplace(Texture.ShaderResourceView, std::move(Entry));
+}
+
+void FTextureCache::AddHit(SEntry& Entry, SRenderTarget& Texture) noexcept
+{
+	++Entry.ReferenceCount;
+	++Statistics.Hits;
+	Statistics.BytesSaved += Entry.ByteSize;
+	Texture = Entry.Texture;
+}
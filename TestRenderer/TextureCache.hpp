@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Renderer.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Shares decoded and uploaded textures between every material that references them.
+// Textures are looked up by canonical path plus format first and by a hash of the file
+// contents second, so the same image referenced through different paths is only decoded once.
+// A content hash match is only reused after the format and the file bytes compared equal.
+class FTextureCache
+{
+public:
+	struct SStatistics
+	{
+		uint64_t Hits = 0;
+		uint64_t ContentHits = 0;
+		uint64_t Misses = 0;
+		uint64_t BytesSaved = 0;
+		uint64_t BytesResident = 0;
+	};
+
+	explicit FTextureCache(FRenderer& Renderer);
+	~FTextureCache();
+
+	FTextureCache(const FTextureCache&) = delete;
+	FTextureCache& operator=(const FTextureCache&) = delete;
+
+	// returns a shared texture, every successful acquire has to be paired with a release
+	EErrorCode Acquire(const char* FileName, const DXGI_FORMAT Format, SRenderTarget& Texture) noexcept;
+	EErrorCode AcquireFromMemory(const char* Name, const uint8_t* Data, const uint32_t Width, const uint32_t Height, const uint8_t Components, const DXGI_FORMAT Format, SRenderTarget& Texture) noexcept;
+	void AddReference(const SRenderTarget& Texture) noexcept;
+	void Release(SRenderTarget& Texture) noexcept;
+
+	const SStatistics& GetStatistics() const noexcept;
+	void OnGui() noexcept;
+
+private:
+	struct SEntry
+	{
+		SRenderTarget Texture{};
+		std::vector<std::string> Keys{};
+		uint64_t ContentHash = 0;
+		uint64_t ByteSize = 0;
+		DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+		// the encoded file, empty for textures created from memory which are never matched by content
+		std::vector<uint8_t> Source{};
+		uint32_t ReferenceCount = 0;
+	};
+
+	void AddEntry(const std::string& Key, const uint64_t ContentHash, const uint64_t ByteSize, const DXGI_FORMAT Format, std::vector<uint8_t> Source, const SRenderTarget& Texture) noexcept;
+	void AddHit(SEntry& Entry, SRenderTarget& Texture) noexcept;
+
+	FRenderer& InternalRenderer;
+
+	std::unordered_map<ID3D11ShaderResourceView*, SEntry> Entries;
+	std::unordered_map<std::string, ID3D11ShaderResourceView*> PathLookup;
+	std::unordered_map<uint64_t, ID3D11ShaderResourceView*> ContentLookup;
+
+	SStatistics Statistics{};
+};
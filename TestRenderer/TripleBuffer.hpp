@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Hands whole values from one writer thread to one reader thread without locks. The writer fills
+// its own slot and swaps it with the spare one on Publish, the reader swaps the spare slot in on
+// Update, so neither side waits and the reader never sees a value that is still being written.
+// Values published faster than they are read are dropped, the reader always gets the newest one.
+template <typename T>
+class TTripleBuffer
+{
+public:
+	// writer side, the slot holds whatever was written into it two publishes ago
+	T& GetWriteBuffer() noexcept
+	{
+		return Slots[WriteIndex].Value;
+	}
+
+	void Publish() noexcept
+	{
+		WriteIndex = Spare.exchange(WriteIndex | DIRTY, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	// reader side, true when a value was published since the last call
+	bool Update() noexcept
+	{
+		if ((Spare.load(std::memory_order_relaxed) & DIRTY) == 0)
+		{
+			return false;
+		}
+		ReadIndex = Spare.exchange(ReadIndex, std::memory_order_acq_rel) & INDEX_MASK;
+		return true;
+	}
+
+	bool HasUpdate() const noexcept
+	{
+		return (Spare.load(std::memory_order_relaxed) & DIRTY) != 0;
+	}
+
+	const T& GetReadBuffer() const noexcept
+	{
+		return Slots[ReadIndex].Value;
+	}
+
+private:
+	static constexpr uint32_t INDEX_MASK = 3;
+	static constexpr uint32_t DIRTY = 4;
+
+	// the sides touch different slots at all times, padding keeps them off each other's cache lines
+	struct SSlot
+	{
+		T Value{};
+		char Padding[64]{};
+	};
+	SSlot Slots[3];
+
+	uint32_t WriteIndex = 0;
+	char WritePadding[64]{};
+	std::atomic<uint32_t> Spare{ 1 };
+	char SparePadding[64]{};
+	uint32_t ReadIndex = 2;
+};
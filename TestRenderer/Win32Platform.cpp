@@ -0,0 +1,140 @@
+#include "Win32Platform.hpp"
+
+#include "imgui/imgui_impl_win32.h"
+#include <chrono>
+
+extern LRESULT ImGui_ImplWin32_WndProcHandler(HWND HWnd, UINT Msg, WPARAM WParam, LPARAM LParam);
+
+FWin32Platform::~FWin32Platform()
+{
+	if (Window)
+	{
+		DestroyWindow(Window);
+	}
+	if (Instance)
+	{
+		UnregisterClass("WindowClass", Instance);
+	}
+}
+
+EErrorCode FWin32Platform::Initialize(const HINSTANCE InInstance, const uint32_t InWidth, const uint32_t InHeight, const int ShowCommand) noexcept
+{
+	Instance = InInstance;
+	Width = InWidth;
+	Height = InHeight;
+
+	ImGui_ImplWin32_EnableDpiAwareness();
+	WNDCLASSEX WindowClass{};
+	WindowClass.cbSize = sizeof(WNDCLASSEX);
+	WindowClass.style = CS_HREDRAW | CS_VREDRAW;
+	WindowClass.lpfnWndProc = WindowProc;
+	WindowClass.hInstance = Instance;
+	WindowClass.hCursor = LoadCursor(nullptr, IDC_ARROW);
+	WindowClass.lpszClassName = "WindowClass";
+	RegisterClassEx(&WindowClass);
+
+	RECT WindowRect = { 0, 0, static_cast<LONG>(Width), static_cast<LONG>(Height)};
+	AdjustWindowRect(&WindowRect, WS_OVERLAPPEDWINDOW, FALSE);
+
+	Window = CreateWindowEx(0, "WindowClass", "Test Renderer", WS_OVERLAPPEDWINDOW, 300, 300, WindowRect.right - WindowRect.left, WindowRect.bottom - WindowRect.top, nullptr, nullptr, Instance, this);
+	if (Window == nullptr)
+	{
+		return EErrorCode::FAIL;
+	}
+	ShowWindow(Window, ShowCommand);
+	UpdateWindow(Window);
+
+	// showing the window reports its initial size, the renderer is created with it anyway
+	bResized = false;
+	return EErrorCode::OK;
+}
+
+bool FWin32Platform::PumpEvents() noexcept
+{
+	MSG Msg{};
+	while (PeekMessage(&Msg, nullptr, 0, 0, PM_REMOVE))
+	{
+		TranslateMessage(&Msg);
+		DispatchMessage(&Msg);
+
+		if (Msg.message == WM_QUIT)
+		{
+			ExitCode = static_cast<int>(Msg.wParam);
+			return false;
+		}
+	}
+	return true;
+}
+
+double FWin32Platform::GetTime() noexcept
+{
+	static const auto Start = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - Start).count();
+}
+
+uint32_t FWin32Platform::GetWidth() const noexcept
+{
+	return Width;
+}
+
+uint32_t FWin32Platform::GetHeight() const noexcept
+{
+	return Height;
+}
+
+bool FWin32Platform::ConsumeResize() noexcept
+{
+	const bool bWasResized = bResized;
+	bResized = false;
+	return bWasResized;
+}
+
+void* FWin32Platform::GetNativeWindow() const noexcept
+{
+	return Window;
+}
+
+int FWin32Platform::GetExitCode() const noexcept
+{
+	return ExitCode;
+}
+
+LRESULT CALLBACK FWin32Platform::WindowProc(const HWND HWnd, const UINT Message, const WPARAM WParam, const LPARAM LParam)
+{
+	if (ImGui_ImplWin32_WndProcHandler(HWnd, Message, WParam, LParam))
+	{
+		return true;
+	}
+	if (Message == WM_NCCREATE)
+	{
+		const auto CreateStruct = reinterpret_cast<const CREATESTRUCT*>(LParam);
+		SetWindowLongPtr(HWnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(CreateStruct->lpCreateParams));
+	}
+	auto Platform = reinterpret_cast<FWin32Platform*>(GetWindowLongPtr(HWnd, GWLP_USERDATA));
+	switch (Message)
+	{
+	case WM_DESTROY:
+	{
+		if (Platform)
+		{
+			Platform->Window = nullptr;
+		}
+		PostQuitMessage(0);
+		return 0;
+	}
+	case WM_SIZE:
+	{
+		if (Platform && WParam != SIZE_MINIMIZED)
+		{
+			Platform->Width = static_cast<uint32_t>(LOWORD(LParam));
+			Platform->Height = static_cast<uint32_t>(HIWORD(LParam));
+			Platform->bResized = true;
+		}
+	}
+	default:
+	{
+		break;
+	}
+	}
+	return DefWindowProc(HWnd, Message, WParam, LParam);
+}
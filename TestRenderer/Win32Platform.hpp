@@ -0,0 +1,40 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include "Platform.hpp"
+#include "Renderer.hpp"
+
+// A top level window whose messages go to ImGui's Win32 backend first.
+class FWin32Platform final : public FPlatform
+{
+public:
+	FWin32Platform() = default;
+	~FWin32Platform();
+
+	FWin32Platform(const FWin32Platform&) = delete;
+	FWin32Platform& operator=(const FWin32Platform&) = delete;
+
+	EErrorCode Initialize(const HINSTANCE Instance, const uint32_t Width, const uint32_t Height, const int ShowCommand) noexcept;
+
+	bool PumpEvents() noexcept override;
+	double GetTime() noexcept override;
+	uint32_t GetWidth() const noexcept override;
+	uint32_t GetHeight() const noexcept override;
+	bool ConsumeResize() noexcept override;
+	void* GetNativeWindow() const noexcept override;
+
+	// wParam of the WM_QUIT message, valid once PumpEvents returned false
+	int GetExitCode() const noexcept;
+
+private:
+	static LRESULT CALLBACK WindowProc(const HWND HWnd, const UINT Message, const WPARAM WParam, const LPARAM LParam);
+
+	HINSTANCE Instance = nullptr;
+	HWND Window = nullptr;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	bool bResized = false;
+	int ExitCode = 0;
+};
@@ -0,0 +1,600 @@
+#include "../TestRenderer/ImageWriter.hpp"
+#include "../TestRenderer/JobSystem.hpp"
+#include "../TestRenderer/TexGenGraph.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Bakes TexGen graph files, as the Texture Generator window saves them, with the CPU kernels and
+// writes their outputs as PNG or EXR. No GPU is needed.
+//
+// TexGenBaker [-out=<directory>] [-size=<n>[,<n>...]] [-format=png|exr[,...]] [-jobs=<n>] [-threads=<n>]
+//             [-encoders=<n>] [-band=<rows>] [-list=<file>] [-json=<file>] <graph file>...
+//
+// -jobs graphs are baked at once, each on a job system of -threads threads. By default half the
+// hardware threads bake a graph each and the threads are shared out between them. Finished bands
+// of rows are handed to -encoders threads that write the files while the next bands are baked, all
+// bands of a file go to the same encoder so they stay in order. A bake waits when the encoders fall
+// behind, so memory stays bounded by a few bands per job.
+//
+// Every size is baked once and written in every format. Without -size the resolution of the graph's
+// output is baked, without -format outputs of an 8 bit format are written as PNG and the others as
+// EXR. -list names more graph files, one per line, lines starting with # are skipped. Outputs are
+// <out>/<graph file name>.png and .exr, with _<size> before the extension when several sizes are
+// baked, so graph files in different directories need different names. The output directory has to
+// exist. Prints a line per output and the graphs per hour, -json writes them as json as well.
+// Returns 0 when every output was written and 1 otherwise.
+
+namespace
+{
+	using FClock = std::chrono::steady_clock;
+
+	constexpr uint32_t FORMAT_PNG = 1;
+	constexpr uint32_t FORMAT_EXR = 2;
+
+	struct SOptions
+	{
+		std::string OutputDirectory = ".";
+		std::vector<uint32_t> Sizes;
+		// FORMAT_ flags, 0 picks from the format of the output
+		uint32_t Formats = 0;
+		size_t JobCount = 0;
+		size_t ThreadCount = 0;
+		size_t EncoderCount = 1;
+		uint32_t BandHeight = Generator::TEXGEN_BAKE_BAND_HEIGHT;
+	};
+
+	// one size of one graph
+	struct SBakeTask
+	{
+		std::string GraphFileName;
+		// 0 for the resolution of the graph's output
+		uint32_t RequestedSize = 0;
+
+		// set by the baking thread before the first band is queued, the encoder only touches the
+		// writers after that
+		uint32_t Size = 0;
+		uint32_t Formats = 0;
+		std::string FileNames[2];
+		FPngWriter Png;
+		FExrWriter Exr;
+		std::atomic<bool> bWriteFailed{ false };
+
+		// filled in by the baking thread
+		const char* Error = nullptr;
+		double BakeMilliseconds = 0.0;
+		size_t BakeBytes = 0;
+		// filled in by the encoder
+		double EncodeMilliseconds = 0.0;
+		uint64_t BytesWritten = 0;
+	};
+
+	struct SEncodeItem
+	{
+		SBakeTask* Task;
+		// null once the bake of Task ended
+		std::vector<uint32_t>* Band;
+		uint32_t RowCount;
+	};
+
+	// Band buffers the baking threads fill and the encoders empty, a bake waits while all of them are queued
+	class FBandPool
+	{
+	public:
+		explicit FBandPool(const size_t Count)
+			: Bands(Count)
+		{
+			for (auto& Band : Bands)
+			{
+				Free.push_back(&Band);
+			}
+		}
+
+		std::vector<uint32_t>* Acquire()
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			Condition.wait(Lock, [this]() { return !Free.empty(); });
+			auto Band = Free.back();
+			Free.pop_back();
+			return Band;
+		}
+
+		void Release(std::vector<uint32_t>* Band)
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				Free.push_back(Band);
+			}
+			Condition.notify_one();
+		}
+
+	private:
+		std::mutex Mutex;
+		std::condition_variable Condition;
+		std::vector<std::vector<uint32_t>> Bands;
+		std::vector<std::vector<uint32_t>*> Free;
+	};
+
+	// Writes the bands queued to it on a thread of its own, in the order they were queued
+	class FEncoder
+	{
+	public:
+		explicit FEncoder(FBandPool& Pool)
+			: Pool(Pool)
+		{
+			Thread = std::thread([this]() { Run(); });
+		}
+
+		FEncoder(const FEncoder&) = delete;
+		FEncoder& operator=(const FEncoder&) = delete;
+
+		void Push(const SEncodeItem& Item)
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				Items.push_back(Item);
+			}
+			Condition.notify_one();
+		}
+
+		// writes what is still queued and ends the thread
+		void Finish()
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				bIsFinishing = true;
+			}
+			Condition.notify_one();
+			Thread.join();
+		}
+
+	private:
+		void Run()
+		{
+			for (;;)
+			{
+				SEncodeItem Item;
+				{
+					std::unique_lock<std::mutex> Lock(Mutex);
+					Condition.wait(Lock, [this]() { return !Items.empty() || bIsFinishing; });
+					if (Items.empty())
+					{
+						return;
+					}
+					Item = Items.front();
+					Items.pop_front();
+				}
+				Encode(Item);
+			}
+		}
+
+		void Encode(const SEncodeItem& Item)
+		{
+			auto& Task = *Item.Task;
+			const auto Start = FClock::now();
+			if (Item.Band)
+			{
+				// a failed file is not written to anymore, the bake stops at its next band
+				const auto Pixels = Item.Band->data();
+				const bool bWritten = !Task.bWriteFailed && ((Task.Formats & FORMAT_PNG) == 0 || Task.Png.WriteRows(Pixels, Item.RowCount)) &&
+					((Task.Formats & FORMAT_EXR) == 0 || Task.Exr.WriteRows(Pixels, Item.RowCount));
+				Pool.Release(Item.Band);
+				if (!bWritten)
+				{
+					Task.bWriteFailed = true;
+				}
+			}
+			else
+			{
+				// Close fails for a file that is missing rows, which a bake that stopped leaves behind
+				const bool bPngClosed = (Task.Formats & FORMAT_PNG) == 0 || Task.Png.Close();
+				const bool bExrClosed = (Task.Formats & FORMAT_EXR) == 0 || Task.Exr.Close();
+				if (!bPngClosed || !bExrClosed)
+				{
+					Task.bWriteFailed = true;
+				}
+				Task.BytesWritten = Task.Png.GetBytesWritten() + Task.Exr.GetBytesWritten();
+			}
+			Task.EncodeMilliseconds += std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+		}
+
+		FBandPool& Pool;
+		std::mutex Mutex;
+		std::condition_variable Condition;
+		std::deque<SEncodeItem> Items;
+		bool bIsFinishing = false;
+		std::thread Thread;
+	};
+
+	bool IsEightBit(const Generator::ETexGenFormat Format) noexcept
+	{
+		return Format == Generator::ETexGenFormat::R8 || Format == Generator::ETexGenFormat::RGBA8;
+	}
+
+	// the file name without its directory and extension
+	std::string GetStem(const std::string& FileName)
+	{
+		const auto Separator = FileName.find_last_of("/\\");
+		auto Stem = Separator == std::string::npos ? FileName : FileName.substr(Separator + 1);
+		const auto Dot = Stem.find_last_of('.');
+		return Dot == std::string::npos || Dot == 0 ? Stem : Stem.substr(0, Dot);
+	}
+
+	bool OpenOutputs(SBakeTask& Task, const SOptions& Options)
+	{
+		auto Base = Options.OutputDirectory + "/" + GetStem(Task.GraphFileName);
+		if (Options.Sizes.size() > 1)
+		{
+			Base += "_" + std::to_string(Task.Size);
+		}
+		Task.FileNames[0] = Task.Formats & FORMAT_PNG ? Base + ".png" : std::string();
+		Task.FileNames[1] = Task.Formats & FORMAT_EXR ? Base + ".exr" : std::string();
+		if ((Task.Formats & FORMAT_PNG) != 0 && !Task.Png.Open(Task.FileNames[0].c_str(), Task.Size, Task.Size))
+		{
+			return false;
+		}
+		if ((Task.Formats & FORMAT_EXR) != 0 && !Task.Exr.Open(Task.FileNames[1].c_str(), Task.Size, Task.Size))
+		{
+			Task.Png.Close();
+			return false;
+		}
+		return true;
+	}
+
+	// takes tasks until none are left, every baking thread has a job system of its own so the
+	// graphs it bakes are split across its threads only
+	void BakeTasks(std::vector<SBakeTask>& Tasks, std::atomic<size_t>& NextTask, const SOptions& Options, FBandPool& Pool, std::vector<std::unique_ptr<FEncoder>>& Encoders)
+	{
+		FJobSystem JobSystem;
+		JobSystem.Initialize(Options.ThreadCount);
+		Generator::FTexGenGraph Graph;
+		Generator::FTexGenCpuGraph CpuGraph;
+		for (size_t Index = NextTask++; Index < Tasks.size(); Index = NextTask++)
+		{
+			auto& Task = Tasks[Index];
+			const auto Start = FClock::now();
+			if (!Graph.Load(Task.GraphFileName.c_str()))
+			{
+				Task.Error = "cannot be read";
+				continue;
+			}
+			CpuGraph.Clear();
+			const auto Output = Graph.AddToCpuGraph(CpuGraph);
+			if (Output == Generator::FTexGenCpuGraph::NO_INPUT)
+			{
+				Task.Error = "has no connected output";
+				continue;
+			}
+			Generator::ETexGenFormat Format;
+			uint32_t Resolution;
+			Graph.ResolveOutput(Format, Resolution);
+			Task.Size = Task.RequestedSize != 0 ? Task.RequestedSize : Resolution;
+			Task.Formats = Options.Formats != 0 ? Options.Formats : IsEightBit(Format) ? FORMAT_PNG : FORMAT_EXR;
+			if (!OpenOutputs(Task, Options))
+			{
+				Task.Error = "cannot create its output files";
+				continue;
+			}
+
+			auto& Encoder = *Encoders[Index % Encoders.size()];
+			const bool bBaked = CpuGraph.Bake(Task.Size, Task.Size, Output, Options.BandHeight, [&](const uint32_t* Pixels, const uint32_t RowCount)
+			{
+				auto Band = Pool.Acquire();
+				Band->assign(Pixels, Pixels + static_cast<size_t>(RowCount) * Task.Size);
+				Encoder.Push({ &Task, Band, RowCount });
+				return !Task.bWriteFailed;
+			});
+			Encoder.Push({ &Task, nullptr, 0 });
+			Task.BakeMilliseconds = std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+			Task.BakeBytes = CpuGraph.GetBakeBytes();
+			if (!bBaked && !Task.bWriteFailed)
+			{
+				Task.Error = "cannot be baked";
+			}
+		}
+		CpuGraph.ReleaseImages();
+		JobSystem.Shutdown();
+	}
+
+	const char* GetError(const SBakeTask& Task) noexcept
+	{
+		return Task.Error ? Task.Error : Task.bWriteFailed ? "cannot be written" : nullptr;
+	}
+
+	// a json string, only quotes and backslashes of the file names need escaping
+	void PrintString(FILE* File, const std::string& String)
+	{
+		fputc('"', File);
+		for (const auto Character : String)
+		{
+			if (Character == '"' || Character == '\\')
+			{
+				fputc('\\', File);
+			}
+			fputc(Character, File);
+		}
+		fputc('"', File);
+	}
+
+	bool ReadList(const char* FileName, std::vector<std::string>& GraphFileNames)
+	{
+		FILE* File = fopen(FileName, "r");
+		if (File == nullptr)
+		{
+			return false;
+		}
+		char Line[4096];
+		while (fgets(Line, sizeof(Line), File))
+		{
+			size_t Length = strlen(Line);
+			while (Length > 0 && (Line[Length - 1] == '\n' || Line[Length - 1] == '\r' || Line[Length - 1] == ' ' || Line[Length - 1] == '\t'))
+			{
+				--Length;
+			}
+			if (Length > 0 && Line[0] != '#')
+			{
+				GraphFileNames.emplace_back(Line, Length);
+			}
+		}
+		fclose(File);
+		return true;
+	}
+
+	// a comma separated list, false if any entry is not a positive number
+	bool ParseSizes(const char* Text, std::vector<uint32_t>& Sizes)
+	{
+		for (;;)
+		{
+			char* End = nullptr;
+			const auto Size = strtoul(Text, &End, 10);
+			if (End == Text || Size == 0 || Size > (1u << 27))
+			{
+				return false;
+			}
+			Sizes.push_back(static_cast<uint32_t>(Size));
+			if (*End == '\0')
+			{
+				return true;
+			}
+			if (*End != ',')
+			{
+				return false;
+			}
+			Text = End + 1;
+		}
+	}
+
+	bool ParseFormats(const char* Text, uint32_t& Formats)
+	{
+		for (;;)
+		{
+			const char* End = strchr(Text, ',');
+			const size_t Length = End ? static_cast<size_t>(End - Text) : strlen(Text);
+			if (Length == 3 && strncmp(Text, "png", 3) == 0)
+			{
+				Formats |= FORMAT_PNG;
+			}
+			else if (Length == 3 && strncmp(Text, "exr", 3) == 0)
+			{
+				Formats |= FORMAT_EXR;
+			}
+			else
+			{
+				return false;
+			}
+			if (End == nullptr)
+			{
+				return true;
+			}
+			Text = End + 1;
+		}
+	}
+
+	void PrintUsage()
+	{
+		printf("usage: TexGenBaker [-out=<directory>] [-size=<n>[,<n>...]] [-format=png|exr[,...]] [-jobs=<n>] [-threads=<n>] [-encoders=<n>] [-band=<rows>] [-list=<file>] [-json=<file>] <graph file>...\n");
+	}
+}
+
+int main(int ArgumentCount, char** Arguments)
+{
+	SOptions Options;
+	std::vector<std::string> GraphFileNames;
+	const char* JsonFileName = nullptr;
+	for (int Index = 1; Index < ArgumentCount; ++Index)
+	{
+		const char* Argument = Arguments[Index];
+		bool bValid = true;
+		if (strncmp(Argument, "-out=", 5) == 0)
+		{
+			Options.OutputDirectory = Argument + 5;
+		}
+		else if (strncmp(Argument, "-size=", 6) == 0)
+		{
+			bValid = ParseSizes(Argument + 6, Options.Sizes);
+		}
+		else if (strncmp(Argument, "-format=", 8) == 0)
+		{
+			bValid = ParseFormats(Argument + 8, Options.Formats);
+		}
+		else if (strncmp(Argument, "-jobs=", 6) == 0)
+		{
+			Options.JobCount = std::max<size_t>(1, strtoul(Argument + 6, nullptr, 10));
+		}
+		else if (strncmp(Argument, "-threads=", 9) == 0)
+		{
+			Options.ThreadCount = std::max<size_t>(1, strtoul(Argument + 9, nullptr, 10));
+		}
+		else if (strncmp(Argument, "-encoders=", 10) == 0)
+		{
+			Options.EncoderCount = std::max<size_t>(1, strtoul(Argument + 10, nullptr, 10));
+		}
+		else if (strncmp(Argument, "-band=", 6) == 0)
+		{
+			Options.BandHeight = std::max(1u, static_cast<uint32_t>(strtoul(Argument + 6, nullptr, 10)));
+		}
+		else if (strncmp(Argument, "-list=", 6) == 0)
+		{
+			if (!ReadList(Argument + 6, GraphFileNames))
+			{
+				fprintf(stderr, "cannot read %s\n", Argument + 6);
+				return 1;
+			}
+		}
+		else if (strncmp(Argument, "-json=", 6) == 0)
+		{
+			JsonFileName = Argument + 6;
+		}
+		else if (Argument[0] != '-')
+		{
+			GraphFileNames.emplace_back(Argument);
+		}
+		else
+		{
+			bValid = false;
+		}
+		if (!bValid)
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+	if (GraphFileNames.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const auto SizeCount = std::max<size_t>(1, Options.Sizes.size());
+	std::vector<SBakeTask> Tasks(GraphFileNames.size() * SizeCount);
+	for (size_t Graph = 0; Graph < GraphFileNames.size(); ++Graph)
+	{
+		for (size_t Size = 0; Size < SizeCount; ++Size)
+		{
+			auto& Task = Tasks[Graph * SizeCount + Size];
+			Task.GraphFileName = GraphFileNames[Graph];
+			Task.RequestedSize = Options.Sizes.empty() ? 0 : Options.Sizes[Size];
+		}
+	}
+
+	const size_t HardwareThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	if (Options.JobCount == 0)
+	{
+		Options.JobCount = std::max<size_t>(1, HardwareThreads / 2);
+	}
+	Options.JobCount = std::min(Options.JobCount, Tasks.size());
+	if (Options.ThreadCount == 0)
+	{
+		Options.ThreadCount = std::max<size_t>(1, HardwareThreads / Options.JobCount);
+	}
+
+	// two bands per job, one being filled while the other one is written, and one per encoder
+	FBandPool Pool(Options.JobCount * 2 + Options.EncoderCount);
+	std::vector<std::unique_ptr<FEncoder>> Encoders;
+	for (size_t Encoder = 0; Encoder < Options.EncoderCount; ++Encoder)
+	{
+		Encoders.emplace_back(new FEncoder(Pool));
+	}
+
+	const auto Start = FClock::now();
+	std::atomic<size_t> NextTask{ 0 };
+	std::vector<std::thread> Jobs;
+	for (size_t Job = 0; Job < Options.JobCount; ++Job)
+	{
+		Jobs.emplace_back([&]() { BakeTasks(Tasks, NextTask, Options, Pool, Encoders); });
+	}
+	for (auto& Job : Jobs)
+	{
+		Job.join();
+	}
+	for (auto& Encoder : Encoders)
+	{
+		Encoder->Finish();
+	}
+	const double Seconds = std::chrono::duration<double>(FClock::now() - Start).count();
+
+	// a graph counts once all of its sizes were written
+	size_t FailedCount = 0;
+	size_t FailedGraphCount = 0;
+	double PixelCount = 0.0;
+	for (size_t Graph = 0; Graph < GraphFileNames.size(); ++Graph)
+	{
+		bool bGraphFailed = false;
+		for (size_t Size = 0; Size < SizeCount; ++Size)
+		{
+			const auto& Task = Tasks[Graph * SizeCount + Size];
+			if (const auto Error = GetError(Task))
+			{
+				printf("%s: %s\n", Task.GraphFileName.c_str(), Error);
+				bGraphFailed = true;
+				++FailedCount;
+				continue;
+			}
+			printf("%s: %ux%u in %.1f ms, %.1f ms encoding, %.2f MB written, %.2f MB of images\n", Task.GraphFileName.c_str(), Task.Size, Task.Size, Task.BakeMilliseconds, Task.EncodeMilliseconds,
+				Task.BytesWritten / (1024.0 * 1024.0), Task.BakeBytes / (1024.0 * 1024.0));
+			PixelCount += static_cast<double>(Task.Size) * Task.Size;
+		}
+		FailedGraphCount += bGraphFailed ? 1 : 0;
+	}
+	const size_t BakedGraphCount = GraphFileNames.size() - FailedGraphCount;
+	const double GraphsPerHour = Seconds > 0.0 ? BakedGraphCount * 3600.0 / Seconds : 0.0;
+	const double MegapixelsPerSecond = Seconds > 0.0 ? PixelCount / Seconds / 1e6 : 0.0;
+	printf("%zu of %zu graphs baked in %.2f s with %zu jobs of %zu threads and %zu encoders: %.0f graphs/hour, %.2f Mpx/s\n", BakedGraphCount, GraphFileNames.size(), Seconds,
+		Options.JobCount, Options.ThreadCount, Options.EncoderCount, GraphsPerHour, MegapixelsPerSecond);
+
+	if (JsonFileName)
+	{
+		FILE* Json = fopen(JsonFileName, "w");
+		if (Json == nullptr)
+		{
+			fprintf(stderr, "cannot write %s\n", JsonFileName);
+			return 1;
+		}
+		fprintf(Json, "{\n\t\"graphs\": %zu,\n\t\"failed_graphs\": %zu,\n\t\"jobs\": %zu,\n\t\"threads\": %zu,\n\t\"encoders\": %zu,\n\t\"band\": %u,\n\t\"seconds\": %.4f,\n\t\"graphs_per_hour\": %.2f,\n\t\"megapixels_per_second\": %.4f,\n",
+			GraphFileNames.size(), FailedGraphCount, Options.JobCount, Options.ThreadCount, Options.EncoderCount, Options.BandHeight, Seconds, GraphsPerHour, MegapixelsPerSecond);
+		fprintf(Json, "\t\"outputs\": [");
+		for (size_t Index = 0; Index < Tasks.size(); ++Index)
+		{
+			const auto& Task = Tasks[Index];
+			const auto Error = GetError(Task);
+			fprintf(Json, "%s\n\t\t{ \"graph\": ", Index == 0 ? "" : ",");
+			PrintString(Json, Task.GraphFileName);
+			fprintf(Json, ", \"size\": %u, \"files\": [", Task.Size);
+			bool bIsFirst = true;
+			for (const auto& FileName : Task.FileNames)
+			{
+				if (!FileName.empty())
+				{
+					fprintf(Json, "%s", bIsFirst ? "" : ", ");
+					PrintString(Json, FileName);
+					bIsFirst = false;
+				}
+			}
+			fprintf(Json, "], \"bake_ms\": %.4f, \"encode_ms\": %.4f, \"bytes\": %llu, \"image_bytes\": %zu, \"error\": ", Task.BakeMilliseconds, Task.EncodeMilliseconds,
+				static_cast<unsigned long long>(Task.BytesWritten), Task.BakeBytes);
+			if (Error)
+			{
+				PrintString(Json, Error);
+			}
+			else
+			{
+				fprintf(Json, "null");
+			}
+			fprintf(Json, " }");
+		}
+		fprintf(Json, "\n\t]\n}\n");
+		fclose(Json);
+	}
+	return FailedCount == 0 ? 0 : 1;
+}